@@ -73,6 +73,9 @@
      int  filesystem_mkdir     ( char *pathname, mode_t mode );
      int  filesystem_rmdir     ( char *pathname );
      int  filesystem_mkpath    ( char *pathname );
+     int  filesystem_mkdir_p   ( char *pathname, mode_t mode );
+     int  filesystem_rmtree    ( char *pathname );
+     int  filesystem_walk      ( char *pathname, int (*walk_fn)(char *path, int is_dir, int depth, void *arg), void *arg );
 
      DIR           *filesystem_opendir  ( char *name );
      long           filesystem_telldir  ( DIR  *dirp );
@@ -0,0 +1,115 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _KV_INDEX_H_
+#define _KV_INDEX_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "base/filesystem.h"
+     #include <pthread.h>
+     #include <libgen.h>
+
+
+  /* ... Const / Const ................................................. */
+
+     // Log file header
+     #define KV_INDEX_MAGIC           "XPNKVLOG"
+     #define KV_INDEX_VERSION         1
+
+     // Log record types
+     #define KV_INDEX_RECORD_PUT      1
+     #define KV_INDEX_RECORD_DEL      2
+
+     // Compact when the dead part of the log is bigger than the live part and than...
+     #define KV_INDEX_COMPACT_MIN     (4 * 1024 * 1024)
+
+     // Initial number of hash buckets (power of two)
+     #define KV_INDEX_INITIAL_BUCKETS 1024
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     struct kv_index_entry
+     {
+         struct kv_index_entry *next;
+         uint32_t hash;
+         uint32_t key_len;
+         char    *key;
+         char     value[];   // value_size bytes, followed by the key
+     };
+
+     //
+     // Path-keyed index of fixed-size values:
+     //  * all the entries are kept in memory (chained hash table)
+     //  * every update is appended to a log file as a checksummed record
+     //  * on open, the log is replayed until the first torn record, which is cut off
+     //
+     typedef struct
+     {
+         pthread_mutex_t mutex;
+
+         char     log_path[PATH_MAX];
+         int      fd;
+         int      sync;          // fdatasync after every update
+         size_t   value_size;
+
+         struct kv_index_entry **buckets;
+         long     n_buckets;
+         long     n_entries;
+
+         off_t    log_size;      // bytes in the log file
+         off_t    live_size;     // bytes of the records still alive
+     } kv_index_t;
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     kv_index_t *kv_index_open       ( char *log_path, size_t value_size, int sync );
+     int         kv_index_close      ( kv_index_t *kv );
+
+     int         kv_index_get        ( kv_index_t *kv, char *key, void *value );
+     int         kv_index_put        ( kv_index_t *kv, char *key, void *value );
+     int         kv_index_update     ( kv_index_t *kv, char *key, int (*update_fn)(void *value, void *arg), void *arg );
+     int         kv_index_del        ( kv_index_t *kv, char *key );
+     int         kv_index_del_prefix ( kv_index_t *kv, char *prefix );
+     int         kv_index_rename     ( kv_index_t *kv, char *old_prefix, char *new_prefix );
+
+     int         kv_index_foreach    ( kv_index_t *kv, int (*foreach_fn)(char *key, void *value, void *arg), void *arg );
+     int         kv_index_compact    ( kv_index_t *kv );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
@@ -0,0 +1,66 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _LZ4_CODEC_H_
+#define _LZ4_CODEC_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "debug_msg.h"
+
+
+  /* ... Const / Const ................................................. */
+
+     // codecs for the data sent to the servers
+     #define XPN_CODEC_NONE   0
+     #define XPN_CODEC_LZ4    1
+
+     // worst case size of the compressed data
+     #define LZ4_CODEC_BOUND(size)  ((size) + ((size) / 255) + 16)
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     // LZ4 block format, no frame. They return the size of the output or -1.
+     // Compression also fails when the result does not fit in dst_capacity, so a small
+     // capacity makes it give up early on data that is not worth compressing.
+     int lz4_codec_compress   ( const char *src, int src_size, char *dst, int dst_capacity );
+     int lz4_codec_decompress ( const char *src, int src_size, char *dst, int dst_size );
+
+     int lz4_codec_from_name  ( const char *name );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
@@ -0,0 +1,65 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#ifndef _MPI_PIPE_H_
+#define _MPI_PIPE_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "debug_msg.h"
+     #include "utils.h"
+
+
+  /* ... Const / Const ................................................. */
+
+     // Messages longer than this are split into pieces that travel at the same time.
+     // Both sides must split the same way, so it is not configurable.
+     #define MPI_PIPE_CHUNK             (256 * 1024)
+
+     // Pieces in flight (env XPN_MPI_INFLIGHT)
+     #define MPI_PIPE_DEFAULT_INFLIGHT  8
+
+
+  /* ... Functions / Funciones ......................................... */
+
+#ifdef ENABLE_MPI_SERVER
+     int mpi_pipe_send ( void *data, ssize_t size, int dest,   int tag, MPI_Comm comm );
+     int mpi_pipe_recv ( void *data, ssize_t size, int source, int tag, MPI_Comm comm );
+#endif
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
@@ -57,6 +57,10 @@
      #define CONST_TEMP 1024
      #endif
 
+     // lookups are served from memory, the DNS file is checked for changes at most once per period
+     #define NS_CACHE_BUCKETS       1024
+     #define NS_CACHE_CHECK_DEFAULT 1    // seconds (env XPN_NS_CHECK)
+
 
   /* ... Functions / Funciones ......................................... */
 
@@ -65,8 +69,16 @@
 
      int ns_publish    ( char * dns_file, char * protocol, char * param_srv_name, char * srv_ip, char * port_name ) ;
      int ns_unpublish  ( char * dns_file, char * protocol, char * param_srv_name ) ;
+     // srv_ip has room for CONST_TEMP bytes and port_name for MAX_PORT_NAME_LENGTH bytes
      int ns_lookup     (                  char * protocol, char * param_srv_name, char * srv_ip, char * port_name ) ;
 
+#ifdef ENABLE_MPI_SERVER
+     // collective: rank 0 reads the DNS file and the rest of 'comm' gets it from it.
+     // Opt-in for MPI programs that call ns_lookup from every rank, once after MPI_Init
+     // (the client and the servers of Expand get the port names from the servers, not from the DNS file)
+     int ns_bcast      ( MPI_Comm comm,   char * protocol ) ;
+#endif
+
 
   /* ................................................................... */
 
@@ -44,8 +44,13 @@
       #define SOCKET_ACCEPT_CODE_MPI            100
       #define SOCKET_ACCEPT_CODE_SCK_CONN       151
       #define SOCKET_ACCEPT_CODE_SCK_NO_CONN    152
+      #define SOCKET_ACCEPT_CODE_SHM_CONN       153
       #define SOCKET_FINISH_CODE                750
       #define SOCKET_FINISH_CODE_AWAIT          751
+      #define SOCKET_STATS_CODE                 760
+
+      // answer instead of a port name when the server is at its connection limit
+      #define SOCKET_BUSY_ANSWER                "busy"
 
       #ifdef MPI_MAX_PORT_NAME
         #define MAX_PORT_NAME_LENGTH MPI_MAX_PORT_NAME
@@ -58,6 +63,7 @@
 
      int sersoc_do_send_recv ( char * srv_name, int port, int req_id, char *res_val ) ;
      int sersoc_do_send      ( char * srv_name, int port, int req_id ) ;
+     int sersoc_do_send_msg_recv ( char * srv_name, int port, int req_id, char *msg, char *res_val ) ;
 
      int sersoc_lookup_port_name ( char * srv_name, char * port_name, int socket_accept_code ) ;
 
@@ -0,0 +1,113 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _SHM_RING_H_
+#define _SHM_RING_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "debug_msg.h"
+     #include "utils.h"
+
+
+  /* ... Const / Const ................................................. */
+
+     #define SHM_RING_MAGIC         0x58504e52   // "XPNR"
+     #define SHM_RING_DEFAULT_SIZE  (1024 * 1024) // bytes per direction (env XPN_SHM_SIZE)
+
+     // index of each ring inside the channel
+     #define SHM_RING_TO_SERVER     0
+     #define SHM_RING_TO_CLIENT     1
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     // One single-producer/single-consumer byte stream.
+     // head and tail only grow; seq words are the futex doorbells.
+     typedef struct
+     {
+         uint64_t head;        // bytes written by the producer
+         uint32_t head_seq;    // changes every time head moves
+         uint32_t head_wait;   // consumer sleeping on head_seq
+         char     pad1[48];
+         uint64_t tail;        // bytes read by the consumer
+         uint32_t tail_seq;    // changes every time tail moves
+         uint32_t tail_wait;   // producer sleeping on tail_seq
+         char     pad2[48];
+     } shm_ring_ctl_t;
+
+     // Shared header at the beginning of the mapping, followed by the data of both rings
+     typedef struct
+     {
+         uint32_t magic;
+         uint32_t ring_size;
+         int32_t  client_pid;
+         int32_t  server_pid;
+         uint32_t closed;
+         char     pad[44];
+         shm_ring_ctl_t ring[2];
+     } shm_ring_hdr_t;
+
+     // Local view of one side of the channel
+     typedef struct
+     {
+         shm_ring_hdr_t *hdr;
+         size_t          map_size;
+         int             fd;        // memfd of the creator (-1 once the peer has mapped it)
+         pid_t           peer;      // process at the other side
+         int             broken;    // the peer died, do not wait for it again
+         shm_ring_ctl_t *tx_ctl;
+         shm_ring_ctl_t *rx_ctl;
+         char           *tx_data;
+         char           *rx_data;
+         pthread_mutex_t tx_mutex;  // one sender and one receiver per side
+         pthread_mutex_t rx_mutex;
+     } shm_ring_t;
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     int shm_ring_create   ( shm_ring_t *ring, size_t ring_size );
+     int shm_ring_getname  ( shm_ring_t *ring, char *name, size_t name_size );
+     int shm_ring_attach   ( shm_ring_t *ring, char *name );
+     int shm_ring_attached ( shm_ring_t *ring );
+     int shm_ring_close    ( shm_ring_t *ring );
+
+     int shm_ring_send     ( shm_ring_t *ring, void *buffer, int size );
+     int shm_ring_recv     ( shm_ring_t *ring, void *buffer, int size );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
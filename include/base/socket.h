@@ -40,6 +40,11 @@
      #include <netdb.h>
      #include <sys/socket.h>
      #include <netinet/in.h>
+     #include <sys/uio.h>
+     #include <poll.h>
+  #if defined(__linux__)
+     #include <linux/errqueue.h>
+  #endif
 
 
   /* ... Const / Const ................................................. */
@@ -48,11 +53,16 @@
      #define SCK_IP4 4
      #define SCK_IP6 6
 
+     // socket_sendv
+     #define SOCKET_IOV_MAX        8             // pieces of one message
+     #define SOCKET_ZEROCOPY_MIN   (64 * 1024)   // smaller messages are copied (env XPN_SCK_ZEROCOPY=0 always copies)
+
 
   /* ... Functions / Funciones ......................................... */
 
      int socket_send ( int socket, void * buffer, int size );
      int socket_recv ( int socket, void * buffer, int size );
+     ssize_t socket_sendv ( int socket, struct iovec * iov, int iovcnt );
 
      int socket_setopt_data    ( int socket ) ;
      int socket_setopt_service ( int socket ) ;
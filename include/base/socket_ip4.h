@@ -42,6 +42,7 @@
      int socket_ip4_client_connect              ( char * srv_name, int   port,      int *out_socket ) ;
      int socket_ip4_client_connect_with_retries ( char * srv_name, char *port_name, int *out_socket, int n_retries ) ;
 
+     int socket_ip4_resolve       ( char * srv_name, struct in_addr * addr ) ;
      int socket_ip4_gethostname   ( char * srv_name ) ;
      int socket_ip4_gethostbyname ( char * ip, size_t ip_size, char * srv_name ) ;
      int socket_ip4_getsockname   ( char * port_name, int new_socket ) ;
@@ -32,6 +32,7 @@
 
      #include "all_system.h"
      #include "workers_common.h"
+     #include "base/utils.h"
 
   
   /* ... Const / Const ................................................. */
@@ -42,23 +43,54 @@
      // End pool
      #define TH_FINALIZE 200
 
+     // Operations taken at once from the injection queue to the own deque
+     #define POOL_BATCH 8
+
+     // Tries to find work before sleeping
+     #define POOL_SPIN  64
+
 
   /* ... Data structures / Estructuras de datos ........................ */
 
-     typedef struct
+     // Cell of the injection queue (bounded MPMC ring, the sequence number says who owns it)
+     struct worker_pool_cell
      {
-       pthread_mutex_t m_pool;
-       pthread_cond_t  c_pool_no_full;
-       pthread_cond_t  c_poll_no_empty;
-       pthread_mutex_t m_pool_end;
+       size_t       seq;
+       struct st_th th;
+     };
+
+     // Deque of one thread: the owner takes from the tail, the rest steal from the head
+     struct worker_pool_deque
+     {
+       pthread_mutex_t m_deque;
+       struct st_th   *ops;
+       int             size;
+       int             head;
+       int             n_ops;
+       int             id;
+       void           *pool;
+     };
 
+     typedef struct
+     {
        int POOL_MAX_THREADS;
        pthread_t *thid;
 
-       struct st_th operations_buffer[MAX_OPERATIONS];
+       // injection queue for the threads out of the pool (MAX_OPERATIONS must be a power of two)
+       struct worker_pool_cell operations_buffer[MAX_OPERATIONS];
+       size_t deq_pos;
+       size_t enq_pos;
+
+       // one deque per thread
+       struct worker_pool_deque *deques;
+       int next_deque;
+
+       // idle threads sleep here
+       pthread_mutex_t m_pool;
+       pthread_cond_t  c_poll_no_empty;
+       int n_sleeping;
        int n_operation;
-       int deq_pos;
-       int enq_pos;
+
        int pool_end; 
      } worker_pool_t;
 
@@ -69,7 +101,7 @@
      void         worker_pool_destroy ( worker_pool_t *w );
 
      void         worker_pool_enqueue ( worker_pool_t *w, struct st_th *th_arg, void (*worker_function)(struct st_th));
-     struct st_th worker_pool_dequeue ( worker_pool_t *w );
+     int          worker_pool_dequeue ( worker_pool_t *w, int id, struct st_th *th );
 
      int          worker_pool_wait    ( struct st_th *th_arg );
 
@@ -50,12 +50,18 @@
   #define NFIDIR     1
   #define NFINULL   -1
 
+  // READ LATENCY (bucket i counts the reads of less than 2^i usec)
+  #define NFI_LAT_BUCKETS      32
+  #define NFI_LAT_WINDOW     1024   // the counts are halved when they reach it
+  #define NFI_LAT_MIN_SAMPLES  16   // below this, no percentile is given
+
 
   /* ... Data structures / Estructuras de datos ........................ */
 
   // info of the servers
   struct nfi_ops;
   struct nfi_worker;
+  struct nfi_worker_io;
 
   struct nfi_server 
   {
@@ -78,6 +84,15 @@
     int xpn_session_dir;
 
     int keep_connected;     // keep connection between operations
+    int n_streams;          // connections to the server (1 = one operation at a time)
+    int codec;              // compression of the data on the wire (XPN_CODEC_NONE = off)
+
+    // Load seen by this client, to choose among replicas
+    int  n_inflight;                 // requests launched and not finished
+    int  n_slow;                     // reads that another replica answered first, still running
+    long lat_read;                   // moving average of the read latency (usec)
+    long lat_n;                      // reads counted in lat_hist
+    long lat_hist[NFI_LAT_BUCKETS];
   };
 
   struct nfi_attr_server
@@ -128,6 +143,17 @@
   // Forward declaration
   struct xpn_metadata;
 
+  // Called by nfi_walk for each entry found (path relative to the walk root)
+  typedef int (*nfi_walk_fn) ( char *path, int type, int depth, void *arg );
+
+  // Usage of a subtree, as seen by one server
+  struct nfi_summary
+  {
+    long long bytes;            // logical size of the files
+    long long files;
+    long long dirs;
+  };
+
   struct nfi_ops 
   {
     int     (*nfi_reconnect) (struct nfi_server *serv);
@@ -142,6 +168,9 @@
     int     (*nfi_rename)   (struct nfi_server *serv, char *old_url, char *new_url);
     ssize_t (*nfi_read)     (struct nfi_server *serv, struct nfi_fhandle *fh, void *buffer, off_t offset, size_t size);
     ssize_t (*nfi_write)    (struct nfi_server *serv, struct nfi_fhandle *fh, void *buffer, off_t offset, size_t size);
+    // Optional: all the blocks of one request in a single operation
+    ssize_t (*nfi_readv)    (struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int n_io, off_t header_size);
+    ssize_t (*nfi_writev)   (struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int n_io, off_t header_size);
     int     (*nfi_mkdir)    (struct nfi_server *serv, char *url, mode_t mode, struct nfi_attr *attr, struct nfi_fhandle *fh);
     int     (*nfi_rmdir)    (struct nfi_server *serv, char *url);
     int     (*nfi_opendir)  (struct nfi_server *serv, char *url, struct nfi_fhandle *fho);
@@ -150,6 +179,14 @@
     int     (*nfi_statfs)   (struct nfi_server *serv, struct nfi_info *inf);
     int     (*nfi_read_mdata)  (struct nfi_server *serv, char *url, struct xpn_metadata *mdata);
     int     (*nfi_write_mdata) (struct nfi_server *serv, char *url, struct xpn_metadata *mdata, int only_file_size);
+    int     (*nfi_mkdir_p)  (struct nfi_server *serv, char *url, mode_t mode);
+    int     (*nfi_rmtree)   (struct nfi_server *serv, char *url);
+    int     (*nfi_walk)     (struct nfi_server *serv, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg);
+    int     (*nfi_summarize)(struct nfi_server *serv, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary);
+
+    // Optional: bind/unbind a free connection to the calling thread around each operation
+    int     (*nfi_stream_get)(struct nfi_server *serv);
+    void    (*nfi_stream_put)(struct nfi_server *serv);
   };
 
 
@@ -86,6 +86,10 @@
   int     nfi_local_readdir    ( struct nfi_server *server, struct nfi_fhandle *fhd, struct dirent *entry );
   int     nfi_local_closedir   ( struct nfi_server *server, struct nfi_fhandle *fh );
   int     nfi_local_rmdir      ( struct nfi_server *server, char *url );
+  int     nfi_local_mkdir_p    ( struct nfi_server *server, char *url, mode_t mode );
+  int     nfi_local_rmtree     ( struct nfi_server *server, char *url );
+  int     nfi_local_walk       ( struct nfi_server *server, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg );
+  int     nfi_local_summarize  ( struct nfi_server *server, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary );
 
   int     nfi_local_statfs     ( struct nfi_server *server, struct nfi_info *inf );
 
@@ -34,6 +34,7 @@
   #include "base/ns.h"
   #include "base/socket.h"
   #include "base/service_socket.h"
+  #include "base/mpi_pipe.h"
   #include "xpn_server/xpn_server_ops.h"
 
 
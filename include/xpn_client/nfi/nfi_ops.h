@@ -53,6 +53,10 @@
        op_opendir  = 22,
        op_readdir  = 23,
        op_closedir = 24,
+       op_mkdir_p  = 25,
+       op_rmtree   = 26,
+       op_walk     = 27,
+       op_summarize = 28,
 
        op_statfs   = 60,
 
@@ -81,12 +85,43 @@
      int nfi_worker_do_readdir  ( struct nfi_worker *wrk,            struct nfi_fhandle *fhd, struct dirent *entry );
      int nfi_worker_do_closedir ( struct nfi_worker *wrk,            struct nfi_fhandle *fh );
      int nfi_worker_do_rmdir    ( struct nfi_worker *wrk, char *url );
+     int nfi_worker_do_mkdir_p  ( struct nfi_worker *wrk, char *url, mode_t mode );
+     int nfi_worker_do_rmtree   ( struct nfi_worker *wrk, char *url );
+     int nfi_worker_do_walk     ( struct nfi_worker *wrk, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg );
+     int nfi_worker_do_summarize( struct nfi_worker *wrk, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary );
 
      int nfi_worker_do_statfs   ( struct nfi_worker *wrk, struct nfi_info *inf );
 
      int nfi_worker_do_read_mdata   ( struct nfi_worker *wrk, char *url, struct xpn_metadata *mdata );
      int nfi_worker_do_write_mdata  ( struct nfi_worker *wrk, char *url, struct xpn_metadata *mdata, int only_file_size );
 
+     // Same operations on a caller-owned request, so several of them can be in flight per server
+     int nfi_request_do_open     ( struct nfi_request *req, char *url, int flags, mode_t mode, struct nfi_fhandle *fho );
+     int nfi_request_do_create   ( struct nfi_request *req, char *url,            mode_t mode, struct nfi_attr *attr, struct nfi_fhandle  *fh );
+     int nfi_request_do_read     ( struct nfi_request *req, struct nfi_fhandle *fh, struct nfi_worker_io *io,int n );
+     int nfi_request_do_write    ( struct nfi_request *req, struct nfi_fhandle *fh, struct nfi_worker_io *io,int n );
+     int nfi_request_do_close    ( struct nfi_request *req, struct nfi_fhandle *fh );
+
+     int nfi_request_do_remove   ( struct nfi_request *req, char *url );
+     int nfi_request_do_rename   ( struct nfi_request *req, char *old_url, char *new_url );
+     int nfi_request_do_getattr  ( struct nfi_request *req, struct nfi_fhandle *fh, struct nfi_attr *attr );
+     int nfi_request_do_setattr  ( struct nfi_request *req, struct nfi_fhandle *fh, struct nfi_attr *attr );
+
+     int nfi_request_do_mkdir    ( struct nfi_request *req, char *url, mode_t mode, struct nfi_attr *attr, struct nfi_fhandle *fh );
+     int nfi_request_do_opendir  ( struct nfi_request *req, char *url, struct nfi_fhandle *fho );
+     int nfi_request_do_readdir  ( struct nfi_request *req,            struct nfi_fhandle *fhd, struct dirent *entry );
+     int nfi_request_do_closedir ( struct nfi_request *req,            struct nfi_fhandle *fh );
+     int nfi_request_do_rmdir    ( struct nfi_request *req, char *url );
+     int nfi_request_do_mkdir_p  ( struct nfi_request *req, char *url, mode_t mode );
+     int nfi_request_do_rmtree   ( struct nfi_request *req, char *url );
+     int nfi_request_do_walk     ( struct nfi_request *req, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg );
+     int nfi_request_do_summarize( struct nfi_request *req, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary );
+
+     int nfi_request_do_statfs   ( struct nfi_request *req, struct nfi_info *inf );
+
+     int nfi_request_do_read_mdata   ( struct nfi_request *req, char *url, struct xpn_metadata *mdata );
+     int nfi_request_do_write_mdata  ( struct nfi_request *req, char *url, struct xpn_metadata *mdata, int only_file_size );
+
 
   /* ................................................................... */
 
@@ -44,10 +44,21 @@
 
   // NEW //////////////////////////////////////////
   int     nfiworker_init    (struct nfi_server *serv) ;
-  int     nfiworker_launch  ( void (*worker_function)(struct st_th), struct nfi_worker *wrk );
   ssize_t nfiworker_wait    ( struct nfi_worker *wrk );
   void    nfiworker_destroy (struct nfi_server *serv);
 
+  // Per-request completion, any number of them can be in flight for the same server
+  int     nfi_request_init     ( struct nfi_request *req, struct nfi_server *serv );
+  int     nfi_request_launch   ( struct nfi_request *req );
+  ssize_t nfi_request_wait     ( struct nfi_request *req );
+  ssize_t nfi_request_wait_all ( struct nfi_request *reqs, int n );
+  void    nfi_request_flush    ( void );
+
+  // Load of a server, as seen by this client
+  void    nfi_server_lat_add        ( struct nfi_server *serv, long usec );
+  long    nfi_server_lat_percentile ( struct nfi_server *serv, int percentile );
+  long    nfi_server_cost           ( struct nfi_server *serv, int extra );
+
 
   /* ................................................................... */
 
@@ -71,6 +71,28 @@
        unsigned char        * type;
        struct xpn_metadata  * mdata;
        int                    mdata_only_file_size;
+
+       int                    serv_id;
+       int                    n_serv;
+       int                    root_master;
+       nfi_walk_fn            walk_fn;
+       void                 * walk_arg;
+       struct nfi_summary   * summary;
+     };
+
+     struct nfi_worker;
+
+     // One operation on one server: its arguments and its completion
+     struct nfi_request
+     {
+       struct nfi_worker      *wrk;     // worker of the server the request goes to
+       struct st_th            warg;
+       struct nfi_worker_args  arg;
+       int                     launched;
+
+       // optional, called by the thread that runs the request when it finishes
+       void                  (*done)(struct nfi_request *req);
+       void                   *done_arg;
      };
 
      struct nfi_worker
@@ -85,10 +107,10 @@
 
        // NEW
        worker_t     wb ;
-       struct st_th warg ;
+       pthread_mutex_t m_ops;           // one operation at a time on the server connection
 
        struct nfi_server      *server;
-       struct nfi_worker_args  arg; // TODO: Convert this into a list of 'struct nfi_worker_args' to make Expand reentrant
+       struct nfi_request      req;     // used by the nfi_worker_do_* functions
      };
 
 
@@ -36,6 +36,7 @@
   #include "base/workers.h"
   #include "base/ns.h"
   #include "base/service_socket.h"
+  #include "base/shm_ring.h"
   #include "nfi.h"
   #include "nfi_local.h"
   #include "nfi_worker.h"
@@ -43,6 +44,14 @@
   #include "xpn_server/xpn_server_ops.h"
 
 
+  /* ... Const / Const ................................................. */
+
+  #define XPN_CONNECT_DEFAULT_IDLE       0    // seconds without use before closing the connections (env XPN_CONNECT_IDLE, 0 = never)
+  #define XPN_CONNECT_DEFAULT_BUSY_WAIT  60   // seconds to wait for a busy server (env XPN_CONNECT_BUSY_WAIT)
+  #define XPN_CONNECT_BACKOFF_MIN_MS     10
+  #define XPN_CONNECT_BACKOFF_MAX_MS     1000
+
+
   /* ... Data structures / Estructuras de datos ........................ */
 
   struct nfi_xpn_server
@@ -56,6 +65,10 @@
     int xpn_locality;
     int locality;
 
+    // short-circuit local reads (sc_header: header bytes not stored in the data files, from the layout of the server, -1 if not known)
+    int short_circuit;
+    int sc_header;
+
     // MQTT usage
     int xpn_mosquitto_mode;
     int xpn_mosquitto_qos;
@@ -66,13 +79,29 @@
 
     int keep_connected;
 
+    // lazy connection: 1 while not connected, until the first operation (XPN_CONNECT_LAZY) or after being idle
+    int lazy;
+    pthread_mutex_t m_lazy;
+
+    // idle connections: closed after idle_time seconds without use (0 = never) by the idle reaper
+    int    idle_time;
+    time_t last_use;
+    struct nfi_server *idle_next;
+
+    // seconds to wait for a server at its connection limit
+    int busy_wait;
+
+    // compression of the data chunks, accepted by the server (XPN_CODEC_NONE = off)
+    int codec;
+
     // server comm
-    int server_type;  // it can be XPN_SERVER_TYPE_MPI, XPN_SERVER_TYPE_SCK
+    int server_type;  // it can be XPN_SERVER_TYPE_MPI, XPN_SERVER_TYPE_SCK, XPN_SERVER_TYPE_SHM
     #ifdef ENABLE_MPI_SERVER
     MPI_Comm server_comm; // For mpi_server
     #endif
     #ifdef ENABLE_SCK_SERVER
     int server_socket; // For sck_server
+    shm_ring_t *server_shm; // For sck_server on the same node
     #endif
     // server port
     char port_name [MAX_PORT_NAME_LENGTH];
@@ -81,6 +110,17 @@
     // server arguments
     int    argc;
     char **argv;
+
+    // connection pool (the first connection is the private_info of the server and owns the rest)
+    int    n_streams;
+    struct nfi_xpn_server **streams;
+    pthread_mutex_t m_streams;
+    pthread_cond_t  c_streams;
+
+    // use of this connection
+    int       in_use;
+    pthread_t owner;
+    long      n_ops;
   };
 
   struct nfi_xpn_server_fhandle
@@ -89,6 +129,7 @@
     long telldir;
     DIR *dir;
     int fd;
+    int sc_fd;  // local descriptor of the data file (-1: not opened yet, -2: not readable by the client)
   };
 
 
@@ -101,10 +142,15 @@
   int     nfi_xpn_server_reconnect  ( struct nfi_server *server );
   int     nfi_xpn_server_disconnect ( struct nfi_server *server );
 
+  int     nfi_xpn_server_stream_get ( struct nfi_server *server );
+  void    nfi_xpn_server_stream_put ( struct nfi_server *server );
+
   int     nfi_xpn_server_create     ( struct nfi_server *server, char *url, mode_t mode, struct nfi_attr *attr, struct nfi_fhandle  *fh );
   int     nfi_xpn_server_open       ( struct nfi_server *server, char *url, int flags, mode_t mode, struct nfi_fhandle *fho );
   ssize_t nfi_xpn_server_read       ( struct nfi_server *server, struct nfi_fhandle *fh, void *buffer, off_t offset, size_t size );
   ssize_t nfi_xpn_server_write      ( struct nfi_server *server, struct nfi_fhandle *fh, void *buffer, off_t offset, size_t size );
+  ssize_t nfi_xpn_server_readv      ( struct nfi_server *server, struct nfi_fhandle *fh, struct nfi_worker_io *io, int n_io, off_t header_size );
+  ssize_t nfi_xpn_server_writev     ( struct nfi_server *server, struct nfi_fhandle *fh, struct nfi_worker_io *io, int n_io, off_t header_size );
   int     nfi_xpn_server_close      ( struct nfi_server *server, struct nfi_fhandle *fh );
   int     nfi_xpn_server_remove     ( struct nfi_server *server, char *url );
   int     nfi_xpn_server_rename     ( struct nfi_server *server, char *old_url, char *new_url );
@@ -117,6 +163,10 @@
   int     nfi_xpn_server_readdir    ( struct nfi_server *server, struct nfi_fhandle *fhd, struct dirent *entry );
   int     nfi_xpn_server_closedir   ( struct nfi_server *server, struct nfi_fhandle *fhd );
   int     nfi_xpn_server_rmdir      ( struct nfi_server *server, char *url );
+  int     nfi_xpn_server_mkdir_p    ( struct nfi_server *server, char *url, mode_t mode );
+  int     nfi_xpn_server_rmtree     ( struct nfi_server *server, char *url );
+  int     nfi_xpn_server_walk       ( struct nfi_server *server, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg );
+  int     nfi_xpn_server_summarize  ( struct nfi_server *server, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary );
 
   int     nfi_xpn_server_statfs     ( struct nfi_server *server, struct nfi_info *inf );
 
@@ -41,11 +41,14 @@
      int     nfi_xpn_server_comm_init              ( struct nfi_xpn_server *params );
      int     nfi_xpn_server_comm_destroy           ( struct nfi_xpn_server *params );
 
+     int     nfi_xpn_server_comm_lookup_conn       ( struct nfi_xpn_server *params );
      int     nfi_xpn_server_comm_connect           ( struct nfi_xpn_server *params );
      int     nfi_xpn_server_comm_disconnect        ( struct nfi_xpn_server *params );
 
      int     nfi_xpn_server_comm_write_operation   ( struct nfi_xpn_server *params, int op);
+     ssize_t nfi_xpn_server_comm_write_request     ( struct nfi_xpn_server *params, int op, struct iovec *iov, int iovcnt );
      ssize_t nfi_xpn_server_comm_write_data        ( struct nfi_xpn_server *params, char *data, ssize_t size );
+     ssize_t nfi_xpn_server_comm_write_datav       ( struct nfi_xpn_server *params, struct iovec *iov, int iovcnt );
      ssize_t nfi_xpn_server_comm_read_data         ( struct nfi_xpn_server *params, char *data, ssize_t size );
 
 
@@ -38,6 +38,16 @@
 
       #define DEFAULT_XPN_PROXY_PORT 5555
 
+  /* ... Data structures / Estructuras de datos ........................ */
+
+  // Usage of a subtree (what is below its root)
+  struct xpn_summary
+  {
+    long long bytes;   // logical size of the files
+    long long files;
+    long long dirs;
+  };
+
   /* ... Functions / Funciones ......................................... */
 
   // xpn_cwd.c
@@ -48,6 +58,14 @@
   int         xpn_mkdir (const char *path, mode_t perm);
   int         xpn_rmdir (const char *path);
 
+  // server-side bulk operations, executed by every server on its local subtree
+  int         xpn_mkdir_p (const char *path, mode_t perm);
+  int         xpn_rmtree  (const char *path);
+  // walk_fn is called once per entry (path relative to 'path'); it must not call xpn_* functions
+  int         xpn_walk    (const char *path, int (*walk_fn)(const char *path, int is_dir, int depth, void *arg), void *arg);
+  // bytes, files and directories below path, added up by the servers
+  int         xpn_summarize (const char *path, struct xpn_summary *summary);
+
   // xpn_init.c
   int         xpn_init    ( void );
   int         xpn_destroy ( void );
@@ -49,6 +49,12 @@
     int replication_level;     // replication_level of files :0, 1, 2,... 
     char name[PATH_MAX];  // name of partition 
     ssize_t block_size;   // size of distribution used 
+    ssize_t small_file_size; // files up to this size are kept only in the master node (0 = off)
+    int server_streams;   // connections to each server, large transfers are split among them
+    int hedge_percentile; // replicated reads slower than this latency percentile are also sent to another replica (0 = off)
+    int distribution_policy; // distribution of the blocks of new files (round-robin, weighted or raid5)
+    unsigned char weights[XPN_METADATA_MAX_WEIGHTS]; // blocks per round of each server (weighted distribution)
+    int compression;      // codec of the data sent to the servers (XPN_CODEC_NONE or XPN_CODEC_LZ4)
 
     int data_nserv;     // number of server 
     struct nfi_server *data_serv; // list of data servers in the partition 
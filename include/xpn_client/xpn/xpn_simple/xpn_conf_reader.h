@@ -52,10 +52,24 @@
      #define XPN_CONF_TAG_PARTITION_NAME        "partition_name"
      #define XPN_CONF_TAG_REPLICATION_LEVEL     "replication_level"
      #define XPN_CONF_TAG_BLOCKSIZE             "bsize"
+     #define XPN_CONF_TAG_SMALL_FILE_SIZE       "small_file_size"
+     #define XPN_CONF_TAG_SERVER_STREAMS        "server_streams"
+     #define XPN_CONF_TAG_HEDGE_PERCENTILE      "hedge_percentile"
+     #define XPN_CONF_TAG_DISTRIBUTION          "distribution"
+     #define XPN_CONF_TAG_COMPRESSION           "compression"
      #define XPN_CONF_TAG_SERVER_URL            "server_url"
+     #define XPN_CONF_TAG_SERVER_WEIGHT         "server_weight"
 
      #define XPN_CONF_DEFAULT_REPLICATION_LEVEL 0
      #define XPN_CONF_DEFAULT_BLOCKSIZE         512*KB
+     #define XPN_CONF_DEFAULT_SMALL_FILE_SIZE   0
+     #define XPN_CONF_DEFAULT_SERVER_STREAMS    1
+     #define XPN_CONF_MAX_SERVER_STREAMS        64
+     #define XPN_CONF_DEFAULT_HEDGE_PERCENTILE  0
+     #define XPN_CONF_DEFAULT_SERVER_WEIGHT     1
+     #define XPN_CONF_DEFAULT_DISTRIBUTION      "round_robin"
+     #define XPN_CONF_DEFAULT_COMPRESSION       "none"
+     #define XPN_CONF_MAX_SERVER_WEIGHT         255
 
 
   /* ... Data structures / Estructuras de datos ........................ */
@@ -65,8 +79,14 @@
        char   *partition_name;
        int     replication_level;
        long    bsize;
+       long    small_file_size;    // Files up to this size are kept only in the master node (0 = off)
+       int     server_streams;     // Connections opened to each server
+       int     hedge_percentile;   // Reads slower than this percentile go to another replica too (0 = off)
+       char   *distribution;       // Layout of the file data: round_robin or raid5
+       char   *compression;        // Codec of the data sent to the servers: none or lz4
        int     server_n;           // Array of number of servers in partition
        char  **servers;            // The pointers to the servers
+       int    *weights;            // Weight of each server (blocks per round, weighted distribution)
      };
 
      struct conf_file_data
@@ -90,6 +110,7 @@
      int xpn_conf_reader_get_num_partitions ( struct conf_file_data *conf_data ) ;
      int xpn_conf_reader_get_num_servers    ( struct conf_file_data *conf_data, int partition_index ) ;
      int xpn_conf_reader_get_server         ( struct conf_file_data *conf_data, char *value, int partition, int server ) ;
+     int xpn_conf_reader_get_server_weight  ( struct conf_file_data *conf_data, int partition, int server ) ;
      int xpn_conf_reader_get_value          ( struct conf_file_data *conf_data, int partition_index, char *key, char *value ) ;
 
      // Old API
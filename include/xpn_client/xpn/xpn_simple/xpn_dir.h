@@ -39,6 +39,10 @@
  
      int xpn_simple_mkdir(const char *path, mode_t perm) ;
      int xpn_simple_rmdir(const char *path) ;
+     int xpn_simple_mkdir_p(const char *path, mode_t perm) ;
+     int xpn_simple_rmtree(const char *path) ;
+     int xpn_simple_walk(const char *path, int (*walk_fn)(const char *path, int is_dir, int depth, void *arg), void *arg) ;
+     int xpn_simple_summarize(const char *path, struct nfi_summary *summary) ;
 
 
   /* ................................................................... */
@@ -32,15 +32,20 @@
 
      #include "all_system.h"
      #include "base/path_misc.h"
+     #include "base/lz4_codec.h"
      #include "xpn_policy_init.h"
      #include "xpn_cwd.h"
      #include "xpn_file.h"
+     #include "xpn_policy_rw.h"
 
 
   /* ... Const / Const ................................................. */
  
      #define XPN_MAX_PART 128
 
+     #define XPN_CONNECT_DEFAULT_FANOUT 16   // threads connecting the servers of a partition (env XPN_CONNECT_FANOUT)
+     #define XPN_CONNECT_MAX_FANOUT     128
+
 
   /* ... Data structures / Estructuras de datos ........................ */
 
@@ -35,11 +35,17 @@
   /* ... Const / Const ................................................. */
 
   #define XPN_HEADER_SIZE 8192
+
+  // Name of the metadata index log inside the directory given to xpn_server -d
+  #define XPN_MDATA_INDEX_FILE "xpn_mdata.log"
   
   #define XPN_MAGIC_NUMBER "XPN"
   #define XPN_METADATA_VERSION 1
   #define XPN_METADATA_MAX_RECONSTURCTIONS 40
   #define XPN_METADATA_DISTRIBUTION_ROUND_ROBIN 1
+  #define XPN_METADATA_DISTRIBUTION_WEIGHTED    2
+  #define XPN_METADATA_DISTRIBUTION_RAID5       3
+  #define XPN_METADATA_MAX_WEIGHTS 128
 
   #define XPN_CHECK_MAGIC_NUMBER(mdata) \
          (((mdata)->magic_number[0] == XPN_MAGIC_NUMBER[0]) && \
@@ -68,10 +74,12 @@
     int     distribution_policy;                          // Distribution policy of blocks, default: round-robin
     int     data_nserv[XPN_METADATA_MAX_RECONSTURCTIONS]; // Array of number of servers to reconstruct
     int     offsets[XPN_METADATA_MAX_RECONSTURCTIONS];    // Array indicating the block where new server configuration starts
+    unsigned char weights[XPN_METADATA_MAX_WEIGHTS];      // Blocks per round of each server (weighted distribution)
   };
 
   // Forward declaration
   struct nfi_server;
+  struct xpn_partition;
 
   /* ... Functions / Funciones ......................................... */
 
@@ -86,6 +94,8 @@
 
   int XpnUpdateMetadata(struct xpn_metadata *mdata, int nserv, struct nfi_server *servers, const char *path, int replication_level, int only_file_size);
 
+  int XpnIsSmallFile(struct xpn_metadata *mdata, struct xpn_partition *part);
+
   int xpn_simple_get_block_locality(char *path, off_t offset, int *url_c, char **url_v[]);
   int xpn_simple_free_block_locality(int *url_c, char **url_v[]);
 
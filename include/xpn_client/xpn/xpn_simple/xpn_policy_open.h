@@ -65,6 +65,9 @@
 
   int XpnGetServers(int pd, int fd, struct nfi_server **servers);
 
+  int XpnCheckServIsDirMaster(const char *abs_path, int n_serv, int replication_level, int serv);
+  int XpnMakeParentDir(struct nfi_server *serv, const char *abs_path);
+
   int XpnGetFh(struct xpn_metadata *mdata, struct nfi_fhandle **fh,  struct nfi_server *servers,  char *path);
   int XpnGetFhDir(struct xpn_metadata *mdata, struct nfi_fhandle **fh,  struct nfi_server *servers,  char *path);
 
@@ -0,0 +1,54 @@
+
+/*
+ *  Copyright 2000-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Luis Miguel Sanchez Garcia, Borja Bergua Guerra, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _XPN_POLICY_PARITY_H
+#define _XPN_POLICY_PARITY_H
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "xpn_file.h"
+     #include "xpn_policy_open.h"
+     #include "xpn_policy_rw.h"
+     #include "xpn_metadata.h"
+     #include "base/math_misc.h"
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     // RAID-5 layout: a stripe is (nserv-1) data blocks plus their parity block, one block in every server
+     void    XpnCalculateBlockRaid5 (int block_size, int nserv, off_t offset, int replication, int first_node, off_t *local_offset, int *serv);
+
+     ssize_t XpnParityRead          (int fd, void *buffer, size_t size, off_t offset);
+     ssize_t XpnParityWrite         (int fd, const void *buffer, size_t size, off_t offset);
+
+
+  /* ................................................................... */
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
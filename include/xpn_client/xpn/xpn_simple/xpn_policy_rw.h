@@ -33,14 +33,60 @@
      #include "xpn_policy_open.h"
 
 
+  /* ... Const / Const ................................................. */
+
+     // smallest part of a transfer sent through its own connection
+     #define XPN_RW_STREAM_MIN_SIZE (256*KB)
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     struct xpn_rw_streams
+     {
+       int n;                      // requests launched (0 if the server worker is used)
+       struct nfi_request   *reqs;
+       struct nfi_worker_io *io;   // blocks of all the requests
+       int                  *ion;  // blocks of each request
+     };
+
+     // A read sent to one replica, and to the others too if it is slow (see XpnHedgeWait)
+     struct xpn_hedge
+     {
+       pthread_mutex_t       m;
+       pthread_cond_t        c;
+       struct timeval        t_launch;
+
+       struct nfi_request    req;        // the read of the chosen replica, into buf
+       struct nfi_worker_io *io;
+       int                   req_done;
+       int                   req_slow;   // it took longer than the threshold (counted in n_slow)
+
+       struct nfi_request   *hreqs;      // the reads of the other replicas (one per server), into hbuf
+       struct nfi_worker_io *hio;
+       int                   n_hreqs;
+       int                   hreqs_done;
+       int                   hreqs_failed;
+
+       struct nfi_worker_io *dst;        // blocks of the user buffer
+       int                   ion;
+       size_t                size;
+       char                 *buf;
+       char                 *hbuf;
+
+       struct xpn_hedge     *next;       // in the list of reads still running after another one answered
+     };
+
+
   /* ... Functions / Funciones ......................................... */
 
      void XpnCalculateBlockMdata(struct xpn_metadata *mdata, off_t offset, int replication, off_t *local_offset, int *serv);
      void XpnCalculateBlock(int block_size, int replication_level, int nserv, off_t offset, int replication, int first_node, off_t *local_offset, int *serv);
      void XpnCalculateBlockInvert(int block_size, int replication_level, int nserv, int serv, off_t local_offset, int first_node, off_t *offset, int *replication);
+     void XpnCalculateBlockWeighted(int block_size, int replication_level, int nserv, const unsigned char *weights, off_t offset, int replication, int first_node, off_t *local_offset, int *serv);
      void XpnPrintBlockDistribution(int blocks, struct xpn_metadata *mdata);
 
      int XpnReadGetBlock(int fd, off_t offset, int serv_client, off_t *local_offset, int *serv);
+     int XpnReadGetBlockBalanced(int fd, off_t offset, int serv_client, int *load, off_t *local_offset, int *serv);
      int XpnWriteGetBlock(int fd, off_t offset, int replication, off_t *local_offset, int *serv);
 
      void *XpnReadBlocks      (int fd, const void *buffer, size_t size, off_t offset, int serv_client, struct nfi_worker_io ***io_out, int **ion_out, int num_servers);
@@ -51,6 +97,13 @@
      ssize_t XpnReadGetTotalBytes (ssize_t *res_v, int num_servers);
      ssize_t XpnWriteGetTotalBytes (ssize_t *res_v, int num_servers, struct nfi_worker_io ***io, int *ion, struct nfi_server *servers);
 
+     int     XpnRWStreamsLaunch (struct xpn_rw_streams *st, struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int ion, int is_write);
+     ssize_t XpnRWStreamsWait   (struct xpn_rw_streams *st, struct nfi_server *serv);
+
+     struct xpn_hedge *XpnHedgeLaunch (struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int ion);
+     ssize_t           XpnHedgeWait   (struct xpn_hedge *h, int fd, struct nfi_server *servers, int serv, const void *buffer, off_t offset);
+     void              XpnHedgeReap   (int wait);
+
      ssize_t XpnGetRealFileSize(struct xpn_partition *part, struct nfi_attr *attr, int n_serv);
  
 
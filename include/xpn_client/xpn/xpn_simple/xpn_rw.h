@@ -34,6 +34,7 @@
      #include "xpn_file.h"
      #include "xpn_open.h"
      #include "xpn_policy_rw.h"
+     #include "xpn_policy_parity.h"
      #include "base/workers.h"
 
 
@@ -32,6 +32,7 @@
      #include "all_system.h"
      #include "base/utils.h"
      #include "base/time_misc.h"
+     #include "base/mpi_pipe.h"
 
 
   /* ... Functions / Funciones ......................................... */
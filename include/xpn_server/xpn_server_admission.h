@@ -0,0 +1,169 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _XPN_SERVER_ADMISSION_H_
+#define _XPN_SERVER_ADMISSION_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "base/debug_msg.h"
+     #include <pthread.h>
+
+
+  /* ... Const / Const ................................................. */
+
+     // Hash buckets of the client table (power of two)
+     #define XPN_SERVER_ADMISSION_BUCKETS       256
+
+     // Lanes: metadata requests go before the data ones
+     #define XPN_SERVER_ADMISSION_DATA          0
+     #define XPN_SERVER_ADMISSION_MDATA         1
+
+     // Deficit round robin among the clients with data requests waiting
+     #define XPN_SERVER_ADMISSION_QUANTUM       (1024 * 1024)  // bytes per turn and unit of weight (-q)
+     #define XPN_SERVER_ADMISSION_MIN_COST      (4 * 1024)     // cost of a data request smaller than this
+     #define XPN_SERVER_ADMISSION_META_BURST    16             // metadata requests admitted in a row while data waits
+     #define XPN_SERVER_ADMISSION_MAX_WEIGHTS   32             // -W <host>=<weight> entries
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     // Request waiting for credits (lives in the stack of the thread that waits)
+     struct xpn_server_admission_waiter
+     {
+         struct xpn_server_admission_waiter *next;
+         struct xpn_server_admission_client *client;
+         long            bytes;
+         int             admitted;
+         pthread_cond_t  c_admit;
+     };
+
+     // Data requests waiting of the connections of one client host (or of one connection
+     // when the host is unknown), served in deficit round robin with the other flows
+     struct xpn_server_admission_flow
+     {
+         struct xpn_server_admission_flow *next;
+         char            name[INET6_ADDRSTRLEN];   // "" for a flow of only one connection
+         int             weight;
+         int             n_clients;                // connections that use it
+
+         struct xpn_server_admission_waiter *first;
+         struct xpn_server_admission_waiter *last;
+         struct xpn_server_admission_flow   *active_next;
+         long            deficit;
+         int             in_turn;                  // the quantum of the current turn is already added
+     };
+
+     // Credits in use by one client connection
+     struct xpn_server_admission_client
+     {
+         struct xpn_server_admission_client *next;
+         void           *key;          // comm of the connection
+         struct xpn_server_admission_flow *flow;
+         int             connected;    // registered by its dispatcher, kept until it ends
+         int             n_requests;   // requests read and not finished yet
+         long            n_bytes;      // bytes of the admitted requests
+         int             n_enter_wait; // requests waiting for a slot of this client
+         pthread_cond_t  c_enter;
+     };
+
+     //
+     // Credit-based admission of the requests:
+     //  * each connection has request slots: the dispatcher does not read the next request without a free one
+     //  * once the head of a request is read, it waits for its bytes (and a request slot of the server)
+     //  * a request that does not fit waits, so the client blocks on its transport
+     //  * a request bigger than a whole budget is admitted alone
+     //
+     // Order of the waiting requests:
+     //  * metadata requests go first (a burst at most while data requests wait)
+     //  * data requests: deficit round robin among the client hosts, quantum x weight bytes per turn
+     //
+     typedef struct xpn_server_admission
+     {
+         pthread_mutex_t m_admission;
+
+         // limits (0 = no limit)
+         int             max_requests;      // requests running in the server
+         long            max_bytes;         // bytes in flight in the server
+         int             client_requests;   // requests in flight per connection
+         long            client_bytes;      // bytes in flight per connection
+         int             limited;           // any limit, if not only the counters are updated
+         long            quantum;
+
+         // in flight
+         int             n_requests;
+         long            n_bytes;
+
+         // metadata lane
+         struct xpn_server_admission_waiter *m_first;
+         struct xpn_server_admission_waiter *m_last;
+         int             meta_burst;
+
+         // data lane: flows with requests waiting, in round robin order
+         struct xpn_server_admission_flow *active_first;
+         struct xpn_server_admission_flow *active_last;
+         int             n_active;
+
+         // statistics
+         int             n_waiting;
+         int             n_waiting_mdata;
+         int             max_waiting;
+         long            n_admitted;
+         long            n_delayed;
+
+         struct xpn_server_admission_client *clients[XPN_SERVER_ADMISSION_BUCKETS];
+         struct xpn_server_admission_flow   *flows  [XPN_SERVER_ADMISSION_BUCKETS];
+     } xpn_server_admission_t;
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     xpn_server_admission_t *xpn_server_admission_init    ( int max_requests, long max_bytes, int client_requests, long client_bytes, long quantum );
+     void                    xpn_server_admission_destroy ( xpn_server_admission_t *adm );
+
+     void xpn_server_admission_connect    ( xpn_server_admission_t *adm, void *client, char *flow, int weight );
+     void xpn_server_admission_disconnect ( xpn_server_admission_t *adm, void *client );
+
+     void xpn_server_admission_enter      ( xpn_server_admission_t *adm, void *client );
+     void xpn_server_admission_leave      ( xpn_server_admission_t *adm, void *client );
+
+     void xpn_server_admission_get        ( xpn_server_admission_t *adm, void *client, int lane, long bytes );
+     void xpn_server_admission_put        ( xpn_server_admission_t *adm, void *client, long bytes );
+
+     int  xpn_server_admission_stats      ( xpn_server_admission_t *adm, char *buffer, int size );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
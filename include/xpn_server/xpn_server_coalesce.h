@@ -0,0 +1,134 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _XPN_SERVER_COALESCE_H_
+#define _XPN_SERVER_COALESCE_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "base/debug_msg.h"
+     #include "base/filesystem.h"
+     #include <pthread.h>
+
+
+  /* ... Const / Const ................................................. */
+
+     // Hash buckets of the file table (power of two)
+     #define XPN_SERVER_COALESCE_BUCKETS        256
+
+     // Only small writes are held back, and a merged write is not bigger than this (unless its writes overlap)
+     #define XPN_SERVER_COALESCE_MAX_SIZE       (256 * 1024)
+     #define XPN_SERVER_COALESCE_MAX_RUN        (8 * 1024 * 1024)
+
+     // A file is shared while another client wrote it in this time (usec): only then the leader waits the window
+     #define XPN_SERVER_COALESCE_SHARED         (1000 * 1000)
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     // Write waiting to be done (lives in the stack of the thread that waits)
+     struct xpn_server_coalesce_req
+     {
+         struct xpn_server_coalesce_req *next;
+         off_t           offset;
+         char           *buffer;
+         long            size;
+         long            seq;        // arrival order: the last one wins when two writes overlap
+         int             run;
+
+         ssize_t         ret;
+         int             err;
+         int             done;
+         int             lead;       // the previous leader gives it the next batch
+     };
+
+     // Writes of the clients to one file
+     struct xpn_server_coalesce_file
+     {
+         struct xpn_server_coalesce_file *next;
+         char           *path;
+         int             n_users;     // between begin and end
+         int             n_receiving; // the data of their write is still coming
+         int             leader;      // a thread is gathering or writing a batch
+
+         void           *last_client;
+         long            last_time;
+         long            shared_until;
+
+         struct xpn_server_coalesce_req *first;
+         struct xpn_server_coalesce_req *last;
+         int             n_pending;
+         long            pending_bytes;
+         long            seq;
+         pthread_cond_t  c_file;
+     };
+
+     //
+     // Group commit of the small writes to the same file:
+     //  * the first write that arrives becomes the leader of a batch
+     //  * it waits for the writes whose data is coming and, if other clients write the file too, for a short window
+     //  * the batch is sorted by offset, adjacent or overlapping writes are merged and written at once
+     //  * each client gets the result of its own write, and only the leader has to sync the file
+     //
+     typedef struct xpn_server_coalesce
+     {
+         pthread_mutex_t m_coalesce;
+         long            window;      // microseconds
+         long            max_size;
+
+         // statistics
+         long            n_writes;
+         long            n_batches;
+         long            n_syscalls;
+
+         struct xpn_server_coalesce_file *files[XPN_SERVER_COALESCE_BUCKETS];
+     } xpn_server_coalesce_t;
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     xpn_server_coalesce_t *xpn_server_coalesce_init    ( long window );
+     void                   xpn_server_coalesce_destroy ( xpn_server_coalesce_t *c );
+
+     struct xpn_server_coalesce_file *xpn_server_coalesce_begin ( xpn_server_coalesce_t *c, char *path, void *client );
+     void                             xpn_server_coalesce_end   ( xpn_server_coalesce_t *c, struct xpn_server_coalesce_file *file, int written );
+
+     ssize_t xpn_server_coalesce_write ( xpn_server_coalesce_t *c, struct xpn_server_coalesce_file *file, int fd, off_t offset, char *buffer, long size, int *leader );
+
+     int     xpn_server_coalesce_stats ( xpn_server_coalesce_t *c, char *buffer, int size );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
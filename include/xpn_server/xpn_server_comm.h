@@ -36,6 +36,7 @@
      #include "socket.h"
      #include "xpn_server_params.h"
      #include "sck_server_comm.h"
+     #include "shm_server_comm.h"
      #include "mq_server_comm.h"
      #include "mq_server_ops.h"
 #ifdef ENABLE_MPI_SERVER
@@ -63,6 +64,7 @@
 
      ssize_t   xpn_server_comm_read_operation    ( int server_type, void *sd, int  *op,                 int *rank_client_id, int *tag_client_id );
      ssize_t   xpn_server_comm_write_data        ( int server_type, void *sd, char *data, ssize_t size, int  rank_client_id, int  tag_client_id );
+     ssize_t   xpn_server_comm_write_datav       ( int server_type, void *sd, struct iovec *iov, int iovcnt, int  rank_client_id, int  tag_client_id );
      ssize_t   xpn_server_comm_read_data         ( int server_type, void *sd, char *data, ssize_t size, int  rank_client_id, int  tag_client_id );
 
 
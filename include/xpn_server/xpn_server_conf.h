@@ -37,6 +37,7 @@
 
      #define XPN_SERVER_TYPE_MPI 0
      #define XPN_SERVER_TYPE_SCK 1
+     #define XPN_SERVER_TYPE_SHM 2   // sck_server reached through shared memory (same node)
 
 
   /* ................................................................... */
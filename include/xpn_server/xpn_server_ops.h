@@ -31,9 +31,11 @@
 
        #include "all_system.h"
        #include "base/filesystem.h"
+       #include "base/path_misc.h"
        #include "base/urlstr.h"
        #include "base/utils.h"
        #include "base/workers.h"
+       #include "base/lz4_codec.h"
        #include "xpn_metadata.h"
        #include <libgen.h>
 
@@ -53,6 +55,8 @@
        #define XPN_SERVER_RENAME_FILE      7
        #define XPN_SERVER_GETATTR_FILE     8
        #define XPN_SERVER_SETATTR_FILE     9
+       #define XPN_SERVER_READV_FILE       10
+       #define XPN_SERVER_WRITEV_FILE      11
 
        // Directory operations
        #define XPN_SERVER_MKDIR_DIR        20
@@ -61,6 +65,10 @@
        #define XPN_SERVER_OPENDIR_DIR      23
        #define XPN_SERVER_READDIR_DIR      24
        #define XPN_SERVER_CLOSEDIR_DIR     25
+       #define XPN_SERVER_MKDIR_P_DIR      26
+       #define XPN_SERVER_RMTREE_DIR       27
+       #define XPN_SERVER_WALK_DIR         28
+       #define XPN_SERVER_SUMMARIZE_DIR    29
 
        // FS Operations
        #define XPN_SERVER_STATFS_DIR       60
@@ -73,8 +81,26 @@
        // Connection operatons
        #define XPN_SERVER_FINALIZE     80
        #define XPN_SERVER_DISCONNECT   81
+       #define XPN_SERVER_CODEC        82
+       #define XPN_SERVER_LAYOUT       83
        #define XPN_SERVER_END          -1
 
+       /* Layout of the data files (reply of XPN_SERVER_LAYOUT) */
+
+       #define XPN_SERVER_LAYOUT_INDEX     1   // metadata in the index of the server, not in the header of the data files
+       #define XPN_SERVER_LAYOUT_WLOG      2   // the last data written may be in the write logs, not in the data files yet
+
+       /* Codec of the data chunks */
+
+       #define XPN_CODEC_MIN_SIZE          512                       // smaller chunks are sent raw
+       #define XPN_CODEC_MAX_WIRE(size)    ((size) - ((size) / 16))  // less than 1/16 saved: sent raw
+
+       /* Walk */
+
+       #define XPN_SERVER_WALK_BUFFER_SIZE (64*1024)
+       #define XPN_SERVER_WALK_FILE        0
+       #define XPN_SERVER_WALK_DIR_ENTRY   1
+
 
     /* ... Data structures / Estructuras de datos ........................ */
 
@@ -136,10 +162,41 @@
            offset_t      offset;
            xpn_size_t    size;  // 32-bit: use fixed 64-bit size
            char          xpn_session;
+           char          codec;     // XPN_CODEC_NONE or the codec of every data chunk
            int           path_len;
            char          path[XPN_PATH_MAX];
        };
 
+       // (offset, size) pairs sent after a st_xpn_server_rwv
+       struct st_xpn_server_extent
+       {
+           offset_t      offset;
+           xpn_size_t    size;
+       };
+
+       struct st_xpn_server_rwv
+       {
+           int           fd;
+           int           n_extents;
+           xpn_size_t    size;  // sum of the extent sizes
+           char          xpn_session;
+           char          codec;     // XPN_CODEC_NONE or the codec of every data chunk
+           int           path_len;
+           char          path[XPN_PATH_MAX];
+       };
+
+       // With a codec, each data chunk is preceded by this header (wire_size == raw_size: sent raw)
+       struct st_xpn_server_zchunk
+       {
+           int32_t       raw_size;
+           int32_t       wire_size;
+       };
+
+       struct st_xpn_server_codec
+       {
+           int           codec;     // codec proposed by the client, the reply status.ret is the accepted one
+       };
+
        struct st_xpn_server_rw_req
        {
            xpn_ssize_t   size;  // 32-bit: use fixed 64-bit signed size
@@ -213,6 +270,37 @@
            char         path[XPN_PATH_MAX];
        };
 
+       struct st_xpn_server_walk
+       {
+           int         serv_id;      // position of this server in the partition
+           int         n_serv;       // servers in the partition, 0 to report every local entry
+           int         root_master;  // server that lists the root directory of the walk
+           int         path_len;
+           char        path[XPN_PATH_MAX];
+       };
+
+       struct st_xpn_server_walk_req
+       {
+           int         n_entries;    // entries in this batch, 0 means end of walk
+           int         size;         // bytes of packed entries that follow
+           struct      st_xpn_server_status status;
+       };
+
+       struct st_xpn_server_walk_entry
+       {
+           int         type;         // XPN_SERVER_WALK_FILE or XPN_SERVER_WALK_DIR_ENTRY
+           int         depth;
+           int         path_len;     // followed by path_len bytes (relative path, no '\0')
+       };
+
+       struct st_xpn_server_summarize_req
+       {
+           xpn_ssize_t bytes;        // logical size of the files this server is master node of
+           xpn_ssize_t files;
+           xpn_ssize_t dirs;         // directories this server lists in their parent
+           struct      st_xpn_server_status status;
+       };
+
        struct st_xpn_server_end {
            char status;
        };
@@ -227,6 +315,8 @@
                struct st_xpn_server_close op_close;
                struct st_xpn_server_rw op_read;
                struct st_xpn_server_rw op_write;
+               struct st_xpn_server_rwv op_readv;
+               struct st_xpn_server_rwv op_writev;
                struct st_xpn_server_path op_rm;
                struct st_xpn_server_rename op_rename;
                struct st_xpn_server_path op_getattr;
@@ -237,11 +327,17 @@
                struct st_xpn_server_readdir op_readdir;
                struct st_xpn_server_close op_closedir;
                struct st_xpn_server_path op_rmdir;
+               struct st_xpn_server_path_flags op_mkdir_p;
+               struct st_xpn_server_path op_rmtree;
+               struct st_xpn_server_walk op_walk;
+               struct st_xpn_server_walk op_summarize;
 
                struct st_xpn_server_path op_read_mdata;
                struct st_xpn_server_write_mdata op_write_mdata;
                struct st_xpn_server_write_mdata_file_size op_write_mdata_file_size;
 
+               struct st_xpn_server_codec op_codec;
+
                struct st_xpn_server_end op_end;
             }
            u_st_xpn_server_msg;
@@ -276,6 +372,10 @@
                return "GETATTR";
            case XPN_SERVER_SETATTR_FILE:
                return "SETATTR";
+           case XPN_SERVER_READV_FILE:
+               return "READV";
+           case XPN_SERVER_WRITEV_FILE:
+               return "WRITEV";
                // Directory operations
            case XPN_SERVER_MKDIR_DIR:
                return "MKDIR";
@@ -289,6 +389,14 @@
                return "READDIR";
            case XPN_SERVER_CLOSEDIR_DIR:
                return "CLOSEDIR";
+           case XPN_SERVER_MKDIR_P_DIR:
+               return "MKDIR_P";
+           case XPN_SERVER_RMTREE_DIR:
+               return "RMTREE";
+           case XPN_SERVER_WALK_DIR:
+               return "WALK";
+           case XPN_SERVER_SUMMARIZE_DIR:
+               return "SUMMARIZE";
                // FS Operations
            case XPN_SERVER_STATFS_DIR:
                return "STATFS";
@@ -304,6 +412,10 @@
                // Connection operatons
            case XPN_SERVER_DISCONNECT:
                return "DISCONNECT";
+           case XPN_SERVER_CODEC:
+               return "CODEC";
+           case XPN_SERVER_LAYOUT:
+               return "LAYOUT";
            case XPN_SERVER_END:
                return "END";
            default:
@@ -33,7 +33,11 @@
      #include "base/utils.h"
      #include "base/service_socket.h"
      #include "base/workers.h"
+     #include "base/kv_index.h"
      #include "xpn_server_conf.h"
+     #include "xpn_server_admission.h"
+     #include "xpn_server_coalesce.h"
+     #include "xpn_server_wlog.h"
 
 
   /* ... Data structures / Estructuras de datos ........................ */
@@ -51,7 +55,7 @@
          char shutdown_file[PATH_MAX];
          int  thread_mode_connections;
          int  thread_mode_operations;
-         int  server_type;  // it can be XPN_SERVER_TYPE_MPI, XPN_SERVER_TYPE_SCK
+         int  server_type;  // it can be XPN_SERVER_TYPE_MPI, XPN_SERVER_TYPE_SCK, XPN_SERVER_TYPE_SHM
 
  #ifdef ENABLE_SCK_SERVER
          char port_name_conn[MAX_PORT_NAME_LENGTH];
@@ -62,6 +66,30 @@
 
          int await_stop;
 
+         // clients kept connected at the same time (0 = no limit), the rest are told to wait
+         int max_connections;
+
+         // credits of the requests in flight (0 = no limit), in the whole server and per connection
+         int  max_requests;
+         long max_bytes;
+         int  client_requests;
+         long client_bytes;
+         xpn_server_admission_t *admission;
+
+         // fair share of the waiting requests: round robin quantum and weight of some client hosts (1 by default)
+         long quantum;
+         int  n_weights;
+         char weight_host[XPN_SERVER_ADMISSION_MAX_WEIGHTS][HOST_NAME_MAX];
+         int  weight[XPN_SERVER_ADMISSION_MAX_WEIGHTS];
+
+         // small writes of several clients to the same file merged into one (0 = off)
+         long coalesce_window;
+         xpn_server_coalesce_t *coalesce;
+
+         // log-structured writes (empty dir: the writes go to the data files)
+         char               wlog_dir[PATH_MAX];
+         xpn_server_wlog_t *wlog;
+
          // server arguments
          int    argc;
          char **argv;
@@ -77,6 +105,10 @@
 	 // IPv4 or IPv6
          int ipv;
 
+         // metadata index (empty dir: metadata is stored in the header of each file)
+         char        mdata_index_dir[PATH_MAX];
+         kv_index_t *mdata_index;
+
      } xpn_server_param_st;
 
 
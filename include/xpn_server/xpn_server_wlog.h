@@ -0,0 +1,136 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef _XPN_SERVER_WLOG_H_
+#define _XPN_SERVER_WLOG_H_
+
+  #ifdef  __cplusplus
+    extern "C" {
+  #endif
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "all_system.h"
+     #include "base/debug_msg.h"
+     #include "base/filesystem.h"
+     #include <pthread.h>
+
+
+  /* ... Const / Const ................................................. */
+
+     // Hash buckets of the file table (power of two)
+     #define XPN_SERVER_WLOG_BUCKETS        256
+
+     // Compaction: of a log without writes for a while (usec), or as soon as it grows too much
+     #define XPN_SERVER_WLOG_IDLE           (1000 * 1000)
+     #define XPN_SERVER_WLOG_PERIOD         (100 * 1000)
+     #define XPN_SERVER_WLOG_MAX_LOG        (1024L * 1024 * 1024)
+
+     // Buffer used to copy the log into the data file
+     #define XPN_SERVER_WLOG_COPY_SIZE      (4 * 1024 * 1024)
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     // Data of the file at [offset, offset+size) is in the log at log_offset
+     struct xpn_server_wlog_extent
+     {
+         off_t           offset;
+         long            size;
+         off_t           log_offset;
+     };
+
+     // Log of one data file
+     struct xpn_server_wlog_file
+     {
+         struct xpn_server_wlog_file *next;
+         char           *path;
+         int             n_users;     // threads that use it (it is not removed meanwhile)
+         int             flush;       // compact it as soon as possible
+
+         pthread_mutex_t m_file;
+         char            log_path[PATH_MAX];
+         int             log_fd;
+         off_t           log_size;
+         long            last_time;
+
+         // in-memory index: sorted by offset and without overlaps, the last write wins
+         struct xpn_server_wlog_extent *extents;
+         int             n_extents;
+         int             max_extents;
+         off_t           end;         // end of the last extent
+     };
+
+     //
+     // Log-structured writes:
+     //  * the writes to a data file are appended to its log, and an in-memory index tells where each extent is
+     //  * reads are served from the data file with the extents of the log on top of it
+     //  * a thread compacts the log into the data file (sorted by offset) once the file is closed or idle,
+     //    and before the operations that need the data file as it is (stat, rename)
+     //
+     typedef struct xpn_server_wlog
+     {
+         pthread_mutex_t m_wlog;
+         char            dir[PATH_MAX];
+         long            seq;
+
+         // compaction thread
+         pthread_t       th_compact;
+         pthread_cond_t  c_compact;
+         int             the_end;
+
+         // statistics
+         long            n_appends;
+         long            n_bytes_logged;
+         long            n_compactions;
+         long            n_bytes_compacted;
+
+         struct xpn_server_wlog_file *files[XPN_SERVER_WLOG_BUCKETS];
+     } xpn_server_wlog_t;
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     xpn_server_wlog_t *xpn_server_wlog_init    ( char *dir );
+     void               xpn_server_wlog_destroy ( xpn_server_wlog_t *w );
+
+     ssize_t xpn_server_wlog_write   ( xpn_server_wlog_t *w, char *path, off_t offset, char *buffer, long size );
+     ssize_t xpn_server_wlog_read    ( xpn_server_wlog_t *w, char *path, int fd, off_t offset, char *buffer, long size );
+     int     xpn_server_wlog_sync    ( xpn_server_wlog_t *w, char *path );
+
+     void    xpn_server_wlog_flush   ( xpn_server_wlog_t *w, char *path );
+     int     xpn_server_wlog_compact ( xpn_server_wlog_t *w, char *path, int subtree );
+     void    xpn_server_wlog_discard ( xpn_server_wlog_t *w, char *path, int subtree );
+
+     int     xpn_server_wlog_stats   ( xpn_server_wlog_t *w, char *buffer, int size );
+
+
+  /* ................................................................... */
+
+
+  #ifdef  __cplusplus
+    }
+  #endif
+
+#endif
+
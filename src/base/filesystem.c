@@ -140,6 +140,115 @@
          return strlen(s);
      }
 
+     int aux_rmtree ( char * path, size_t len )
+     {
+         DIR  * dir;
+         struct dirent * entry;
+         size_t name_len;
+         int    ret = 0;
+         int    err = 0;
+
+         dir = fs_low_opendir(path);
+         if (NULL == dir) {
+             return -1;
+         }
+
+         while ((entry = fs_low_readdir(dir)) != NULL)
+         {
+             if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
+                 continue;
+             }
+
+             name_len = strlen(entry->d_name);
+             if (len + 1 + name_len >= PATH_MAX) {
+                 err = ENAMETOOLONG;
+                 continue;
+             }
+
+             // path/name in place, no copies per level
+             path[len] = '/';
+             memcpy(path + len + 1, entry->d_name, name_len + 1);
+
+             // d_type may be DT_UNKNOWN: unlink fails with EISDIR (or EPERM) on directories
+             if (DT_DIR == entry->d_type) {
+                 ret = aux_rmtree(path, len + 1 + name_len);
+             }
+             else {
+                 ret = fs_low_unlink(path);
+                 if ((ret < 0) && ((EISDIR == errno) || (EPERM == errno))) {
+                     ret = aux_rmtree(path, len + 1 + name_len);
+                 }
+             }
+
+             if ((ret < 0) && (ENOENT != errno) && (0 == err)) {
+                 err = errno;
+             }
+
+             path[len] = '\0';
+         }
+
+         fs_low_closedir(dir);
+
+         ret = fs_low_rmdir(path);
+         if ((ret < 0) && (0 == err)) {
+             err = errno;
+         }
+
+         errno = err;
+         return (0 == err) ? 0 : -1;
+     }
+
+     int aux_walk ( char * path, size_t len, size_t root_len, int depth, int (*walk_fn)(char *, int, int, void *), void * arg )
+     {
+         DIR  * dir;
+         struct dirent * entry;
+         struct stat st;
+         size_t name_len;
+         int    is_dir;
+         int    ret = 0;
+
+         dir = fs_low_opendir(path);
+         if (NULL == dir) {
+             return -1;
+         }
+
+         while ((entry = fs_low_readdir(dir)) != NULL)
+         {
+             if ((strcmp(entry->d_name, ".") == 0) || (strcmp(entry->d_name, "..") == 0)) {
+                 continue;
+             }
+
+             name_len = strlen(entry->d_name);
+             if (len + 1 + name_len >= PATH_MAX) {
+                 continue;
+             }
+
+             path[len] = '/';
+             memcpy(path + len + 1, entry->d_name, name_len + 1);
+
+             is_dir = (DT_DIR == entry->d_type);
+             if ((DT_UNKNOWN == entry->d_type) && (filesystem_stat(path, &st) == 0)) {
+                 is_dir = S_ISDIR(st.st_mode);
+             }
+
+             // entries are given relative to the root of the walk, parents before children
+             ret = walk_fn(path + root_len + 1, is_dir, depth, arg);
+             if ((ret >= 0) && (is_dir)) {
+                 ret = aux_walk(path, len + 1 + name_len, root_len, depth + 1, walk_fn, arg);
+             }
+
+             path[len] = '\0';
+
+             if (ret < 0) {
+                 break;
+             }
+         }
+
+         fs_low_closedir(dir);
+
+         return ret;
+     }
+
 
      /*
       * API
@@ -529,6 +638,126 @@
          return ret;
      }
 
+     int filesystem_mkdir_p ( char * pathname, mode_t mode )
+     {
+         int ret;
+         char dir[PATH_MAX];
+
+         DEBUG_BEGIN();
+
+         // Check params
+         if (NULL == pathname) {
+             debug_warning("[FILE_POSIX]: pathname is NULL\n");
+             errno = EINVAL;
+             return -1;
+         }
+
+         // make all the parent directories...
+         for (int i = 0; aux_get_dirs(pathname, i, dir) != 0; i++)
+         {
+             ret = fs_low_mkdir(dir, mode) ;
+             if ((ret < 0) && (errno != EEXIST)) {
+                 debug_warning("[FILE_POSIX]: mkdir_p(pathname:%s) cannot mkdir(%s)\n", pathname, dir);
+                 DEBUG_END();
+                 return -1;
+             }
+         }
+
+         // ...and the last one
+         ret = fs_low_mkdir(pathname, mode) ;
+         if ((ret < 0) && (errno == EEXIST)) {
+             errno = 0;
+             ret = 0;
+         }
+         if (ret < 0) {
+             debug_warning("[FILE_POSIX]: mkdir_p(pathname:%s, mode:%d) -> %d\n", pathname, mode, ret);
+         }
+
+         DEBUG_END();
+
+         // Return OK/KO
+         return ret;
+     }
+
+     int filesystem_rmtree ( char * pathname )
+     {
+         int ret;
+         size_t len;
+         char path[PATH_MAX];
+
+         DEBUG_BEGIN();
+
+         // Check params
+         if (NULL == pathname) {
+             debug_warning("[FILE_POSIX]: pathname is NULL\n");
+             errno = EINVAL;
+             return -1;
+         }
+
+         len = strlen(pathname);
+         if (len >= PATH_MAX) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         strcpy(path, pathname);
+         while ((len > 1) && ('/' == path[len - 1])) {
+             path[--len] = '\0';
+         }
+
+         // Try to remove the whole subtree, a single file is removed as is
+         ret = fs_low_unlink(path);
+         if ((ret < 0) && ((EISDIR == errno) || (EPERM == errno))) {
+             ret = aux_rmtree(path, len);
+         }
+         if (ret < 0) {
+             debug_warning("[FILE_POSIX]: rmtree(pathname:%s) -> %d\n", pathname, ret);
+         }
+
+         DEBUG_END();
+
+         // Return OK/KO
+         return ret;
+     }
+
+     int filesystem_walk ( char * pathname, int (*walk_fn)(char *path, int is_dir, int depth, void *arg), void * arg )
+     {
+         int ret;
+         size_t len;
+         char path[PATH_MAX];
+
+         DEBUG_BEGIN();
+
+         // Check params
+         if ((NULL == pathname) || (NULL == walk_fn)) {
+             debug_warning("[FILE_POSIX]: pathname or walk_fn is NULL\n");
+             errno = EINVAL;
+             return -1;
+         }
+
+         len = strlen(pathname);
+         if (len >= PATH_MAX) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         strcpy(path, pathname);
+         while ((len > 1) && ('/' == path[len - 1])) {
+             path[--len] = '\0';
+         }
+
+         // Pre-order walk, walk_fn returning < 0 stops it
+         ret = aux_walk(path, len, len, 0, walk_fn, arg);
+         if (ret < 0) {
+             debug_warning("[FILE_POSIX]: walk(pathname:%s) -> %d\n", pathname, ret);
+         }
+
+         DEBUG_END();
+
+         // Return OK/KO
+         return ret;
+     }
+
      DIR * filesystem_opendir ( char * pathname )
      {
          DIR * ret;
@@ -0,0 +1,889 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "kv_index.h"
+
+
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     struct kv_index_log_header
+     {
+         char     magic[8];
+         uint32_t version;
+         uint32_t value_size;
+     };
+
+     struct kv_index_record
+     {
+         uint32_t crc;       // crc32 of the rest of the record (header fields + key + value)
+         uint32_t type;
+         uint32_t key_len;
+         uint32_t value_len;
+     };
+
+
+  /* ... Functions / Funciones ......................................... */
+
+
+     /*
+      * Internal
+      */
+
+     static uint32_t aux_kv_crc_table[256];
+     static pthread_once_t aux_kv_crc_once = PTHREAD_ONCE_INIT;
+
+     static void aux_kv_crc_init ( void )
+     {
+         for (uint32_t i = 0; i < 256; i++)
+         {
+             uint32_t c = i;
+             for (int j = 0; j < 8; j++) {
+                 c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+             }
+             aux_kv_crc_table[i] = c;
+         }
+     }
+
+     static uint32_t aux_kv_crc ( uint32_t crc, const void *buf, size_t len )
+     {
+         const unsigned char *p = (const unsigned char *)buf;
+
+         crc = crc ^ 0xFFFFFFFF;
+         for (size_t i = 0; i < len; i++) {
+             crc = aux_kv_crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+         }
+
+         return crc ^ 0xFFFFFFFF;
+     }
+
+     static uint32_t aux_kv_hash ( char *key, size_t key_len )
+     {
+         uint32_t h = 2166136261u;
+
+         for (size_t i = 0; i < key_len; i++) {
+             h = (h ^ (unsigned char)key[i]) * 16777619u;
+         }
+
+         return h;
+     }
+
+     // key is 'prefix' or lives under 'prefix/'
+     static int aux_kv_is_prefix ( char *key, size_t key_len, char *prefix, size_t prefix_len )
+     {
+         if (key_len < prefix_len) {
+             return 0;
+         }
+         if (strncmp(key, prefix, prefix_len) != 0) {
+             return 0;
+         }
+
+         return (key_len == prefix_len) || (key[prefix_len] == '/');
+     }
+
+     static size_t aux_kv_record_size ( size_t key_len, size_t value_len )
+     {
+         return sizeof(struct kv_index_record) + key_len + value_len;
+     }
+
+     static size_t aux_kv_record_build ( char *buf, uint32_t type, char *key, size_t key_len, void *value, size_t value_len )
+     {
+         struct kv_index_record rec;
+
+         rec.type      = type;
+         rec.key_len   = key_len;
+         rec.value_len = value_len;
+         memcpy(buf + sizeof(rec), key, key_len);
+         if (value_len > 0) {
+             memcpy(buf + sizeof(rec) + key_len, value, value_len);
+         }
+
+         rec.crc = aux_kv_crc(0,       (char *)&rec + sizeof(rec.crc), sizeof(rec) - sizeof(rec.crc));
+         rec.crc = aux_kv_crc(rec.crc, buf + sizeof(rec), key_len + value_len);
+         memcpy(buf, &rec, sizeof(rec));
+
+         return aux_kv_record_size(key_len, value_len);
+     }
+
+     static struct kv_index_entry *aux_kv_find ( kv_index_t *kv, char *key, size_t key_len, uint32_t hash, struct kv_index_entry ***link )
+     {
+         struct kv_index_entry **l = &(kv->buckets[hash & (kv->n_buckets - 1)]);
+
+         while (*l != NULL)
+         {
+             if (((*l)->hash == hash) && ((*l)->key_len == key_len) && (memcmp((*l)->key, key, key_len) == 0)) {
+                 break;
+             }
+             l = &((*l)->next);
+         }
+
+         if (link != NULL) {
+             *link = l;
+         }
+
+         return *l;
+     }
+
+     static int aux_kv_grow ( kv_index_t *kv )
+     {
+         long n_buckets = kv->n_buckets * 2;
+         struct kv_index_entry **buckets;
+
+         buckets = (struct kv_index_entry **)calloc(n_buckets, sizeof(struct kv_index_entry *));
+         if (NULL == buckets) {
+             return -1;
+         }
+
+         for (long i = 0; i < kv->n_buckets; i++)
+         {
+             struct kv_index_entry *e = kv->buckets[i];
+             while (e != NULL)
+             {
+                 struct kv_index_entry *next = e->next;
+                 e->next = buckets[e->hash & (n_buckets - 1)];
+                 buckets[e->hash & (n_buckets - 1)] = e;
+                 e = next;
+             }
+         }
+
+         free(kv->buckets);
+         kv->buckets   = buckets;
+         kv->n_buckets = n_buckets;
+
+         return 0;
+     }
+
+     static int aux_kv_table_put ( kv_index_t *kv, char *key, size_t key_len, void *value )
+     {
+         uint32_t hash = aux_kv_hash(key, key_len);
+         struct kv_index_entry **link;
+         struct kv_index_entry  *e;
+
+         e = aux_kv_find(kv, key, key_len, hash, &link);
+         if (e != NULL) {
+             memcpy(e->value, value, kv->value_size);
+             return 0;
+         }
+
+         e = (struct kv_index_entry *)malloc(sizeof(struct kv_index_entry) + kv->value_size + key_len + 1);
+         if (NULL == e) {
+             return -1;
+         }
+
+         e->next    = NULL;
+         e->hash    = hash;
+         e->key_len = key_len;
+         e->key     = e->value + kv->value_size;
+         memcpy(e->value, value, kv->value_size);
+         memcpy(e->key, key, key_len);
+         e->key[key_len] = '\0';
+
+         *link = e;
+         kv->n_entries++;
+         kv->live_size += aux_kv_record_size(key_len, kv->value_size);
+
+         if (kv->n_entries > kv->n_buckets) {
+             aux_kv_grow(kv); // a failure only makes the chains longer
+         }
+
+         return 0;
+     }
+
+     static int aux_kv_table_del ( kv_index_t *kv, char *key, size_t key_len )
+     {
+         uint32_t hash = aux_kv_hash(key, key_len);
+         struct kv_index_entry **link;
+         struct kv_index_entry  *e;
+
+         e = aux_kv_find(kv, key, key_len, hash, &link);
+         if (NULL == e) {
+             return -1;
+         }
+
+         *link = e->next;
+         kv->n_entries--;
+         kv->live_size -= aux_kv_record_size(key_len, kv->value_size);
+         free(e);
+
+         return 0;
+     }
+
+     static int aux_kv_append ( kv_index_t *kv, char *buf, size_t len )
+     {
+         ssize_t ret;
+
+         ret = filesystem_write(kv->fd, buf, len);
+         if (ret < 0) {
+             return -1;
+         }
+         kv->log_size += len;
+
+         if (kv->sync) {
+             fdatasync(kv->fd);
+         }
+
+         return 0;
+     }
+
+     static int aux_kv_write_header ( int fd, size_t value_size )
+     {
+         struct kv_index_log_header header;
+
+         memset(&header, 0, sizeof(header));
+         memcpy(header.magic, KV_INDEX_MAGIC, sizeof(header.magic));
+         header.version    = KV_INDEX_VERSION;
+         header.value_size = value_size;
+
+         if (filesystem_write(fd, &header, sizeof(header)) < 0) {
+             return -1;
+         }
+
+         return 0;
+     }
+
+     static int aux_kv_replay ( kv_index_t *kv )
+     {
+         struct kv_index_log_header header;
+         struct kv_index_record rec;
+         struct stat st;
+         off_t  good;
+         char  *buf;
+         FILE  *f;
+         int    fd;
+         uint32_t crc;
+
+         if (fstat(kv->fd, &st) < 0) {
+             return -1;
+         }
+
+         // new log
+         if (st.st_size == 0)
+         {
+             if (aux_kv_write_header(kv->fd, kv->value_size) < 0) {
+                 return -1;
+             }
+             kv->log_size  = sizeof(header);
+             kv->live_size = sizeof(header);
+             return 0;
+         }
+
+         fd = dup(kv->fd);
+         if (fd < 0) {
+             return -1;
+         }
+         f = fdopen(fd, "r");
+         if (NULL == f) {
+             close(fd);
+             return -1;
+         }
+         rewind(f);
+
+         if ((fread(&header, sizeof(header), 1, f) != 1) ||
+             (memcmp(header.magic, KV_INDEX_MAGIC, sizeof(header.magic)) != 0) ||
+             (header.version != KV_INDEX_VERSION) ||
+             (header.value_size != kv->value_size))
+         {
+             printf("[KV_INDEX] [aux_kv_replay] ERROR: '%s' is not a compatible index log\n", kv->log_path);
+             fclose(f);
+             errno = EINVAL;
+             return -1;
+         }
+
+         buf = (char *)malloc(PATH_MAX + kv->value_size);
+         if (NULL == buf) {
+             fclose(f);
+             return -1;
+         }
+
+         // replay records until the end or the first torn/corrupted one
+         good = sizeof(header);
+         kv->live_size = sizeof(header);
+         while (fread(&rec, sizeof(rec), 1, f) == 1)
+         {
+             if ((rec.key_len == 0) || (rec.key_len >= PATH_MAX)) {
+                 break;
+             }
+             if ( ((rec.type == KV_INDEX_RECORD_PUT) && (rec.value_len != kv->value_size)) ||
+                  ((rec.type == KV_INDEX_RECORD_DEL) && (rec.value_len != 0)) ||
+                  ((rec.type != KV_INDEX_RECORD_PUT) && (rec.type != KV_INDEX_RECORD_DEL)) ) {
+                 break;
+             }
+             if (fread(buf, rec.key_len + rec.value_len, 1, f) != 1) {
+                 break;
+             }
+
+             crc = aux_kv_crc(0,   (char *)&rec + sizeof(rec.crc), sizeof(rec) - sizeof(rec.crc));
+             crc = aux_kv_crc(crc, buf, rec.key_len + rec.value_len);
+             if (crc != rec.crc) {
+                 break;
+             }
+
+             if (rec.type == KV_INDEX_RECORD_PUT) {
+                 if (aux_kv_table_put(kv, buf, rec.key_len, buf + rec.key_len) < 0) {
+                     free(buf);
+                     fclose(f);
+                     return -1;
+                 }
+             } else {
+                 aux_kv_table_del(kv, buf, rec.key_len);
+             }
+
+             good += aux_kv_record_size(rec.key_len, rec.value_len);
+         }
+
+         free(buf);
+         fclose(f);
+
+         // cut off the torn tail, so new records are appended after the last good one
+         if (good < st.st_size)
+         {
+             printf("[KV_INDEX] [aux_kv_replay] WARNING: '%s' truncated from %ld to %ld bytes\n", kv->log_path, (long)st.st_size, (long)good);
+             if (ftruncate(kv->fd, good) < 0) {
+                 return -1;
+             }
+         }
+         kv->log_size = good;
+
+         return 0;
+     }
+
+     static int aux_kv_compact ( kv_index_t *kv )
+     {
+         char   tmp_path[PATH_MAX];
+         char   dir_path[PATH_MAX];
+         char  *buf;
+         size_t buf_len, buf_size;
+         off_t  log_size;
+         int    fd, ret;
+
+         ret = snprintf(tmp_path, PATH_MAX, "%s.tmp", kv->log_path);
+         if ((ret < 0) || (ret >= PATH_MAX)) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         fd = filesystem_open2(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+         if (fd < 0) {
+             return -1;
+         }
+
+         buf_size = 64 * 1024;
+         if (buf_size < aux_kv_record_size(PATH_MAX, kv->value_size)) {
+             buf_size = aux_kv_record_size(PATH_MAX, kv->value_size);
+         }
+         buf = (char *)malloc(buf_size);
+         if (NULL == buf) {
+             goto error_aux_kv_compact;
+         }
+
+         if (aux_kv_write_header(fd, kv->value_size) < 0) {
+             goto error_aux_kv_compact;
+         }
+         log_size = sizeof(struct kv_index_log_header);
+
+         // dump the live entries
+         buf_len = 0;
+         for (long i = 0; i < kv->n_buckets; i++)
+         {
+             for (struct kv_index_entry *e = kv->buckets[i]; e != NULL; e = e->next)
+             {
+                 if (buf_len + aux_kv_record_size(e->key_len, kv->value_size) > buf_size)
+                 {
+                     if (filesystem_write(fd, buf, buf_len) < 0) {
+                         goto error_aux_kv_compact;
+                     }
+                     buf_len = 0;
+                 }
+
+                 buf_len  += aux_kv_record_build(buf + buf_len, KV_INDEX_RECORD_PUT, e->key, e->key_len, e->value, kv->value_size);
+                 log_size += aux_kv_record_size(e->key_len, kv->value_size);
+             }
+         }
+         if ((buf_len > 0) && (filesystem_write(fd, buf, buf_len) < 0)) {
+             goto error_aux_kv_compact;
+         }
+
+         // make the new log durable before it replaces the old one
+         if (filesystem_fsync(fd) < 0) {
+             goto error_aux_kv_compact;
+         }
+         filesystem_close(fd);
+         FREE_AND_NULL(buf);
+
+         if (filesystem_rename(tmp_path, kv->log_path) < 0) {
+             unlink(tmp_path);
+             return -1;
+         }
+
+         strcpy(dir_path, kv->log_path);
+         fd = filesystem_open(dirname(dir_path), O_RDONLY);
+         if (fd >= 0) {
+             filesystem_fsync(fd);
+             filesystem_close(fd);
+         }
+
+         // switch to the new log
+         fd = filesystem_open(kv->log_path, O_RDWR | O_APPEND);
+         if (fd < 0) {
+             return -1;
+         }
+         filesystem_close(kv->fd);
+         kv->fd        = fd;
+         kv->log_size  = log_size;
+         kv->live_size = log_size;
+
+         return 0;
+
+error_aux_kv_compact:
+         FREE_AND_NULL(buf);
+         filesystem_close(fd);
+         unlink(tmp_path);
+         return -1;
+     }
+
+     static void aux_kv_maybe_compact ( kv_index_t *kv )
+     {
+         off_t dead_size = kv->log_size - kv->live_size;
+
+         if ((dead_size > KV_INDEX_COMPACT_MIN) && (dead_size > kv->live_size)) {
+             aux_kv_compact(kv); // on failure keep appending to the old log
+         }
+     }
+
+     static struct kv_index_entry **aux_kv_collect_prefix ( kv_index_t *kv, char *prefix, size_t prefix_len, long *n )
+     {
+         struct kv_index_entry **list;
+         long count = 0;
+
+         list = (struct kv_index_entry **)malloc((kv->n_entries + 1) * sizeof(struct kv_index_entry *));
+         if (NULL == list) {
+             return NULL;
+         }
+
+         for (long i = 0; i < kv->n_buckets; i++)
+         {
+             for (struct kv_index_entry *e = kv->buckets[i]; e != NULL; e = e->next)
+             {
+                 if (aux_kv_is_prefix(e->key, e->key_len, prefix, prefix_len)) {
+                     list[count++] = e;
+                 }
+             }
+         }
+
+         *n = count;
+         return list;
+     }
+
+
+     /*
+      * API
+      */
+
+     kv_index_t *kv_index_open ( char *log_path, size_t value_size, int sync )
+     {
+         kv_index_t *kv;
+
+         // check arguments...
+         if ((NULL == log_path) || (value_size == 0) || (strlen(log_path) + 5 >= PATH_MAX)) {
+             errno = EINVAL;
+             return NULL;
+         }
+
+         pthread_once(&aux_kv_crc_once, aux_kv_crc_init);
+
+         kv = (kv_index_t *)malloc(sizeof(kv_index_t));
+         if (NULL == kv) {
+             return NULL;
+         }
+
+         memset(kv, 0, sizeof(kv_index_t));
+         pthread_mutex_init(&(kv->mutex), NULL);
+         strcpy(kv->log_path, log_path);
+         kv->sync       = sync;
+         kv->value_size = value_size;
+         kv->n_buckets  = KV_INDEX_INITIAL_BUCKETS;
+         kv->buckets    = (struct kv_index_entry **)calloc(kv->n_buckets, sizeof(struct kv_index_entry *));
+         if (NULL == kv->buckets) {
+             free(kv);
+             return NULL;
+         }
+
+         kv->fd = filesystem_open2(log_path, O_RDWR | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+         if (kv->fd < 0) {
+             free(kv->buckets);
+             free(kv);
+             return NULL;
+         }
+
+         if (aux_kv_replay(kv) < 0) {
+             int err = errno;
+             kv_index_close(kv);
+             errno = err;
+             return NULL;
+         }
+
+         aux_kv_maybe_compact(kv);
+
+         return kv;
+     }
+
+     int kv_index_close ( kv_index_t *kv )
+     {
+         if (NULL == kv) {
+             return -1;
+         }
+
+         if (kv->fd >= 0) {
+             filesystem_fsync(kv->fd);
+             filesystem_close(kv->fd);
+         }
+
+         for (long i = 0; i < kv->n_buckets; i++)
+         {
+             struct kv_index_entry *e = kv->buckets[i];
+             while (e != NULL)
+             {
+                 struct kv_index_entry *next = e->next;
+                 free(e);
+                 e = next;
+             }
+         }
+
+         free(kv->buckets);
+         pthread_mutex_destroy(&(kv->mutex));
+         free(kv);
+
+         return 0;
+     }
+
+     int kv_index_get ( kv_index_t *kv, char *key, void *value )
+     {
+         struct kv_index_entry *e;
+         size_t key_len;
+
+         if ((NULL == kv) || (NULL == key)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         key_len = strlen(key);
+
+         pthread_mutex_lock(&(kv->mutex));
+         e = aux_kv_find(kv, key, key_len, aux_kv_hash(key, key_len), NULL);
+         if (e != NULL) {
+             memcpy(value, e->value, kv->value_size);
+         }
+         pthread_mutex_unlock(&(kv->mutex));
+
+         if (NULL == e) {
+             errno = ENOENT;
+             return -1;
+         }
+
+         return 0;
+     }
+
+     int kv_index_put ( kv_index_t *kv, char *key, void *value )
+     {
+         char   *buf;
+         size_t  key_len, len;
+         int     ret;
+
+         if ((NULL == kv) || (NULL == key) || (NULL == value)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         key_len = strlen(key);
+         if ((key_len == 0) || (key_len >= PATH_MAX)) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         buf = (char *)malloc(aux_kv_record_size(key_len, kv->value_size));
+         if (NULL == buf) {
+             return -1;
+         }
+         len = aux_kv_record_build(buf, KV_INDEX_RECORD_PUT, key, key_len, value, kv->value_size);
+
+         pthread_mutex_lock(&(kv->mutex));
+         ret = aux_kv_append(kv, buf, len);
+         if (ret >= 0) {
+             ret = aux_kv_table_put(kv, key, key_len, value);
+             aux_kv_maybe_compact(kv);
+         }
+         pthread_mutex_unlock(&(kv->mutex));
+
+         free(buf);
+
+         return ret;
+     }
+
+     int kv_index_update ( kv_index_t *kv, char *key, int (*update_fn)(void *value, void *arg), void *arg )
+     {
+         struct kv_index_entry *e;
+         char   *buf;
+         size_t  key_len, len;
+         int     ret;
+
+         if ((NULL == kv) || (NULL == key) || (NULL == update_fn)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         key_len = strlen(key);
+         if ((key_len == 0) || (key_len >= PATH_MAX)) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         // record buffer, with the new value just after it
+         buf = (char *)malloc(aux_kv_record_size(key_len, kv->value_size) + kv->value_size);
+         if (NULL == buf) {
+             return -1;
+         }
+
+         pthread_mutex_lock(&(kv->mutex));
+
+         e = aux_kv_find(kv, key, key_len, aux_kv_hash(key, key_len), NULL);
+         if (NULL == e)
+         {
+             errno = ENOENT;
+             ret = -1;
+             goto cleanup_kv_index_update;
+         }
+
+         // update_fn returns 1 if the value has been modified
+         char *value = buf + aux_kv_record_size(key_len, kv->value_size);
+         memcpy(value, e->value, kv->value_size);
+         ret = update_fn(value, arg);
+         if (ret <= 0) {
+             goto cleanup_kv_index_update;
+         }
+
+         len = aux_kv_record_build(buf, KV_INDEX_RECORD_PUT, key, key_len, value, kv->value_size);
+         if (aux_kv_append(kv, buf, len) < 0) {
+             ret = -1;
+             goto cleanup_kv_index_update;
+         }
+         memcpy(e->value, value, kv->value_size);
+         aux_kv_maybe_compact(kv);
+
+cleanup_kv_index_update:
+         pthread_mutex_unlock(&(kv->mutex));
+         free(buf);
+
+         return ret;
+     }
+
+     int kv_index_del ( kv_index_t *kv, char *key )
+     {
+         char   *buf;
+         size_t  key_len, len;
+         int     ret;
+
+         if ((NULL == kv) || (NULL == key)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         key_len = strlen(key);
+         if ((key_len == 0) || (key_len >= PATH_MAX)) {
+             errno = ENAMETOOLONG;
+             return -1;
+         }
+
+         buf = (char *)malloc(aux_kv_record_size(key_len, 0));
+         if (NULL == buf) {
+             return -1;
+         }
+         len = aux_kv_record_build(buf, KV_INDEX_RECORD_DEL, key, key_len, NULL, 0);
+
+         pthread_mutex_lock(&(kv->mutex));
+         ret = -1;
+         errno = ENOENT;
+         if (aux_kv_find(kv, key, key_len, aux_kv_hash(key, key_len), NULL) != NULL)
+         {
+             ret = aux_kv_append(kv, buf, len);
+             if (ret >= 0) {
+                 aux_kv_table_del(kv, key, key_len);
+                 aux_kv_maybe_compact(kv);
+             }
+         }
+         pthread_mutex_unlock(&(kv->mutex));
+
+         free(buf);
+
+         return ret;
+     }
+
+     int kv_index_del_prefix ( kv_index_t *kv, char *prefix )
+     {
+         struct kv_index_entry **list;
+         char   buf[sizeof(struct kv_index_record) + PATH_MAX];
+         size_t len;
+         long   n = 0;
+         int    ret = 0;
+
+         if ((NULL == kv) || (NULL == prefix)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         pthread_mutex_lock(&(kv->mutex));
+
+         list = aux_kv_collect_prefix(kv, prefix, strlen(prefix), &n);
+         if (NULL == list) {
+             pthread_mutex_unlock(&(kv->mutex));
+             return -1;
+         }
+
+         for (long i = 0; i < n; i++)
+         {
+             len = aux_kv_record_build(buf, KV_INDEX_RECORD_DEL, list[i]->key, list[i]->key_len, NULL, 0);
+             if (aux_kv_append(kv, buf, len) < 0) {
+                 ret = -1;
+                 break;
+             }
+             aux_kv_table_del(kv, list[i]->key, list[i]->key_len);
+         }
+         aux_kv_maybe_compact(kv);
+
+         pthread_mutex_unlock(&(kv->mutex));
+         free(list);
+
+         return (ret < 0) ? ret : (int)n;
+     }
+
+     int kv_index_rename ( kv_index_t *kv, char *old_prefix, char *new_prefix )
+     {
+         struct kv_index_entry **list;
+         char  *buf;
+         char   new_key[PATH_MAX];
+         size_t old_len, new_len, len;
+         long   n = 0;
+         int    ret = 0;
+
+         if ((NULL == kv) || (NULL == old_prefix) || (NULL == new_prefix)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         old_len = strlen(old_prefix);
+         new_len = strlen(new_prefix);
+
+         // a prefix cannot be moved inside itself
+         if (aux_kv_is_prefix(new_prefix, new_len, old_prefix, old_len)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         // PUT(new) + DEL(old) are written with one write
+         buf = (char *)malloc(aux_kv_record_size(PATH_MAX, kv->value_size) + aux_kv_record_size(PATH_MAX, 0));
+         if (NULL == buf) {
+             return -1;
+         }
+
+         pthread_mutex_lock(&(kv->mutex));
+
+         list = aux_kv_collect_prefix(kv, old_prefix, old_len, &n);
+         if (NULL == list) {
+             pthread_mutex_unlock(&(kv->mutex));
+             free(buf);
+             return -1;
+         }
+
+         for (long i = 0; i < n; i++)
+         {
+             struct kv_index_entry *e = list[i];
+
+             if (new_len + e->key_len - old_len >= PATH_MAX) {
+                 errno = ENAMETOOLONG;
+                 ret = -1;
+                 break;
+             }
+             memcpy(new_key, new_prefix, new_len);
+             strcpy(new_key + new_len, e->key + old_len);
+
+             len  = aux_kv_record_build(buf,       KV_INDEX_RECORD_PUT, new_key, strlen(new_key), e->value, kv->value_size);
+             len += aux_kv_record_build(buf + len, KV_INDEX_RECORD_DEL, e->key,  e->key_len,      NULL,     0);
+             if (aux_kv_append(kv, buf, len) < 0) {
+                 ret = -1;
+                 break;
+             }
+
+             if (aux_kv_table_put(kv, new_key, strlen(new_key), e->value) < 0) {
+                 ret = -1;
+                 break;
+             }
+             aux_kv_table_del(kv, e->key, e->key_len);
+         }
+         aux_kv_maybe_compact(kv);
+
+         pthread_mutex_unlock(&(kv->mutex));
+         free(list);
+         free(buf);
+
+         return (ret < 0) ? ret : (int)n;
+     }
+
+     int kv_index_foreach ( kv_index_t *kv, int (*foreach_fn)(char *key, void *value, void *arg), void *arg )
+     {
+         int ret = 0;
+
+         if ((NULL == kv) || (NULL == foreach_fn)) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         pthread_mutex_lock(&(kv->mutex));
+         for (long i = 0; (i < kv->n_buckets) && (ret >= 0); i++)
+         {
+             for (struct kv_index_entry *e = kv->buckets[i]; (e != NULL) && (ret >= 0); e = e->next) {
+                 ret = foreach_fn(e->key, e->value, arg);
+             }
+         }
+         pthread_mutex_unlock(&(kv->mutex));
+
+         return ret;
+     }
+
+     int kv_index_compact ( kv_index_t *kv )
+     {
+         int ret;
+
+         if (NULL == kv) {
+             errno = EINVAL;
+             return -1;
+         }
+
+         pthread_mutex_lock(&(kv->mutex));
+         ret = aux_kv_compact(kv);
+         pthread_mutex_unlock(&(kv->mutex));
+
+         return ret;
+     }
+
+
+  /* ................................................................... */
+
@@ -0,0 +1,268 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "base/lz4_codec.h"
+
+
+  /* ... Const / Const ................................................. */
+
+     #define LZ4_MIN_MATCH      4
+     #define LZ4_LAST_LITERALS  5     // the block always ends with literals
+     #define LZ4_MF_LIMIT       12    // no match starts in the last 12 bytes
+     #define LZ4_MAX_OFFSET     65535
+     #define LZ4_HASH_LOG       12
+     #define LZ4_SKIP_TRIGGER   6     // larger steps on data without matches
+
+
+  /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
+
+     static inline uint32_t lz4_read32 ( const unsigned char *p )
+     {
+         uint32_t v ;
+
+         memcpy(&v, p, sizeof(v)) ;
+         return v ;
+     }
+
+     static inline uint32_t lz4_hash ( uint32_t v )
+     {
+         return (v * 2654435761U) >> (32 - LZ4_HASH_LOG) ;
+     }
+
+     // 15 in the token nibble, then 255s and the rest
+     static inline unsigned char * lz4_write_length ( unsigned char *op, int len )
+     {
+         while (len >= 255)
+         {
+             *op++ = 255 ;
+             len  -= 255 ;
+         }
+         *op++ = (unsigned char)len ;
+
+         return op ;
+     }
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     int lz4_codec_compress ( const char *src, int src_size, char *dst, int dst_capacity )
+     {
+         uint32_t table[1 << LZ4_HASH_LOG] ;
+         const unsigned char *base   = (const unsigned char *)src ;
+         const unsigned char *ip     = base ;
+         const unsigned char *anchor = base ;
+         const unsigned char *iend   = base + src_size ;
+         const unsigned char *mflimit    = iend - LZ4_MF_LIMIT ;
+         const unsigned char *matchlimit = iend - LZ4_LAST_LITERALS ;
+         const unsigned char *ref ;
+         unsigned char *op   = (unsigned char *)dst ;
+         unsigned char *oend = (unsigned char *)dst + dst_capacity ;
+         unsigned char *token ;
+         uint32_t h ;
+         int lit_len, match_len, misses ;
+
+         if ((src_size < 0) || (dst_capacity < 1)) {
+             return -1 ;
+         }
+
+         bzero(table, sizeof(table)) ;
+         misses = 0 ;
+
+         while ((src_size > LZ4_MF_LIMIT) && (ip < mflimit))
+         {
+             h   = lz4_hash(lz4_read32(ip)) ;
+             ref = base + table[h] ;
+             table[h] = (uint32_t)(ip - base) ;
+
+             if ((ref >= ip) || (ip - ref > LZ4_MAX_OFFSET) || (lz4_read32(ref) != lz4_read32(ip)))
+             {
+                 ip = ip + 1 + (misses++ >> LZ4_SKIP_TRIGGER) ;
+                 continue ;
+             }
+             misses = 0 ;
+
+             // extend the match forward
+             const unsigned char *m = ip  + LZ4_MIN_MATCH ;
+             const unsigned char *r = ref + LZ4_MIN_MATCH ;
+             while ((m < matchlimit) && (*m == *r))
+             {
+                 m++ ;
+                 r++ ;
+             }
+
+             lit_len   = (int)(ip - anchor) ;
+             match_len = (int)(m - ip) - LZ4_MIN_MATCH ;
+
+             // token + literals + offset + lengths must fit
+             if (op + 1 + lit_len + (lit_len / 255) + 1 + 2 + (match_len / 255) + 1 > oend) {
+                 return -1 ;
+             }
+
+             token = op++ ;
+             if (lit_len >= 15) {
+                 *token = (15 << 4) ;
+                 op = lz4_write_length(op, lit_len - 15) ;
+             }
+             else {
+                 *token = (unsigned char)(lit_len << 4) ;
+             }
+             memcpy(op, anchor, lit_len) ;
+             op = op + lit_len ;
+
+             *op++ = (unsigned char)((ip - ref) & 0xff) ;
+             *op++ = (unsigned char)((ip - ref) >> 8) ;
+
+             if (match_len >= 15) {
+                 *token |= 15 ;
+                 op = lz4_write_length(op, match_len - 15) ;
+             }
+             else {
+                 *token |= (unsigned char)match_len ;
+             }
+
+             ip     = m ;
+             anchor = ip ;
+         }
+
+         // last literals
+         lit_len = (int)(iend - anchor) ;
+         if (op + 1 + lit_len + (lit_len / 255) + 1 > oend) {
+             return -1 ;
+         }
+
+         token = op++ ;
+         if (lit_len >= 15) {
+             *token = (15 << 4) ;
+             op = lz4_write_length(op, lit_len - 15) ;
+         }
+         else {
+             *token = (unsigned char)(lit_len << 4) ;
+         }
+         memcpy(op, anchor, lit_len) ;
+         op = op + lit_len ;
+
+         return (int)(op - (unsigned char *)dst) ;
+     }
+
+     int lz4_codec_decompress ( const char *src, int src_size, char *dst, int dst_size )
+     {
+         const unsigned char *ip   = (const unsigned char *)src ;
+         const unsigned char *iend = ip + src_size ;
+         unsigned char *op   = (unsigned char *)dst ;
+         unsigned char *oend = op + dst_size ;
+         const unsigned char *ref ;
+         unsigned int  token, b ;
+         size_t        len, offset ;
+
+         while (ip < iend)
+         {
+             token = *ip++ ;
+
+             // literals
+             len = token >> 4 ;
+             if (15 == len)
+             {
+                 do {
+                     if (ip >= iend) {
+                         return -1 ;
+                     }
+                     b   = *ip++ ;
+                     len = len + b ;
+                 } while (255 == b) ;
+             }
+             if (((size_t)(iend - ip) < len) || ((size_t)(oend - op) < len)) {
+                 return -1 ;
+             }
+             memcpy(op, ip, len) ;
+             ip = ip + len ;
+             op = op + len ;
+
+             // the last sequence has no match
+             if (ip >= iend) {
+                 break ;
+             }
+
+             // match
+             if (iend - ip < 2) {
+                 return -1 ;
+             }
+             offset = ip[0] | (ip[1] << 8) ;
+             ip = ip + 2 ;
+             if ((0 == offset) || (offset > (size_t)(op - (unsigned char *)dst))) {
+                 return -1 ;
+             }
+
+             len = token & 15 ;
+             if (15 == len)
+             {
+                 do {
+                     if (ip >= iend) {
+                         return -1 ;
+                     }
+                     b   = *ip++ ;
+                     len = len + b ;
+                 } while (255 == b) ;
+             }
+             len = len + LZ4_MIN_MATCH ;
+             if ((size_t)(oend - op) < len) {
+                 return -1 ;
+             }
+
+             ref = op - offset ;
+             if (offset >= len)
+             {
+                 memcpy(op, ref, len) ;
+                 op = op + len ;
+             }
+             else
+             {
+                 // overlapping copy repeats the last 'offset' bytes
+                 while (len-- > 0) {
+                     *op++ = *ref++ ;
+                 }
+             }
+         }
+
+         if (op != oend) {
+             return -1 ;
+         }
+
+         return dst_size ;
+     }
+
+     int lz4_codec_from_name ( const char *name )
+     {
+         if ((NULL == name) || (0 == strcasecmp(name, "none"))) {
+             return XPN_CODEC_NONE ;
+         }
+         if (0 == strcasecmp(name, "lz4")) {
+             return XPN_CODEC_LZ4 ;
+         }
+
+         return -1 ;
+     }
+
+
+  /* ................................................................... */
+
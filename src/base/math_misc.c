@@ -27,6 +27,39 @@
 
   /* ... Functions / Funciones ......................................... */
 
+    // 32 bytes per operation: the compiler uses the vector registers of the target (SSE2, AVX, NEON, ...)
+    typedef unsigned char math_misc_vector_t __attribute__ ((vector_size (32))) ;
+
+    /**
+     * dst = dst ^ src, for 'size' bytes.
+     * @param dst block updated.
+     * @param src block of data.
+     * @param size number of bytes.
+     */
+     static void math_misc_xor_into
+     (
+          char       *dst,
+          const char *src,
+          size_t      size
+     )
+     {
+        math_misc_vector_t a, b ;
+        size_t i ;
+
+        for (i=0; i + sizeof(math_misc_vector_t) <= size; i += sizeof(math_misc_vector_t))
+        {
+           memcpy(&a, dst + i, sizeof(math_misc_vector_t)) ;
+           memcpy(&b, src + i, sizeof(math_misc_vector_t)) ;
+           a = a ^ b ;
+           memcpy(dst + i, &a, sizeof(math_misc_vector_t)) ;
+        }
+        for (; i<size; i++)
+        {
+           dst[i] = dst[i] ^ src[i] ;
+        }
+     }
+
+
     /**
      * Compute server index associated to a file.
      * @param file the file name.
@@ -187,15 +220,11 @@
           int   block_size
      )
      {
-        int i;
-
       	/*
       	 * XOR
       	 */
-        for (i=0; i<block_size; i++)
-        {
-           block_result[i] = block_1[i] ^ block_2[i];
-        }
+        memmove(block_result, block_1, block_size) ;
+        math_misc_xor_into(block_result, block_2, block_size) ;
 
       	/*
       	 * Return ok
@@ -222,15 +251,11 @@
           int   block_size
      )
      {
-        int i;
-
       	/*
       	 * XOR
       	 */
-        for (i=0; i<block_size; i++)
-        {
-           block_result[i] = block_1[i] ^ block_2[i] ^  block_3[i] ;
-        }
+        MATH_MISC_Xor(block_result, block_1, block_2, block_size) ;
+        math_misc_xor_into(block_result, block_3, block_size) ;
 
       	/*
       	 * Return ok
@@ -255,19 +280,16 @@
           int    block_size
      )
      {
-        int i, j;
+        int j;
 
       	/*
       	 * XOR
       	 */
-        for (i=0; i<block_size; i++)
-	{
-            block_result[i] = blocks[0][i];
-            for (j=1; j<nblocks; j++)
-            {
-                block_result[i] = block_result[i] ^ blocks[j][i] ;
-            }
-	}
+        memmove(block_result, blocks[0], block_size) ;
+        for (j=1; j<nblocks; j++)
+        {
+            math_misc_xor_into(block_result, blocks[j], block_size) ;
+        }
 
       	/*
       	 * Return ok
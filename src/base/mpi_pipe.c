@@ -0,0 +1,155 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "base/mpi_pipe.h"
+
+
+#ifdef ENABLE_MPI_SERVER
+
+  /* ... Const / Const ................................................. */
+
+     #define MPI_PIPE_MAX_INFLIGHT  64
+
+     // failed tests before giving the processor to other threads
+     #define MPI_PIPE_SPIN          64
+
+
+  /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
+
+     static int mpi_pipe_inflight ( void )
+     {
+         static int inflight = -1 ;
+
+         if (inflight < 0)
+         {
+             int n = utils_getenv_int("XPN_MPI_INFLIGHT", MPI_PIPE_DEFAULT_INFLIGHT) ;
+             if (n < 1) {
+                 n = 1 ;
+             }
+             if (n > MPI_PIPE_MAX_INFLIGHT) {
+                 n = MPI_PIPE_MAX_INFLIGHT ;
+             }
+             inflight = n ;
+         }
+
+         return inflight ;
+     }
+
+     static int mpi_pipe_post ( int is_send, char *data, ssize_t size, int peer, int tag, MPI_Comm comm, MPI_Request *req )
+     {
+         if (is_send) {
+             return MPI_Isend(data, (int)size, MPI_CHAR, peer, tag, comm, req) ;
+         }
+
+         return MPI_Irecv(data, (int)size, MPI_CHAR, peer, tag, comm, req) ;
+     }
+
+     // Keep up to 'inflight' pieces posted and poll them without blocking inside MPI,
+     // so other threads of the process (workers, dispatchers) can use the library meanwhile.
+     static int mpi_pipe_transfer ( int is_send, char *data, ssize_t size, int peer, int tag, MPI_Comm comm )
+     {
+         MPI_Request reqs[MPI_PIPE_MAX_INFLIGHT] ;
+         int         idx[MPI_PIPE_MAX_INFLIGHT] ;
+         int         inflight, active, done, ret, spin ;
+         ssize_t     posted ;
+         ssize_t     piece ;
+
+         inflight = mpi_pipe_inflight() ;
+         active   = 0 ;
+         posted   = 0 ;
+         spin     = 0 ;
+
+         while ((posted < size) || (active > 0))
+         {
+             // post the next pieces (same split on both sides, MPI keeps their order)
+             while ((posted < size) && (active < inflight))
+             {
+                 piece = size - posted ;
+                 if (piece > MPI_PIPE_CHUNK) {
+                     piece = MPI_PIPE_CHUNK ;
+                 }
+
+                 ret = mpi_pipe_post(is_send, data + posted, piece, peer, tag, comm, &(reqs[active])) ;
+                 if (MPI_SUCCESS != ret)
+                 {
+                     debug_error("[MPI_PIPE] [mpi_pipe_transfer] ERROR: post of %ld bytes fails\n", (long)piece) ;
+                     MPI_Waitall(active, reqs, MPI_STATUSES_IGNORE) ;
+                     return -1 ;
+                 }
+
+                 active++ ;
+                 posted = posted + piece ;
+             }
+
+             // poll completion
+             ret = MPI_Testsome(active, reqs, &done, idx, MPI_STATUSES_IGNORE) ;
+             if (MPI_SUCCESS != ret)
+             {
+                 debug_error("[MPI_PIPE] [mpi_pipe_transfer] ERROR: MPI_Testsome fails\n") ;
+                 return -1 ;
+             }
+
+             if ((0 == done) || (MPI_UNDEFINED == done))
+             {
+                 spin++ ;
+                 if (spin > MPI_PIPE_SPIN) {
+                     sched_yield() ;
+                 }
+                 continue ;
+             }
+             spin = 0 ;
+
+             // compact the finished requests (MPI sets them to MPI_REQUEST_NULL)
+             int j = 0 ;
+             for (int i = 0; i < active; i++)
+             {
+                 if (MPI_REQUEST_NULL != reqs[i]) {
+                     reqs[j++] = reqs[i] ;
+                 }
+             }
+             active = j ;
+         }
+
+         return 0 ;
+     }
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     int mpi_pipe_send ( void *data, ssize_t size, int dest, int tag, MPI_Comm comm )
+     {
+         return mpi_pipe_transfer(1, (char *)data, size, dest, tag, comm) ;
+     }
+
+     int mpi_pipe_recv ( void *data, ssize_t size, int source, int tag, MPI_Comm comm )
+     {
+         return mpi_pipe_transfer(0, (char *)data, size, source, tag, comm) ;
+     }
+
+#endif
+
+
+  /* ................................................................... */
+
@@ -23,6 +23,271 @@
      #include "base/ns.h"
 
 
+  /* ... Data structures / Estructuras de datos ........................ */
+
+     // (one byte more than the buffers of ns_lookup, a field filled up to its end did not fit)
+     struct ns_entry
+     {
+         char name[CONST_TEMP + 1];              // <protocol>:<server name>
+         char ip  [CONST_TEMP + 1];
+         char port[MAX_PORT_NAME_LENGTH + 1];    // MPI port names are long
+         int  next_name;                 // next entry in the same bucket (-1 ends)
+         int  next_ip;
+     };
+
+     // Lines of one DNS file, hashed by name and by address
+     static struct
+     {
+         char   file[PATH_MAX];
+         int    loaded;
+         int    pinned;                  // received from rank 0, only checked again on a miss
+         dev_t  dev;
+         ino_t  ino;
+         off_t  size;
+         struct timespec mtime;
+         time_t checked;
+
+         int    n, max;
+         struct ns_entry * entries;
+         int    head_name[NS_CACHE_BUCKETS];
+         int    head_ip  [NS_CACHE_BUCKETS];
+     } ns_cache;
+
+     static pthread_mutex_t ns_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+  /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
+
+     static void ns_dns_file ( char * protocol, char * dns_file )
+     {
+         // try to get the ns_file_name
+         char * dns_file_env = getenv("XPN_DNS");
+         if (dns_file_env == NULL)
+	 {
+             if (strcmp(protocol, "mpi_server") == 0) {
+                 strcpy(dns_file, MPI_SERVER_DNS_FILE_DEFAULT);
+             } else if (strcmp(protocol, "sck_server") == 0) {
+                 strcpy(dns_file, SCK_SERVER_DNS_FILE_DEFAULT);
+             } else if (strcmp(protocol, "mq_server") == 0) {
+                 strcpy(dns_file, MQ_SERVER_DNS_FILE_DEFAULT);
+             } else {
+                 printf("Unrecognized protocol '%s' !!\n", protocol);
+                 dns_file[0] = '\0';
+             }
+         } else {
+             snprintf(dns_file, PATH_MAX, "%s", dns_file_env);
+         }
+     }
+
+     static unsigned ns_hash ( char * str )
+     {
+         unsigned h = 5381;
+
+         while (*str != '\0') {
+             h = (h * 33) ^ (unsigned char) *str;
+             str++;
+         }
+
+         return h % NS_CACHE_BUCKETS;
+     }
+
+     // The whole file in one read, 'st' describes the version read
+     static int ns_cache_read_file ( char * dns_file, char ** text, struct stat * st )
+     {
+         FILE * dns_fd;
+         size_t n;
+
+         *text = NULL;
+
+         dns_fd = fopen(dns_file, "r");
+         if (NULL == dns_fd) {
+             return -1;
+         }
+
+         if (fstat(fileno(dns_fd), st) < 0) {
+             fclose(dns_fd);
+             return -1;
+         }
+
+         *text = (char *) malloc(st->st_size + 1);
+         if (NULL == *text) {
+             fclose(dns_fd);
+             return -1;
+         }
+
+         n = fread(*text, 1, st->st_size, dns_fd);
+         (*text)[n] = '\0';
+         st->st_size = n;
+
+         fclose(dns_fd);
+
+         return 0;
+     }
+
+     // Replace the cache with the lines in 'text' ("<protocol>:<name> <protocol>:<ip> <port>")
+     static int ns_cache_parse ( char * dns_file, char * text, struct stat * st )
+     {
+         char aux_protocol[CONST_TEMP + 1];
+         char format[64];
+         struct ns_entry * e;
+         char * line;
+         char * next;
+         unsigned h;
+         int i;
+
+         // the widths of the scan come from the fields, a field filled up to its width is too long
+         snprintf(format, sizeof(format), "%%%ds %%%d[^:]:%%%ds %%%ds",
+                  (int) sizeof(e->name) - 1, (int) sizeof(aux_protocol) - 1, (int) sizeof(e->ip) - 1, (int) sizeof(e->port) - 1);
+
+         ns_cache.n = 0;
+         for (line = text; (NULL != line) && ('\0' != *line); line = next)
+         {
+             next = strchr(line, '\n');
+             if (NULL != next) {
+                 *next = '\0';
+                 next++;
+             }
+
+             if (ns_cache.n == ns_cache.max)
+             {
+                 int max = (ns_cache.max > 0) ? 2 * ns_cache.max : 64;
+                 e = (struct ns_entry *) realloc(ns_cache.entries, max * sizeof(struct ns_entry));
+                 if (NULL == e) {
+                     ns_cache.loaded = 0;
+                     return -1;
+                 }
+                 ns_cache.entries = e;
+                 ns_cache.max = max;
+             }
+
+             e = &(ns_cache.entries[ns_cache.n]);
+             if (sscanf(line, format, e->name, aux_protocol, e->ip, e->port) != 4) {
+                 continue;
+             }
+             if ( (strlen(e->name) == sizeof(e->name) - 1) || (strlen(aux_protocol) == sizeof(aux_protocol) - 1) ||
+                  (strlen(e->ip)   == sizeof(e->ip)   - 1) || (strlen(e->port)     == sizeof(e->port)     - 1) ) {
+                 debug_error("[NS] [ns_cache_parse] ERROR: line too long in %s, '%.64s...' skipped\n", dns_file, line);
+                 continue;
+             }
+             ns_cache.n++;
+         }
+
+         // chains in file order, so the first line that matches wins as before
+         for (i = 0; i < NS_CACHE_BUCKETS; i++) {
+             ns_cache.head_name[i] = -1;
+             ns_cache.head_ip[i]   = -1;
+         }
+         for (i = ns_cache.n - 1; i >= 0; i--)
+         {
+             e = &(ns_cache.entries[i]);
+
+             h = ns_hash(e->name);
+             e->next_name = ns_cache.head_name[h];
+             ns_cache.head_name[h] = i;
+
+             h = ns_hash(e->ip);
+             e->next_ip = ns_cache.head_ip[h];
+             ns_cache.head_ip[h] = i;
+         }
+
+         snprintf(ns_cache.file, PATH_MAX, "%s", dns_file);
+         ns_cache.dev     = st->st_dev;
+         ns_cache.ino     = st->st_ino;
+         ns_cache.size    = st->st_size;
+         ns_cache.mtime   = st->st_mtim;
+         ns_cache.checked = time(NULL);
+         ns_cache.loaded  = 1;
+         ns_cache.pinned  = 0;
+
+         debug_info("[NS] [ns_cache_parse] %d entries from %s\n", ns_cache.n, dns_file);
+
+         return 0;
+     }
+
+     // 1 if (re)loaded, 0 if the cache is still valid, -1 on error
+     static int ns_cache_refresh ( char * dns_file, int force )
+     {
+         struct stat st;
+         char * text;
+         int ret;
+
+         if ( (1 == ns_cache.loaded) && (strcmp(ns_cache.file, dns_file) == 0) )
+         {
+             if ( (0 == force) && ((1 == ns_cache.pinned) || (time(NULL) - ns_cache.checked < utils_getenv_int("XPN_NS_CHECK", NS_CACHE_CHECK_DEFAULT))) ) {
+                 return 0;
+             }
+
+             if (stat(dns_file, &st) < 0) {
+                 return -1;
+             }
+             ns_cache.checked = time(NULL);
+
+             if ( (st.st_dev == ns_cache.dev) && (st.st_ino == ns_cache.ino) && (st.st_size == ns_cache.size) &&
+                  (st.st_mtim.tv_sec == ns_cache.mtime.tv_sec) && (st.st_mtim.tv_nsec == ns_cache.mtime.tv_nsec) ) {
+                 return 0;
+             }
+         }
+
+         ret = ns_cache_read_file(dns_file, &text, &st);
+         if (ret < 0) {
+             ns_cache.loaded = 0;
+             return -1;
+         }
+
+         ret = ns_cache_parse(dns_file, text, &st);
+         FREE_AND_NULL(text);
+
+         return (ret < 0) ? -1 : 1;
+     }
+
+     static int ns_cache_find ( char * protocol, char * param_srv_name, char * srv_ip, char * port_name )
+     {
+         char prot_srv_name[1024];
+         int i, by_name, by_ip;
+
+         snprintf(prot_srv_name, sizeof(prot_srv_name), "%s:%s", protocol, param_srv_name);
+
+         by_name = -1;
+         for (i = ns_cache.head_name[ns_hash(prot_srv_name)]; i >= 0; i = ns_cache.entries[i].next_name) {
+             if (strcmp(ns_cache.entries[i].name, prot_srv_name) == 0) {
+                 by_name = i;
+                 break;
+             }
+         }
+
+         by_ip = -1;
+         for (i = ns_cache.head_ip[ns_hash(param_srv_name)]; i >= 0; i = ns_cache.entries[i].next_ip) {
+             if (strcmp(ns_cache.entries[i].ip, param_srv_name) == 0) {
+                 by_ip = i;
+                 break;
+             }
+         }
+
+         i = by_name;
+         if ( (by_ip >= 0) && ((i < 0) || (by_ip < i)) ) {
+             i = by_ip;
+         }
+         if (i < 0) {
+             return -1;
+         }
+
+         strcpy(srv_ip,    ns_cache.entries[i].ip);
+         strcpy(port_name, ns_cache.entries[i].port);
+
+         return 0;
+     }
+
+     // publish and unpublish change the file, do not wait for the next check
+     static void ns_cache_invalidate ( char * dns_file )
+     {
+         pthread_mutex_lock(&ns_cache_mutex);
+         if (strcmp(ns_cache.file, dns_file) == 0) {
+             ns_cache.loaded = 0;
+         }
+         pthread_mutex_unlock(&ns_cache_mutex);
+     }
+
+
   /* ... Functions / Funciones ......................................... */
 
      int ns_get_hostname ( char * srv_name )
@@ -84,6 +349,7 @@
          }
 
          fclose(dns_fd);
+         ns_cache_invalidate(dns_file);
 
          debug_info("[NS] [ns_publish] >> End\n");
          return 0;
@@ -95,9 +361,9 @@
          FILE * new_dns_fd;
          char new_dns_file[PATH_MAX];
          int found = 0;
-         char aux_name[1024];
-         char aux_name_2[1024];
-         char port_name[HOST_NAME_MAX];
+         char aux_name[CONST_TEMP];
+         char * line = NULL;
+         size_t line_size = 0;
 
          debug_info("[NS] [ns_unpublish] >> Begin\n");
          int res = 0;
@@ -118,23 +384,24 @@
              return -1;
          }
 
-         char aux_srv_name[2 * HOST_NAME_MAX];
-         sprintf(aux_srv_name, "%s:%s", protocol, param_srv_name);
+         char aux_srv_name[CONST_TEMP];
+         snprintf(aux_srv_name, sizeof(aux_srv_name), "%s:%s", protocol, param_srv_name);
 
-         // copy filtering...
-         while (fscanf(dns_fd, "%1000s %1000s %100s", aux_name, aux_name_2, port_name) != EOF)
+         // copy filtering... (whole lines, the port names may be longer than any buffer here)
+         while (getline(&line, &line_size, dns_fd) != -1)
          {
-             if (strcmp(aux_name, aux_srv_name) == 0) {
+             if ( (sscanf(line, "%1023s", aux_name) == 1) && (strcmp(aux_name, aux_srv_name) == 0) ) {
                  // Not copy the line
                  found = 1;
              } else {
                  // Copy the line
-                 fprintf(new_dns_fd, "%s %s %s\n", aux_name, aux_name_2, port_name);
+                 fputs(line, new_dns_fd);
              }
          }
+         FREE_AND_NULL(line);
 
          if (0 == found) {
-             printf("Warning: Server %s not found\n", aux_name);
+             printf("Warning: Server %s not found\n", aux_srv_name);
          }
 
          // close files
@@ -146,6 +413,7 @@
          if (res != 0) {
              debug_error("Error: in rename %s\n", strerror(errno));
          }
+         ns_cache_invalidate(dns_file);
 
          debug_info("[NS] [ns_unpublish] >> End\n");
 
@@ -154,60 +422,110 @@
 
      int ns_lookup ( char * protocol, char * param_srv_name, char * srv_ip, char * port_name )
      {
-         int found = 0;
-         char aux_srv_name[1024];
-         char prot_srv_name[1024];
-         char aux_protocol[1024];
+         int ret;
          char dns_file[PATH_MAX];
-         FILE * dns_fd;
 
          debug_info("[NS] [ns_lookup] >> Begin\n");
 
-         // try to get the ns_file_name
-         char * dns_file_env = getenv("XPN_DNS");
-         if (dns_file_env == NULL)
-	 {
-             if (strcmp(protocol, "mpi_server") == 0) {
-                 strcpy(dns_file, MPI_SERVER_DNS_FILE_DEFAULT);
-             } else if (strcmp(protocol, "sck_server") == 0) {
-                 strcpy(dns_file, SCK_SERVER_DNS_FILE_DEFAULT);
-             } else if (strcmp(protocol, "mq_server") == 0) {
-                 strcpy(dns_file, MQ_SERVER_DNS_FILE_DEFAULT);
-             } else {
-                 printf("Unrecognized protocol '%s' !!\n", protocol);
+         ns_dns_file(protocol, dns_file);
+
+         pthread_mutex_lock(&ns_cache_mutex);
+
+         ret = ns_cache_refresh(dns_file, 0);
+         if (ret >= 0) {
+             ret = ns_cache_find(protocol, param_srv_name, srv_ip, port_name);
+         }
+
+         // not there: it may have just been published
+         if (ret < 0) {
+             ret = ns_cache_refresh(dns_file, 1);
+             if (ret > 0) {
+                 ret = ns_cache_find(protocol, param_srv_name, srv_ip, port_name);
+             }
+             else {
+                 ret = -1;
              }
-         } else {
-             strcpy(dns_file, dns_file_env);
          }
 
-         // try to open the ns_file_fd
-         dns_fd = fopen(dns_file, "r");
-         if (dns_fd == NULL) {
+         pthread_mutex_unlock(&ns_cache_mutex);
+
+         if (ret < 0) {
              return -1;
          }
 
-         sprintf(prot_srv_name, "%s:%s", protocol, param_srv_name);
+         debug_info("[NS] [ns_lookup] %s:%s -> %s %s\n", protocol, param_srv_name, srv_ip, port_name);
+         debug_info("[NS] [ns_lookup] >> End\n");
 
-         while (fscanf(dns_fd, "%1000s %[^:]:%100s %100s", aux_srv_name, aux_protocol, srv_ip, port_name) != EOF)
-	 {
-             debug_info("[NS] [ns_lookup] %s %s:%s %s\n\n", aux_srv_name, aux_protocol, srv_ip, port_name);
+         return 0;
+     }
 
-             if (strcmp(aux_srv_name, prot_srv_name) == 0 || strcmp(srv_ip, param_srv_name) == 0) {
-                 found = 1;
-                 break;
-             }
+#ifdef ENABLE_MPI_SERVER
+     int ns_bcast ( MPI_Comm comm, char * protocol )
+     {
+         int rank, ret, ok;
+         long long info[6];   // ret, size, dev, ino, mtime sec, mtime nsec
+         char dns_file[PATH_MAX];
+         char * text = NULL;
+         struct stat st;
+
+         debug_info("[NS] [ns_bcast] >> Begin\n");
+
+         MPI_Comm_rank(comm, &rank);
+         ns_dns_file(protocol, dns_file);
+
+         memset(info, 0, sizeof(info));
+         memset(&st, 0, sizeof(st));
+         if (0 == rank)
+         {
+             info[0] = ns_cache_read_file(dns_file, &text, &st);
+             info[1] = st.st_size;
+             info[2] = st.st_dev;
+             info[3] = st.st_ino;
+             info[4] = st.st_mtim.tv_sec;
+             info[5] = st.st_mtim.tv_nsec;
          }
 
-         fclose(dns_fd);
+         MPI_Bcast(info, 6, MPI_LONG_LONG, 0, comm);
+         if (info[0] < 0) {
+             return -1;
+         }
 
-         if (found == 0) {
+         if (0 != rank)
+         {
+             text = (char *) malloc(info[1] + 1);
+             st.st_size         = info[1];
+             st.st_dev          = info[2];
+             st.st_ino          = info[3];
+             st.st_mtim.tv_sec  = info[4];
+             st.st_mtim.tv_nsec = info[5];
+         }
+
+         // every rank needs room for the file or nobody gets it
+         ok = (NULL != text);
+         MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, comm);
+         if (0 == ok) {
+             fprintf(stderr, "[NS] [ns_bcast] ERROR: no memory for %lld bytes\n", info[1]);
+             FREE_AND_NULL(text);
              return -1;
          }
 
-         debug_info("[NS] [ns_lookup] >> End\n");
+         MPI_Bcast(text, info[1], MPI_CHAR, 0, comm);
+         text[info[1]] = '\0';
 
-         return 0;
+         pthread_mutex_lock(&ns_cache_mutex);
+         ret = ns_cache_parse(dns_file, text, &st);
+         if (ret >= 0) {
+             ns_cache.pinned = 1;
+         }
+         pthread_mutex_unlock(&ns_cache_mutex);
+
+         FREE_AND_NULL(text);
+
+         debug_info("[NS] [ns_bcast] >> End\n");
+
+         return ret;
      }
+#endif
 
 
   /* ................................................................... */
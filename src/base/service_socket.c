@@ -87,6 +87,64 @@
          return ret;
      }
 
+     int sersoc_do_send_msg_recv ( char * srv_name, int port, int req_id, char *msg, char *res_val )
+     {
+         int ret = -1 ;
+         int connection_socket ;
+         char msg_buf[MAX_PORT_NAME_LENGTH] ;
+
+         debug_info("[SERSOC] [sersoc_do_send_msg_recv] >> Begin\n");
+
+         int ipv = utils_getenv_int("XPN_SCK_IPV", DEFAULT_XPN_SCK_IPV);
+
+         // request arguments are sent as one fixed-size message, as the responses
+         memset(msg_buf, 0, MAX_PORT_NAME_LENGTH) ;
+         strncpy(msg_buf, msg, MAX_PORT_NAME_LENGTH - 1) ;
+
+         ret  = socket_client_connect(srv_name, port, &connection_socket, ipv);
+         if (ret < 0)
+         {
+             debug_error("[SERSOC] [sersoc_do_send_msg_recv] ERROR: socket connect\n");
+             return -1;
+         }
+
+         ret = socket_send(connection_socket, &req_id, sizeof(int));
+         if (ret < 0)
+         {
+             debug_error("[SERSOC] [sersoc_do_send_msg_recv] ERROR: socket send\n");
+             socket_close(connection_socket);
+             return -1;
+         }
+
+         ret = socket_send(connection_socket, msg_buf, MAX_PORT_NAME_LENGTH);
+         if (ret < 0)
+         {
+             debug_error("[SERSOC] [sersoc_do_send_msg_recv] ERROR: socket send\n");
+             socket_close(connection_socket);
+             return -1;
+         }
+
+         ret = socket_recv(connection_socket, res_val, MAX_PORT_NAME_LENGTH);
+         if (ret <= 0)
+         {
+             debug_error("[SERSOC] [sersoc_do_send_msg_recv] ERROR: socket read\n");
+             socket_close(connection_socket);
+             return -1;
+         }
+
+         ret = socket_close(connection_socket);
+         if (ret < 0)
+         {
+             debug_error("[SERSOC] [sersoc_do_send_msg_recv] ERROR: socket close\n");
+             return -1;
+         }
+
+         debug_info("[SERSOC] [sersoc_do_send_msg_recv] request to '%s' command '%d' -> response: %s\n", srv_name, req_id, res_val);
+         debug_info("[SERSOC] [sersoc_do_send_msg_recv] << End\n");
+
+         return ret;
+     }
+
      int sersoc_do_send ( char * srv_name, int port, int req_id )
      {
          int ret = -1 ;
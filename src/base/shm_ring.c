@@ -0,0 +1,480 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "base/shm_ring.h"
+
+#if defined(__linux__)
+     #include <sys/mman.h>
+     #include <sys/syscall.h>
+     #include <linux/futex.h>
+#endif
+
+
+  /* ... Const / Const ................................................. */
+
+     // polls of the peer position before sleeping in the futex
+     #define SHM_RING_SPIN        1024
+
+     // sleeping time before checking if the peer is still alive
+     #define SHM_RING_WAIT_NSEC   (100 * 1000 * 1000)
+
+
+  /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
+
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+
+     static void shm_ring_futex_wait ( uint32_t *addr, uint32_t val )
+     {
+         struct timespec timeout ;
+
+         timeout.tv_sec  = 0 ;
+         timeout.tv_nsec = SHM_RING_WAIT_NSEC ;
+
+         // the mapping is shared between processes, so no FUTEX_PRIVATE_FLAG
+         syscall(SYS_futex, addr, FUTEX_WAIT, val, &timeout, NULL, 0) ;
+     }
+
+     static void shm_ring_futex_wake ( uint32_t *addr )
+     {
+         syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0) ;
+     }
+
+     static void shm_ring_notify ( uint32_t *seq, uint32_t *waiters )
+     {
+         __atomic_add_fetch(seq, 1, __ATOMIC_SEQ_CST) ;
+         if (__atomic_load_n(waiters, __ATOMIC_SEQ_CST) > 0) {
+             shm_ring_futex_wake(seq) ;
+         }
+     }
+
+     static int shm_ring_peer_alive ( shm_ring_t *ring )
+     {
+         char  path[64] ;
+         char  buf[256] ;
+         char *state ;
+         int   fd, n ;
+
+         if (ring->peer <= 0) {
+             return 1 ;
+         }
+
+         if ((kill(ring->peer, 0) < 0) && (ESRCH == errno)) {
+             return 0 ;
+         }
+
+         // a process not reaped yet still accepts signals
+         sprintf(path, "/proc/%d/stat", (int)ring->peer) ;
+         fd = open(path, O_RDONLY) ;
+         if (fd < 0) {
+             return 1 ;
+         }
+         n = read(fd, buf, sizeof(buf) - 1) ;
+         close(fd) ;
+         if (n <= 0) {
+             return 1 ;
+         }
+         buf[n] = '\0' ;
+
+         state = strrchr(buf, ')') ;
+         if ((NULL != state) && ((state[2] == 'Z') || (state[2] == 'X'))) {
+             return 0 ;
+         }
+
+         return 1 ;
+     }
+
+     // Wait until *pos is not 'old' any more.
+     // Returns 0 if it moved, 1 if the channel was closed and -1 if the peer is gone.
+     static int shm_ring_wait ( shm_ring_t *ring, uint64_t *pos, uint64_t old, uint32_t *seq, uint32_t *waiters )
+     {
+         uint32_t s ;
+
+         for (int i = 0; i < SHM_RING_SPIN; i++)
+         {
+             if (__atomic_load_n(pos, __ATOMIC_ACQUIRE) != old) {
+                 return 0 ;
+             }
+         }
+
+         while (1)
+         {
+             // announce the waiter before reading the doorbell, the producer checks them in the opposite order
+             __atomic_add_fetch(waiters, 1, __ATOMIC_SEQ_CST) ;
+             s = __atomic_load_n(seq, __ATOMIC_SEQ_CST) ;
+             if (__atomic_load_n(pos, __ATOMIC_SEQ_CST) == old) {
+                 shm_ring_futex_wait(seq, s) ;
+             }
+             __atomic_sub_fetch(waiters, 1, __ATOMIC_SEQ_CST) ;
+
+             if (__atomic_load_n(pos, __ATOMIC_ACQUIRE) != old) {
+                 return 0 ;
+             }
+             if (__atomic_load_n(&(ring->hdr->closed), __ATOMIC_ACQUIRE)) {
+                 return 1 ;
+             }
+             if (! shm_ring_peer_alive(ring)) {
+                 ring->broken = 1 ;
+                 return -1 ;
+             }
+         }
+     }
+
+     static void shm_ring_setup ( shm_ring_t *ring, int tx, int rx )
+     {
+         ring->tx_ctl  = &(ring->hdr->ring[tx]) ;
+         ring->rx_ctl  = &(ring->hdr->ring[rx]) ;
+         ring->tx_data = (char *)(ring->hdr + 1) + (size_t)tx * ring->hdr->ring_size ;
+         ring->rx_data = (char *)(ring->hdr + 1) + (size_t)rx * ring->hdr->ring_size ;
+
+         pthread_mutex_init(&(ring->tx_mutex), NULL) ;
+         pthread_mutex_init(&(ring->rx_mutex), NULL) ;
+     }
+
+#endif
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     //
+     //  Setup
+     //
+
+     int shm_ring_create ( shm_ring_t *ring, size_t ring_size )
+     {
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+         int ret ;
+
+         memset(ring, 0, sizeof(shm_ring_t)) ;
+         ring->fd = -1 ;
+
+         if (0 == ring_size) {
+             ring_size = SHM_RING_DEFAULT_SIZE ;
+         }
+         ring->map_size = sizeof(shm_ring_hdr_t) + 2 * ring_size ;
+
+         // anonymous memory file, the peer opens it through /proc/<pid>/fd/<fd>
+         ring->fd = syscall(SYS_memfd_create, "xpn_shm", 0) ;
+         if (ring->fd < 0)
+         {
+             debug_error("[SHM_RING] [shm_ring_create] ERROR: memfd_create fails\n") ;
+             return -1 ;
+         }
+
+         ret = ftruncate(ring->fd, ring->map_size) ;
+         if (ret < 0)
+         {
+             debug_error("[SHM_RING] [shm_ring_create] ERROR: ftruncate of %ld bytes fails\n", (long)ring->map_size) ;
+             close(ring->fd) ;
+             return -1 ;
+         }
+
+         ring->hdr = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0) ;
+         if (MAP_FAILED == ring->hdr)
+         {
+             debug_error("[SHM_RING] [shm_ring_create] ERROR: mmap fails\n") ;
+             ring->hdr = NULL ;
+             close(ring->fd) ;
+             return -1 ;
+         }
+
+         // new pages are zeroed, so both rings start empty
+         ring->hdr->ring_size  = ring_size ;
+         ring->hdr->client_pid = getpid() ;
+         ring->hdr->magic      = SHM_RING_MAGIC ;
+
+         shm_ring_setup(ring, SHM_RING_TO_SERVER, SHM_RING_TO_CLIENT) ;
+
+         return 0 ;
+#else
+         memset(ring, 0, sizeof(shm_ring_t)) ;
+         ring->fd = -1 ;
+         (void) ring_size ;
+
+         return -1 ;
+#endif
+     }
+
+     int shm_ring_getname ( shm_ring_t *ring, char *name, size_t name_size )
+     {
+         int ret ;
+
+         ret = snprintf(name, name_size, "%d %d", (int)getpid(), ring->fd) ;
+         if ((ret < 0) || ((size_t)ret >= name_size)) {
+             return -1 ;
+         }
+
+         return 0 ;
+     }
+
+     int shm_ring_attach ( shm_ring_t *ring, char *name )
+     {
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+         int   ret ;
+         int   pid, fd ;
+         char  path[PATH_MAX] ;
+         struct stat st ;
+
+         memset(ring, 0, sizeof(shm_ring_t)) ;
+         ring->fd = -1 ;
+
+         ret = sscanf(name, "%d %d", &pid, &fd) ;
+         if (ret != 2)
+         {
+             debug_error("[SHM_RING] [shm_ring_attach] ERROR: wrong channel name '%s'\n", name) ;
+             return -1 ;
+         }
+
+         // only works on the same node and for the same user, otherwise the client falls back to sockets
+         sprintf(path, "/proc/%d/fd/%d", pid, fd) ;
+         fd = open(path, O_RDWR) ;
+         if (fd < 0)
+         {
+             debug_error("[SHM_RING] [shm_ring_attach] ERROR: open '%s' fails\n", path) ;
+             return -1 ;
+         }
+
+         ret = fstat(fd, &st) ;
+         if ((ret < 0) || ((size_t)st.st_size < sizeof(shm_ring_hdr_t)))
+         {
+             close(fd) ;
+             return -1 ;
+         }
+
+         ring->map_size = st.st_size ;
+         ring->hdr = mmap(NULL, ring->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) ;
+         close(fd) ;
+         if (MAP_FAILED == ring->hdr)
+         {
+             debug_error("[SHM_RING] [shm_ring_attach] ERROR: mmap fails\n") ;
+             ring->hdr = NULL ;
+             return -1 ;
+         }
+
+         if ((ring->hdr->magic != SHM_RING_MAGIC) || (ring->hdr->client_pid != pid) ||
+             (ring->map_size != sizeof(shm_ring_hdr_t) + 2 * (size_t)ring->hdr->ring_size))
+         {
+             debug_error("[SHM_RING] [shm_ring_attach] ERROR: '%s' is not a channel\n", path) ;
+             munmap(ring->hdr, ring->map_size) ;
+             ring->hdr = NULL ;
+             return -1 ;
+         }
+
+         ring->hdr->server_pid = getpid() ;
+         ring->peer = pid ;
+
+         shm_ring_setup(ring, SHM_RING_TO_CLIENT, SHM_RING_TO_SERVER) ;
+
+         return 0 ;
+#else
+         memset(ring, 0, sizeof(shm_ring_t)) ;
+         ring->fd = -1 ;
+         (void) name ;
+
+         return -1 ;
+#endif
+     }
+
+     int shm_ring_attached ( shm_ring_t *ring )
+     {
+         // the server has its own mapping now
+         if (ring->fd >= 0)
+         {
+             close(ring->fd) ;
+             ring->fd = -1 ;
+         }
+
+         ring->peer = ring->hdr->server_pid ;
+
+         return 0 ;
+     }
+
+     int shm_ring_close ( shm_ring_t *ring )
+     {
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+         if (NULL == ring->hdr) {
+             return 0 ;
+         }
+
+         // wake up anybody waiting at the other side
+         __atomic_store_n(&(ring->hdr->closed), 1, __ATOMIC_RELEASE) ;
+         for (int i = 0; i < 2; i++)
+         {
+             shm_ring_notify(&(ring->hdr->ring[i].head_seq), &(ring->hdr->ring[i].head_wait)) ;
+             shm_ring_notify(&(ring->hdr->ring[i].tail_seq), &(ring->hdr->ring[i].tail_wait)) ;
+         }
+
+         munmap(ring->hdr, ring->map_size) ;
+         ring->hdr = NULL ;
+
+         if (ring->fd >= 0)
+         {
+             close(ring->fd) ;
+             ring->fd = -1 ;
+         }
+
+         pthread_mutex_destroy(&(ring->tx_mutex)) ;
+         pthread_mutex_destroy(&(ring->rx_mutex)) ;
+#else
+         (void) ring ;
+#endif
+
+         return 0 ;
+     }
+
+
+     //
+     //  Send/Recv
+     //
+
+     int shm_ring_send ( shm_ring_t *ring, void *buffer, int size )
+     {
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+         shm_ring_ctl_t *ctl = ring->tx_ctl ;
+         uint64_t cap = ring->hdr->ring_size ;
+         uint64_t head, tail, n ;
+         int l = size ;
+         int ret ;
+
+         if (ring->broken) {
+             errno = ECONNRESET ;
+             return -1 ;
+         }
+
+         pthread_mutex_lock(&(ring->tx_mutex)) ;
+
+         head = __atomic_load_n(&(ctl->head), __ATOMIC_RELAXED) ;
+         while (l > 0)
+         {
+             tail = __atomic_load_n(&(ctl->tail), __ATOMIC_ACQUIRE) ;
+             if (head - tail == cap)
+             {
+                 // ring full: wait for the consumer
+                 ret = shm_ring_wait(ring, &(ctl->tail), tail, &(ctl->tail_seq), &(ctl->tail_wait)) ;
+                 if (ret != 0)
+                 {
+                     printf("[SHM_RING] [shm_ring_send] ERROR: peer closed the channel\n") ;
+                     pthread_mutex_unlock(&(ring->tx_mutex)) ;
+                     errno = ECONNRESET ;
+                     return -1 ;
+                 }
+                 continue ;
+             }
+
+             n = cap - (head - tail) ;
+             if (n > (uint64_t)l) {
+                 n = l ;
+             }
+             if (n > cap - head % cap) {
+                 n = cap - head % cap ;
+             }
+
+             memcpy(ring->tx_data + head % cap, buffer, n) ;
+             head = head + n ;
+             __atomic_store_n(&(ctl->head), head, __ATOMIC_SEQ_CST) ;
+             shm_ring_notify(&(ctl->head_seq), &(ctl->head_wait)) ;
+
+             l = l - n ;
+             buffer = (void *) ((char *)buffer + n) ;
+         }
+
+         pthread_mutex_unlock(&(ring->tx_mutex)) ;
+
+         return size ;
+#else
+         (void) ring ; (void) buffer ;
+         errno = ENOSYS ;
+         return (size > 0) ? -1 : 0 ;
+#endif
+     }
+
+     int shm_ring_recv ( shm_ring_t *ring, void *buffer, int size )
+     {
+#if defined(__linux__) && defined(SYS_futex) && defined(SYS_memfd_create)
+         shm_ring_ctl_t *ctl = ring->rx_ctl ;
+         uint64_t cap = ring->hdr->ring_size ;
+         uint64_t head, tail, n ;
+         int l = size ;
+         int ret ;
+
+         if (ring->broken) {
+             errno = ECONNRESET ;
+             return -1 ;
+         }
+
+         pthread_mutex_lock(&(ring->rx_mutex)) ;
+
+         tail = __atomic_load_n(&(ctl->tail), __ATOMIC_RELAXED) ;
+         while (l > 0)
+         {
+             head = __atomic_load_n(&(ctl->head), __ATOMIC_ACQUIRE) ;
+             if (head == tail)
+             {
+                 // ring empty: wait for the producer
+                 ret = shm_ring_wait(ring, &(ctl->head), head, &(ctl->head_seq), &(ctl->head_wait)) ;
+                 if (ret > 0)
+                 {
+                     printf("[SHM_RING] [shm_ring_recv] WARN: end of file receive for channel of '%d'\n", (int)ring->peer) ;
+                     pthread_mutex_unlock(&(ring->rx_mutex)) ;
+                     return 0 ;
+                 }
+                 if (ret < 0)
+                 {
+                     printf("[SHM_RING] [shm_ring_recv] ERROR: process '%d' closed the channel abruptly\n", (int)ring->peer) ;
+                     pthread_mutex_unlock(&(ring->rx_mutex)) ;
+                     errno = ECONNRESET ;
+                     return -1 ;
+                 }
+                 continue ;
+             }
+
+             n = head - tail ;
+             if (n > (uint64_t)l) {
+                 n = l ;
+             }
+             if (n > cap - tail % cap) {
+                 n = cap - tail % cap ;
+             }
+
+             memcpy(buffer, ring->rx_data + tail % cap, n) ;
+             tail = tail + n ;
+             __atomic_store_n(&(ctl->tail), tail, __ATOMIC_SEQ_CST) ;
+             shm_ring_notify(&(ctl->tail_seq), &(ctl->tail_wait)) ;
+
+             l = l - n ;
+             buffer = (void *) ((char *)buffer + n) ;
+         }
+
+         pthread_mutex_unlock(&(ring->rx_mutex)) ;
+
+         return size ;
+#else
+         (void) ring ; (void) buffer ;
+         errno = ENOSYS ;
+         return (size > 0) ? -1 : 0 ;
+#endif
+     }
+
+
+  /* ................................................................... */
+
@@ -87,6 +87,193 @@
      }
 
 
+     //
+     //  Gather send (several buffers, one sendmsg)
+     //
+
+  #if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+
+     // -1: not checked yet, 0: copy, 1: MSG_ZEROCOPY for large messages
+     static int socket_zerocopy = -1 ;
+
+     static int socket_zerocopy_enabled ( int socket )
+     {
+         int flag = 1 ;
+
+         if (socket_zerocopy < 0) {
+             socket_zerocopy = (utils_getenv_int("XPN_SCK_ZEROCOPY", 1) != 0) ;
+         }
+         if (0 == socket_zerocopy) {
+             return 0 ;
+         }
+
+         // only done for large messages, where the syscall is not noticed
+         if (setsockopt(socket, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag)) < 0)
+         {
+             debug_info("[SOCKET] [socket_zerocopy_enabled] SO_ZEROCOPY not supported, copying from now on\n") ;
+             socket_zerocopy = 0 ;
+             return 0 ;
+         }
+
+         return 1 ;
+     }
+
+     // The buffers of a zero-copy send belong to the kernel until it notifies their completion
+     // through the error queue, so wait for all of them before giving the buffers back.
+     static int socket_zerocopy_reap ( int socket, unsigned int n_sends )
+     {
+         char            control[128] ;
+         struct msghdr   msg ;
+         struct cmsghdr *cm ;
+         struct pollfd   pfd ;
+         struct sock_extended_err *serr ;
+         unsigned int    done = 0 ;
+         int             ret ;
+
+         while (done < n_sends)
+         {
+             bzero(&msg, sizeof(msg)) ;
+             msg.msg_control    = control ;
+             msg.msg_controllen = sizeof(control) ;
+
+             ret = recvmsg(socket, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) ;
+             if (ret < 0)
+             {
+                 if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno)) {
+                     printf("[SOCKET] [socket_zerocopy_reap] ERROR: recvmsg of the error queue fails\n") ;
+                     return -1 ;
+                 }
+
+                 // POLLERR is reported even if not requested
+                 pfd.fd      = socket ;
+                 pfd.events  = 0 ;
+                 pfd.revents = 0 ;
+                 if ((poll(&pfd, 1, 1000) < 0) && (EINTR != errno)) {
+                     return -1 ;
+                 }
+                 if (pfd.revents & (POLLHUP | POLLNVAL)) {
+                     return -1 ;
+                 }
+                 continue ;
+             }
+
+             for (cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm))
+             {
+                 if (! (((SOL_IP   == cm->cmsg_level) && (IP_RECVERR   == cm->cmsg_type)) ||
+                        ((SOL_IPV6 == cm->cmsg_level) && (IPV6_RECVERR == cm->cmsg_type)))) {
+                     continue ;
+                 }
+
+                 serr = (struct sock_extended_err *) CMSG_DATA(cm) ;
+                 if ((SO_EE_ORIGIN_ZEROCOPY != serr->ee_origin) || (0 != serr->ee_errno)) {
+                     continue ;
+                 }
+
+                 // [ee_info, ee_data] is the range of sends completed
+                 done = done + (serr->ee_data - serr->ee_info + 1) ;
+
+                 // the kernel had to copy anyway (i.e. loopback), stop paying for the notifications
+                 if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                     socket_zerocopy = 0 ;
+                 }
+             }
+         }
+
+         return 0 ;
+     }
+
+  #else
+
+     static int socket_zerocopy_reap ( __attribute__((__unused__)) int socket, __attribute__((__unused__)) unsigned int n_sends )
+     {
+         return 0 ;
+     }
+
+  #endif
+
+     ssize_t socket_sendv ( int socket, struct iovec * iov, int iovcnt )
+     {
+         struct iovec  v[SOCKET_IOV_MAX] ;
+         struct msghdr msg ;
+         ssize_t       total, r ;
+         int           i, first, flags ;
+         unsigned int  n_zc ;
+
+         if ((iovcnt < 0) || (iovcnt > SOCKET_IOV_MAX)) {
+             errno = EINVAL ;
+             return -1 ;
+         }
+
+         // local copy, advanced on partial sends
+         total = 0 ;
+         for (i = 0; i < iovcnt; i++)
+         {
+             v[i]  = iov[i] ;
+             total = total + iov[i].iov_len ;
+         }
+         if (0 == total) {
+             return 0 ;
+         }
+
+         flags = MSG_NOSIGNAL ;
+     #if defined(__linux__) && defined(MSG_ZEROCOPY) && defined(SO_ZEROCOPY)
+         if ((total >= SOCKET_ZEROCOPY_MIN) && socket_zerocopy_enabled(socket)) {
+             flags = flags | MSG_ZEROCOPY ;
+         }
+     #endif
+
+         first = 0 ;
+         n_zc  = 0 ;
+         while (first < iovcnt)
+         {
+             bzero(&msg, sizeof(msg)) ;
+             msg.msg_iov    = v + first ;
+             msg.msg_iovlen = iovcnt - first ;
+
+             r = sendmsg(socket, &msg, flags) ;
+             if (r < 0)
+             {
+                 if (EINTR == errno) {
+                     continue ;
+                 }
+                 // out of option memory for the notifications: copy this time
+                 if ((ENOBUFS == errno) && (flags != MSG_NOSIGNAL)) {
+                     flags = MSG_NOSIGNAL ;
+                     continue ;
+                 }
+
+                 if (EPIPE == errno)
+                      printf("[SOCKET] [socket_sendv] ERROR: client closed the connection.\n") ;
+                 else printf("[SOCKET] [socket_sendv] ERROR: socket send buffer size %ld Failed\n", (long)total) ;
+
+                 socket_zerocopy_reap(socket, n_zc) ;
+                 return -1 ;
+             }
+             if (flags != MSG_NOSIGNAL) {
+                 n_zc++ ;
+             }
+
+             // skip what has been sent
+             while ((first < iovcnt) && (r >= (ssize_t)v[first].iov_len))
+             {
+                 r = r - v[first].iov_len ;
+                 first++ ;
+             }
+             if (first < iovcnt)
+             {
+                 v[first].iov_base = (char *)v[first].iov_base + r ;
+                 v[first].iov_len  = v[first].iov_len - r ;
+             }
+         }
+
+         if ((n_zc > 0) && (socket_zerocopy_reap(socket, n_zc) < 0)) {
+             return -1 ;
+         }
+
+         return total ;
+     }
+
+
      //
      //  setopt for data or server
      //
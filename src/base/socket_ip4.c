@@ -27,6 +27,23 @@
 
   /* ... Functions / Funciones ......................................... */
 
+     // gethostbyname_r: servers may be connected from several threads at the same time
+     int socket_ip4_resolve ( char * srv_name, struct in_addr * addr )
+     {
+         struct hostent hbuf, *hp = NULL;
+         char tmp[2048];
+         int ret, herr;
+
+         ret = gethostbyname_r(srv_name, &hbuf, tmp, sizeof(tmp), &hp, &herr);
+         if ( (ret != 0) || (hp == NULL) || (hp->h_addr_list[0] == NULL) ) {
+             return -1;
+         }
+
+         memcpy(addr, hp->h_addr_list[0], sizeof(struct in_addr));
+
+         return 0;
+     }
+
      int socket_ip4_server_create ( int * out_socket, int port )
      {
          int ret = 0;
@@ -134,7 +151,6 @@
      {
          int    ret, client_fd;
          struct sockaddr_in serv_addr;
-         struct hostent * hp;
 
          // check arguments...
          if (NULL == out_socket)
@@ -151,18 +167,16 @@
              return -1;
          }
 
-         hp = gethostbyname(srv_name);
-         if (hp == NULL)
+         bzero((char * ) & serv_addr, sizeof(serv_addr));
+         if (socket_ip4_resolve(srv_name, & (serv_addr.sin_addr)) < 0)
          {
              printf("[SOCKET_IP4] [socket_read] ERROR: gethostbyname srv_name: %s\n", srv_name);
              close(client_fd);
              return -1;
          }
 
-         bzero((char * ) & serv_addr, sizeof(serv_addr));
          serv_addr.sin_family = AF_INET;
          serv_addr.sin_port   = htons(port);
-         memcpy( & (serv_addr.sin_addr), hp->h_addr, hp->h_length);
 
          ret = connect(client_fd, (struct sockaddr * ) &serv_addr, sizeof(serv_addr));
          if (ret < 0)
@@ -179,7 +193,6 @@
      int socket_ip4_client_connect_with_retries ( char * srv_name, char * port_name, int *out_socket, int n_retries )
      {
          int ret;
-         struct hostent * hp;
          struct sockaddr_in server_addr;
 	 int socket_setopt_data ( int socket ) ;
          int socket_client_connect_retries ( int sd, int n_retries, struct sockaddr *ai_addr, socklen_t ai_addrlen ) ;
@@ -200,17 +213,16 @@
          }
 
          // get address with gethostbyname
-         hp = gethostbyname(srv_name);
-         if (hp == NULL)
+         bzero((char * ) &server_addr, sizeof(server_addr));
+         if (socket_ip4_resolve(srv_name, & (server_addr.sin_addr)) < 0)
          {
              fprintf(stderr, "nfi_sck_server_init: error gethostbyname %s (%s,%s)\n", srv_name, srv_name, port_name);
+             close(*out_socket);
              return -1;
          }
 
-         bzero((char * ) &server_addr, sizeof(server_addr));
          server_addr.sin_family = AF_INET;
          server_addr.sin_port   = htons(atoi(port_name));
-         memcpy( & (server_addr.sin_addr), hp->h_addr, hp->h_length);
 
          // Connect with retries
          ret = socket_client_connect_retries(*out_socket, n_retries, (struct sockaddr *)&server_addr, sizeof(server_addr)) ;
@@ -242,7 +254,7 @@
 
      int socket_ip4_gethostbyname ( char *ip, size_t ip_size, char *srv_name )
      {
-         struct hostent *srv_entry;
+         struct in_addr addr;
 
          if (ip == NULL) {
              printf("[SOCKET_IP4] [socket_ip4_gethostbyname] ERROR: NULL ip argument\n");
@@ -250,23 +262,17 @@
          }
 
          // Resolver nombre
-         srv_entry = gethostbyname(srv_name);
-         if (srv_entry == NULL) {
+         if (socket_ip4_resolve(srv_name, &addr) < 0) {
              printf("[SOCKET_IP4] [socket_ip4_gethostbyname] ERROR: gethostbyname failed for '%s'\n", srv_name);
              return -1;
          }
 
-         // Asegurarse de que haya al menos una IP
-         if (srv_entry->h_addr_list == NULL || srv_entry->h_addr_list[0] == NULL) {
+         // Convertir a string y copiar a ip
+         if (inet_ntop(AF_INET, &addr, ip, ip_size) == NULL) {
              printf("[SOCKET_IP4] [socket_ip4_gethostbyname] ERROR: No IP address found for '%s'\n", srv_name);
              return -1;
          }
 
-         // Convertir a string y copiar a ip
-         const char *ip_local = inet_ntoa(*(struct in_addr *)srv_entry->h_addr_list[0]);
-         strncpy(ip, ip_local, ip_size - 1);
-         ip[ip_size - 1] = '\0'; // asegurarse de que esté terminada en null
-
          return 1;
      }
 
@@ -25,24 +25,198 @@
       #include "workers_pool.h"
 
 
+   /* ... Global variables / Variables globales ........................ */
+
+      // pool and deque of the current thread (if it is a thread of a pool)
+      static __thread worker_pool_t *pool_self    = NULL;
+      static __thread int            pool_self_id = -1;
+
+
    /* ... Auxiliar functions / Funciones auxiliares ......................................... */
 
+       // Injection queue
+       int worker_pool_inject_push ( worker_pool_t *w, struct st_th *th )
+       {
+          struct worker_pool_cell *cell;
+          size_t pos, seq;
+          long dif;
+
+          pos = __atomic_load_n(&(w->enq_pos), __ATOMIC_RELAXED);
+          while (1)
+          {
+             cell = &(w->operations_buffer[pos & (MAX_OPERATIONS - 1)]);
+             seq  = __atomic_load_n(&(cell->seq), __ATOMIC_ACQUIRE);
+             dif  = (long)seq - (long)pos;
+             if (dif == 0)
+             {
+                 if (__atomic_compare_exchange_n(&(w->enq_pos), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                     break;
+                 }
+             }
+             else if (dif < 0) {
+                 return -1; // full
+             }
+             else {
+                 pos = __atomic_load_n(&(w->enq_pos), __ATOMIC_RELAXED);
+             }
+          }
+
+          cell->th = *th;
+          __atomic_store_n(&(cell->seq), pos + 1, __ATOMIC_RELEASE);
+
+          return 0;
+       }
+
+       int worker_pool_inject_pop ( worker_pool_t *w, struct st_th *th )
+       {
+          struct worker_pool_cell *cell;
+          size_t pos, seq;
+          long dif;
+
+          pos = __atomic_load_n(&(w->deq_pos), __ATOMIC_RELAXED);
+          while (1)
+          {
+             cell = &(w->operations_buffer[pos & (MAX_OPERATIONS - 1)]);
+             seq  = __atomic_load_n(&(cell->seq), __ATOMIC_ACQUIRE);
+             dif  = (long)seq - (long)(pos + 1);
+             if (dif == 0)
+             {
+                 if (__atomic_compare_exchange_n(&(w->deq_pos), &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                     break;
+                 }
+             }
+             else if (dif < 0) {
+                 return -1; // empty
+             }
+             else {
+                 pos = __atomic_load_n(&(w->deq_pos), __ATOMIC_RELAXED);
+             }
+          }
+
+          *th = cell->th;
+          __atomic_store_n(&(cell->seq), pos + MAX_OPERATIONS, __ATOMIC_RELEASE);
+
+          return 0;
+       }
+
+       // Deques
+       int worker_pool_deque_push ( struct worker_pool_deque *d, struct st_th *th )
+       {
+          struct st_th *ops;
+
+          pthread_mutex_lock(&(d->m_deque));
+
+          // grow it if full
+          if (d->n_ops == d->size)
+          {
+              ops = (struct st_th *)malloc(2 * d->size * sizeof(struct st_th));
+              if (NULL == ops)
+              {
+                  pthread_mutex_unlock(&(d->m_deque));
+                  return -1;
+              }
+
+              for (int i = 0; i < d->n_ops; i++) {
+                   ops[i] = d->ops[(d->head + i) % d->size];
+              }
+
+              free(d->ops);
+              d->ops  = ops;
+              d->head = 0;
+              d->size = 2 * d->size;
+          }
+
+          d->ops[(d->head + d->n_ops) % d->size] = *th;
+          __atomic_store_n(&(d->n_ops), d->n_ops + 1, __ATOMIC_RELEASE);
+
+          pthread_mutex_unlock(&(d->m_deque));
+
+          return 0;
+       }
+
+       int worker_pool_deque_pop ( struct worker_pool_deque *d, struct st_th *th, int steal )
+       {
+          int ret = -1;
+
+          if (__atomic_load_n(&(d->n_ops), __ATOMIC_ACQUIRE) == 0) {
+              return -1;
+          }
+
+          pthread_mutex_lock(&(d->m_deque));
+          if (d->n_ops > 0)
+          {
+              if (steal)
+              {
+                  // the oldest one
+                  *th = d->ops[d->head];
+                  d->head = (d->head + 1) % d->size;
+              }
+              else
+              {
+                  // the newest one
+                  *th = d->ops[(d->head + d->n_ops - 1) % d->size];
+              }
+
+              __atomic_store_n(&(d->n_ops), d->n_ops - 1, __ATOMIC_RELEASE);
+              ret = 0;
+          }
+          pthread_mutex_unlock(&(d->m_deque));
+
+          return ret;
+       }
+
        void *worker_pool_function ( void *arg )
        {
-          int           is_true;
+          struct worker_pool_deque *d;
           worker_pool_t *w;
           struct st_th  th;
           struct st_th  *th_shadow;
+          int ret, spin;
     
           debug_info("[WORKERS_POOL] [worker_pool_function] >> Begin\n");
     
-          w = (worker_pool_t *)arg;
-          is_true = 1;
-          while (is_true)
+          d = (struct worker_pool_deque *)arg;
+          w = (worker_pool_t *)(d->pool);
+          pool_self    = w;
+          pool_self_id = d->id;
+
+          while (1)
           {
             // Dequeue operation
             debug_info("[WORKERS_POOL] [worker_pool_function] dequeue\n");
-            th = worker_pool_dequeue(w);
+            ret  = worker_pool_dequeue(w, d->id, &th);
+            spin = 0;
+
+            while (ret < 0)
+            {
+               if (__atomic_load_n(&(w->pool_end), __ATOMIC_ACQUIRE)) {
+                   goto worker_pool_function_end;
+               }
+
+               // spin a little...
+               if (spin < POOL_SPIN)
+               {
+                   spin++;
+                   if (spin % 8 == 0) {
+                       sched_yield();
+                   }
+                   ret = worker_pool_dequeue(w, d->id, &th);
+                   continue;
+               }
+
+               // ...and then sleep until there are operations
+               debug_info("[WORKERS_POOL] [worker_pool_function] wait c_poll_no_empty\n");
+               pthread_mutex_lock(&(w->m_pool));
+               __atomic_add_fetch(&(w->n_sleeping), 1, __ATOMIC_SEQ_CST);
+               while ((__atomic_load_n(&(w->n_operation), __ATOMIC_SEQ_CST) == 0) && (!__atomic_load_n(&(w->pool_end), __ATOMIC_SEQ_CST))) {
+                   pthread_cond_wait(&(w->c_poll_no_empty), &(w->m_pool));
+               }
+               __atomic_sub_fetch(&(w->n_sleeping), 1, __ATOMIC_SEQ_CST);
+               pthread_mutex_unlock(&(w->m_pool));
+
+               spin = 0;
+               ret  = worker_pool_dequeue(w, d->id, &th);
+            }
     
             // do function code...
             debug_info("[WORKERS_POOL] [worker_pool_function] execute function\n");
@@ -59,7 +233,8 @@
                 pthread_mutex_unlock(&(th_shadow->m_wait));
             }
           }
-    
+
+       worker_pool_function_end:
           debug_info("[WORKERS_POOL] [worker_pool_function] thread exit\n");
           pthread_exit(0);
     
@@ -76,26 +251,53 @@
     
          // initialize variables...
          pthread_mutex_init(&(w->m_pool),          NULL);
-         pthread_cond_init (&(w->c_pool_no_full),  NULL);
          pthread_cond_init (&(w->c_poll_no_empty), NULL);
-         pthread_mutex_init(&(w->m_pool_end),      NULL);
     
          // malloc threads...
          debug_info("[WORKERS_POOL] [worker_pool_init] Malloc threads\n");
     
-         w->POOL_MAX_THREADS = POOL_OVERSUSCRIPTION * sysconf(_SC_NPROCESSORS_ONLN);
-         w->thid = (pthread_t *)malloc(w->POOL_MAX_THREADS * sizeof(pthread_t));
-         if (NULL == w->thid)
+         w->POOL_MAX_THREADS = utils_getenv_int("XPN_POOL_THREADS", POOL_OVERSUSCRIPTION * sysconf(_SC_NPROCESSORS_ONLN));
+         if (w->POOL_MAX_THREADS < 1) {
+             w->POOL_MAX_THREADS = 1;
+         }
+         if (w->POOL_MAX_THREADS > MAX_THREADS) {
+             w->POOL_MAX_THREADS = MAX_THREADS;
+         }
+
+         w->thid   = (pthread_t *)malloc(w->POOL_MAX_THREADS * sizeof(pthread_t));
+         w->deques = (struct worker_pool_deque *)malloc(w->POOL_MAX_THREADS * sizeof(struct worker_pool_deque));
+         if ((NULL == w->thid) || (NULL == w->deques))
          {
             perror("[WORKERS_POOL] [worker_pool_init] ERROR malloc: ");
             return -1;
          }
     
          // initialize queue variables...
+         for (size_t i = 0; i < MAX_OPERATIONS; i++) {
+              w->operations_buffer[i].seq = i;
+         }
+         w->deq_pos     = 0;
+         w->enq_pos     = 0;
+         w->next_deque  = 0;
+         w->n_sleeping  = 0;
          w->n_operation = 0;
-         w->deq_pos = 0;
-         w->enq_pos = 0;
-         w->pool_end = 0;
+         w->pool_end    = 0;
+
+         for (int i = 0; i < w->POOL_MAX_THREADS; i++)
+         {
+            pthread_mutex_init(&(w->deques[i].m_deque), NULL);
+            w->deques[i].size  = POOL_BATCH;
+            w->deques[i].head  = 0;
+            w->deques[i].n_ops = 0;
+            w->deques[i].id    = i;
+            w->deques[i].pool  = (void *)w;
+            w->deques[i].ops   = (struct st_th *)malloc(POOL_BATCH * sizeof(struct st_th));
+            if (NULL == w->deques[i].ops)
+            {
+               perror("[WORKERS_POOL] [worker_pool_init] ERROR malloc: ");
+               return -1;
+            }
+         }
     
          // starting threads...
          debug_info("[WORKERS_POOL] [worker_pool_init] Starting threads\n");
@@ -103,7 +305,7 @@
          for (int i = 0; i < w->POOL_MAX_THREADS; i++)
          {
             debug_info("[WORKERS_POOL] [worker_pool_init] create_thread\n");
-            if (pthread_create(&(w->thid[i]), NULL, (void *(*)(void *))(worker_pool_function), (void *)w) !=0)
+            if (pthread_create(&(w->thid[i]), NULL, (void *(*)(void *))(worker_pool_function), (void *)&(w->deques[i])) !=0)
             {
                perror("[WORKERS_POOL] [worker_pool_init] ERROR: creating thread pool\n");
                return -1;
@@ -118,85 +320,104 @@
        void worker_pool_enqueue ( worker_pool_t *w, struct st_th *th_arg, void (*worker_function)(struct st_th) )
        {
          static int th_cont = 0;
+         int ret, i;
     
          debug_info("[WORKERS_POOL] [worker_pool_enqueue] >> Begin\n");
     
-         // wait no_full
-         debug_info("[WORKERS_POOL] [worker_pool_enqueue] lock\n");
-    
-         pthread_mutex_lock(&(w->m_pool));
-         while (w->n_operation == MAX_OPERATIONS)
-         {
-            debug_info("[WORKERS_POOL] [worker_pool_enqueue] wait c_pool_no_full\n");
-            pthread_cond_wait(&(w->c_pool_no_full), &(w->m_pool));
-         }
-    
          // prepare arguments...
          debug_info("[WORKERS_POOL] [worker_pool_enqueue] copy arguments\n");
     
-         th_arg->id       = th_cont++;
+         th_arg->id       = __atomic_fetch_add(&th_cont, 1, __ATOMIC_RELAXED);
          th_arg->function = worker_function;
          th_arg->w        = w;
          th_arg->v        = (void *)th_arg;
     
-         // enqueue
+         // enqueue: own deque for the threads of the pool, the injection queue for the rest...
          debug_info("[WORKERS_POOL] [worker_pool_enqueue] enqueue id = %d\n", th_arg->id);
+
+         ret = -1;
+         if (pool_self == w) {
+             ret = worker_pool_deque_push(&(w->deques[pool_self_id]), th_arg);
+         }
+         if (ret < 0) {
+             ret = worker_pool_inject_push(w, th_arg);
+         }
+
+         // ...and the deque of some thread if the injection queue is full
+         while (ret < 0)
+         {
+             i   = __atomic_fetch_add(&(w->next_deque), 1, __ATOMIC_RELAXED) % w->POOL_MAX_THREADS;
+             ret = worker_pool_deque_push(&(w->deques[i]), th_arg);
+             if (ret < 0) {
+                 sched_yield();
+             }
+         }
+
+         __atomic_add_fetch(&(w->n_operation), 1, __ATOMIC_SEQ_CST);
     
-         w->operations_buffer[w->enq_pos] = *th_arg;
-         w->enq_pos = (w->enq_pos + 1) % MAX_OPERATIONS;
-         w->n_operation++;
-    
-         // signal no_empty
-         debug_info("[WORKERS_POOL] [worker_pool_enqueue] signal c_poll_no_empty\n");
-         pthread_cond_signal(&(w->c_poll_no_empty));
-    
-         debug_info("[WORKERS_POOL] [worker_pool_enqueue] unlock\n");
-         pthread_mutex_unlock(&(w->m_pool));
+         // signal no_empty if some thread sleeps
+         if (__atomic_load_n(&(w->n_sleeping), __ATOMIC_SEQ_CST) > 0)
+         {
+             debug_info("[WORKERS_POOL] [worker_pool_enqueue] signal c_poll_no_empty\n");
+             pthread_mutex_lock(&(w->m_pool));
+             pthread_cond_signal(&(w->c_poll_no_empty));
+             pthread_mutex_unlock(&(w->m_pool));
+         }
     
          debug_info("[WORKERS_POOL] [worker_pool_enqueue] >> End\n");
        }
     
-       struct st_th worker_pool_dequeue ( worker_pool_t *w )
+       int worker_pool_dequeue ( worker_pool_t *w, int id, struct st_th *th )
        {
-         struct st_th th;
+         struct st_th batch[POOL_BATCH];
+         int ret, n;
     
          debug_info("[WORKERS_POOL] [worker_pool_dequeue] >> Begin\n");
     
-         debug_info("[WORKERS_POOL] [worker_pool_dequeue] lock\n");
-         pthread_mutex_lock(&(w->m_pool));
-    
-         while (w->n_operation == 0)
+         // (1) own deque
+         ret = worker_pool_deque_pop(&(w->deques[id]), th, 0);
+
+         // (2) injection queue, taking a few more if there are many waiting
+         if (ret < 0)
          {
-           debug_info("[WORKERS_POOL] [worker_pool_dequeue] wait c_poll_no_empty\n");
-           pthread_cond_wait(&(w->c_poll_no_empty), &(w->m_pool));
+             ret = worker_pool_inject_pop(w, th);
+             if (ret == 0)
+             {
+                 n = __atomic_load_n(&(w->n_operation), __ATOMIC_RELAXED) / w->POOL_MAX_THREADS;
+                 if (n > POOL_BATCH) {
+                     n = POOL_BATCH;
+                 }
+
+                 int k = 0;
+                 while ((k < n) && (worker_pool_inject_pop(w, &(batch[k])) == 0)) {
+                     k++;
+                 }
+
+                 // newest first, so that the owner takes them in order
+                 while (k > 0) {
+                     k--;
+                     if (worker_pool_deque_push(&(w->deques[id]), &(batch[k])) < 0) {
+                         while (worker_pool_inject_push(w, &(batch[k])) < 0) {
+                             sched_yield();
+                         }
+                     }
+                 }
+             }
          }
-    
-         // dequeue
-         debug_info("[WORKERS_POOL] [worker_pool_dequeue] thread id = %ld\n", pthread_self());
-         debug_info("[WORKERS_POOL] [worker_pool_dequeue] dequeue\n");
-    
-         th = w->operations_buffer[w->deq_pos];
-         w->deq_pos = (w->deq_pos + 1) % MAX_OPERATIONS;
-         w->n_operation--;
-    
-         if ( w->pool_end == 1 || th.type_op == TH_FINALIZE )
-         {
-            debug_info("[WORKERS_POOL] [worker_pool_dequeue] unlock end\n");
-            pthread_mutex_unlock(&(w->m_pool));
-    
-            debug_info("[WORKERS_POOL] [worker_pool_dequeue] exit\n");
-            pthread_exit(0);
+
+         // (3) steal from the other threads
+         for (int i = 1; (ret < 0) && (i < w->POOL_MAX_THREADS); i++) {
+              ret = worker_pool_deque_pop(&(w->deques[(id + i) % w->POOL_MAX_THREADS]), th, 1);
+         }
+
+         if (ret == 0) {
+             __atomic_sub_fetch(&(w->n_operation), 1, __ATOMIC_SEQ_CST);
+             debug_info("[WORKERS_POOL] [worker_pool_dequeue] thread id = %ld dequeue id = %d\n", pthread_self(), th->id);
          }
-    
-         debug_info("[WORKERS_POOL] [worker_pool_dequeue] signal c_pool_no_full\n");
-         pthread_cond_signal(&(w->c_pool_no_full));
-    
-         debug_info("[WORKERS_POOL] [worker_pool_dequeue] unlock\n");
-         pthread_mutex_unlock(&(w->m_pool));
     
          debug_info("[WORKERS_POOL] [worker_pool_dequeue] >> End\n");
     
-         return th;
+         return ret;
        }
     
        int worker_pool_wait ( struct st_th *th_arg )
@@ -218,29 +439,12 @@
     
        void worker_pool_destroy ( worker_pool_t *w )
        {
-         struct st_th th_arg;
-    
          debug_info("[WORKERS_POOL] [worker_pool_destroy] >> Begin\n");
     
-         // update pool_end...
-         debug_info("[WORKERS_POOL] [worker_pool_destroy]   lock m_pool_end\n");
-         pthread_mutex_lock(&(w->m_pool_end));
-         w->pool_end = 1;
-    
-         debug_info("[WORKERS_POOL] [worker_pool_destroy] unlock m_pool_end\n");
-         pthread_mutex_unlock(&(w->m_pool_end));
-    
-         // prepare arguments...
-         debug_info("[WORKERS_POOL] [worker_pool_destroy] finalize operation enqueue\n");
-         memset(&th_arg, 0, sizeof(struct st_th));
-         th_arg.type_op = TH_FINALIZE;
-    
-         for (int i = 0; i < w->POOL_MAX_THREADS; ++i) {
-              worker_pool_enqueue(w, &th_arg, NULL);
-         }
-    
-         debug_info("[WORKERS_POOL] [worker_pool_destroy]   lock m_pool\n");
+         // update pool_end (the threads end when there are no more operations)...
+         debug_info("[WORKERS_POOL] [worker_pool_destroy] lock m_pool\n");
          pthread_mutex_lock(&(w->m_pool));
+         __atomic_store_n(&(w->pool_end), 1, __ATOMIC_SEQ_CST);
     
          debug_info("[WORKERS_POOL] [worker_pool_destroy] broadcast\n");
          pthread_cond_broadcast(&(w->c_poll_no_empty));
@@ -256,14 +460,19 @@
     
          // free threads...
          debug_info("[WORKERS_POOL] [worker_pool_destroy] free\n");
+         for (int i=0; i < w->POOL_MAX_THREADS; i++)
+         {
+              free(w->deques[i].ops);
+              pthread_mutex_destroy(&(w->deques[i].m_deque));
+         }
+         free(w->deques);
+         w->deques = NULL;
          free(w->thid);
          w->thid = NULL;
     
          debug_info("[WORKERS_POOL] [worker_pool_destroy] destroy\n");
          pthread_mutex_destroy(&(w->m_pool));
-         pthread_cond_destroy (&(w->c_pool_no_full));
          pthread_cond_destroy (&(w->c_poll_no_empty));
-         pthread_mutex_destroy(&(w->m_pool_end));
     
          debug_info("[WORKERS_POOL] [worker_pool_destroy] >> End\n");
        }
@@ -15,6 +15,7 @@ import org.apache.hadoop.fs.permission.FsPermission;
 import org.apache.hadoop.fs.FSDataInputStream;
 import org.apache.hadoop.fs.FSDataOutputStream;
 import org.apache.hadoop.fs.BlockLocation;
+import org.apache.hadoop.fs.ContentSummary;
 import org.apache.hadoop.util.Progressable;
 import org.apache.hadoop.fs.PathFilter;
 
@@ -174,6 +175,23 @@ public class Expand extends FileSystem {
 					stats.st_mtime * 1000, path);
 	}
 
+	@Override
+	public ContentSummary getContentSummary (Path path) throws IOException {
+		path = removeURI(path);
+
+		// the servers add up the subtree instead of a listStatus per directory
+		long [] summary = this.xpn.jni_xpn_summarize(path.toString());
+		if (summary == null) {
+			throw new FileNotFoundException("File does not exist: " + path.toString());
+		}
+
+		// hadoop counts the directory itself too
+		long dirs = summary[2] + (isDirectory(path) ? 1 : 0);
+
+		return new ContentSummary.Builder().length(summary[0]).fileCount(summary[1])
+					.directoryCount(dirs).spaceConsumed(summary[0]).build();
+	}
+
 	public long getLength (Path path) throws IOException {
 		path = removeURI(path);
 
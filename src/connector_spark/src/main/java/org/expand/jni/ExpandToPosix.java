@@ -59,6 +59,8 @@ public class ExpandToPosix {
 
 	public native Stat jni_xpn_stat(String path);
 
+	public native long [] jni_xpn_summarize(String path);
+
 	public native int jni_xpn_unlink(String path);
 
 	public native long jni_xpn_write(int fd, ByteBuffer buf, long count);
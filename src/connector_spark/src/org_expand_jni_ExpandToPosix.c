@@ -178,6 +178,29 @@ JNIEXPORT jobject JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1fstat
 	return jstats;
 }
 
+JNIEXPORT jlongArray JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1summarize
+  (JNIEnv *env, jobject obj, jstring path){
+
+	int path_len = (*env)->GetStringLength(env, path);
+	char cpath[path_len + 1];
+	(*env)->GetStringUTFRegion(env, path, 0, path_len, cpath);
+	struct xpn_summary summary;
+	jlong values[3];
+
+	int i = xpn_summarize(cpath, &summary);
+	if (i != 0) return NULL;
+
+	// { length, files, directories }
+	values[0] = summary.bytes;
+	values[1] = summary.files;
+	values[2] = summary.dirs;
+
+	jlongArray res = (*env)->NewLongArray(env, 3);
+	(*env)->SetLongArrayRegion(env, res, 0, 3, values);
+
+	return res;
+}
+
 JNIEXPORT jint JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1get_1block_1locality
   (JNIEnv *env, jobject obj, jstring jpath, jlong joffset, jobjectArray jurl_v) {
 	
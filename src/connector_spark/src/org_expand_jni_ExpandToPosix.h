@@ -183,6 +183,14 @@ JNIEXPORT jint JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1rmdir
 JNIEXPORT jobject JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1stat
   (JNIEnv *, jobject, jstring);
 
+/*
+ * Class:     org_expand_jni_ExpandToPosix
+ * Method:    jni_xpn_summarize
+ * Signature: (Ljava/lang/String;)[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_expand_jni_ExpandToPosix_jni_1xpn_1summarize
+  (JNIEnv *, jobject, jstring);
+
 /*
  * Class:     org_expand_jni_ExpandToPosix
  * Method:    jni_xpn_unlink
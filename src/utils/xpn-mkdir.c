@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <sys/param.h>
 #include <stdio.h>
+#include <string.h>
 #include "all_system.h"
 #include "xpn.h"
 
@@ -31,11 +32,16 @@ int main(int argc, char *argv[])
 {
   char *destination;
   int fdp,fd;
+  int parents = 0;
 
   // Arguments
-  if(argc !=2){
+  if ((argc == 3) && (strcmp(argv[1], "-p") == 0)) {
+    parents = 1;
+  }
+  else if(argc !=2){
     printf("ERROR: Incorrect number of parameters.\n") ;
-    printf("Usage \"%s <path>\"\n", argv[0]);
+    printf("Usage \"%s [-p] <path>\"\n", argv[0]);
+    printf("  -p  make parent directories as needed (done by the servers)\n");
     exit(0);
   }
 
@@ -45,8 +51,10 @@ int main(int argc, char *argv[])
     exit(-1);
   }
   
-  destination=argv[1];
-  fdp = xpn_mkdir(destination,0777); 
+  destination=argv[argc-1];
+  if (parents)
+       fdp = xpn_mkdir_p(destination,0777);
+  else fdp = xpn_mkdir(destination,0777); 
 	  
   if (fdp<0)
        printf("ERROR: mkdir fdp = %d\n",fdp);
@@ -55,4 +63,3 @@ int main(int argc, char *argv[])
   xpn_destroy();
   exit(fdp);
 }
-
@@ -34,23 +34,27 @@
 
 void usage ( char * program_name )
 {
-	printf("Usage: %s [-h] <file>\n", program_name);
+	printf("Usage: %s [-h] [-r] <file>\n", program_name);
+	printf("  -r  remove the whole subtree (xpn:// paths only, done by the servers)\n");
 }
 
 int main(int argc, char *argv[])
 {
 	char *source;
 	int ret;
-	int isxpn = 0, xpnsource = 0;
+	int isxpn = 0, xpnsource = 0, recursive = 0;
 	const char *xpnprefix ;
 	int c;
 
 	xpnprefix = "xpn://";
 	opterr = 0;
-	while ((c = getopt (argc, argv, "h")) != -1)
+	while ((c = getopt (argc, argv, "hr")) != -1)
 	{
 		switch (c)
 		{
+			case 'r':
+				recursive = 1;
+				break;
 			case 'h':
 				usage(argv[0]);
 				return 0;
@@ -80,6 +84,11 @@ int main(int argc, char *argv[])
 	}
 	
 	isxpn = xpnsource;
+
+	if (recursive && !xpnsource) {
+		fprintf(stderr, "ERROR: -r is only available for xpn:// paths.\n");
+		return 1;
+	}
 #ifdef DEBUG
 	printf("xpnsource=%d, isxpn=%d\n", xpnsource, isxpn);
 	
@@ -93,10 +102,15 @@ int main(int argc, char *argv[])
 		}
 	}
 	
-	if (xpnsource)
-		xpn_unlink(source);
+	if (xpnsource && recursive)
+		ret = xpn_rmtree(source);
+	else if (xpnsource)
+		ret = xpn_unlink(source);
 	else
-		unlink(source);
+		ret = unlink(source);
+
+	if (ret < 0)
+		perror("rm");
 	
 	if (isxpn) {
 		xpn_destroy();
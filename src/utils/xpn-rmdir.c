@@ -23,6 +23,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <string.h>
 
 #include "all_system.h"
 #include "xpn.h"
@@ -32,11 +33,16 @@ int main(int argc, char *argv[])
 {
   char *destination;
   int fdp,fd;
+  int recursive = 0;
 
   // Arguments
-  if (argc != 2) {
+  if ((argc == 3) && (strcmp(argv[1], "-r") == 0)) {
+      recursive = 1;
+  }
+  else if (argc != 2) {
       printf("ERROR: incorrect number of parameters.\n");
-      printf("Usage \"%s <path>\"\n", argv[0]);
+      printf("Usage \"%s [-r] <path>\"\n", argv[0]);
+      printf("  -r  remove the directory and all its content (done by the servers)\n");
       exit(0);
   }
 
@@ -46,8 +52,10 @@ int main(int argc, char *argv[])
       exit(-1);
   }
   
-  destination = argv[1];
-  fdp = xpn_rmdir(destination); 
+  destination = argv[argc-1];
+  if (recursive)
+       fdp = xpn_rmtree(destination);
+  else fdp = xpn_rmdir(destination);
 	  
   if (fdp<0)
        printf("ERROR: rmdir fdp = %d\n",fdp);
@@ -56,4 +64,3 @@ int main(int argc, char *argv[])
   xpn_destroy();
   exit(0);
 }
-
@@ -32,6 +32,7 @@ int main(int argc, char *argv[])
 {
   char *destination;
   int fdp,fd;
+  struct xpn_summary summary;
 
   // Arguments
   if(argc !=2) {
@@ -47,14 +48,16 @@ int main(int argc, char *argv[])
   }
   
   destination=argv[1];
-  // TODO: xpn_mkdir -> xpn_statfs
-  fdp = xpn_mkdir(destination,777); 
-	  
+  // TODO: xpn_statfs for the free space, by now the usage of the subtree
+  fdp = xpn_summarize(destination, &summary);
+
   if(fdp<0){
-    printf("error in mkdir fdp = %d\n",fdp);
+    printf("error in summarize fdp = %d\n",fdp);
     exit(-1);
   } 
 
+  printf("%s: %lld bytes in %lld files and %lld directories\n", destination, summary.bytes, summary.files, summary.dirs);
+
   xpn_destroy();
   exit(0);
 }
@@ -126,12 +126,12 @@
          }
     }
 
-    // Modify the metadata
+    // Modify the metadata (files with weighted or raid5 distribution keep their blocks in the servers they were created in)
     if (mdata.data_nserv[XPN_METADATA_MAX_RECONSTURCTIONS-1] != 0){
         printf("Error: it cannot be more expansion in servers it not fit in metadata\n");
     }
 
-    for (int i = 1; i < XPN_METADATA_MAX_RECONSTURCTIONS; i++)
+    for (int i = 1; (i < XPN_METADATA_MAX_RECONSTURCTIONS) && (mdata.distribution_policy != XPN_METADATA_DISTRIBUTION_WEIGHTED) && (mdata.distribution_policy != XPN_METADATA_DISTRIBUTION_RAID5); i++)
     {
       if (mdata.data_nserv[i] == 0){
         int actual_blocks = mdata.file_size / mdata.block_size;
@@ -0,0 +1,401 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/* ... Include / Inclusion ........................................... */
+
+  #include <stdio.h>
+  #include <unistd.h>
+  #include <sys/types.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <fcntl.h>
+  #include <linux/limits.h>
+  #include <sys/stat.h>
+
+  #include "xpn/xpn_simple/xpn_metadata.h"
+  #include "base/filesystem.h"
+  #include "base/kv_index.h"
+
+
+/* ... Const / Const ................................................. */
+
+  //
+  // Converts the data directory of one xpn_server between the two metadata layouts:
+  //   * header: metadata in the first XPN_HEADER_SIZE bytes of each file (default)
+  //   * index:  metadata in <index dir>/XPN_MDATA_INDEX_FILE (xpn_server -d <index dir>)
+  //
+  // It must be run on every server node, with the server stopped and with the
+  // same data directory path used in the server_url of xpn.conf.
+  //
+  // Each file is rewritten into "<file>.xpn_migrate" and renamed over the old one.
+  // The files already done are recorded in a journal (one per direction), so an
+  // interrupted run can be executed again. The index log itself tells the layout:
+  // it exists only while the data directory is in the index layout.
+  //
+
+  #define MIGRATE_TMP_SUFFIX             ".xpn_migrate"
+  #define MIGRATE_JOURNAL_FILE_TO_INDEX  "xpn_mdata.migrate.to_index"
+  #define MIGRATE_JOURNAL_FILE_TO_HEADER "xpn_mdata.migrate.to_header"
+  #define MIGRATE_BUFFER_SIZE            (1024 * 1024)
+
+  // journal state of a file: the new version is in "<file>.xpn_migrate" or already renamed
+  #define MIGRATE_TMP_READY              1
+
+  struct migrate_arg
+  {
+      int         to_index;      // 1: header -> index, 0: index -> header
+      char       *data_dir;
+      char       *log_path;
+      char       *journal_path;
+      kv_index_t *mdata_index;
+      kv_index_t *journal;
+      char       *buffer;
+      long        n_files;
+      long        n_mdata;
+  };
+
+
+/* ... Functions / Funciones ......................................... */
+
+  int is_zero ( char *buf, ssize_t len )
+  {
+      for (ssize_t i = 0; i < len; i++) {
+          if (buf[i] != 0) {
+              return 0;
+          }
+      }
+
+      return 1;
+  }
+
+  // copy [src_offset, end of file) of fd_src into fd_dst at dst_offset, keeping holes
+  int copy_data ( int fd_src, off_t src_offset, int fd_dst, off_t dst_offset, off_t src_size, char *buffer )
+  {
+      ssize_t n;
+
+      while (src_offset < src_size)
+      {
+          if (lseek(fd_src, src_offset, SEEK_SET) < 0) {
+              return -1;
+          }
+          n = filesystem_read(fd_src, buffer, MIGRATE_BUFFER_SIZE);
+          if (n < 0) {
+              return -1;
+          }
+          if (n == 0) {
+              break;
+          }
+
+          if (!is_zero(buffer, n))
+          {
+              if (lseek(fd_dst, dst_offset, SEEK_SET) < 0) {
+                  return -1;
+              }
+              if (filesystem_write(fd_dst, buffer, n) < 0) {
+                  return -1;
+              }
+          }
+
+          src_offset += n;
+          dst_offset += n;
+      }
+
+      // the final size also covers a hole at the end
+      return ftruncate(fd_dst, dst_offset);
+  }
+
+  int migrate_file ( struct migrate_arg *m, char *path, struct stat *st )
+  {
+      struct xpn_metadata mdata;
+      char   tmp_path[PATH_MAX];
+      char   state;
+      int    fd_src, fd_dst;
+      int    has_mdata = 0;
+      int    ret;
+
+      ret = snprintf(tmp_path, PATH_MAX, "%s%s", path, MIGRATE_TMP_SUFFIX);
+      if ((ret < 0) || (ret >= PATH_MAX)) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: path too long '%s'\n", path);
+          return -1;
+      }
+
+      // done in a previous run, maybe without the final rename
+      if (kv_index_get(m->journal, path, &state) == 0)
+      {
+          if ((state == MIGRATE_TMP_READY) && (access(tmp_path, F_OK) == 0))
+          {
+              if (rename(tmp_path, path) < 0) {
+                  perror("rename: ");
+                  return -1;
+              }
+          }
+          return 0;
+      }
+
+      fd_src = open(path, O_RDONLY);
+      if (fd_src < 0) {
+          perror("open: ");
+          return -1;
+      }
+
+      fd_dst = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, st->st_mode & 07777);
+      if (fd_dst < 0) {
+          perror("open: ");
+          close(fd_src);
+          return -1;
+      }
+
+      if (m->to_index)
+      {
+          // header -> index: metadata from the header (master node only), data moved back XPN_HEADER_SIZE bytes
+          memset(&mdata, 0, sizeof(struct xpn_metadata));
+          if ( (filesystem_read(fd_src, &mdata, sizeof(struct xpn_metadata)) == sizeof(struct xpn_metadata)) && XPN_CHECK_MAGIC_NUMBER(&mdata) )
+          {
+              has_mdata = 1;
+              if (kv_index_put(m->mdata_index, path, &mdata) < 0) {
+                  perror("kv_index_put: ");
+                  ret = -1;
+                  goto cleanup_migrate_file;
+              }
+          }
+
+          ret = copy_data(fd_src, XPN_HEADER_SIZE, fd_dst, 0, st->st_size, m->buffer);
+      }
+      else
+      {
+          // index -> header: metadata written at the beginning, data moved forward XPN_HEADER_SIZE bytes
+          if (kv_index_get(m->mdata_index, path, &mdata) == 0)
+          {
+              has_mdata = 1;
+              if (filesystem_write(fd_dst, &mdata, sizeof(struct xpn_metadata)) < 0) {
+                  perror("write: ");
+                  ret = -1;
+                  goto cleanup_migrate_file;
+              }
+          }
+
+          if (st->st_size > 0)
+               ret = copy_data(fd_src, 0, fd_dst, XPN_HEADER_SIZE, st->st_size, m->buffer);
+          else ret = 0;
+      }
+
+      if (ret < 0) {
+          perror("copy: ");
+          goto cleanup_migrate_file;
+      }
+
+      // the new file must be durable before it is recorded in the journal
+      ret = fsync(fd_dst);
+      if (ret < 0) {
+          perror("fsync: ");
+          goto cleanup_migrate_file;
+      }
+
+      state = MIGRATE_TMP_READY;
+      ret = kv_index_put(m->journal, path, &state);
+      if (ret < 0) {
+          perror("kv_index_put: ");
+          goto cleanup_migrate_file;
+      }
+
+      ret = rename(tmp_path, path);
+      if (ret < 0) {
+          perror("rename: ");
+          goto cleanup_migrate_file;
+      }
+
+      m->n_files++;
+      m->n_mdata += has_mdata;
+
+cleanup_migrate_file:
+      close(fd_src);
+      close(fd_dst);
+      if (ret < 0) {
+          unlink(tmp_path);
+      }
+
+      return ret;
+  }
+
+  int migrate_entry ( char *rel_path, int is_dir, __attribute__((__unused__)) int depth, void *arg )
+  {
+      struct migrate_arg *m = (struct migrate_arg *)arg;
+      char   path[PATH_MAX];
+      struct stat st;
+      size_t len;
+      int    ret;
+
+      if (is_dir) {
+          return 0;
+      }
+
+      ret = snprintf(path, PATH_MAX, "%s/%s", m->data_dir, rel_path);
+      if ((ret < 0) || (ret >= PATH_MAX)) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: path too long '%s/%s'\n", m->data_dir, rel_path);
+          return -1;
+      }
+
+      // skip our own files: temporary copies, the index and the journal
+      len = strlen(path);
+      if ( (len > strlen(MIGRATE_TMP_SUFFIX)) && (strcmp(path + len - strlen(MIGRATE_TMP_SUFFIX), MIGRATE_TMP_SUFFIX) == 0) ) {
+          return 0;
+      }
+      if ( (strncmp(path, m->log_path, PATH_MAX) == 0) || (strncmp(path, m->journal_path, PATH_MAX) == 0) ) {
+          return 0;
+      }
+
+      // only regular files have metadata
+      if ( (lstat(path, &st) < 0) || (!S_ISREG(st.st_mode)) ) {
+          return 0;
+      }
+
+      return migrate_file(m, path, &st);
+  }
+
+  int main ( int argc, char *argv[] )
+  {
+      struct migrate_arg m;
+      char   log_path[PATH_MAX];
+      char   journal_path[PATH_MAX];
+      char   other_journal_path[PATH_MAX];
+      char  *data_dir;
+      char  *index_dir;
+      size_t len;
+      int    ret;
+
+      //
+      // Check arguments...
+      //
+      memset(&m, 0, sizeof(struct migrate_arg));
+      m.to_index = 1;
+      if ((argc == 4) && (strcmp(argv[1], "-r") == 0)) {
+          m.to_index = 0;
+          argv++;
+          argc--;
+      }
+
+      if (argc != 3)
+      {
+          printf("Usage:\n");
+          printf(" ./%s [-r] <server data directory> <metadata index directory>\n", argv[0]);
+          printf("   move the metadata of each file from its header into the index (xpn_server -d)\n");
+          printf("   -r: move it back from the index into the header of each file\n");
+          printf("\n");
+          return -1;
+      }
+
+      data_dir  = argv[1];
+      index_dir = argv[2];
+
+      len = strlen(data_dir);
+      while ((len > 1) && (data_dir[len - 1] == '/')) {
+          data_dir[--len] = '\0';
+      }
+
+      if ( (snprintf(log_path,           PATH_MAX, "%s/%s", index_dir, XPN_MDATA_INDEX_FILE) >= PATH_MAX) ||
+           (snprintf(journal_path,       PATH_MAX, "%s/%s", index_dir, m.to_index ? MIGRATE_JOURNAL_FILE_TO_INDEX  : MIGRATE_JOURNAL_FILE_TO_HEADER) >= PATH_MAX) ||
+           (snprintf(other_journal_path, PATH_MAX, "%s/%s", index_dir, m.to_index ? MIGRATE_JOURNAL_FILE_TO_HEADER : MIGRATE_JOURNAL_FILE_TO_INDEX)  >= PATH_MAX) ) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: index directory path too long\n");
+          return -1;
+      }
+
+      //
+      // Check the current layout (files must never be shifted twice)
+      //
+      if (access(other_journal_path, F_OK) == 0) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: a migration in the other direction was interrupted, run it again first\n");
+          return -1;
+      }
+      if ( (m.to_index) && (access(log_path, F_OK) == 0) && (access(journal_path, F_OK) != 0) ) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: '%s' already uses the metadata index\n", data_dir);
+          return -1;
+      }
+      if ( (!m.to_index) && (access(log_path, F_OK) != 0) ) {
+          printf("[XPN_MDATA_MIGRATE] ERROR: there is no metadata index in '%s'\n", index_dir);
+          return -1;
+      }
+
+      if (filesystem_mkdir_p(index_dir, S_IRWXU) < 0) {
+          perror("mkdir: ");
+          return -1;
+      }
+
+      //
+      // Open the index and the journal of the migration
+      //
+      m.data_dir     = data_dir;
+      m.log_path     = log_path;
+      m.journal_path = journal_path;
+
+      m.mdata_index = kv_index_open(log_path, sizeof(struct xpn_metadata), 1);
+      if (NULL == m.mdata_index) {
+          perror("kv_index_open: ");
+          return -1;
+      }
+
+      m.journal = kv_index_open(journal_path, sizeof(char), 1);
+      if (NULL == m.journal) {
+          perror("kv_index_open: ");
+          kv_index_close(m.mdata_index);
+          return -1;
+      }
+
+      m.buffer = (char *)malloc(MIGRATE_BUFFER_SIZE);
+      if (NULL == m.buffer) {
+          perror("malloc: ");
+          kv_index_close(m.journal);
+          kv_index_close(m.mdata_index);
+          return -1;
+      }
+
+      //
+      // Migrate all the files
+      //
+      printf("Migrating '%s' %s '%s'...\n", data_dir, (m.to_index ? "to the index in" : "from the index in"), index_dir);
+
+      ret = filesystem_walk(data_dir, migrate_entry, &m);
+
+      printf("%ld files rewritten, %ld with metadata\n", m.n_files, m.n_mdata);
+
+      free(m.buffer);
+      kv_index_close(m.journal);
+
+      if (ret < 0)
+      {
+          kv_index_close(m.mdata_index);
+          printf("[XPN_MDATA_MIGRATE] ERROR: migration not completed, run it again to resume\n");
+          return -1;
+      }
+
+      // once completed, the journal is no longer needed and the index is dropped when going back to headers
+      unlink(journal_path);
+      kv_index_close(m.mdata_index);
+      if (!m.to_index) {
+          unlink(log_path);
+      }
+
+      return 0;
+  }
+
+
+/* ................................................................... */
+
@@ -129,6 +129,14 @@
     new_mdata = mdata;
     MPI_Bcast(&st, sizeof(st), MPI_CHAR, master_node_old, MPI_COMM_WORLD);
     debug_info("after bcast\n");
+
+    // The blocks of the removed servers cannot be placed in a weighted or raid5 distribution
+    if ((mdata.distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED) || (mdata.distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5)){
+      if (rank == 0){
+        printf("Error: %s has a weighted or raid5 distribution, it cannot be shrunk\n", entry);
+      }
+      MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
     
     if (rank == 0){
       #ifdef DEBUG
@@ -23,38 +23,89 @@
 #include <string.h>
 #include "xpn.h"
 
-void print_tree(const char *path, int depth) {
-    DIR *dir;
-    struct dirent *entry;
+struct tree_entry {
+    char *path;
+    int   depth;
+};
 
-    if (!(dir = xpn_opendir(path)))
-        return;
+struct tree {
+    struct tree_entry *entries;
+    size_t n;
+    size_t max;
+};
+
+// Entries come from every server in any order: keep them and sort later
+int add_entry(const char *path, __attribute__((__unused__)) int is_dir, int depth, void *arg) {
+    struct tree *t = (struct tree *) arg;
+
+    if (t->n == t->max) {
+        size_t new_max = (t->max == 0) ? 1024 : 2 * t->max;
+        struct tree_entry *aux = realloc(t->entries, new_max * sizeof(struct tree_entry));
+        if (aux == NULL)
+            return -1;
+        t->entries = aux;
+        t->max = new_max;
+    }
+
+    t->entries[t->n].path = strdup(path);
+    if (t->entries[t->n].path == NULL)
+        return -1;
+    t->entries[t->n].depth = depth;
+    t->n++;
+
+    return 0;
+}
+
+// Compare paths with '/' lower than any other char, so children follow their parent
+int cmp_entry(const void *a, const void *b) {
+    const unsigned char *p1 = (const unsigned char *) ((const struct tree_entry *) a)->path;
+    const unsigned char *p2 = (const unsigned char *) ((const struct tree_entry *) b)->path;
+
+    while ((*p1 != '\0') && (*p1 == *p2)) {
+        p1++;
+        p2++;
+    }
 
-    while ((entry = xpn_readdir(dir)) != NULL) {
-        // Ignore "." and ".."
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-            continue;
+    int c1 = (*p1 == '/') ? 1 : (*p1 == '\0') ? 0 : *p1 + 1;
+    int c2 = (*p2 == '/') ? 1 : (*p2 == '\0') ? 0 : *p2 + 1;
+    return c1 - c2;
+}
+
+void print_tree(const char *path) {
+    struct tree t = { NULL, 0, 0 };
+    const char *name;
+
+    if (xpn_walk(path, add_entry, &t) < 0)
+        perror("xpn_walk");
 
+    qsort(t.entries, t.n, sizeof(struct tree_entry), cmp_entry);
+
+    for (size_t i = 0; i < t.n; i++) {
         // Print spaces according to the depth
-        for (int i = 0; i < depth; i++) {
+        for (int j = 0; j < t.entries[i].depth; j++) {
             printf(" |   ");
         }
 
         // Print the file/directory name
-        printf(" |-- %s\n", entry->d_name);
+        name = strrchr(t.entries[i].path, '/');
+        printf(" |-- %s\n", (name != NULL) ? name + 1 : t.entries[i].path);
+
+        free(t.entries[i].path);
+    }
 
+    free(t.entries);
+}
 
-        // Construct the new path
-        char new_path[1024];
-        snprintf(new_path, sizeof(new_path), "%s/%s", path, entry->d_name);
+void print_summary(const char *path) {
+    struct xpn_summary summary;
 
-        // Check if it's a directory and make a recursive call
-        struct stat info;
-        if (xpn_stat(new_path, &info) == 0 && S_ISDIR(info.st_mode)) {
-            print_tree(new_path, depth + 1);
-        }
+    // The servers add up the subtree, nothing is listed here
+    if (xpn_summarize(path, &summary) < 0) {
+        perror("xpn_summarize");
+        return;
     }
-    xpn_closedir(dir);
+
+    printf("\n%lld directories, %lld files, %lld bytes\n", summary.dirs, summary.files, summary.bytes);
 }
 
 int main(int argc, char *argv[])
@@ -72,7 +123,8 @@ int main(int argc, char *argv[])
     }
 
     printf("Path:\n%s\n", argv[1]);
-    print_tree(argv[1], 0);
+    print_tree(argv[1]);
+    print_summary(argv[1]);
 
     xpn_destroy();
 
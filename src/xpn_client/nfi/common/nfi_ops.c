@@ -23,6 +23,7 @@
 /* ... Include / Inclusion ........................................... */
 
    #include "nfi/nfi_ops.h"
+   #include "base/time_misc.h"
 
 
 /* ... Functions / Funciones ......................................... */
@@ -31,29 +32,46 @@
 void nfi_do_operation (struct st_th th_arg) 
 {
   ssize_t aux, ret;
+  struct timeval t1, t2, td;
 
   debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_do_operation] >> Begin\n", pthread_self());
 
-  struct nfi_worker * wrk = (struct nfi_worker * )(th_arg.params);
+  struct nfi_request * req = (struct nfi_request * )(th_arg.params);
+  struct nfi_worker  * wrk = req->wrk;
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_do_operation] op: %d\n", pthread_self(), wrk->arg.operation);
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_do_operation] op: %d\n", pthread_self(), req->arg.operation);
+
+  // requests to the same server may be in flight at once: each one takes a free
+  // connection from the server pool, or the only connection when there is no pool
+  if (wrk->server->ops->nfi_stream_get != NULL) {
+    wrk->server->ops->nfi_stream_get(wrk->server);
+  }
+  else {
+    pthread_mutex_lock(&(wrk->m_ops));
+  }
+
+  TIME_MISC_Timer(&t1);
 
   ret = -1;
-  switch (wrk->arg.operation) 
+  switch (req->arg.operation) 
   {
     //File API
     case op_open:
-      ret = wrk->server->ops->nfi_open(wrk->server, wrk->arg.url, wrk->arg.flags, wrk->arg.mode, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_open(wrk->server, req->arg.url, req->arg.flags, req->arg.mode, req->arg.fh);
       break;
     case op_create:
-      ret = wrk->server->ops->nfi_create(wrk->server, wrk->arg.url, wrk->arg.mode, wrk->arg.attr, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_create(wrk->server, req->arg.url, req->arg.mode, req->arg.attr, req->arg.fh);
       break;
     case op_read:
+      if ((req->arg.n_io > 1) && (wrk->server->ops->nfi_readv != NULL)) {
+        ret = wrk->server->ops->nfi_readv(wrk->server, req->arg.fh, req->arg.io, req->arg.n_io, XPN_HEADER_SIZE);
+        break;
+      }
       ret = 0;
-      for (int i = 0; i < wrk->arg.n_io; i++) 
+      for (int i = 0; i < req->arg.n_io; i++) 
       {
-        //TODO: wrk->arg.io[i].res = aux = wrk->server->ops->nfi_read(wrk->server,
-        aux = wrk->server->ops->nfi_read(wrk->server, wrk->arg.fh, wrk->arg.io[i].buffer, wrk->arg.io[i].offset+XPN_HEADER_SIZE, wrk->arg.io[i].size);
+        //TODO: req->arg.io[i].res = aux = wrk->server->ops->nfi_read(wrk->server,
+        aux = wrk->server->ops->nfi_read(wrk->server, req->arg.fh, req->arg.io[i].buffer, req->arg.io[i].offset+XPN_HEADER_SIZE, req->arg.io[i].size);
         if (aux < 0) 
         {
           ret = aux;
@@ -63,17 +81,21 @@ void nfi_do_operation (struct st_th th_arg)
         ret = ret + aux;
 
         // Remove???
-        /*if(wrk->arg.io[i].size > (unsigned int)aux){
+        /*if(req->arg.io[i].size > (unsigned int)aux){
           break;
         }*/
       }
       break;
     case op_write:
+      if ((req->arg.n_io > 1) && (wrk->server->ops->nfi_writev != NULL)) {
+        ret = wrk->server->ops->nfi_writev(wrk->server, req->arg.fh, req->arg.io, req->arg.n_io, XPN_HEADER_SIZE);
+        break;
+      }
       ret = 0;
-      for (int i = 0; i < wrk->arg.n_io; i++) 
+      for (int i = 0; i < req->arg.n_io; i++) 
       {
-        //TODO: wrk->arg.io[i].res = aux = wrk->server->ops->nfi_write(wrk->server,
-        aux = wrk->server->ops->nfi_write(wrk->server, wrk->arg.fh, wrk->arg.io[i].buffer, wrk->arg.io[i].offset+XPN_HEADER_SIZE, wrk->arg.io[i].size);
+        //TODO: req->arg.io[i].res = aux = wrk->server->ops->nfi_write(wrk->server,
+        aux = wrk->server->ops->nfi_write(wrk->server, req->arg.fh, req->arg.io[i].buffer, req->arg.io[i].offset+XPN_HEADER_SIZE, req->arg.io[i].size);
         if (aux < 0) 
         {
           ret = aux;
@@ -83,355 +105,586 @@ void nfi_do_operation (struct st_th th_arg)
       }
       break;
     case op_close:
-      ret = wrk->server->ops->nfi_close(wrk->server, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_close(wrk->server, req->arg.fh);
       break;
     case op_remove:
-      ret = wrk->server->ops->nfi_remove(wrk->server, wrk->arg.url);
+      ret = wrk->server->ops->nfi_remove(wrk->server, req->arg.url);
       break;
     case op_rename:
-      ret = wrk->server->ops->nfi_rename(wrk->server, wrk->arg.url, wrk->arg.newurl);
+      ret = wrk->server->ops->nfi_rename(wrk->server, req->arg.url, req->arg.newurl);
       break;
     case op_getattr:
-      ret = wrk->server->ops->nfi_getattr(wrk->server, wrk->arg.fh, wrk->arg.attr);
+      ret = wrk->server->ops->nfi_getattr(wrk->server, req->arg.fh, req->arg.attr);
       break;
     case op_setattr:
-      ret = wrk->server->ops->nfi_setattr(wrk->server, wrk->arg.fh, wrk->arg.attr);
+      ret = wrk->server->ops->nfi_setattr(wrk->server, req->arg.fh, req->arg.attr);
       break;
 
     //Directory API
     case op_mkdir:
-      ret = wrk->server->ops->nfi_mkdir(wrk->server, wrk->arg.url, wrk->arg.mode, wrk->arg.attr, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_mkdir(wrk->server, req->arg.url, req->arg.mode, req->arg.attr, req->arg.fh);
       break;
     case op_opendir:
-      ret = wrk->server->ops->nfi_opendir(wrk->server, wrk->arg.url, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_opendir(wrk->server, req->arg.url, req->arg.fh);
       break;
     case op_readdir:
-      ret = wrk->server->ops->nfi_readdir(wrk->server, wrk->arg.fh, wrk->arg.entry);
+      ret = wrk->server->ops->nfi_readdir(wrk->server, req->arg.fh, req->arg.entry);
       break;
     case op_closedir:
-      ret = wrk->server->ops->nfi_closedir(wrk->server, wrk->arg.fh);
+      ret = wrk->server->ops->nfi_closedir(wrk->server, req->arg.fh);
       break;
     case op_rmdir:
-      ret = wrk->server->ops->nfi_rmdir(wrk->server, wrk->arg.url);
+      ret = wrk->server->ops->nfi_rmdir(wrk->server, req->arg.url);
+      break;
+    case op_mkdir_p:
+      if (wrk->server->ops->nfi_mkdir_p == NULL) {
+        errno = ENOTSUP;
+        break;
+      }
+      ret = wrk->server->ops->nfi_mkdir_p(wrk->server, req->arg.url, req->arg.mode);
+      break;
+    case op_rmtree:
+      if (wrk->server->ops->nfi_rmtree == NULL) {
+        errno = ENOTSUP;
+        break;
+      }
+      ret = wrk->server->ops->nfi_rmtree(wrk->server, req->arg.url);
+      break;
+    case op_walk:
+      if (wrk->server->ops->nfi_walk == NULL) {
+        errno = ENOTSUP;
+        break;
+      }
+      ret = wrk->server->ops->nfi_walk(wrk->server, req->arg.url, req->arg.serv_id, req->arg.n_serv, req->arg.root_master, req->arg.walk_fn, req->arg.walk_arg);
+      break;
+    case op_summarize:
+      if (wrk->server->ops->nfi_summarize == NULL) {
+        errno = ENOTSUP;
+        break;
+      }
+      ret = wrk->server->ops->nfi_summarize(wrk->server, req->arg.url, req->arg.serv_id, req->arg.n_serv, req->arg.root_master, req->arg.summary);
       break;
 
     //FS API
     case op_statfs:
-      ret = wrk->server->ops->nfi_statfs(wrk->server, wrk->arg.inf);
+      ret = wrk->server->ops->nfi_statfs(wrk->server, req->arg.inf);
       break;
 
     //Metadata
     case op_read_mdata:
-      ret = wrk->server->ops->nfi_read_mdata(wrk->server, wrk->arg.url, wrk->arg.mdata);
+      ret = wrk->server->ops->nfi_read_mdata(wrk->server, req->arg.url, req->arg.mdata);
       break;
     case op_write_mdata:
-      ret = wrk->server->ops->nfi_write_mdata(wrk->server, wrk->arg.url, wrk->arg.mdata, wrk->arg.mdata_only_file_size);
+      ret = wrk->server->ops->nfi_write_mdata(wrk->server, req->arg.url, req->arg.mdata, req->arg.mdata_only_file_size);
       break;
   }
 
-  wrk->arg.result = ret;
-  wrk->arg.worker_errno = errno;
+  req->arg.result = ret;
+  req->arg.worker_errno = errno;
+
+  // read latency, used to choose among replicas
+  if ((req->arg.operation == op_read) && (ret >= 0))
+  {
+    TIME_MISC_Timer(&t2);
+    TIME_MISC_DiffTime(&t1, &t2, &td);
+    nfi_server_lat_add(wrk->server, TIME_MISC_TimevaltoMicroLong(&td));
+  }
+
+  if (wrk->server->ops->nfi_stream_put != NULL) {
+    wrk->server->ops->nfi_stream_put(wrk->server);
+  }
+  else {
+    pthread_mutex_unlock(&(wrk->m_ops));
+  }
+
+  __atomic_sub_fetch(&(wrk->server->n_inflight), 1, __ATOMIC_RELAXED);
+
+  if (req->done != NULL) {
+    req->done(req);
+  }
 
   debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_do_operation] >> End\n", pthread_self());
 }
 
 
 // File API
-int nfi_worker_do_open (struct nfi_worker * wrk, char * url, int flags, mode_t mode, struct nfi_fhandle * fh) 
+int nfi_request_do_open (struct nfi_request * req, char * url, int flags, mode_t mode, struct nfi_fhandle * fh)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_open] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_open] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_open;
-  wrk->arg.fh = fh;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.flags = flags;
-  wrk->arg.mode = mode;
+  req->arg.operation = op_open;
+  req->arg.fh = fh;
+  strcpy(req->arg.url, url);
+  req->arg.flags = flags;
+  req->arg.mode = mode;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_open] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_open] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_create (struct nfi_worker * wrk, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh) 
+int nfi_request_do_create (struct nfi_request * req, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_create] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_create] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_create;
-  wrk->arg.fh = fh;
-  wrk->arg.attr = attr;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.mode = mode;
+  req->arg.operation = op_create;
+  req->arg.fh = fh;
+  req->arg.attr = attr;
+  strcpy(req->arg.url, url);
+  req->arg.mode = mode;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_create] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_create] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_read (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n) 
+int nfi_request_do_read (struct nfi_request * req, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_read] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_read] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_read;
-  wrk->arg.fh = fh;
-  wrk->arg.io = io;
-  wrk->arg.n_io = n;
+  req->arg.operation = op_read;
+  req->arg.fh = fh;
+  req->arg.io = io;
+  req->arg.n_io = n;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_read] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_read] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_write (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n) 
+int nfi_request_do_write (struct nfi_request * req, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_write] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_write] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_write;
-  wrk->arg.fh = fh;
-  wrk->arg.io = io;
-  wrk->arg.n_io = n;
+  req->arg.operation = op_write;
+  req->arg.fh = fh;
+  req->arg.io = io;
+  req->arg.n_io = n;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_write] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_write] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_close (struct nfi_worker * wrk, struct nfi_fhandle * fh) 
+int nfi_request_do_close (struct nfi_request * req, struct nfi_fhandle * fh)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_close] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_close] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_close;
-  wrk->arg.fh = fh;
+  req->arg.operation = op_close;
+  req->arg.fh = fh;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_close] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_close] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_remove (struct nfi_worker * wrk, char * url) 
+int nfi_request_do_remove (struct nfi_request * req, char * url)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_remove] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_remove] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_remove;
-  strcpy(wrk->arg.url, url);
+  req->arg.operation = op_remove;
+  strcpy(req->arg.url, url);
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_remove] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_remove] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_rename (struct nfi_worker * wrk, char * old_url, char * new_url) 
+int nfi_request_do_rename (struct nfi_request * req, char * old_url, char * new_url)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_rename] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rename] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_rename;
-  strcpy(wrk->arg.url, old_url);
-  strcpy(wrk->arg.newurl, new_url);
+  req->arg.operation = op_rename;
+  strcpy(req->arg.url, old_url);
+  strcpy(req->arg.newurl, new_url);
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_rename] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rename] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_getattr (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_attr * attr) 
+int nfi_request_do_getattr (struct nfi_request * req, struct nfi_fhandle * fh, struct nfi_attr * attr)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_getattr] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_getattr] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_getattr;
-  wrk->arg.fh = fh;
-  wrk->arg.attr = attr;
+  req->arg.operation = op_getattr;
+  req->arg.fh = fh;
+  req->arg.attr = attr;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_getattr] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_getattr] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_setattr (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_attr * attr) 
+int nfi_request_do_setattr (struct nfi_request * req, struct nfi_fhandle * fh, struct nfi_attr * attr)
 {
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_setattr] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_setattr] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_setattr;
-  wrk->arg.fh = fh;
-  wrk->arg.attr = attr;
+  req->arg.operation = op_setattr;
+  req->arg.fh = fh;
+  req->arg.attr = attr;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_setattr] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_setattr] >> End\n", pthread_self());
 
   return 0;
 }
 
 
 //Directory API
-int nfi_worker_do_mkdir (struct nfi_worker * wrk, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh) 
+int nfi_request_do_mkdir (struct nfi_request * req, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh)
+{
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_mkdir] >> Begin\n", pthread_self());
+
+  // Pack request
+  req->arg.fh = fh;
+  req->arg.attr = attr;
+  req->arg.operation = op_mkdir;
+  strcpy(req->arg.url, url);
+  req->arg.mode = mode;
+
+  // Do operation
+  nfi_request_launch(req);
+
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_mkdir] >> End\n", pthread_self());
+
+  return 0;
+}
+
+int nfi_request_do_opendir (struct nfi_request * req, char * url, struct nfi_fhandle * fh)
+{
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_opendir] >> Begin\n", pthread_self());
+
+  // Pack request
+  req->arg.operation = op_opendir;
+  strcpy(req->arg.url, url);
+  req->arg.fh = fh;
+
+  // Do operation
+  nfi_request_launch(req);
+
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_opendir] >> End\n", pthread_self());
+
+  return 0;
+}
+
+int nfi_request_do_readdir (struct nfi_request * req, struct nfi_fhandle * fh, struct dirent * entry)
+{
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_readdir] >> Begin\n", pthread_self());
+
+  // Pack request
+  req->arg.operation = op_readdir;
+  req->arg.entry = entry;
+  req->arg.fh = fh;
+
+  // Do operation
+  nfi_request_launch(req);
+
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_readdir] >> End\n", pthread_self());
+
+  return 0;
+}
+
+int nfi_request_do_closedir (struct nfi_request * req, struct nfi_fhandle * fh)
+{
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_closedir] >> Begin\n", pthread_self());
+
+  // Pack request
+  req->arg.fh = fh;
+  req->arg.operation = op_closedir;
+
+  // Do operation
+  nfi_request_launch(req);
+
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_closedir] >> End\n", pthread_self());
+
+  return 0;
+}
+
+int nfi_request_do_rmdir (struct nfi_request * req, char * url)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_mkdir] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rmdir] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.fh = fh;
-  wrk->arg.attr = attr;
-  wrk->arg.operation = op_mkdir;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.mode = mode;
+  req->arg.operation = op_rmdir;
+  strcpy(req->arg.url, url);
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_mkdir] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rmdir] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_opendir (struct nfi_worker * wrk, char * url, struct nfi_fhandle * fh) 
+int nfi_request_do_mkdir_p (struct nfi_request * req, char * url, mode_t mode)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_opendir] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_mkdir_p] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_opendir;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.fh = fh;
+  req->arg.operation = op_mkdir_p;
+  strcpy(req->arg.url, url);
+  req->arg.mode = mode;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_opendir] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_mkdir_p] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_readdir (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct dirent * entry) 
+int nfi_request_do_rmtree (struct nfi_request * req, char * url)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_readdir] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rmtree] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_readdir;
-  wrk->arg.entry = entry;
-  wrk->arg.fh = fh;
+  req->arg.operation = op_rmtree;
+  strcpy(req->arg.url, url);
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_readdir] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_rmtree] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_closedir (struct nfi_worker * wrk, struct nfi_fhandle * fh) 
+int nfi_request_do_walk (struct nfi_request * req, char * url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void * walk_arg)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_closedir] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_walk] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.fh = fh;
-  wrk->arg.operation = op_closedir;
+  req->arg.operation = op_walk;
+  strcpy(req->arg.url, url);
+  req->arg.serv_id = serv_id;
+  req->arg.n_serv = n_serv;
+  req->arg.root_master = root_master;
+  req->arg.walk_fn = walk_fn;
+  req->arg.walk_arg = walk_arg;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_closedir] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_walk] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_rmdir (struct nfi_worker * wrk, char * url) 
+int nfi_request_do_summarize (struct nfi_request * req, char * url, int serv_id, int n_serv, int root_master, struct nfi_summary * summary)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_rmdir] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_summarize] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_rmdir;
-  strcpy(wrk->arg.url, url);
+  req->arg.operation = op_summarize;
+  strcpy(req->arg.url, url);
+  req->arg.serv_id = serv_id;
+  req->arg.n_serv = n_serv;
+  req->arg.root_master = root_master;
+  req->arg.summary = summary;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_rmdir] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_summarize] >> End\n", pthread_self());
 
   return 0;
 }
 
 //FS API
-int nfi_worker_do_statfs (struct nfi_worker * wrk, struct nfi_info * inf) 
+int nfi_request_do_statfs (struct nfi_request * req, struct nfi_info * inf)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_statfs] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_statfs] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_statfs;
-  wrk->arg.inf = inf;
+  req->arg.operation = op_statfs;
+  req->arg.inf = inf;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_statfs] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_statfs] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_read_mdata (struct nfi_worker *wrk, char * url, struct xpn_metadata *mdata)
+int nfi_request_do_read_mdata (struct nfi_request * req, char * url, struct xpn_metadata *mdata)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_read_data] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_read_data] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_read_mdata;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.mdata = mdata;
+  req->arg.operation = op_read_mdata;
+  strcpy(req->arg.url, url);
+  req->arg.mdata = mdata;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_read_data] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_read_data] >> End\n", pthread_self());
 
   return 0;
 }
 
-int nfi_worker_do_write_mdata (struct nfi_worker *wrk, char * url, struct xpn_metadata *mdata, int only_file_size)
+int nfi_request_do_write_mdata (struct nfi_request * req, char * url, struct xpn_metadata *mdata, int only_file_size)
 {
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_write_data] >> Begin\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_write_data] >> Begin\n", pthread_self());
 
   // Pack request
-  wrk->arg.operation = op_write_mdata;
-  strcpy(wrk->arg.url, url);
-  wrk->arg.mdata = mdata;
-  wrk->arg.mdata_only_file_size = only_file_size;
+  req->arg.operation = op_write_mdata;
+  strcpy(req->arg.url, url);
+  req->arg.mdata = mdata;
+  req->arg.mdata_only_file_size = only_file_size;
 
   // Do operation
-  nfiworker_launch(nfi_do_operation, wrk);
+  nfi_request_launch(req);
 
-  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_worker_do_write_data] >> End\n", pthread_self());
+  debug_info("[TH_ID=%lu] [NFI_OPS] [nfi_request_do_write_data] >> End\n", pthread_self());
 
   return 0;
 }
 
+
+// Single outstanding operation per server, on its own request (serv->wrk->req)
+int nfi_worker_do_open (struct nfi_worker * wrk, char * url, int flags, mode_t mode, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_open(&(wrk->req), url, flags, mode, fh);
+}
+
+int nfi_worker_do_create (struct nfi_worker * wrk, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_create(&(wrk->req), url, mode, attr, fh);
+}
+
+int nfi_worker_do_read (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n)
+{
+  return nfi_request_do_read(&(wrk->req), fh, io, n);
+}
+
+int nfi_worker_do_write (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n)
+{
+  return nfi_request_do_write(&(wrk->req), fh, io, n);
+}
+
+int nfi_worker_do_close (struct nfi_worker * wrk, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_close(&(wrk->req), fh);
+}
+
+int nfi_worker_do_remove (struct nfi_worker * wrk, char * url)
+{
+  return nfi_request_do_remove(&(wrk->req), url);
+}
+
+int nfi_worker_do_rename (struct nfi_worker * wrk, char * old_url, char * new_url)
+{
+  return nfi_request_do_rename(&(wrk->req), old_url, new_url);
+}
+
+int nfi_worker_do_getattr (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_attr * attr)
+{
+  return nfi_request_do_getattr(&(wrk->req), fh, attr);
+}
+
+int nfi_worker_do_setattr (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct nfi_attr * attr)
+{
+  return nfi_request_do_setattr(&(wrk->req), fh, attr);
+}
+
+int nfi_worker_do_mkdir (struct nfi_worker * wrk, char * url, mode_t mode, struct nfi_attr * attr, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_mkdir(&(wrk->req), url, mode, attr, fh);
+}
+
+int nfi_worker_do_opendir (struct nfi_worker * wrk, char * url, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_opendir(&(wrk->req), url, fh);
+}
+
+int nfi_worker_do_readdir (struct nfi_worker * wrk, struct nfi_fhandle * fh, struct dirent * entry)
+{
+  return nfi_request_do_readdir(&(wrk->req), fh, entry);
+}
+
+int nfi_worker_do_closedir (struct nfi_worker * wrk, struct nfi_fhandle * fh)
+{
+  return nfi_request_do_closedir(&(wrk->req), fh);
+}
+
+int nfi_worker_do_rmdir (struct nfi_worker * wrk, char * url)
+{
+  return nfi_request_do_rmdir(&(wrk->req), url);
+}
+
+int nfi_worker_do_mkdir_p (struct nfi_worker * wrk, char * url, mode_t mode)
+{
+  return nfi_request_do_mkdir_p(&(wrk->req), url, mode);
+}
+
+int nfi_worker_do_rmtree (struct nfi_worker * wrk, char * url)
+{
+  return nfi_request_do_rmtree(&(wrk->req), url);
+}
+
+int nfi_worker_do_walk (struct nfi_worker * wrk, char * url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void * walk_arg)
+{
+  return nfi_request_do_walk(&(wrk->req), url, serv_id, n_serv, root_master, walk_fn, walk_arg);
+}
+
+int nfi_worker_do_summarize (struct nfi_worker * wrk, char * url, int serv_id, int n_serv, int root_master, struct nfi_summary * summary)
+{
+  return nfi_request_do_summarize(&(wrk->req), url, serv_id, n_serv, root_master, summary);
+}
+
+int nfi_worker_do_statfs (struct nfi_worker * wrk, struct nfi_info * inf)
+{
+  return nfi_request_do_statfs(&(wrk->req), inf);
+}
+
+int nfi_worker_do_read_mdata (struct nfi_worker * wrk, char * url, struct xpn_metadata *mdata)
+{
+  return nfi_request_do_read_mdata(&(wrk->req), url, mdata);
+}
+
+int nfi_worker_do_write_mdata (struct nfi_worker * wrk, char * url, struct xpn_metadata *mdata, int only_file_size)
+{
+  return nfi_request_do_write_mdata(&(wrk->req), url, mdata, only_file_size);
+}
+
+
 /* ................................................................... */
@@ -33,6 +33,9 @@
    pthread_cond_t  global_cnd;
    int             global_busy;
 
+   // last request launched by this thread, still not given to the server workers
+   static __thread struct nfi_request * nfi_request_pending = NULL;
+
 
 /* ... Functions / Funciones ......................................... */
 
@@ -62,7 +65,7 @@ void * nfi_worker_run(struct nfi_worker * args)
     // ret = nfi_do_operation(wrk);
     ret = 1; // TMP
 
-    wrk->arg.result = ret;
+    wrk->req.arg.result = ret;
     wrk->ready = 0;
     pthread_cond_signal(&(wrk->cnd));
     pthread_mutex_unlock(&(wrk->mt));
@@ -101,6 +104,9 @@ int nfi_worker_init(struct nfi_worker * wrk, struct nfi_server * serv, int threa
   thread = 1; // FIXME: Needed since the last changes in the threads architecture
   wrk->thread = thread;
 
+  pthread_mutex_init(&(wrk->m_ops), NULL);
+  nfi_request_init(&(wrk->req), serv);
+
   if (thread) 
   {
     pthread_mutex_init(&(wrk->mt), NULL);
@@ -153,8 +159,8 @@ ssize_t nfi_worker_wait(struct nfi_worker * wrk)
     }
   }
 
-  ret = wrk->arg.result;
-  wrk->arg.result = 0;
+  ret = wrk->req.arg.result;
+  wrk->req.arg.result = 0;
 
   if (wrk->thread) 
   {
@@ -182,6 +188,7 @@ int nfi_worker_end(struct nfi_worker * wrk)
     pthread_cond_destroy(&(wrk->cnd));
   }
 
+  pthread_mutex_destroy(&(wrk->m_ops));
   free(wrk);
   wrk = NULL;
 
@@ -211,57 +218,234 @@ int nfiworker_init (struct nfi_server * serv)
 
   ret = base_workers_init(&(serv->wrk->wb), serv->xpn_thread);
 
+  pthread_mutex_init(&(serv->wrk->m_ops), NULL);
+  nfi_request_init(&(serv->wrk->req), serv);
+
   debug_info("[NFI_WORKER] [nfiworker_init] >> End\n");
 
   return ret;
 }
 
-int nfiworker_launch (void( * worker_function)(struct st_th), struct nfi_worker * wrk) 
+ssize_t nfiworker_wait(struct nfi_worker * wrk) 
 {
-  int ret = -1;
-  
+  return nfi_request_wait(&(wrk->req));
+}
+
+int nfi_request_init (struct nfi_request * req, struct nfi_server * serv)
+{
+  memset(req, 0, sizeof(struct nfi_request));
+  req->wrk = serv->wrk;
+
+  return 0;
+}
+
+void nfi_request_submit (struct nfi_request * req)
+{
+  // the server worker threads run it, the request keeps the arguments and the result
+  base_workers_launch(&(req->wrk->wb), &(req->warg), nfi_do_operation);
+}
+
+void nfi_request_run (struct nfi_request * req)
+{
+  // the calling thread runs it, without the hop to a worker thread
+  nfi_do_operation(req->warg);
+
+  pthread_mutex_destroy(&(req->warg.m_wait));
+  pthread_cond_destroy(&(req->warg.c_wait));
+  req->launched = 0;
+}
+
+int nfi_request_launch (struct nfi_request * req)
+{
+  struct nfi_request * prev;
+  struct nfi_worker * wrk = req->wrk;
+
   if (wrk->server->error == -1)
     return -1;
 
-  debug_info("[NFI_WORKER] [nfiworker_launch] >> Begin\n");
+  debug_info("[NFI_WORKER] [nfi_request_launch] >> Begin\n");
 
-  // initialize wrk->warg...
-  memset(&(wrk->warg), 0, sizeof(struct st_th));
-  wrk->warg.params = (void * ) wrk;
-  wrk->warg.function = worker_function;
+  // initialize req->warg...
+  memset(&(req->warg), 0, sizeof(struct st_th));
+  req->warg.params = (void * ) req;
+  req->warg.function = nfi_do_operation;
 
-  // wrk->warg.th_worker = <NULL>;
-  pthread_mutex_init(&(wrk->warg.m_wait), NULL);
-  pthread_cond_init(&(wrk->warg.c_wait), NULL);
-  wrk->warg.r_wait = TRUE;
-  wrk->warg.wait4me = TRUE;
+  pthread_mutex_init(&(req->warg.m_wait), NULL);
+  pthread_cond_init(&(req->warg.c_wait), NULL);
+  req->warg.r_wait = TRUE;
+  req->warg.wait4me = TRUE;
+  req->launched = 1;
 
-  ret = base_workers_launch(&(wrk->wb), &(wrk->warg), worker_function);
+  __atomic_add_fetch(&(wrk->server->n_inflight), 1, __ATOMIC_RELAXED);
 
-  debug_info("[NFI_WORKER] [nfiworker_launch] >> End\n");
+  if (wrk->wb.thread_mode == TH_NOT)
+  {
+    nfi_request_submit(req);
+    return 0;
+  }
 
-  return ret;
+  // The request is kept until the next step of this thread: if it is a wait,
+  // the request runs inline; if another request is launched (fan-out), it goes to the workers
+  prev = nfi_request_pending;
+  nfi_request_pending = req;
+  if ((prev != NULL) && (prev != req)) {
+    nfi_request_submit(prev);
+  }
+
+  debug_info("[NFI_WORKER] [nfi_request_launch] >> End\n");
+
+  return 0;
 }
 
-ssize_t nfiworker_wait(struct nfi_worker * wrk) 
+ssize_t nfi_request_wait (struct nfi_request * req)
 {
   ssize_t ret;
+  struct nfi_request * prev;
 
-  if (wrk->server->error == -1)
+  // the pending request runs on this thread, meanwhile the workers serve the rest
+  prev = nfi_request_pending;
+  nfi_request_pending = NULL;
+  if (prev != NULL) {
+    nfi_request_run(prev);
+  }
+
+  // a launched request is always waited, it still uses its arguments
+  if ((prev != req) && (!req->launched) && (req->wrk->server->error == -1))
     return 0;
 
-  debug_info("[NFI_WORKER] [nfiworker_wait] >> Begin\n");
+  debug_info("[NFI_WORKER] [nfi_request_wait] >> Begin\n");
 
-  base_workers_wait(&(wrk->wb), &(wrk->warg));
-  ret = wrk->arg.result;
-  if (wrk->arg.worker_errno != 0)
-    errno = wrk->arg.worker_errno;
+  if (req->launched)
+  {
+    base_workers_wait(&(req->wrk->wb), &(req->warg));
+    pthread_mutex_destroy(&(req->warg.m_wait));
+    pthread_cond_destroy(&(req->warg.c_wait));
+    req->launched = 0;
+  }
 
-  debug_info("[NFI_WORKER] [nfiworker_wait] >> End\n");
+  ret = req->arg.result;
+  if (req->arg.worker_errno != 0)
+    errno = req->arg.worker_errno;
+
+  debug_info("[NFI_WORKER] [nfi_request_wait] >> End\n");
 
   return ret;
 }
 
+ssize_t nfi_request_wait_all (struct nfi_request * reqs, int n)
+{
+  ssize_t ret, total = 0;
+  int i, err = 0;
+
+  debug_info("[NFI_WORKER] [nfi_request_wait_all] >> Begin\n");
+
+  // wait for all of them, the first error wins
+  for (i = 0; i < n; i++)
+  {
+    ret = nfi_request_wait(&(reqs[i]));
+    if (ret < 0)
+    {
+      if (!err) {
+        err = errno;
+        total = ret;
+      }
+      continue;
+    }
+
+    if (!err) {
+      total += ret;
+    }
+  }
+
+  if (err) {
+    errno = err;
+  }
+
+  debug_info("[NFI_WORKER] [nfi_request_wait_all] >> End\n");
+
+  return total;
+}
+
+void nfi_request_flush (void)
+{
+  struct nfi_request * prev;
+
+  // the request kept by nfi_request_launch goes to the workers now, for a caller that waits for several at once
+  prev = nfi_request_pending;
+  nfi_request_pending = NULL;
+  if (prev != NULL) {
+    nfi_request_submit(prev);
+  }
+}
+
+void nfi_server_lat_add (struct nfi_server * serv, long usec)
+{
+  long avg, half;
+  int i;
+
+  // moving average, 1/8 of the new sample
+  avg = __atomic_load_n(&(serv->lat_read), __ATOMIC_RELAXED);
+  if (avg == 0)
+       avg = usec;
+  else avg = avg + (usec - avg) / 8;
+  __atomic_store_n(&(serv->lat_read), avg, __ATOMIC_RELAXED);
+
+  // histogram, the old samples weigh less every NFI_LAT_WINDOW reads
+  for (i = 0; (i < NFI_LAT_BUCKETS - 1) && (usec >= (1L << i)); i++);
+  __atomic_add_fetch(&(serv->lat_hist[i]), 1, __ATOMIC_RELAXED);
+
+  if (__atomic_add_fetch(&(serv->lat_n), 1, __ATOMIC_RELAXED) == NFI_LAT_WINDOW)
+  {
+    for (i = 0; i < NFI_LAT_BUCKETS; i++)
+    {
+      half = __atomic_load_n(&(serv->lat_hist[i]), __ATOMIC_RELAXED) / 2;
+      __atomic_sub_fetch(&(serv->lat_hist[i]), half, __ATOMIC_RELAXED);
+    }
+    __atomic_sub_fetch(&(serv->lat_n), NFI_LAT_WINDOW / 2, __ATOMIC_RELAXED);
+  }
+}
+
+long nfi_server_lat_percentile (struct nfi_server * serv, int percentile)
+{
+  long n, count, limit;
+  int i;
+
+  n = __atomic_load_n(&(serv->lat_n), __ATOMIC_RELAXED);
+  if (n < NFI_LAT_MIN_SAMPLES) {
+    return -1;
+  }
+
+  // upper bound of the bucket where the percentile falls
+  limit = (n * percentile) / 100;
+  count = 0;
+  for (i = 0; i < NFI_LAT_BUCKETS - 1; i++)
+  {
+    count += __atomic_load_n(&(serv->lat_hist[i]), __ATOMIC_RELAXED);
+    if (count > limit) {
+      break;
+    }
+  }
+
+  return (1L << i);
+}
+
+long nfi_server_cost (struct nfi_server * serv, int extra)
+{
+  long lat;
+  int  queue;
+
+  // a server with a stalled read goes last, it would stall the next ones too
+  if (__atomic_load_n(&(serv->n_slow), __ATOMIC_RELAXED) > 0) {
+    return LONG_MAX;
+  }
+
+  // expected wait: latency of one read times the reads ahead (the ones in flight plus 'extra')
+  lat   = __atomic_load_n(&(serv->lat_read), __ATOMIC_RELAXED);
+  queue = __atomic_load_n(&(serv->n_inflight), __ATOMIC_RELAXED);
+
+  return (lat + 1) * (1 + queue + extra);
+}
+
 void nfiworker_destroy(struct nfi_server * serv) 
 {
   debug_info("[NFI_WORKER] [nfiworker_destroy] >> Begin\n");
@@ -171,6 +171,10 @@ int nfi_local_init ( char *url, struct nfi_server *serv, __attribute__((__unused
   serv->ops->nfi_readdir    = nfi_local_readdir;
   serv->ops->nfi_closedir   = nfi_local_closedir;
   serv->ops->nfi_rmdir      = nfi_local_rmdir;
+  serv->ops->nfi_mkdir_p    = nfi_local_mkdir_p;
+  serv->ops->nfi_rmtree     = nfi_local_rmtree;
+  serv->ops->nfi_walk       = nfi_local_walk;
+  serv->ops->nfi_summarize  = nfi_local_summarize;
 
   serv->ops->nfi_statfs     = nfi_local_statfs;
 
@@ -222,6 +226,9 @@ int nfi_local_init ( char *url, struct nfi_server *serv, __attribute__((__unused
   memset(serv->wrk, 0, sizeof(struct nfi_worker));
   serv->wrk->server = serv;
 
+  // local calls do not use connections
+  serv->n_streams = 1;
+
   // Initialize workers
   debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_init] Initialize workers\n", serv->id);
 
@@ -988,6 +995,258 @@ int nfi_local_rmdir ( struct nfi_server *serv, char *url )
   return 0;
 }
 
+int nfi_local_mkdir_p ( struct nfi_server *serv, char *url, mode_t mode )
+{
+  int  ret;
+  char dir[PATH_MAX];
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_mkdir_p] >> Begin\n", serv->id);
+
+  // Check arguments...
+  NULL_RET_ERR(serv, EINVAL);
+  NULL_RET_ERR(url,  EINVAL);
+  nfi_local_keep_connected(serv);
+  NULL_RET_ERR(serv->private_info, EINVAL);
+
+  // from url -> server + dir
+  ret = ParseURL(url, NULL, NULL, NULL, NULL, NULL, dir);
+  if (ret < 0)
+  {
+    printf("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_mkdir_p] ERROR: incorrect url '%s'.\n", serv->id, url);
+    errno = EINVAL;
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_mkdir_p] nfi_local_mkdir_p(%s)\n", serv->id, dir);
+
+  ret = filesystem_mkdir_p(dir, mode);
+  if (ret < 0)
+  {
+    debug_error("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_mkdir_p] ERROR: filesystem_mkdir_p fails to mkdir '%s' in server %s.\n", serv->id, dir, serv->server);
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_mkdir_p] >> End\n", serv->id);
+
+  return 0;
+}
+
+int nfi_local_rmtree ( struct nfi_server *serv, char *url )
+{
+  int  ret;
+  char dir[PATH_MAX];
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_rmtree] >> Begin\n", serv->id);
+
+  // Check arguments...
+  NULL_RET_ERR(serv, EINVAL);
+  NULL_RET_ERR(url,  EINVAL);
+  nfi_local_keep_connected(serv);
+  NULL_RET_ERR(serv->private_info, EINVAL);
+
+  // from url -> server + dir
+  ret = ParseURL(url, NULL, NULL, NULL, NULL, NULL, dir);
+  if (ret < 0)
+  {
+    printf("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_rmtree] ERROR: incorrect url '%s'.\n", serv->id, url);
+    errno = EINVAL;
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_rmtree] nfi_local_rmtree(%s)\n", serv->id, dir);
+
+  ret = filesystem_rmtree(dir);
+  if (ret < 0)
+  {
+    debug_error("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_rmtree] ERROR: filesystem_rmtree fails to rm '%s' in server %s.\n", serv->id, dir, serv->server);
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_rmtree] >> End\n", serv->id);
+
+  return 0;
+}
+
+struct nfi_local_walk_arg
+{
+  int serv_id;
+  int n_serv;
+  int root_master;
+  nfi_walk_fn walk_fn;
+  void *walk_arg;
+};
+
+int nfi_local_walk_entry ( char *path, int is_dir, int depth, void *arg )
+{
+  struct nfi_local_walk_arg *walk = (struct nfi_local_walk_arg *) arg;
+  int master;
+
+  // only the master of the parent directory reports an entry (as readdir does)
+  if (walk->n_serv > 0)
+  {
+    master = (0 == depth) ? walk->root_master : hash(path, walk->n_serv, 0);
+    if (master != walk->serv_id) {
+      return 0;
+    }
+  }
+
+  return walk->walk_fn(path, is_dir ? NFIDIR : NFIFILE, depth, walk->walk_arg);
+}
+
+int nfi_local_walk ( struct nfi_server *serv, char *url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void *walk_arg )
+{
+  int  ret;
+  char dir[PATH_MAX];
+  struct nfi_local_walk_arg walk;
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_walk] >> Begin\n", serv->id);
+
+  // Check arguments...
+  NULL_RET_ERR(serv,    EINVAL);
+  NULL_RET_ERR(url,     EINVAL);
+  NULL_RET_ERR(walk_fn, EINVAL);
+  nfi_local_keep_connected(serv);
+  NULL_RET_ERR(serv->private_info, EINVAL);
+
+  // from url -> server + dir
+  ret = ParseURL(url, NULL, NULL, NULL, NULL, NULL, dir);
+  if (ret < 0)
+  {
+    printf("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_walk] ERROR: incorrect url '%s'.\n", serv->id, url);
+    errno = EINVAL;
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_walk] nfi_local_walk(%s)\n", serv->id, dir);
+
+  walk.serv_id     = serv_id;
+  walk.n_serv      = n_serv;
+  walk.root_master = root_master;
+  walk.walk_fn     = walk_fn;
+  walk.walk_arg    = walk_arg;
+
+  ret = filesystem_walk(dir, nfi_local_walk_entry, &walk);
+  if (ret < 0)
+  {
+    debug_error("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_walk] ERROR: filesystem_walk fails to walk '%s' in server %s.\n", serv->id, dir, serv->server);
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_walk] >> End\n", serv->id);
+
+  return 0;
+}
+
+struct nfi_local_summarize_arg
+{
+  int serv_id;
+  int n_serv;
+  int root_master;
+  char root_path[PATH_MAX];
+  struct nfi_summary *summary;
+};
+
+int nfi_local_summarize_entry ( char *path, int is_dir, int depth, void *arg )
+{
+  struct nfi_local_summarize_arg *sum = (struct nfi_local_summarize_arg *) arg;
+  struct xpn_metadata mdata;
+  struct stat st;
+  char full_path[PATH_MAX];
+  int  master, fd;
+
+  if (is_dir)
+  {
+    // a directory is counted by the master of its parent (as readdir does)
+    master = (0 == depth) ? sum->root_master : hash(path, sum->n_serv, 0);
+    if ((sum->n_serv == 0) || (master == sum->serv_id)) {
+      sum->summary->dirs++;
+    }
+    return 0;
+  }
+
+  // a file is counted by its master node, that has the header with the logical size
+  if ((sum->n_serv > 0) && (hash(path, sum->n_serv, 1) != sum->serv_id)) {
+    return 0;
+  }
+
+  if (snprintf(full_path, PATH_MAX, "%s/%s", sum->root_path, path) >= PATH_MAX)
+  {
+    debug_error("[NFI_LOCAL] [nfi_local_summarize_entry] ERROR: path too long, '%s' skipped\n", path);
+    return 0;
+  }
+  sum->summary->files++;
+
+  memset(&mdata, 0, sizeof(struct xpn_metadata));
+  fd = filesystem_open(full_path, O_RDONLY);
+  if (fd >= 0) {
+    filesystem_read(fd, &mdata, sizeof(struct xpn_metadata));
+    filesystem_close(fd);
+  }
+
+  if (XPN_CHECK_MAGIC_NUMBER(&mdata)) {
+    sum->summary->bytes += mdata.file_size;
+  }
+  else if (filesystem_stat(full_path, &st) == 0) {
+    sum->summary->bytes += st.st_size;
+  }
+
+  return 0;
+}
+
+int nfi_local_summarize ( struct nfi_server *serv, char *url, int serv_id, int n_serv, int root_master, struct nfi_summary *summary )
+{
+  int  ret;
+  size_t len;
+  struct nfi_local_summarize_arg *sum;
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_summarize] >> Begin\n", serv->id);
+
+  // Check arguments...
+  NULL_RET_ERR(serv,    EINVAL);
+  NULL_RET_ERR(url,     EINVAL);
+  NULL_RET_ERR(summary, EINVAL);
+  nfi_local_keep_connected(serv);
+  NULL_RET_ERR(serv->private_info, EINVAL);
+
+  sum = (struct nfi_local_summarize_arg *) malloc(sizeof(struct nfi_local_summarize_arg));
+  NULL_RET_ERR(sum, ENOMEM);
+
+  // from url -> server + dir
+  ret = ParseURL(url, NULL, NULL, NULL, NULL, NULL, sum->root_path);
+  if (ret < 0)
+  {
+    printf("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_summarize] ERROR: incorrect url '%s'.\n", serv->id, url);
+    FREE_AND_NULL(sum);
+    errno = EINVAL;
+    return -1;
+  }
+
+  len = strlen(sum->root_path);
+  while ((len > 1) && ('/' == sum->root_path[len - 1])) {
+    sum->root_path[--len] = '\0';
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_summarize] nfi_local_summarize(%s)\n", serv->id, sum->root_path);
+
+  memset(summary, 0, sizeof(struct nfi_summary));
+  sum->serv_id     = serv_id;
+  sum->n_serv      = n_serv;
+  sum->root_master = root_master;
+  sum->summary     = summary;
+
+  ret = filesystem_walk(sum->root_path, nfi_local_summarize_entry, sum);
+  FREE_AND_NULL(sum);
+  if (ret < 0)
+  {
+    debug_error("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_summarize] ERROR: filesystem_walk fails to summarize in server %s.\n", serv->id, serv->server);
+    return -1;
+  }
+
+  debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_summarize] >> End\n", serv->id);
+
+  return 0;
+}
+
 int nfi_local_statfs ( __attribute__((__unused__)) struct nfi_server *serv, __attribute__((__unused__)) struct nfi_info *inf )
 {
   debug_info("[SERV_ID=%d] [NFI_LOCAL] [nfi_local_statfs] >> Begin\n", serv->id);
@@ -1135,6 +1394,11 @@ int nfi_local_write_mdata ( struct nfi_server *server, char *url, struct xpn_met
   debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_local_write_mdata] nfi_local_write_mdata(%s)\n", server->id, dir);
 
   fd = filesystem_open2(dir, O_WRONLY | O_CREAT, S_IRWXU);
+  if ((fd < 0) && (errno == ENOENT)){
+    // directories are created lazily out of their master servers
+    filesystem_mkpath(dir);
+    fd = filesystem_open2(dir, O_WRONLY | O_CREAT, S_IRWXU);
+  }
   if (fd < 0){
     if (errno == EISDIR){
     // if is directory there are no metadata to write so return 0
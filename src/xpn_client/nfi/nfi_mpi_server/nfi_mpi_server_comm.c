@@ -312,9 +312,9 @@ ssize_t nfi_mpi_server_comm_write_data ( MPI_Comm fd, char *data, ssize_t size )
     // Send message
     debug_info("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_write_data] Write data tag %d\n", tag);
 
-    ret = MPI_Send(data, size, MPI_CHAR, 0, tag, fd);
-    if (MPI_SUCCESS != ret) {
-        printf("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_write_data] ERROR: MPI_Send fails\n");
+    ret = mpi_pipe_send(data, size, 0, tag, fd);
+    if (ret < 0) {
+        printf("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_write_data] ERROR: mpi_pipe_send fails\n");
         size = 0;
     }
 
@@ -327,7 +327,6 @@ ssize_t nfi_mpi_server_comm_write_data ( MPI_Comm fd, char *data, ssize_t size )
 ssize_t nfi_mpi_server_comm_read_data(MPI_Comm fd, char *data, ssize_t size)
 {
     int ret;
-    MPI_Status status;
 
     debug_info("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_read_data] >> Begin\n");
 
@@ -345,9 +344,9 @@ ssize_t nfi_mpi_server_comm_read_data(MPI_Comm fd, char *data, ssize_t size)
     // Get message
     debug_info("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_read_data] Read data tag %d\n", tag);
 
-    ret = MPI_Recv(data, size, MPI_CHAR, 0, tag, fd, &status);
-    if (MPI_SUCCESS != ret) {
-        printf("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_read_data] ERROR: MPI_Recv fails\n");
+    ret = mpi_pipe_recv(data, size, 0, tag, fd);
+    if (ret < 0) {
+        printf("[NFI_MPI_SERVER_COMM] [nfi_mpi_server_comm_read_data] ERROR: mpi_pipe_recv fails\n");
         size = 0;
     }
 
@@ -0,0 +1,106 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "nfi_shm_server_comm.h"
+
+
+  /* ... Functions / Funciones ......................................... */
+
+     int nfi_shm_server_comm_connect ( char *srv_name, shm_ring_t **out_ring )
+     {
+         int   ret ;
+         int   port ;
+         char  name[MAX_PORT_NAME_LENGTH] ;
+         char  status[MAX_PORT_NAME_LENGTH] ;
+         shm_ring_t *ring ;
+
+         debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_connect] >> Begin\n");
+
+         *out_ring = NULL ;
+
+         ring = (shm_ring_t *) malloc(sizeof(shm_ring_t)) ;
+         if (NULL == ring) {
+             return -1 ;
+         }
+
+         // the client owns the memory of the channel...
+         ret = shm_ring_create(ring, utils_getenv_int("XPN_SHM_SIZE", SHM_RING_DEFAULT_SIZE)) ;
+         if (ret < 0)
+         {
+             debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_connect] shared memory not available\n");
+             free(ring) ;
+             return -1 ;
+         }
+
+         // ...and asks the server to map it
+         shm_ring_getname(ring, name, MAX_PORT_NAME_LENGTH) ;
+         port = utils_getenv_int("XPN_SCK_PORT", DEFAULT_XPN_SCK_PORT) ;
+         ret  = sersoc_do_send_msg_recv(srv_name, port, SOCKET_ACCEPT_CODE_SHM_CONN, name, status) ;
+         if ((ret < 0) || (strcmp(status, "ok") != 0))
+         {
+             debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_connect] server '%s' cannot map the channel\n", srv_name);
+             shm_ring_close(ring) ;
+             free(ring) ;
+             return -1 ;
+         }
+
+         shm_ring_attached(ring) ;
+         *out_ring = ring ;
+
+         debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_connect] << End\n");
+
+         return 0 ;
+     }
+
+     int nfi_shm_server_comm_disconnect ( shm_ring_t *ring )
+     {
+         int ret ;
+         int code = XPN_SERVER_DISCONNECT;
+
+         debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_disconnect] >> Begin\n");
+
+         // If it has been previously disconnected, just return OK
+         if (NULL == ring)
+         {
+             debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_disconnect] Previously disconnected\n");
+             return 0;
+         }
+
+         ret = shm_ring_send(ring, &code, sizeof(code));
+         if (ret < 0) {
+             printf("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_disconnect] ERROR: disconnect message fails\n");
+         }
+
+         shm_ring_close(ring) ;
+         free(ring) ;
+
+         debug_info("[NFI_SHM_SERVER_COMM] [nfi_shm_server_comm_disconnect] << End\n");
+
+         return (ret < 0) ? -1 : 0 ;
+     }
+
+
+  /* ................................................................... */
+
@@ -34,16 +34,18 @@
  /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
 
    // Communication
-   int nfi_write_operation(struct nfi_xpn_server * params, struct st_xpn_server_msg * head)
+   // Send the operation, its arguments and, after them, the pieces in 'data' (path tail, payload...)
+   int nfi_write_operation_data(struct nfi_xpn_server * params, struct st_xpn_server_msg * head, struct iovec * data, int n_data)
    {
-       int ret;
+       int ret, i;
+       struct iovec iov[SOCKET_IOV_MAX];
+       int iovcnt = 0;
 
        debug_info("[NFI_XPN] [nfi_write_operation] >> Begin\n");
        debug_info("[NFI_XPN] [nfi_write_operation] Send operation\n");
 
-       ret = nfi_xpn_server_comm_write_operation(params, head->type);
-       if (ret < 0) {
-           printf("[NFI_XPN] [nfi_write_operation] ERROR: nfi_write_operation fails\n");
+       if (n_data > SOCKET_IOV_MAX - 2) {
+           printf("[NFI_XPN] [nfi_write_operation] ERROR: too many pieces (%d)\n", n_data);
            return -1;
        }
 
@@ -54,85 +56,180 @@
            //File API
        case XPN_SERVER_OPEN_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] OPEN operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_open), sizeof(head->u_st_xpn_server_msg.op_open));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_open);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_open);
+           iovcnt = 1;
            break;
        case XPN_SERVER_CREAT_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] CREAT operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_creat), sizeof(head->u_st_xpn_server_msg.op_creat));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_creat);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_creat);
+           iovcnt = 1;
            break;
        case XPN_SERVER_READ_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] READ operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_read), sizeof(head->u_st_xpn_server_msg.op_read));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_read);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_read);
+           iovcnt = 1;
            break;
        case XPN_SERVER_WRITE_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] WRITE operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_write), sizeof(head->u_st_xpn_server_msg.op_write));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_write);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_write);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_READV_FILE:
+           debug_info("[NFI_XPN] [nfi_write_operation] READV operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_readv);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_readv);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_WRITEV_FILE:
+           debug_info("[NFI_XPN] [nfi_write_operation] WRITEV operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_writev);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_writev);
+           iovcnt = 1;
            break;
        case XPN_SERVER_CLOSE_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] CLOSE operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_close), sizeof(head->u_st_xpn_server_msg.op_close));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_close);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_close);
+           iovcnt = 1;
            break;
        case XPN_SERVER_RM_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] RM operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_rm), sizeof(head->u_st_xpn_server_msg.op_rm));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rm);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rm);
+           iovcnt = 1;
            break;
        case XPN_SERVER_RM_FILE_ASYNC:
            debug_info("[NFI_XPN] [nfi_write_operation] RM_ASYNC operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_rm), sizeof(head->u_st_xpn_server_msg.op_rm));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rm);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rm);
+           iovcnt = 1;
            break;
        case XPN_SERVER_RENAME_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] RENAME operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_rename), sizeof(head->u_st_xpn_server_msg.op_rename));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rename);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rename);
+           iovcnt = 1;
            break;
        case XPN_SERVER_GETATTR_FILE:
            debug_info("[NFI_XPN] [nfi_write_operation] GETATTR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_getattr), sizeof(head->u_st_xpn_server_msg.op_getattr));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_getattr);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_getattr);
+           iovcnt = 1;
            break;
 
            //Directory API
        case XPN_SERVER_MKDIR_DIR:
            debug_info("[NFI_XPN] [nfi_write_operation] MKDIR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_mkdir), sizeof(head->u_st_xpn_server_msg.op_mkdir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_mkdir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_mkdir);
+           iovcnt = 1;
            break;
        case XPN_SERVER_OPENDIR_DIR:
            debug_info("[NFI_XPN] [nfi_write_operation] OPENDIR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_opendir), sizeof(head->u_st_xpn_server_msg.op_opendir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_opendir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_opendir);
+           iovcnt = 1;
            break;
        case XPN_SERVER_READDIR_DIR:
            debug_info("[NFI_XPN] [nfi_write_operation] READDIR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_readdir), sizeof(head->u_st_xpn_server_msg.op_readdir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_readdir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_readdir);
+           iovcnt = 1;
            break;
        case XPN_SERVER_CLOSEDIR_DIR:
            debug_info("[NFI_XPN] [nfi_write_operation] CLOSEDIR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_closedir), sizeof(head->u_st_xpn_server_msg.op_closedir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_closedir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_closedir);
+           iovcnt = 1;
            break;
        case XPN_SERVER_RMDIR_DIR:
            debug_info("[NFI_XPN] [nfi_write_operation] RMDIR operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_rmdir), sizeof(head->u_st_xpn_server_msg.op_rmdir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rmdir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rmdir);
+           iovcnt = 1;
            break;
        case XPN_SERVER_RMDIR_DIR_ASYNC:
            debug_info("[NFI_XPN] [nfi_write_operation] RMDIR_ASYNC operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_rmdir), sizeof(head->u_st_xpn_server_msg.op_rmdir));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rmdir);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rmdir);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_MKDIR_P_DIR:
+           debug_info("[NFI_XPN] [nfi_write_operation] MKDIR_P operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_mkdir_p);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_mkdir_p);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_RMTREE_DIR:
+           debug_info("[NFI_XPN] [nfi_write_operation] RMTREE operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_rmtree);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_rmtree);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_WALK_DIR:
+           debug_info("[NFI_XPN] [nfi_write_operation] WALK operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_walk);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_walk);
+           iovcnt = 1;
+           break;
+       case XPN_SERVER_SUMMARIZE_DIR:
+           debug_info("[NFI_XPN] [nfi_write_operation] SUMMARIZE operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_summarize);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_summarize);
+           iovcnt = 1;
            break;
        case XPN_SERVER_READ_MDATA:
            debug_info("[NFI_XPN] [nfi_write_operation] READ_MDATA operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_read_mdata), sizeof(head->u_st_xpn_server_msg.op_read_mdata));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_read_mdata);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_read_mdata);
+           iovcnt = 1;
            break;
        case XPN_SERVER_WRITE_MDATA:
            debug_info("[NFI_XPN] [nfi_write_operation] WRITE_MDATA operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_write_mdata), sizeof(head->u_st_xpn_server_msg.op_write_mdata));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_write_mdata);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_write_mdata);
+           iovcnt = 1;
            break;
        case XPN_SERVER_WRITE_MDATA_FILE_SIZE:
            debug_info("[NFI_XPN] [nfi_write_operation] WRITE_MDATA_FILE_SIZE operation\n");
-           ret = nfi_xpn_server_comm_write_data(params, (char * ) & (head->u_st_xpn_server_msg.op_write_mdata_file_size), sizeof(head->u_st_xpn_server_msg.op_write_mdata_file_size));
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_write_mdata_file_size);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_write_mdata_file_size);
+           iovcnt = 1;
+           break;
+
+           //Connection API
+       case XPN_SERVER_CODEC:
+           debug_info("[NFI_XPN] [nfi_write_operation] CODEC operation\n");
+           iov[0].iov_base = (char * ) & (head->u_st_xpn_server_msg.op_codec);
+           iov[0].iov_len  = sizeof(head->u_st_xpn_server_msg.op_codec);
+           iovcnt = 1;
            break;
        }
 
+       for (i = 0; i < n_data; i++) {
+           iov[iovcnt++] = data[i];
+       }
+
+       ret = nfi_xpn_server_comm_write_request(params, head->type, iov, iovcnt);
+       if (ret < 0) {
+           printf("[NFI_XPN] [nfi_write_operation] ERROR: nfi_xpn_server_comm_write_request fails\n");
+           return -1;
+       }
+
        debug_info("[NFI_XPN] [nfi_write_operation] >> End\n");
 
        return ret;
    }
 
+   int nfi_write_operation(struct nfi_xpn_server * params, struct st_xpn_server_msg * head)
+   {
+       return nfi_write_operation_data(params, head, NULL, 0);
+   }
+
    int nfi_xpn_server_do_request(struct nfi_xpn_server * server_aux, struct st_xpn_server_msg * msg, char * req, int req_size)
    {
        ssize_t ret;
@@ -159,514 +256,1982 @@
        return 0;
    }
 
-   int nfi_xpn_server_keep_connected(struct nfi_server * serv)
+   // Data chunks with a codec: st_xpn_server_zchunk header and the coded bytes (raw if it does not pay off)
+   int nfi_xpn_server_chunk_pack(int codec, char * data, int size, char * zbuffer, struct st_xpn_server_zchunk * zhdr, struct iovec * iov)
    {
-       // check params...
-       if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_keep_connected] ERROR: serv argument is NULL\n", -1);
-           return -1;
+       if ((XPN_CODEC_NONE == codec) || (size <= 0))
+       {
+           iov[0].iov_base = data;
+           iov[0].iov_len  = size;
+           return 1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] >> Begin\n", serv->id);
+       zhdr->raw_size  = size;
+       zhdr->wire_size = -1;
+       if (size >= XPN_CODEC_MIN_SIZE) {
+           zhdr->wire_size = lz4_codec_compress(data, size, zbuffer, XPN_CODEC_MAX_WIRE(size));
+       }
 
-       if (serv->keep_connected == 0) {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] Server reconnect\n", 0);
-           int ret = nfi_xpn_server_reconnect(serv);
-           if (ret < 0) {
-               serv->private_info = NULL;
-               return -1;
-           }
+       if (zhdr->wire_size < 0) {
+           zhdr->wire_size = size;
+       }
+       else {
+           data = zbuffer;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] >> End\n", serv->id);
+       iov[0].iov_base = (char * ) zhdr;
+       iov[0].iov_len  = sizeof(struct st_xpn_server_zchunk);
+       iov[1].iov_base = data;
+       iov[1].iov_len  = zhdr->wire_size;
 
-       return (serv->private_info != NULL);
+       return 2;
    }
 
-   void nfi_2_xpn_attr(struct stat * att, struct nfi_attr * nfi_att)
+   ssize_t nfi_xpn_server_send_chunk(struct nfi_xpn_server * server_aux, int codec, char * data, int size, char * zbuffer)
    {
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_2_xpn_attr] >> Begin\n", -1);
-
-       att->st_dev = nfi_att->st_dev;
-       att->st_ino = nfi_att->st_ino;
+       struct st_xpn_server_zchunk zhdr;
+       struct iovec iov[2];
+       ssize_t ret;
+       int n;
 
-       if (nfi_att->at_type == NFIFILE) {
-           att->st_mode = nfi_att->at_mode | S_IFREG; // protection
-       }
+       n = nfi_xpn_server_chunk_pack(codec, data, size, zbuffer, & zhdr, iov);
 
-       if (nfi_att->at_type == NFIDIR) {
-           att->st_mode = nfi_att->at_mode | S_IFDIR; // protection
+       ret = nfi_xpn_server_comm_write_datav(server_aux, iov, n);
+       if (ret < 0) {
+           return -1;
        }
 
-       att->st_nlink = nfi_att->at_nlink; // number of hard links
-       att->st_uid = nfi_att->at_uid; // user ID of owner
-       att->st_gid = nfi_att->at_gid; // group ID of owner
-       att->st_size = nfi_att->at_size; // size
-       att->st_blksize = nfi_att->at_blksize; // blocksize for filesystem I/O
-       att->st_blocks = nfi_att->at_blocks; // number of blocks allocated
-       att->st_atime = nfi_att->at_atime; // time of last access
-       att->st_mtime = nfi_att->at_mtime; // time of last modification
-       att->st_ctime = nfi_att->at_ctime; // time of last change
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_2_xpn_attr] >> End\n", -1);
+       return size;
    }
 
-   void xpn_2_nfi_attr(struct nfi_attr * nfi_att, struct stat * att)
+   ssize_t nfi_xpn_server_recv_chunk(struct nfi_xpn_server * server_aux, int codec, char * buffer, int size, char * zbuffer)
    {
-       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_attr] >> Begin\n", -1);
+       struct st_xpn_server_zchunk zhdr;
+       ssize_t ret;
 
-       nfi_att->st_dev = att->st_dev;
-       nfi_att->st_ino = att->st_ino;
+       if ((XPN_CODEC_NONE == codec) || (size <= 0)) {
+           return nfi_xpn_server_comm_read_data(server_aux, buffer, size);
+       }
 
-       if (S_ISREG(att->st_mode)) {
-           nfi_att->at_type = NFIFILE;
+       ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & zhdr, sizeof(zhdr));
+       if (ret < 0) {
+           return -1;
        }
-       if (S_ISDIR(att->st_mode)) {
-           nfi_att->at_type = NFIDIR;
+       if ((zhdr.raw_size != size) || (zhdr.wire_size <= 0) || (zhdr.wire_size > size)) {
+           printf("[NFI_XPN] [nfi_xpn_server_recv_chunk] ERROR: wrong chunk header (%d, %d) for %d bytes\n", zhdr.raw_size, zhdr.wire_size, size);
+           return -1;
        }
 
-       nfi_att->at_mode = att->st_mode & (S_IRWXU | S_IRWXG | S_IRWXO); // protection
-       nfi_att->at_nlink = att->st_nlink; // number of hard links
-       nfi_att->at_uid = att->st_uid; // user ID of owner
-       nfi_att->at_gid = att->st_gid; // group ID of owner
-       nfi_att->at_size = att->st_size; // total size, in bytes
-       nfi_att->at_blksize = att->st_blksize; // blocksize for filesystem I/O
-       nfi_att->at_blocks = att->st_blocks; // number of blocks allocated
-       nfi_att->at_atime = att->st_atime; // time of last access
-       nfi_att->at_mtime = att->st_mtime; // time of last modification
-       nfi_att->at_ctime = att->st_ctime; // time of last change
+       // sent raw
+       if (zhdr.wire_size == size) {
+           return nfi_xpn_server_comm_read_data(server_aux, buffer, size);
+       }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_attr] >> End\n", -1);
+       ret = nfi_xpn_server_comm_read_data(server_aux, zbuffer, zhdr.wire_size);
+       if (ret < 0) {
+           return -1;
+       }
+       if (lz4_codec_decompress(zbuffer, zhdr.wire_size, buffer, size) != size) {
+           printf("[NFI_XPN] [nfi_xpn_server_recv_chunk] ERROR: corrupted chunk of %d bytes\n", size);
+           return -1;
+       }
+
+       return size;
    }
 
-   void xpn_2_nfi_info(__attribute__((__unused__)) struct nfi_info * nfi_inf, __attribute__((__unused__)) struct nfi_info * xpn_inf)
+   // Scratch buffer for the coded chunks of one operation (no codec for this one if there is no memory)
+   char * nfi_xpn_server_zbuffer(struct nfi_xpn_server * server_aux, long size, int * codec)
    {
-       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_info] >> Begin\n", -1);
+       char * zbuffer = NULL;
 
-       //TODO
+       * codec = server_aux->codec;
+       if (XPN_CODEC_NONE != * codec)
+       {
+           if (size > MAX_BUFFER_SIZE) {
+               size = MAX_BUFFER_SIZE;
+           }
+           zbuffer = (char * ) malloc((size > 0) ? size : 1);
+           if (NULL == zbuffer) {
+               * codec = XPN_CODEC_NONE;
+           }
+       }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_info] >> End\n", -1);
+       return zbuffer;
    }
 
-
-/* ... Functions / Funciones ......................................... */
-
-   int nfi_xpn_server_init(char * url, struct nfi_server * serv, int server_type)
+   // Connection pool
+   int nfi_xpn_server_codec_init(struct nfi_server * serv)
    {
        int ret;
-       char server[PATH_MAX], dir[PATH_MAX], prt[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       char hostname[HOST_NAME_MAX];
-       char hostip[HOST_NAME_MAX];
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
 
-       // check params...
-       if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_init] ERROR: serv argument is NULL\n", -1);
-           return -1;
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       server_aux->codec = XPN_CODEC_NONE;
+
+       if ((serv->codec == XPN_CODEC_NONE) || (server_aux->server_type != XPN_SERVER_TYPE_SCK) ||
+           (server_aux->keep_connected == 0) || (server_aux->xpn_mosquitto_mode == 1)) {
+           return 0;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_codec_init] >> Begin\n", serv->id);
 
-       // new nfi_ops with xpn functions...
-       serv->ops = (struct nfi_ops * ) malloc(sizeof(struct nfi_ops));
-       NULL_RET_ERR(serv->ops, ENOMEM);
+       msg.type = XPN_SERVER_CODEC;
+       msg.u_st_xpn_server_msg.op_codec.codec = serv->codec;
 
-       // Fill serv->ops...
-       bzero(serv->ops, sizeof(struct nfi_ops));
-       serv->ops->nfi_reconnect = nfi_xpn_server_reconnect;
-       serv->ops->nfi_disconnect = nfi_xpn_server_disconnect;
-       serv->ops->nfi_destroy = nfi_xpn_server_destroy;
+       ret = nfi_xpn_server_do_request(server_aux, & msg, (char * ) & status, sizeof(struct st_xpn_server_status));
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_codec_init] ERROR: nfi_xpn_server_do_request fails\n", serv->id);
+           return -1;
+       }
 
-       serv->ops->nfi_open = nfi_xpn_server_open;
-       serv->ops->nfi_create = nfi_xpn_server_create;
-       serv->ops->nfi_read = nfi_xpn_server_read;
-       serv->ops->nfi_write = nfi_xpn_server_write;
-       serv->ops->nfi_close = nfi_xpn_server_close;
-       serv->ops->nfi_remove = nfi_xpn_server_remove;
-       serv->ops->nfi_rename = nfi_xpn_server_rename;
-       serv->ops->nfi_getattr = nfi_xpn_server_getattr;
-       serv->ops->nfi_setattr = nfi_xpn_server_setattr;
+       server_aux->codec = status.ret;
+       serv->codec = status.ret;
 
-       serv->ops->nfi_opendir = nfi_xpn_server_opendir;
-       serv->ops->nfi_mkdir = nfi_xpn_server_mkdir;
-       serv->ops->nfi_readdir = nfi_xpn_server_readdir;
-       serv->ops->nfi_closedir = nfi_xpn_server_closedir;
-       serv->ops->nfi_rmdir = nfi_xpn_server_rmdir;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_codec_init] codec(%d)=%d\n", serv->id, msg.u_st_xpn_server_msg.op_codec.codec, status.ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_codec_init] << End\n", serv->id);
 
-       serv->ops->nfi_statfs = nfi_xpn_server_statfs;
+       return 0;
+   }
 
-       serv->ops->nfi_write_mdata = nfi_xpn_server_write_mdata;
-       serv->ops->nfi_read_mdata = nfi_xpn_server_read_mdata;
+   // A client on the same node uses the data files directly (locality or short-circuit reads)
+   // only if they are laid out as expected and hold the last data written
+   int nfi_xpn_server_layout_init(struct nfi_server * serv)
+   {
+       int ret;
+       struct nfi_xpn_server * server_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
 
-       // parse url...
-       ret = ParseURL(url, prt, NULL, NULL, server, NULL, dir);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ERROR: incorrect url '%s'.\n", serv->id, url);
-           FREE_AND_NULL(serv->ops);
-           return -1;
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if ((server_aux->locality == 0) || ((server_aux->xpn_locality == 0) && (server_aux->short_circuit == 0))) {
+           return 0;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_layout_init] >> Begin\n", serv->id);
 
-       // new nfi_XPNserver...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Copy nfi_xpn_server structure\n", serv->id);
+       msg.type = XPN_SERVER_LAYOUT;
 
-       server_aux = (struct nfi_xpn_server * ) malloc(sizeof(struct nfi_xpn_server));
-       if (server_aux == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ERROR: out of memory.\n", serv->id);
-           FREE_AND_NULL(serv->ops);
+       ret = nfi_xpn_server_do_request(server_aux, & msg, (char * ) & status, sizeof(struct st_xpn_server_status));
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_layout_init] ERROR: nfi_xpn_server_do_request fails\n", serv->id);
            return -1;
        }
 
-       // private_info...
-       serv->private_info = (void * ) server_aux;
-
-       // Initialize params
-       memset(server_aux, 0, sizeof(struct nfi_xpn_server));
-       server_aux->server_type = server_type;
-
-       // thread mode
-       serv->xpn_thread = utils_getenv_int("XPN_THREAD", TH_NOT);
-       server_aux->xpn_thread = serv->xpn_thread;
-
-       // keep connection between operations
-       int keep_connection = utils_getenv_int("XPN_CONNECTED", 1);
-       if ((keep_connection < 0) || (keep_connection > 1)) {
-           debug_info("ERROR: unknown keep-connection value. Default value 1 selected\n");
-           keep_connection = 1;
+       // metadata kept in an index of the server: nfi_local would read and write the header in the data files,
+       // and the data files do not have the header bytes for the short-circuit reads
+       server_aux->sc_header = 0;
+       if (status.ret & XPN_SERVER_LAYOUT_INDEX) {
+           server_aux->xpn_locality = 0;
+           server_aux->sc_header    = XPN_HEADER_SIZE;
+       }
+       // write logs of the server (-L): the data files may not have the last data yet
+       if (status.ret & XPN_SERVER_LAYOUT_WLOG) {
+           server_aux->xpn_locality  = 0;
+           server_aux->short_circuit = 0;
        }
-       serv->keep_connected = keep_connection;
-       server_aux->keep_connected = keep_connection;
 
-       // session mode
-       serv->xpn_session_file = utils_getenv_int("XPN_SESSION_FILE", 0);
-       serv->xpn_session_dir = utils_getenv_int("XPN_SESSION_DIR", 1);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_layout_init] layout=%d locality=%d short_circuit=%d\n", serv->id, status.ret, server_aux->xpn_locality, server_aux->short_circuit);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_layout_init] << End\n", serv->id);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Thread mode: %d\n", serv->id, serv->xpn_thread);
+       return 0;
+   }
 
-       // Locality mode
-       server_aux->xpn_locality = utils_getenv_int("XPN_LOCALITY", 1);
+   int nfi_xpn_server_streams_init(struct nfi_server * serv)
+   {
+       int ret, n;
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server * stream;
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Locality enable: %d\n", serv->id, server_aux->xpn_locality);
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
 
-       // Initialize XPN Client communication side...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Initialize XPN Client communication side\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_streams_init] >> Begin\n", serv->id);
 
-       ret = nfi_xpn_server_comm_init(server_aux);
-       if (ret < 0) {
-           FREE_AND_NULL(serv->ops);
-           FREE_AND_NULL(server_aux);
-           return -1;
+       // Only sockets (or shared memory channels) kept connected can have more than one connection
+       n = serv->n_streams;
+       if ((server_aux->server_type == XPN_SERVER_TYPE_MPI) || (server_aux->keep_connected == 0) || (n < 1)) {
+           n = 1;
        }
 
-       // copy 'url' string...
-       serv->url = strdup(url);
-       NULL_RET_ERR(serv->url, ENOMEM);
+       server_aux->streams = (struct nfi_xpn_server ** ) malloc(n * sizeof(struct nfi_xpn_server * ));
+       NULL_RET_ERR(server_aux->streams, ENOMEM);
 
-       // new server wrk...
-       serv->wrk = (struct nfi_worker * ) malloc(sizeof(struct nfi_worker));
-       memset(serv->wrk, 0, sizeof(struct nfi_worker));
-       serv->wrk->server = serv;
+       pthread_mutex_init(&(server_aux->m_streams), NULL);
+       pthread_cond_init(&(server_aux->c_streams), NULL);
+       server_aux->streams[0] = server_aux;
+       server_aux->n_streams = 1;
 
-       // Server conection
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Server connection\n", serv->id);
+       // Extra connections share the server info of the first one
+       while (server_aux->n_streams < n)
+       {
+           stream = (struct nfi_xpn_server * ) malloc(sizeof(struct nfi_xpn_server));
+           if (stream == NULL) {
+               break;
+           }
 
-       if (server_aux->keep_connected == 0) {
-           // lookup port_name
-           ret = sersoc_lookup_port_name(server, server_aux->port_name, SOCKET_ACCEPT_CODE_SCK_NO_CONN);
+           memcpy(stream, server_aux, sizeof(struct nfi_xpn_server));
+           stream->streams = NULL;
+           stream->n_streams = 0;
+           #ifdef ENABLE_SCK_SERVER
+           stream->server_socket = -1;
+           stream->server_shm = NULL;
+           #endif
+           stream->busy_wait = 0; // a busy server gets less connections
+
+           ret = nfi_xpn_server_comm_connect(stream);
            if (ret < 0) {
-               fprintf(stderr, "nfi_sck_server_comm_lookup_port_name: error on '%s'\n", server_aux->srv_name);
-               return -1;
+               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_streams_init] ERROR: only %d connections of %d\n", serv->id, server_aux->n_streams, n);
+               FREE_AND_NULL(stream);
+               break;
            }
-       }
 
-       ret = nfi_xpn_server_connect(serv, url, prt, server, dir);
-       if (ret < 0) {
-           FREE_AND_NULL(serv->ops);
-           FREE_AND_NULL(server_aux);
-           return -1;
+           server_aux->streams[server_aux->n_streams] = stream;
+           server_aux->n_streams++;
        }
 
-       // Check locality
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Data locality\n", serv->id);
+       serv->n_streams = server_aux->n_streams;
 
-       if (server_aux->xpn_locality == 1) {
-           ns_get_host_ip(hostip, HOST_NAME_MAX);
-           ns_get_hostname(hostname);
-           if (strstr(server, hostip) != NULL || strstr(server, hostname) != NULL) {
-               XPN_DEBUG("Locality in serv_url: %s client: %s hostname: %s", server, hostip, hostname);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_streams_init] << End\n", serv->id);
 
-               // free private_info, 'url' string and 'server' string...
-               FREE_AND_NULL(serv->ops);
-               void * aux_private_info = serv->private_info;
+       return 0;
+   }
 
-               ret = nfi_local_init(url, serv, NULL);
-               struct nfi_local_server * priv = (struct nfi_local_server * ) serv->private_info;
-               priv->private_info_server = aux_private_info;
+   // Connections of the pool closed when the server was idle (the ones the server does not accept are dropped)
+   int nfi_xpn_server_streams_reconnect(struct nfi_server * serv)
+   {
+       int i, n;
+       struct nfi_xpn_server * server_aux;
 
-               if (serv->keep_connected == 0) {
-                   nfi_xpn_server_disconnect(serv);
-               }
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
 
-               return ret;
+       pthread_mutex_lock(&(server_aux->m_streams));
+       n = 1;
+       for (i = 1; i < server_aux->n_streams; i++)
+       {
+           if (nfi_xpn_server_comm_connect(server_aux->streams[i]) < 0) {
+               FREE_AND_NULL(server_aux->streams[i]);
+               continue;
            }
+
+           server_aux->streams[n] = server_aux->streams[i];
+           n++;
        }
+       server_aux->n_streams = n;
+       serv->n_streams = n;
+       pthread_mutex_unlock(&(server_aux->m_streams));
 
-       // MQTT Initialization
-       server_aux->xpn_mosquitto_mode = utils_getenv_int("XPN_MQTT", 0);
-       if (1 == server_aux->xpn_mosquitto_mode) {
-           nfi_mq_server_init(server_aux);
-       }
+       return 0;
+   }
 
-       // Initialize workers
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Initialize workers\n", serv->id);
+   // The first operation of a server with lazy connection opens its connections
+   int nfi_xpn_server_lazy_connect(struct nfi_server * serv)
+   {
+       int ret = 0;
+       struct nfi_xpn_server * server_aux;
 
-       ret = nfiworker_init(serv);
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if ((server_aux == NULL) || (__atomic_load_n(&(server_aux->lazy), __ATOMIC_ACQUIRE) == 0)) {
+           return 0;
+       }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] << End\n", serv->id);
+       pthread_mutex_lock(&(server_aux->m_lazy));
+       if (server_aux->lazy == 1)
+       {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_lazy_connect] Connect to %s\n", serv->id, server_aux->srv_name);
 
-       if (server_aux->keep_connected == 0) {
-           nfi_xpn_server_disconnect(serv);
+           ret = nfi_xpn_server_comm_connect(server_aux);
+           if ((ret >= 0) && (server_aux->streams == NULL))
+           {
+               ret = nfi_xpn_server_codec_init(serv);
+               if (ret >= 0) {
+                   ret = nfi_xpn_server_layout_init(serv);
+               }
+               if (ret >= 0) {
+                   ret = nfi_xpn_server_streams_init(serv);
+               }
+           }
+           else if (ret >= 0) {
+               ret = nfi_xpn_server_streams_reconnect(serv);
+           }
+
+           if (ret < 0) {
+               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_lazy_connect] ERROR: cannot connect to %s\n", serv->id, server_aux->srv_name);
+               serv->error = -1;
+           }
+           else {
+               __atomic_store_n(&(server_aux->lazy), 0, __ATOMIC_RELEASE);
+           }
        }
+       pthread_mutex_unlock(&(server_aux->m_lazy));
 
-       return 0;
+       return ret;
    }
 
-   int nfi_xpn_server_destroy(struct nfi_server * serv)
+   int nfi_xpn_server_keep_connected(struct nfi_server * serv)
    {
-       int ret;
        struct nfi_xpn_server * server_aux;
 
        // check params...
        if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_destroy] ERROR: serv argument is NULL\n", -1);
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_keep_connected] ERROR: serv argument is NULL\n", -1);
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] >> Begin\n", serv->id);
-
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] >> Begin\n", serv->id);
 
+       // (with m_lazy the idle reaper cannot close the connections between this point and the operation)
        server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL) {
-           return 0;
+       if ((server_aux != NULL) && (server_aux->idle_time > 0))
+       {
+           pthread_mutex_lock(&(server_aux->m_lazy));
+           __atomic_store_n(&(server_aux->last_use), time(NULL), __ATOMIC_RELAXED);
+           pthread_mutex_unlock(&(server_aux->m_lazy));
        }
 
-       // Workers destroy...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Destroy workers\n", serv->id);
-
-       nfiworker_destroy(serv);
-
-       // MQTT destroy
-       nfi_mq_server_destroy(server_aux);
-
-       // MPI Finalize...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Destroy MPI Client communication\n", serv->id);
-
-       ret = nfi_xpn_server_comm_destroy(server_aux);
-       if (ret < 0) {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] ERROR: nfi_xpn_server_comm_destroy fails\n", serv->id);
+       if (nfi_xpn_server_lazy_connect(serv) < 0) {
+           return -1;
        }
 
-       // free private_info, 'url' string and 'server' string...
-       FREE_AND_NULL(serv->ops);
-       FREE_AND_NULL(serv->private_info);
-       FREE_AND_NULL(serv->url);
-       FREE_AND_NULL(serv->server);
-       FREE_AND_NULL(serv->wrk);
+       if (serv->keep_connected == 0) {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] Server reconnect\n", 0);
+           int ret = nfi_xpn_server_reconnect(serv);
+           if (ret < 0) {
+               serv->private_info = NULL;
+               return -1;
+           }
+       }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] << End\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_keep_connected] >> End\n", serv->id);
 
-       return 0;
+       return (serv->private_info != NULL);
    }
 
-   int nfi_xpn_server_connect(struct nfi_server * serv, __attribute__((__unused__)) char * url, __attribute__((__unused__)) char * prt, char * server, __attribute__((__unused__)) char * dir)
+   // Idle reaper: one thread of the client closes the connections of the servers not used for a while,
+   // they go back to the lazy state and the next operation connects again
+   static pthread_mutex_t    nfi_xpn_server_idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+   static pthread_cond_t     nfi_xpn_server_idle_cond  = PTHREAD_COND_INITIALIZER;
+   static struct nfi_server *nfi_xpn_server_idle_list  = NULL;
+   static pthread_t          nfi_xpn_server_idle_th;
+   static int                nfi_xpn_server_idle_run   = 0;
+
+   void nfi_xpn_server_idle_reclaim(struct nfi_server * serv)
    {
-       int ret;
+       int i, busy;
        struct nfi_xpn_server * server_aux;
 
-       // check params...
-       if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv argument is NULL\n", -1);
-           return -1;
-       }
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] >> Begin\n", serv->id);
-
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] Get server private info\n", serv->id);
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
 
-       server_aux = (struct nfi_xpn_server * )(serv->private_info);
-       if (server_aux == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv->private_info is NULL\n", serv->id);
-           return -1;
+       // a server being connected or starting an operation is not idle
+       if (pthread_mutex_trylock(&(server_aux->m_lazy)) != 0) {
+           return;
        }
 
-       // Copy server name
-       strcpy(server_aux->srv_name, server);
+       if ((server_aux->lazy == 0) && (server_aux->streams != NULL))
+       {
+           pthread_mutex_lock(&(server_aux->m_streams));
+           busy = (time(NULL) - __atomic_load_n(&(server_aux->last_use), __ATOMIC_RELAXED) < server_aux->idle_time);
+           for (i = 0; i < server_aux->n_streams; i++) {
+               busy = busy || server_aux->streams[i]->in_use;
+           }
+           if (! busy) {
+               __atomic_store_n(&(server_aux->lazy), 1, __ATOMIC_RELEASE);
+           }
+           pthread_mutex_unlock(&(server_aux->m_streams));
 
-       // MPI Connection...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] XPN server connection\n", serv->id);
+           if (! busy)
+           {
+               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_idle_reclaim] Disconnect idle %s\n", serv->id, server_aux->srv_name);
 
-       ret = nfi_xpn_server_comm_connect(server_aux);
-       if (ret < 0) {
-           return -1;
+               for (i = 1; i < server_aux->n_streams; i++) {
+                   nfi_xpn_server_comm_disconnect(server_aux->streams[i]);
+               }
+               nfi_xpn_server_comm_disconnect(server_aux);
+           }
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] << End\n", serv->id);
-
-       return 0;
+       pthread_mutex_unlock(&(server_aux->m_lazy));
    }
 
-   int nfi_xpn_server_disconnect(struct nfi_server * serv)
+   void * nfi_xpn_server_idle_reaper(__attribute__((__unused__)) void * arg)
    {
-       int ret;
-       struct nfi_xpn_server * server_aux;
+       int period, p;
+       struct timespec ts;
+       struct nfi_server * serv;
 
-       // check params...
-       if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] ERROR: serv argument is NULL\n", -1);
-           return -1;
+       pthread_mutex_lock(&nfi_xpn_server_idle_mutex);
+       while (nfi_xpn_server_idle_run)
+       {
+           // look at the servers twice per idle time (the shortest one)
+           period = 0;
+           for (serv = nfi_xpn_server_idle_list; serv != NULL; serv = ((struct nfi_xpn_server * ) serv->private_info)->idle_next)
+           {
+               p = ((struct nfi_xpn_server * ) serv->private_info)->idle_time / 2;
+               if ((period == 0) || (p < period)) {
+                   period = p;
+               }
+           }
+           if (period < 1) {
+               period = 1;
+           }
+
+           clock_gettime(CLOCK_REALTIME, &ts);
+           ts.tv_sec = ts.tv_sec + period;
+           pthread_cond_timedwait(&nfi_xpn_server_idle_cond, &nfi_xpn_server_idle_mutex, &ts);
+
+           for (serv = nfi_xpn_server_idle_list; serv != NULL; serv = ((struct nfi_xpn_server * ) serv->private_info)->idle_next) {
+               nfi_xpn_server_idle_reclaim(serv);
+           }
        }
+       pthread_mutex_unlock(&nfi_xpn_server_idle_mutex);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] >> Begin\n", serv->id);
+       return NULL;
+   }
 
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] Get server private info\n", serv->id);
+   void nfi_xpn_server_idle_register(struct nfi_server * serv)
+   {
+       struct nfi_xpn_server * server_aux;
 
        server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv->private_info is NULL\n", serv->id);
-           return 0;
-       }
 
-       // XPN Disconnect...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] XPN server disconnect\n", serv->id);
+       pthread_mutex_lock(&nfi_xpn_server_idle_mutex);
+       server_aux->idle_next = nfi_xpn_server_idle_list;
+       nfi_xpn_server_idle_list = serv;
 
-       ret = nfi_xpn_server_comm_disconnect(server_aux);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] ERROR: nfi_xpn_server_comm_disconnect fails\n", serv->id);
+       if (nfi_xpn_server_idle_run == 0)
+       {
+           nfi_xpn_server_idle_run = 1;
+           if (pthread_create(&nfi_xpn_server_idle_th, NULL, nfi_xpn_server_idle_reaper, NULL) != 0) {
+               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_idle_register] ERROR: idle connections will not be closed\n", serv->id);
+               nfi_xpn_server_idle_run = 0;
+           }
        }
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] << End\n", serv->id);
-
-       return 0;
+       pthread_mutex_unlock(&nfi_xpn_server_idle_mutex);
    }
 
-   int nfi_xpn_server_reconnect(struct nfi_server * serv)
+   void nfi_xpn_server_idle_unregister(struct nfi_server * serv)
    {
-       int ret;
+       int stop = 0;
+       pthread_t th;
+       struct nfi_server ** p;
 
-       // check params...
-       if (serv == NULL) {
-           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_reconnect] ERROR: serv argument is NULL\n", -1);
-           errno = EINVAL;
-           return -1;
+       pthread_mutex_lock(&nfi_xpn_server_idle_mutex);
+       for (p = &nfi_xpn_server_idle_list; *p != NULL; p = &(((struct nfi_xpn_server * ) (*p)->private_info)->idle_next))
+       {
+           if (*p == serv) {
+               *p = ((struct nfi_xpn_server * ) serv->private_info)->idle_next;
+               break;
+           }
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] >> Begin\n", serv->id);
+       // the last server stops the reaper
+       if ((nfi_xpn_server_idle_list == NULL) && (nfi_xpn_server_idle_run == 1))
+       {
+           nfi_xpn_server_idle_run = 0;
+           th = nfi_xpn_server_idle_th;
+           stop = 1;
+           pthread_cond_signal(&nfi_xpn_server_idle_cond);
+       }
+       pthread_mutex_unlock(&nfi_xpn_server_idle_mutex);
 
-       // reconnect...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] XPN server reconnection\n", serv->id);
+       if (stop) {
+           pthread_join(th, NULL);
+       }
+   }
 
-       ret = nfi_xpn_server_comm_connect(serv->private_info);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] ERROR: nfi_xpn_server_comm_connect fails\n", serv->id);
-           return -1;
+   void nfi_xpn_server_streams_destroy(struct nfi_xpn_server * server_aux)
+   {
+       if (server_aux->streams == NULL) {
+           return;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] << End\n", serv->id);
+       for (int i = 1; i < server_aux->n_streams; i++) {
+           FREE_AND_NULL(server_aux->streams[i]);
+       }
+       FREE_AND_NULL(server_aux->streams);
+       server_aux->n_streams = 0;
 
-       return 0;
+       pthread_cond_destroy(&(server_aux->c_streams));
+       pthread_mutex_destroy(&(server_aux->m_streams));
    }
 
-   // File API
-   int nfi_xpn_server_open(struct nfi_server * serv, char * url, int flags, mode_t mode, struct nfi_fhandle * fho)
+   int nfi_xpn_server_stream_get(struct nfi_server * serv)
    {
-       int ret;
-       char dir[PATH_MAX], server[PATH_MAX], protocol[PATH_MAX];
+       int i, best;
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
-       struct st_xpn_server_msg msg;
-       struct st_xpn_server_status status;
-
-       // Check arguments...
-       NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fho, EINVAL);
-       nfi_xpn_server_keep_connected(serv);
-       NULL_RET_ERR(serv->private_info, EINVAL);
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] >> Begin\n", serv->id);
-
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] Get server private info\n", serv->id);
+       struct nfi_xpn_server * stream;
 
        server_aux = (struct nfi_xpn_server * ) serv->private_info;
        if (server_aux == NULL) {
-           errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: NULL serv->private_info.\n", serv->id);
-           goto nfi_xpn_server_open_KO;
+           return -1;
        }
 
-       // from url->protocol + server + dir
-       ret = ParseURL(url, protocol, NULL, NULL, server, NULL, dir);
-       if (ret < 0) {
-           errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: incorrect url '%s'.\n", serv->id, url);
-           goto nfi_xpn_server_open_KO;
+       // (the idle reaper may close the connections until one of them is taken)
+       while (1)
+       {
+           if (nfi_xpn_server_lazy_connect(serv) < 0) {
+               return -1;
+           }
+           if (server_aux->streams == NULL) {
+               return -1;
+           }
+
+           pthread_mutex_lock(&(server_aux->m_streams));
+           if (__atomic_load_n(&(server_aux->lazy), __ATOMIC_ACQUIRE) == 0) {
+               break;
+           }
+           pthread_mutex_unlock(&(server_aux->m_streams));
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+       // Wait for an idle connection, the least used one first
+       best = -1;
+       while (best < 0)
+       {
+           for (i = 0; i < server_aux->n_streams; i++)
+           {
+               stream = server_aux->streams[i];
+               if ((stream->in_use == 0) && ((best < 0) || (stream->n_ops < server_aux->streams[best]->n_ops))) {
+                   best = i;
+               }
+           }
 
-       // Copy .url field
-       fho->url = strdup(url);
-       NULL_RET_ERR(fho->url, ENOMEM);
+           if (best < 0) {
+               pthread_cond_wait(&(server_aux->c_streams), &(server_aux->m_streams));
+           }
+       }
 
-       // Set .has_mqtt field
-       if (strcasecmp(protocol, "mq_server") == 0)
-           fho->has_mqtt = 1;
-       else fho->has_mqtt = 0;
+       stream = server_aux->streams[best];
+       stream->in_use = 1;
+       stream->owner = pthread_self();
+       stream->n_ops++;
+       pthread_mutex_unlock(&(server_aux->m_streams));
 
-       fh_aux = (struct nfi_xpn_server_fhandle * ) malloc(sizeof(struct nfi_xpn_server_fhandle));
-       NULL_RET_ERR(fh_aux, ENOMEM);
-       bzero(fh_aux, sizeof(struct nfi_xpn_server_fhandle));
+       return best;
+   }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] nfi_xpn_server_open(%s)\n", serv->id, dir);
+   void nfi_xpn_server_stream_put(struct nfi_server * serv)
+   {
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server * stream;
 
-       int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_open.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_open.path, XPN_PATH_MAX);
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if ((server_aux == NULL) || (server_aux->streams == NULL)) {
+           return;
+       }
 
-       if (dir_len < XPN_PATH_MAX)
+       pthread_mutex_lock(&(server_aux->m_streams));
+       for (int i = 0; i < server_aux->n_streams; i++)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, dir_len);
-           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
+           stream = server_aux->streams[i];
+           if ((stream->in_use == 1) && pthread_equal(stream->owner, pthread_self())) {
+               stream->in_use = 0;
+               break;
+           }
        }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, XPN_PATH_MAX);
-           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
+       if (server_aux->idle_time > 0) {
+           __atomic_store_n(&(server_aux->last_use), time(NULL), __ATOMIC_RELAXED);
        }
+       pthread_cond_signal(&(server_aux->c_streams));
+       pthread_mutex_unlock(&(server_aux->m_streams));
+   }
 
-       msg.type = XPN_SERVER_OPEN_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, PATH_MAX - 1);
-       msg.u_st_xpn_server_msg.op_open.flags = flags;
-       msg.u_st_xpn_server_msg.op_open.mode = mode;
-       msg.u_st_xpn_server_msg.op_open.xpn_session = serv->xpn_session_file;
-       msg.u_st_xpn_server_msg.op_open.file_type = fho->has_mqtt;
+   struct nfi_xpn_server * nfi_xpn_server_stream(struct nfi_server * serv)
+   {
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server * stream;
 
+       // The connection taken by this thread or the first one
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if ((server_aux == NULL) || (__atomic_load_n(&(server_aux->lazy), __ATOMIC_ACQUIRE) == 1) || (server_aux->n_streams <= 1)) {
+           return server_aux;
+       }
 
-       if (dir_len >= XPN_PATH_MAX)
+       stream = server_aux;
+       pthread_mutex_lock(&(server_aux->m_streams));
+       for (int i = 0; i < server_aux->n_streams; i++)
        {
-           ret = nfi_write_operation(server_aux, & msg);
-           if (ret < 0) {
-               return -1;
+           if ((server_aux->streams[i]->in_use == 1) && pthread_equal(server_aux->streams[i]->owner, pthread_self())) {
+               stream = server_aux->streams[i];
+               break;
            }
+       }
+       pthread_mutex_unlock(&(server_aux->m_streams));
 
-           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
-               return -1;
+       return stream;
+   }
+
+   void nfi_2_xpn_attr(struct stat * att, struct nfi_attr * nfi_att)
+   {
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_2_xpn_attr] >> Begin\n", -1);
+
+       att->st_dev = nfi_att->st_dev;
+       att->st_ino = nfi_att->st_ino;
+
+       if (nfi_att->at_type == NFIFILE) {
+           att->st_mode = nfi_att->at_mode | S_IFREG; // protection
+       }
+
+       if (nfi_att->at_type == NFIDIR) {
+           att->st_mode = nfi_att->at_mode | S_IFDIR; // protection
+       }
+
+       att->st_nlink = nfi_att->at_nlink; // number of hard links
+       att->st_uid = nfi_att->at_uid; // user ID of owner
+       att->st_gid = nfi_att->at_gid; // group ID of owner
+       att->st_size = nfi_att->at_size; // size
+       att->st_blksize = nfi_att->at_blksize; // blocksize for filesystem I/O
+       att->st_blocks = nfi_att->at_blocks; // number of blocks allocated
+       att->st_atime = nfi_att->at_atime; // time of last access
+       att->st_mtime = nfi_att->at_mtime; // time of last modification
+       att->st_ctime = nfi_att->at_ctime; // time of last change
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_2_xpn_attr] >> End\n", -1);
+   }
+
+   void xpn_2_nfi_attr(struct nfi_attr * nfi_att, struct stat * att)
+   {
+       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_attr] >> Begin\n", -1);
+
+       nfi_att->st_dev = att->st_dev;
+       nfi_att->st_ino = att->st_ino;
+
+       if (S_ISREG(att->st_mode)) {
+           nfi_att->at_type = NFIFILE;
+       }
+       if (S_ISDIR(att->st_mode)) {
+           nfi_att->at_type = NFIDIR;
+       }
+
+       nfi_att->at_mode = att->st_mode & (S_IRWXU | S_IRWXG | S_IRWXO); // protection
+       nfi_att->at_nlink = att->st_nlink; // number of hard links
+       nfi_att->at_uid = att->st_uid; // user ID of owner
+       nfi_att->at_gid = att->st_gid; // group ID of owner
+       nfi_att->at_size = att->st_size; // total size, in bytes
+       nfi_att->at_blksize = att->st_blksize; // blocksize for filesystem I/O
+       nfi_att->at_blocks = att->st_blocks; // number of blocks allocated
+       nfi_att->at_atime = att->st_atime; // time of last access
+       nfi_att->at_mtime = att->st_mtime; // time of last modification
+       nfi_att->at_ctime = att->st_ctime; // time of last change
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_attr] >> End\n", -1);
+   }
+
+   void xpn_2_nfi_info(__attribute__((__unused__)) struct nfi_info * nfi_inf, __attribute__((__unused__)) struct nfi_info * xpn_inf)
+   {
+       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_info] >> Begin\n", -1);
+
+       //TODO
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [xpn_2_nfi_info] >> End\n", -1);
+   }
+
+
+/* ... Functions / Funciones ......................................... */
+
+   int nfi_xpn_server_init(char * url, struct nfi_server * serv, int server_type)
+   {
+       int ret;
+       char server[PATH_MAX], dir[PATH_MAX], prt[PATH_MAX];
+       struct nfi_xpn_server * server_aux;
+       char hostname[HOST_NAME_MAX];
+       char hostip[HOST_NAME_MAX];
+
+       // check params...
+       if (serv == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_init] ERROR: serv argument is NULL\n", -1);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] >> Begin\n", serv->id);
+
+       // new nfi_ops with xpn functions...
+       serv->ops = (struct nfi_ops * ) malloc(sizeof(struct nfi_ops));
+       NULL_RET_ERR(serv->ops, ENOMEM);
+
+       // Fill serv->ops...
+       bzero(serv->ops, sizeof(struct nfi_ops));
+       serv->ops->nfi_reconnect = nfi_xpn_server_reconnect;
+       serv->ops->nfi_disconnect = nfi_xpn_server_disconnect;
+       serv->ops->nfi_destroy = nfi_xpn_server_destroy;
+
+       serv->ops->nfi_open = nfi_xpn_server_open;
+       serv->ops->nfi_create = nfi_xpn_server_create;
+       serv->ops->nfi_read = nfi_xpn_server_read;
+       serv->ops->nfi_write = nfi_xpn_server_write;
+       serv->ops->nfi_readv = nfi_xpn_server_readv;
+       serv->ops->nfi_writev = nfi_xpn_server_writev;
+       serv->ops->nfi_close = nfi_xpn_server_close;
+       serv->ops->nfi_remove = nfi_xpn_server_remove;
+       serv->ops->nfi_rename = nfi_xpn_server_rename;
+       serv->ops->nfi_getattr = nfi_xpn_server_getattr;
+       serv->ops->nfi_setattr = nfi_xpn_server_setattr;
+
+       serv->ops->nfi_opendir = nfi_xpn_server_opendir;
+       serv->ops->nfi_mkdir = nfi_xpn_server_mkdir;
+       serv->ops->nfi_readdir = nfi_xpn_server_readdir;
+       serv->ops->nfi_closedir = nfi_xpn_server_closedir;
+       serv->ops->nfi_rmdir = nfi_xpn_server_rmdir;
+       serv->ops->nfi_mkdir_p = nfi_xpn_server_mkdir_p;
+       serv->ops->nfi_rmtree = nfi_xpn_server_rmtree;
+       serv->ops->nfi_walk = nfi_xpn_server_walk;
+       serv->ops->nfi_summarize = nfi_xpn_server_summarize;
+
+       serv->ops->nfi_statfs = nfi_xpn_server_statfs;
+
+       serv->ops->nfi_write_mdata = nfi_xpn_server_write_mdata;
+       serv->ops->nfi_read_mdata = nfi_xpn_server_read_mdata;
+
+       serv->ops->nfi_stream_get = nfi_xpn_server_stream_get;
+       serv->ops->nfi_stream_put = nfi_xpn_server_stream_put;
+
+       // parse url...
+       ret = ParseURL(url, prt, NULL, NULL, server, NULL, dir);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ERROR: incorrect url '%s'.\n", serv->id, url);
+           FREE_AND_NULL(serv->ops);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+
+       // new nfi_XPNserver...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Copy nfi_xpn_server structure\n", serv->id);
+
+       server_aux = (struct nfi_xpn_server * ) malloc(sizeof(struct nfi_xpn_server));
+       if (server_aux == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] ERROR: out of memory.\n", serv->id);
+           FREE_AND_NULL(serv->ops);
+           return -1;
+       }
+
+       // private_info...
+       serv->private_info = (void * ) server_aux;
+
+       // Initialize params
+       memset(server_aux, 0, sizeof(struct nfi_xpn_server));
+       server_aux->server_type = server_type;
+
+       // thread mode
+       serv->xpn_thread = utils_getenv_int("XPN_THREAD", TH_NOT);
+       server_aux->xpn_thread = serv->xpn_thread;
+
+       // keep connection between operations
+       int keep_connection = utils_getenv_int("XPN_CONNECTED", 1);
+       if ((keep_connection < 0) || (keep_connection > 1)) {
+           debug_info("ERROR: unknown keep-connection value. Default value 1 selected\n");
+           keep_connection = 1;
+       }
+       serv->keep_connected = keep_connection;
+       server_aux->keep_connected = keep_connection;
+
+       // wait for a server at its connection limit
+       server_aux->busy_wait = utils_getenv_int("XPN_CONNECT_BUSY_WAIT", XPN_CONNECT_DEFAULT_BUSY_WAIT);
+
+       // session mode
+       serv->xpn_session_file = utils_getenv_int("XPN_SESSION_FILE", 0);
+       serv->xpn_session_dir = utils_getenv_int("XPN_SESSION_DIR", 1);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Thread mode: %d\n", serv->id, serv->xpn_thread);
+
+       // Locality mode
+       server_aux->xpn_locality = utils_getenv_int("XPN_LOCALITY", 1);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Locality enable: %d\n", serv->id, server_aux->xpn_locality);
+
+       // Short-circuit local reads (only when locality does not replace the server)
+       server_aux->short_circuit = utils_getenv_int("XPN_SHORT_CIRCUIT", 0);
+       server_aux->sc_header = -1;
+
+       // Shared memory with a server on the same node
+       int xpn_shm = utils_getenv_int("XPN_SHM", 1);
+       #ifdef ENABLE_SCK_SERVER
+       server_aux->server_shm = NULL;
+       #endif
+
+       // Check locality
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Data locality\n", serv->id);
+
+       if ((server_aux->xpn_locality == 1) || (server_aux->short_circuit == 1) || (xpn_shm == 1)) {
+           ns_get_host_ip(hostip, HOST_NAME_MAX);
+           ns_get_hostname(hostname);
+           server_aux->locality = (strstr(server, hostip) != NULL || strstr(server, hostname) != NULL);
+       }
+       if (server_aux->locality == 0) {
+           server_aux->short_circuit = 0;
+       }
+
+       // (it falls back to the socket if the server cannot map the channel)
+       if ((xpn_shm == 1) && (server_aux->locality == 1) && (server_aux->server_type == XPN_SERVER_TYPE_SCK) && (server_aux->keep_connected == 1)) {
+           server_aux->server_type = XPN_SERVER_TYPE_SHM;
+       }
+
+       // Initialize XPN Client communication side...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Initialize XPN Client communication side\n", serv->id);
+
+       ret = nfi_xpn_server_comm_init(server_aux);
+       if (ret < 0) {
+           FREE_AND_NULL(serv->ops);
+           FREE_AND_NULL(server_aux);
+           return -1;
+       }
+
+       // copy 'url' string...
+       serv->url = strdup(url);
+       NULL_RET_ERR(serv->url, ENOMEM);
+
+       // new server wrk...
+       serv->wrk = (struct nfi_worker * ) malloc(sizeof(struct nfi_worker));
+       memset(serv->wrk, 0, sizeof(struct nfi_worker));
+       serv->wrk->server = serv;
+
+       // Server conection
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Server connection\n", serv->id);
+
+       if (server_aux->keep_connected == 0) {
+           // lookup port_name
+           ret = sersoc_lookup_port_name(server, server_aux->port_name, SOCKET_ACCEPT_CODE_SCK_NO_CONN);
+           if (ret < 0) {
+               fprintf(stderr, "nfi_sck_server_comm_lookup_port_name: error on '%s'\n", server_aux->srv_name);
+               return -1;
+           }
+       }
+
+       // Lazy connection: only servers kept connected by sockets (a server in this node is used now by locality)
+       pthread_mutex_init(&(server_aux->m_lazy), NULL);
+       server_aux->lazy = utils_getenv_int("XPN_CONNECT_LAZY", 0);
+       if ((server_aux->lazy != 1) || (server_aux->keep_connected == 0) || (server_aux->server_type == XPN_SERVER_TYPE_MPI) ||
+           ((server_aux->xpn_locality == 1) && (server_aux->locality == 1))) {
+           server_aux->lazy = 0;
+       }
+
+       if (server_aux->lazy == 1)
+       {
+           strcpy(server_aux->srv_name, server);
+           #ifdef ENABLE_SCK_SERVER
+           server_aux->server_socket = -1;
+           #endif
+       }
+       else
+       {
+           ret = nfi_xpn_server_connect(serv, url, prt, server, dir);
+           if (ret >= 0) {
+               ret = nfi_xpn_server_layout_init(serv);
+           }
+           if (ret < 0) {
+               pthread_mutex_destroy(&(server_aux->m_lazy));
+               FREE_AND_NULL(serv->ops);
+               FREE_AND_NULL(server_aux);
+               return -1;
+           }
+       }
+
+       if (server_aux->xpn_locality == 1) {
+           if (server_aux->locality == 1) {
+               XPN_DEBUG("Locality in serv_url: %s client: %s hostname: %s", server, hostip, hostname);
+
+               // free private_info, 'url' string and 'server' string...
+               FREE_AND_NULL(serv->ops);
+               void * aux_private_info = serv->private_info;
+
+               ret = nfi_local_init(url, serv, NULL);
+               struct nfi_local_server * priv = (struct nfi_local_server * ) serv->private_info;
+               priv->private_info_server = aux_private_info;
+
+               if (serv->keep_connected == 0) {
+                   nfi_xpn_server_disconnect(serv);
+               }
+
+               return ret;
+           }
+       }
+
+       // MQTT Initialization
+       server_aux->xpn_mosquitto_mode = utils_getenv_int("XPN_MQTT", 0);
+       if (1 == server_aux->xpn_mosquitto_mode) {
+           nfi_mq_server_init(server_aux);
+       }
+
+       if (server_aux->lazy == 0)
+       {
+           // Compression (only for sockets kept connected, the server may say no)
+           ret = nfi_xpn_server_codec_init(serv);
+           if (ret < 0) {
+               return -1;
+           }
+
+           // Connection pool
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Connection pool\n", serv->id);
+
+           ret = nfi_xpn_server_streams_init(serv);
+           if (ret < 0) {
+               return -1;
+           }
+       }
+
+       // Idle connections: closed by the idle reaper and opened again by the next operation
+       server_aux->idle_time = utils_getenv_int("XPN_CONNECT_IDLE", XPN_CONNECT_DEFAULT_IDLE);
+       if ((server_aux->idle_time < 0) || (server_aux->keep_connected == 0) || (server_aux->server_type == XPN_SERVER_TYPE_MPI) ||
+           (server_aux->xpn_mosquitto_mode == 1)) {
+           server_aux->idle_time = 0;
+       }
+       server_aux->last_use = time(NULL);
+       if (server_aux->idle_time > 0) {
+           nfi_xpn_server_idle_register(serv);
+       }
+
+       // Initialize workers
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] Initialize workers\n", serv->id);
+
+       ret = nfiworker_init(serv);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_init] << End\n", serv->id);
+
+       if (server_aux->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return 0;
+   }
+
+   int nfi_xpn_server_destroy(struct nfi_server * serv)
+   {
+       int ret;
+       struct nfi_xpn_server * server_aux;
+
+       // check params...
+       if (serv == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_destroy] ERROR: serv argument is NULL\n", -1);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] >> Begin\n", serv->id);
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Get server private info\n", serv->id);
+
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if (server_aux == NULL) {
+           return 0;
+       }
+
+       // Workers destroy...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Destroy workers\n", serv->id);
+
+       nfiworker_destroy(serv);
+
+       // MQTT destroy
+       nfi_mq_server_destroy(server_aux);
+
+       // Connection pool destroy
+       if (server_aux->idle_time > 0) {
+           nfi_xpn_server_idle_unregister(serv);
+           server_aux->idle_time = 0;
+       }
+       nfi_xpn_server_streams_destroy(server_aux);
+       pthread_mutex_destroy(&(server_aux->m_lazy));
+
+       // MPI Finalize...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] Destroy MPI Client communication\n", serv->id);
+
+       ret = nfi_xpn_server_comm_destroy(server_aux);
+       if (ret < 0) {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] ERROR: nfi_xpn_server_comm_destroy fails\n", serv->id);
+       }
+
+       // free private_info, 'url' string and 'server' string...
+       FREE_AND_NULL(serv->ops);
+       FREE_AND_NULL(serv->private_info);
+       FREE_AND_NULL(serv->url);
+       FREE_AND_NULL(serv->server);
+       FREE_AND_NULL(serv->wrk);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_destroy] << End\n", serv->id);
+
+       return 0;
+   }
+
+   int nfi_xpn_server_connect(struct nfi_server * serv, __attribute__((__unused__)) char * url, __attribute__((__unused__)) char * prt, char * server, __attribute__((__unused__)) char * dir)
+   {
+       int ret;
+       struct nfi_xpn_server * server_aux;
+
+       // check params...
+       if (serv == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv argument is NULL\n", -1);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] >> Begin\n", serv->id);
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] Get server private info\n", serv->id);
+
+       server_aux = (struct nfi_xpn_server * )(serv->private_info);
+       if (server_aux == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv->private_info is NULL\n", serv->id);
+           return -1;
+       }
+
+       // Copy server name
+       strcpy(server_aux->srv_name, server);
+
+       // MPI Connection...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] XPN server connection\n", serv->id);
+
+       ret = nfi_xpn_server_comm_connect(server_aux);
+       if (ret < 0) {
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_connect] << End\n", serv->id);
+
+       return 0;
+   }
+
+   int nfi_xpn_server_disconnect(struct nfi_server * serv)
+   {
+       int ret;
+       struct nfi_xpn_server * server_aux;
+
+       // check params...
+       if (serv == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] ERROR: serv argument is NULL\n", -1);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] >> Begin\n", serv->id);
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] Get server private info\n", serv->id);
+
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       if (server_aux == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_connect] ERROR: serv->private_info is NULL\n", serv->id);
+           return 0;
+       }
+
+       // the idle reaper does not look at it any more
+       if (server_aux->idle_time > 0) {
+           nfi_xpn_server_idle_unregister(serv);
+           server_aux->idle_time = 0;
+       }
+
+       // never connected (or closed as idle)
+       if (server_aux->lazy == 1) {
+           return 0;
+       }
+
+       // XPN Disconnect...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] XPN server disconnect\n", serv->id);
+
+       ret = nfi_xpn_server_comm_disconnect(server_aux);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] ERROR: nfi_xpn_server_comm_disconnect fails\n", serv->id);
+       }
+
+       for (int i = 1; i < server_aux->n_streams; i++)
+       {
+           ret = nfi_xpn_server_comm_disconnect(server_aux->streams[i]);
+           if (ret < 0) {
+               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] ERROR: nfi_xpn_server_comm_disconnect fails\n", serv->id);
+           }
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_disconnect] << End\n", serv->id);
+
+       return 0;
+   }
+
+   int nfi_xpn_server_reconnect(struct nfi_server * serv)
+   {
+       int ret;
+
+       // check params...
+       if (serv == NULL) {
+           debug_info("[SERV_ID=%d] [NFI_n] [nfi_xpn_server_reconnect] ERROR: serv argument is NULL\n", -1);
+           errno = EINVAL;
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] >> Begin\n", serv->id);
+
+       // reconnect...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] XPN server reconnection\n", serv->id);
+
+       ret = nfi_xpn_server_comm_connect(serv->private_info);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] ERROR: nfi_xpn_server_comm_connect fails\n", serv->id);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_reconnect] << End\n", serv->id);
+
+       return 0;
+   }
+
+   // File API
+   int nfi_xpn_server_open(struct nfi_server * serv, char * url, int flags, mode_t mode, struct nfi_fhandle * fho)
+   {
+       int ret;
+       char dir[PATH_MAX], server[PATH_MAX], protocol[PATH_MAX];
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fho, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] >> Begin\n", serv->id);
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] Get server private info\n", serv->id);
+
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL) {
+           errno = EINVAL;
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: NULL serv->private_info.\n", serv->id);
+           goto nfi_xpn_server_open_KO;
+       }
+
+       // from url->protocol + server + dir
+       ret = ParseURL(url, protocol, NULL, NULL, server, NULL, dir);
+       if (ret < 0) {
+           errno = EINVAL;
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: incorrect url '%s'.\n", serv->id, url);
+           goto nfi_xpn_server_open_KO;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+
+       // Copy .url field
+       fho->url = strdup(url);
+       NULL_RET_ERR(fho->url, ENOMEM);
+
+       // Set .has_mqtt field
+       if (strcasecmp(protocol, "mq_server") == 0)
+           fho->has_mqtt = 1;
+       else fho->has_mqtt = 0;
+
+       fh_aux = (struct nfi_xpn_server_fhandle * ) malloc(sizeof(struct nfi_xpn_server_fhandle));
+       NULL_RET_ERR(fh_aux, ENOMEM);
+       bzero(fh_aux, sizeof(struct nfi_xpn_server_fhandle));
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] nfi_xpn_server_open(%s)\n", serv->id, dir);
+
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_open.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_open.path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, dir_len);
+           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, XPN_PATH_MAX);
+           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
+       }
+
+       msg.type = XPN_SERVER_OPEN_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_open.path, dir, 0, PATH_MAX - 1);
+       msg.u_st_xpn_server_msg.op_open.flags = flags;
+       msg.u_st_xpn_server_msg.op_open.mode = mode;
+       msg.u_st_xpn_server_msg.op_open.xpn_session = serv->xpn_session_file;
+       msg.u_st_xpn_server_msg.op_open.file_type = fho->has_mqtt;
+
+
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           ret = nfi_write_operation(server_aux, & msg);
+           if (ret < 0) {
+               return -1;
+           }
+
+           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+               return -1;
+            }
+
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
+           }
+       }
+       else
+       {
+           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+       }
+
+       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+       if (status.ret < 0) {
+           errno = status.server_errno;
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: remote open fails to open '%s' in server %s.\n", serv->id, dir, serv->server);
+           FREE_AND_NULL(fh_aux);
+           FREE_AND_NULL(fho->url);
+           goto nfi_xpn_server_open_KO;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] nfi_xpn_server_open(%s)\n", serv->id, dir);
+
+       memccpy(fh_aux->path, dir, 0, PATH_MAX - 1);
+       fh_aux->fd = status.ret;
+       fh_aux->sc_fd = -1;
+
+       fho->type = NFIFILE;
+       fho->priv_fh = NULL;
+       fho->server = serv;
+       fho->priv_fh = (void * ) fh_aux;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] >> End\n", serv->id);
+
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+       return 0;
+
+nfi_xpn_server_open_KO:
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return -1;
+   }
+
+   int nfi_xpn_server_create(struct nfi_server * serv, char * url, mode_t mode, __attribute__((__unused__)) struct nfi_attr * attr, struct nfi_fhandle * fh)
+   {
+       //NOTE: actually creat is not in use, it use like POSIX open(path, O_WRONLY|O_CREAT|O_TRUNC, mode);
+       return nfi_xpn_server_open(serv, url, O_WRONLY | O_CREAT | O_TRUNC, mode, fh);
+   }
+
+   /*
+    * Short-circuit read of a file whose server runs on this node: the data file is read
+    * directly with the server path. The header bytes that the server does not keep in its
+    * data files (metadata index) come from the layout the server reported at connection.
+    * Returns -2 when the server has to do the read.
+    */
+   static ssize_t nfi_xpn_server_read_local(struct nfi_server * serv, struct nfi_fhandle * fh, void * buffer, off_t offset, size_t size)
+   {
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       ssize_t ret;
+       int fd;
+
+       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+
+       if ((fh_aux->sc_fd == -2) || (server_aux->sc_header < 0) || (offset < XPN_HEADER_SIZE) || (fh->has_mqtt)) {
+           return -2;
+       }
+
+       // open the data file once per file handle
+       fd = fh_aux->sc_fd;
+       if (fd < 0)
+       {
+           fd = open(fh_aux->path, O_RDONLY);
+           if (fd < 0) {
+               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read_local] open(%s) fails, reading through the server\n", serv->id, fh_aux->path);
+               __sync_bool_compare_and_swap(&(fh_aux->sc_fd), -1, -2);
+               return -2;
+           }
+           if (!__sync_bool_compare_and_swap(&(fh_aux->sc_fd), -1, fd)) {
+               close(fd);
+               fd = fh_aux->sc_fd;
+               if (fd < 0) {
+                   return -2;
+               }
+           }
+       }
+
+       ret = pread(fd, buffer, size, offset - server_aux->sc_header);
+       if (ret < 0) {
+           return -2;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read_local] pread(%s, %ld, %ld)=%ld\n", serv->id, fh_aux->path, offset, size, ret);
+
+       return ret;
+   }
+
+   ssize_t nfi_xpn_server_read(struct nfi_server * serv, struct nfi_fhandle * fh, void * buffer, off_t offset, size_t size)
+   {
+       int ret, cont, diff, codec;
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_rw_req req;
+       char * zbuffer = NULL;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fh, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] >> Begin\n", serv->id);
+
+       // short-circuit read from the local data file
+       if (((struct nfi_xpn_server * ) serv->private_info)->short_circuit == 1)
+       {
+           ssize_t ret_local = nfi_xpn_server_read_local(serv, fh, buffer, offset, size);
+           if (ret_local != -2) {
+               if (serv->keep_connected == 0) {
+                   nfi_xpn_server_disconnect(serv);
+               }
+               return ret_local;
+           }
+       }
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] Get server private info\n", serv->id);
+
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL) {
+           errno = EINVAL;
+           goto nfi_xpn_server_read_KO;
+       }
+
+       // private_info file handle
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+
+       int dir_len = strlen(fh_aux->path);
+       msg.u_st_xpn_server_msg.op_read.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_read.path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, dir_len);
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, XPN_PATH_MAX);
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_read(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] xpn_read(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
+
+       // do operation
+       msg.type = XPN_SERVER_READ_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, PATH_MAX);
+       msg.u_st_xpn_server_msg.op_read.offset = offset;
+       msg.u_st_xpn_server_msg.op_read.size = size;
+       msg.u_st_xpn_server_msg.op_read.fd = fh_aux->fd;
+       msg.u_st_xpn_server_msg.op_read.xpn_session = serv->xpn_session_file;
+
+       zbuffer = nfi_xpn_server_zbuffer(server_aux, size, & codec);
+       msg.u_st_xpn_server_msg.op_read.codec = codec;
+
+       // request + path tail in one message
+       struct iovec data[1];
+       int n_data = 0;
+
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           data[n_data].iov_base = fh_aux->path + XPN_PATH_MAX;
+           data[n_data].iov_len  = dir_len - XPN_PATH_MAX;
+           n_data++;
+       }
+
+       ret = nfi_write_operation_data(server_aux, & msg, data, n_data);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_write_operation fails\n", serv->id);
+           goto nfi_xpn_server_read_KO;
+       }
+
+       // read n times: number of bytes + read data (n bytes)
+       cont = 0;
+       do
+       {
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
+           if (ret < 0) {
+               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+               goto nfi_xpn_server_read_KO;
+           }
+
+           if (req.status.ret < 0) {
+               errno = req.status.server_errno;
+               goto nfi_xpn_server_read_KO;
+           }
+
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data=%d.\n", serv->id, ret);
+
+           if (req.size > 0) {
+               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data(%ld)\n", serv->id, req.size);
+
+               ret = nfi_xpn_server_recv_chunk(server_aux, codec, (char * ) buffer + cont, req.size, zbuffer);
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+               }
+
+               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data(%ld)=%d\n", serv->id, req.size, ret);
+           }
+           cont = cont + req.size;
+           diff = msg.u_st_xpn_server_msg.op_read.size - cont;
+
+       } while ((diff > 0) && (req.size != 0));
+
+       if (req.size < 0) {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_read reads zero bytes from '%s' in server %s\n", serv->id, fh_aux->path, serv->server);
+           if (req.status.ret < 0)
+               errno = req.status.server_errno;
+
+           goto nfi_xpn_server_read_KO;
+       }
+
+       if (req.status.ret < 0) {
+           errno = req.status.server_errno;
+       }
+       ret = cont;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_read(%s, %ld, %ld)=%d\n", serv->id, fh_aux->path, offset, size, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] >> End\n", serv->id);
+
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return ret;
+
+nfi_xpn_server_read_KO:
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return -1;
+   }
+
+   ssize_t nfi_xpn_server_write(struct nfi_server * serv, struct nfi_fhandle * fh, void * buffer, off_t offset, size_t size)
+   {
+       int ret, diff, cont, codec;
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_rw_req req;
+       struct st_xpn_server_zchunk zhdr;
+       char * zbuffer = NULL;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fh, EINVAL);
+
+       server_aux = nfi_xpn_server_stream(serv);
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] >> Begin\n", serv->id);
+
+       // MQTT publish
+       if (fh->has_mqtt) {
+           return nfi_mq_server_publish(server_aux, fh_aux, buffer, offset, size);
+       }
+
+       // 0-size buffer
+       if (size == 0) {
+           return 0;
+       }
+
+       // private_info...
+       nfi_xpn_server_keep_connected(serv);
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL) {
+           errno = EINVAL;
+           goto nfi_xpn_server_write_KO;
+       }
+
+       // private_info file handle
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_write(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] xpn_write(%s, %ld, %ld)\n", serv->id, msg.u_st_xpn_server_msg.op_write.path, offset, size);
+
+       int dir_len = strlen(fh_aux->path);
+       msg.u_st_xpn_server_msg.op_write.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_write.path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, dir_len);
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, XPN_PATH_MAX);
+       }
+
+       // Do request
+       msg.type = XPN_SERVER_WRITE_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, PATH_MAX - 1);
+       msg.u_st_xpn_server_msg.op_write.offset = offset;
+       msg.u_st_xpn_server_msg.op_write.size = size;
+       msg.u_st_xpn_server_msg.op_write.fd = fh_aux->fd;
+       msg.u_st_xpn_server_msg.op_write.xpn_session = serv->xpn_session_file;
+       msg.u_st_xpn_server_msg.op_write.file_type = fh->has_mqtt;
+
+       zbuffer = nfi_xpn_server_zbuffer(server_aux, size, & codec);
+       msg.u_st_xpn_server_msg.op_write.codec = codec;
+
+       int buffer_size = size;
+
+       // Max buffer size
+       if (buffer_size > MAX_BUFFER_SIZE) {
+           buffer_size = MAX_BUFFER_SIZE;
+       }
+
+       // request + path tail + first data chunk in one message
+       struct iovec data[3];
+       int n_data = 0;
+
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           data[n_data].iov_base = fh_aux->path + XPN_PATH_MAX;
+           data[n_data].iov_len  = dir_len - XPN_PATH_MAX;
+           n_data++;
+       }
+       if (buffer_size > 0)
+       {
+           n_data = n_data + nfi_xpn_server_chunk_pack(codec, (char * ) buffer, buffer_size, zbuffer, & zhdr, data + n_data);
+       }
+
+       ret = nfi_write_operation_data(server_aux, & msg, data, n_data);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_write_operation fails\n", serv->id);
+           goto nfi_xpn_server_write_KO;
+       }
+
+       cont = buffer_size;
+       diff = size - cont;
+
+       // writes the rest n times: number of bytes + write data (n bytes)
+       while (diff > 0)
+       {
+           if (diff > buffer_size) {
+               ret = nfi_xpn_server_send_chunk(server_aux, codec, (char * ) buffer + cont, buffer_size, zbuffer);
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_write_data fails\n", serv->id);
+               }
+           } else {
+               ret = nfi_xpn_server_send_chunk(server_aux, codec, (char * ) buffer + cont, diff, zbuffer);
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_write_data fails\n", serv->id);
+               }
+           }
+
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_comm_write_data=%d.\n", serv->id, ret);
+
+           if (ret <= 0) {
+               goto nfi_xpn_server_write_KO;
+           }
+
+           cont = cont + ret; //Send bytes
+           diff = size - cont;
+       }
+
+       ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+           goto nfi_xpn_server_write_KO;
+       }
+
+       if (req.size < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_write writes zero bytes from '%s' in server %s\n", serv->id, fh_aux->path, serv->server);
+
+           if (req.status.ret < 0) {
+               errno = req.status.server_errno;
+           }
+           goto nfi_xpn_server_write_KO;
+       }
+
+       if (req.status.ret < 0) {
+           errno = req.status.server_errno;
+       }
+       ret = cont;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_write(%s, %ld, %ld)=%d\n", serv->id, fh_aux->path, offset, size, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] >> End\n", serv->id);
+
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+       return ret;
+
+nfi_xpn_server_write_KO:
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+       return -1;
+   }
+
+   int nfi_xpn_server_send_rwv(struct nfi_server * serv, struct nfi_xpn_server * server_aux, struct nfi_fhandle * fh, int type, struct nfi_worker_io * io, int n_io, off_t header_size, int codec)
+   {
+       int ret, i;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_rwv * rwv;
+       struct st_xpn_server_extent * extents;
+
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+
+       if (type == XPN_SERVER_READV_FILE)
+            rwv = & (msg.u_st_xpn_server_msg.op_readv);
+       else rwv = & (msg.u_st_xpn_server_msg.op_writev);
+
+       int dir_len = strlen(fh_aux->path);
+       rwv->path_len = dir_len;
+       bzero(rwv->path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
+       {
+           memccpy(rwv->path, fh_aux->path, 0, dir_len);
+       }
+       else
+       {
+           memccpy(rwv->path, fh_aux->path, 0, XPN_PATH_MAX);
+       }
+
+       extents = (struct st_xpn_server_extent * ) malloc(n_io * sizeof(struct st_xpn_server_extent));
+       if (NULL == extents) {
+           return -1;
+       }
+
+       msg.type = type;
+       rwv->fd = fh_aux->fd;
+       rwv->n_extents = n_io;
+       rwv->size = 0;
+       rwv->xpn_session = serv->xpn_session_file;
+       rwv->codec = codec;
+       for (i = 0; i < n_io; i++)
+       {
+           extents[i].offset = io[i].offset + header_size;
+           extents[i].size = io[i].size;
+           rwv->size = rwv->size + io[i].size;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_send_rwv] %s(%s, %d extents, %ld)\n", serv->id, xpn_server_op2string(type), fh_aux->path, n_io, rwv->size);
+
+       // header + path tail + extents in one message
+       struct iovec data[2];
+       int n_data = 0;
+
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           data[n_data].iov_base = fh_aux->path + XPN_PATH_MAX;
+           data[n_data].iov_len  = dir_len - XPN_PATH_MAX;
+           n_data++;
+       }
+       data[n_data].iov_base = (char * ) extents;
+       data[n_data].iov_len  = n_io * sizeof(struct st_xpn_server_extent);
+       n_data++;
+
+       ret = nfi_write_operation_data(server_aux, & msg, data, n_data);
+
+       FREE_AND_NULL(extents);
+
+       return (ret < 0) ? -1 : 0;
+   }
+
+   ssize_t nfi_xpn_server_readv(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n_io, off_t header_size)
+   {
+       int ret, i, codec;
+       ssize_t total;
+       long cont, diff;
+       struct nfi_xpn_server * server_aux;
+       struct st_xpn_server_rw_req req;
+       char * zbuffer = NULL;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fh, EINVAL);
+       NULL_RET_ERR(io, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] >> Begin\n", serv->id);
+
+       // short-circuit read from the local data file (all the extents or none)
+       if (((struct nfi_xpn_server * ) serv->private_info)->short_circuit == 1)
+       {
+           ssize_t ret_local = 0;
+
+           total = 0;
+           for (i = 0; (i < n_io) && (ret_local != -2); i++)
+           {
+               ret_local = nfi_xpn_server_read_local(serv, fh, io[i].buffer, io[i].offset + header_size, io[i].size);
+               total = total + ret_local;
+           }
+           if (ret_local != -2) {
+               if (serv->keep_connected == 0) {
+                   nfi_xpn_server_disconnect(serv);
+               }
+               return total;
+           }
+       }
+
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL) {
+           errno = EINVAL;
+           goto nfi_xpn_server_readv_KO;
+       }
+
+       // do operation
+       total = 0;
+       for (i = 0; i < n_io; i++) {
+           total = total + io[i].size;
+       }
+       zbuffer = nfi_xpn_server_zbuffer(server_aux, total, & codec);
+
+       ret = nfi_xpn_server_send_rwv(serv, server_aux, fh, XPN_SERVER_READV_FILE, io, n_io, header_size, codec);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] ERROR: nfi_xpn_server_send_rwv fails\n", serv->id);
+           goto nfi_xpn_server_readv_KO;
+       }
+
+       // for each extent, read n times: number of bytes + read data (n bytes)
+       total = 0;
+       for (i = 0; i < n_io; i++)
+       {
+           cont = 0;
+           diff = io[i].size;
+
+           while (diff > 0)
+           {
+               ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+                   goto nfi_xpn_server_readv_KO;
+               }
+
+               if ((req.size < 0) || (req.status.ret < 0)) {
+                   errno = req.status.server_errno;
+                   goto nfi_xpn_server_readv_KO;
+               }
+
+               if (req.size == 0) {
+                   break;
+               }
+
+               ret = nfi_xpn_server_recv_chunk(server_aux, codec, (char * ) io[i].buffer + cont, req.size, zbuffer);
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+                   goto nfi_xpn_server_readv_KO;
+               }
+
+               cont = cont + req.size;
+               diff = io[i].size - cont;
+           }
+
+           total = total + cont;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] nfi_xpn_server_readv(%d extents)=%ld\n", serv->id, n_io, total);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readv] >> End\n", serv->id);
+
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return total;
+
+nfi_xpn_server_readv_KO:
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return -1;
+   }
+
+   ssize_t nfi_xpn_server_writev(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_worker_io * io, int n_io, off_t header_size)
+   {
+       int ret, i, codec;
+       ssize_t total;
+       long cont, diff, to_write;
+       struct nfi_xpn_server * server_aux;
+       struct st_xpn_server_rw_req req;
+       char * zbuffer = NULL;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fh, EINVAL);
+       NULL_RET_ERR(io, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] >> Begin\n", serv->id);
+
+       // MQTT publish goes one block at a time
+       if (fh->has_mqtt)
+       {
+           total = 0;
+           for (i = 0; i < n_io; i++)
+           {
+               ret = nfi_xpn_server_write(serv, fh, io[i].buffer, io[i].offset + header_size, io[i].size);
+               if (ret < 0) {
+                   return -1;
+               }
+               total = total + ret;
+           }
+           return total;
+       }
+
+       // private_info...
+       nfi_xpn_server_keep_connected(serv);
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL) {
+           errno = EINVAL;
+           goto nfi_xpn_server_writev_KO;
+       }
+
+       // do operation
+       total = 0;
+       for (i = 0; i < n_io; i++) {
+           total = total + io[i].size;
+       }
+       zbuffer = nfi_xpn_server_zbuffer(server_aux, total, & codec);
+
+       ret = nfi_xpn_server_send_rwv(serv, server_aux, fh, XPN_SERVER_WRITEV_FILE, io, n_io, header_size, codec);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] ERROR: nfi_xpn_server_send_rwv fails\n", serv->id);
+           goto nfi_xpn_server_writev_KO;
+       }
+
+       // the data of every extent, in chunks of at most MAX_BUFFER_SIZE
+       total = 0;
+       for (i = 0; i < n_io; i++)
+       {
+           cont = 0;
+           diff = io[i].size;
+
+           while (diff > 0)
+           {
+               to_write = (diff > MAX_BUFFER_SIZE) ? MAX_BUFFER_SIZE : diff;
+
+               ret = nfi_xpn_server_send_chunk(server_aux, codec, (char * ) io[i].buffer + cont, to_write, zbuffer);
+               if (ret < 0) {
+                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] ERROR: nfi_xpn_server_comm_write_data fails\n", serv->id);
+                   goto nfi_xpn_server_writev_KO;
+               }
+
+               cont = cont + to_write;
+               diff = io[i].size - cont;
+           }
+
+           total = total + cont;
+       }
+
+       ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
+           goto nfi_xpn_server_writev_KO;
+       }
+
+       if ((req.size < 0) || (req.status.ret < 0)) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] ERROR: nfi_xpn_server_writev fails on '%s' in server %s\n", serv->id, ((struct nfi_xpn_server_fhandle * ) fh->priv_fh)->path, serv->server);
+           errno = req.status.server_errno;
+           goto nfi_xpn_server_writev_KO;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] nfi_xpn_server_writev(%d extents)=%ld\n", serv->id, n_io, total);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_writev] >> End\n", serv->id);
+
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+       return total;
+
+nfi_xpn_server_writev_KO:
+       FREE_AND_NULL(zbuffer);
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+       return -1;
+   }
+
+   int nfi_xpn_server_close(__attribute__((__unused__)) struct nfi_server * serv, __attribute__((__unused__)) struct nfi_fhandle * fh)
+   {
+       // With sesion...
+       struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
+       int ret = 0;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(fh, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] >> Begin\n", serv->id);
+
+       // local descriptor of short-circuit reads
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+       if ((fh_aux != NULL) && (fh_aux->sc_fd >= 0)) {
+           close(fh_aux->sc_fd);
+           fh_aux->sc_fd = -1;
+       }
+
+       // Without sesion close do nothing
+       if (serv->xpn_session_file != 1)
+       {
+           FREE_AND_NULL(fh->priv_fh);
+           FREE_AND_NULL(fh->url);
+
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+           return 0;
+       }
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] Get server private info\n", serv->id);
+
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
+       {
+           errno = EINVAL;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+           return -1;
+       }
+
+       // private_info file handle
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] nfi_xpn_server_close(%d)\n", serv->id, fh_aux->fd);
+
+       int dir_len = strlen(fh_aux->path);
+       msg.u_st_xpn_server_msg.op_close.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_close.path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, dir_len);
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, XPN_PATH_MAX);
+       }
+
+       msg.type = XPN_SERVER_CLOSE_FILE;
+       msg.u_st_xpn_server_msg.op_close.fd = fh_aux->fd;
+       msg.u_st_xpn_server_msg.op_close.file_type = fh->has_mqtt;
+       //memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, PATH_MAX - 1);
+
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           ret = nfi_write_operation(server_aux, & msg);
+           if (ret < 0) {
+               return -1;
+           }
+
+           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+               return -1;
             }
 
            ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
@@ -679,420 +2244,403 @@
            nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
        }
 
-       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
        if (status.ret < 0) {
            errno = status.server_errno;
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] ERROR: remote open fails to open '%s' in server %s.\n", serv->id, dir, serv->server);
-           FREE_AND_NULL(fh_aux);
-           FREE_AND_NULL(fho->url);
-           goto nfi_xpn_server_open_KO;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] nfi_xpn_server_open(%s)\n", serv->id, dir);
-
-       memccpy(fh_aux->path, dir, 0, PATH_MAX - 1);
-       fh_aux->fd = status.ret;
-
-       fho->type = NFIFILE;
-       fho->priv_fh = NULL;
-       fho->server = serv;
-       fho->priv_fh = (void * ) fh_aux;
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_open] >> End\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] nfi_xpn_server_close(%d)=%d\n", serv->id, fh_aux->fd, status.ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] >> End\n", serv->id);
 
-       if (serv->keep_connected == 0) {
-           nfi_xpn_server_disconnect(serv);
-       }
-       return 0;
+       FREE_AND_NULL(fh->priv_fh);
+       FREE_AND_NULL(fh->url);
 
-nfi_xpn_server_open_KO:
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return -1;
-   }
-
-   int nfi_xpn_server_create(struct nfi_server * serv, char * url, mode_t mode, __attribute__((__unused__)) struct nfi_attr * attr, struct nfi_fhandle * fh)
-   {
-       //NOTE: actually creat is not in use, it use like POSIX open(path, O_WRONLY|O_CREAT|O_TRUNC, mode);
-       return nfi_xpn_server_open(serv, url, O_WRONLY | O_CREAT | O_TRUNC, mode, fh);
+       return status.ret;
    }
 
-   ssize_t nfi_xpn_server_read(struct nfi_server * serv, struct nfi_fhandle * fh, void * buffer, off_t offset, size_t size)
+   int nfi_xpn_server_remove(struct nfi_server * serv, char * url)
    {
-       int ret, cont, diff;
+       int ret;
+       char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_rw_req req;
+       struct st_xpn_server_status status;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fh, EINVAL);
+       NULL_RET_ERR(url, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] Get server private info\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL) {
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
+       {
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
            errno = EINVAL;
-           goto nfi_xpn_server_read_KO;
+           return -1;
        }
 
-       // private_info file handle
-       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+       // from url->server + dir
+       ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
+       if (ret < 0)
+       {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] ERROR: incorrect url '%s'.\n", serv->id, url);
+           errno = EINVAL;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
 
-       int dir_len = strlen(fh_aux->path);
-       msg.u_st_xpn_server_msg.op_read.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_read.path, XPN_PATH_MAX);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] nfi_xpn_server_remove(%s)\n", serv->id, dir);
+
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_rm.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_rm.path, XPN_PATH_MAX);
 
        if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, dir_len);
+           memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, dir_len);
+           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, XPN_PATH_MAX);
+           memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, XPN_PATH_MAX);
+           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_read(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] xpn_read(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
-
-       // do operation
-       msg.type = XPN_SERVER_READ_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_read.path, fh_aux->path, 0, PATH_MAX);
-       msg.u_st_xpn_server_msg.op_read.offset = offset;
-       msg.u_st_xpn_server_msg.op_read.size = size;
-       msg.u_st_xpn_server_msg.op_read.fd = fh_aux->fd;
-       msg.u_st_xpn_server_msg.op_read.xpn_session = serv->xpn_session_file;
-
-       ret = nfi_write_operation(server_aux, & msg);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_write_operation fails\n", serv->id);
-           goto nfi_xpn_server_read_KO;
-       }
+       msg.type = XPN_SERVER_RM_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, XPN_PATH_MAX);
 
        if (dir_len >= XPN_PATH_MAX)
        {
-           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+           ret = nfi_write_operation(server_aux, & msg);
+           if (ret < 0) {
+               return -1;
+           }
+
+           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
                return -1;
             }
+
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
+           }
+       }
+       else
+       {
+           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
        }
 
-       // read n times: number of bytes + read data (n bytes)
-       cont = 0;
-       do
+       if (status.ret < 0) {
+           errno = status.server_errno;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] nfi_xpn_server_remove(%s)=%d\n", serv->id, dir, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] >> End\n", serv->id);
+
+       if (serv->keep_connected == 0) {
+           nfi_xpn_server_disconnect(serv);
+       }
+
+       return ret;
+   }
+
+   int nfi_xpn_server_rename(struct nfi_server * serv, char * old_url, char * new_url)
+   {
+       int ret;
+       char server[PATH_MAX], old_path[PATH_MAX], new_path[PATH_MAX];
+       struct nfi_xpn_server * server_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
+
+       // Check arguments...
+       NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(old_url, EINVAL);
+       NULL_RET_ERR(new_url, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] >> Begin\n", serv->id);
+
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] Get server private info\n", serv->id);
+
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
        {
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
-           if (ret < 0) {
-               printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
-               goto nfi_xpn_server_read_KO;
+           errno = EINVAL;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
            }
+           return -1;
+       }
 
-           if (req.status.ret < 0) {
-               errno = req.status.server_errno;
-               goto nfi_xpn_server_read_KO;
+       // from url->server + dir
+       ret = ParseURL(old_url, NULL, NULL, NULL, server, NULL, old_path);
+       if (ret < 0)
+       {
+           errno = EINVAL;
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ERROR: incorrect url '%s'.\n", serv->id, old_url);
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
            }
+           return -1;
+       }
 
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data=%d.\n", serv->id, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ParseURL(%s)= %s; %s\n", serv->id, old_url, server, old_path);
 
-           if (req.size > 0) {
-               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data(%ld)\n", serv->id, req.size);
+       // from url->server + dir
+       ret = ParseURL(new_url, NULL, NULL, NULL, server, NULL, new_path);
+       if (ret < 0)
+       {
+           errno = EINVAL;
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ERROR: incorrect url '%s'.\n", serv->id, new_url);
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ParseURL(%s)= %s; %s\n", serv->id, new_path, server, new_path);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] nfi_xpn_server_rename(%s,%s)\n", serv->id, old_path, new_path);
+
+       int old_path_len = strlen(old_path);
+       msg.u_st_xpn_server_msg.op_rename.old_url_len = old_path_len;
+       bzero(msg.u_st_xpn_server_msg.op_rename.old_url, XPN_PATH_MAX);
+
+       int new_path_len = strlen(new_path);
+       msg.u_st_xpn_server_msg.op_rename.new_url_len = new_path_len;
+       bzero(msg.u_st_xpn_server_msg.op_rename.new_url, XPN_PATH_MAX);
+
+       if (old_path_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, old_path_len);
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, XPN_PATH_MAX);
+       }
+
+       if (new_path_len < XPN_PATH_MAX)
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, new_path_len);
+       }
+       else
+       {
+           memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, XPN_PATH_MAX);
+       }
 
-               ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) buffer + cont, req.size);
-               if (ret < 0) {
-                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
-               }
+       msg.type = XPN_SERVER_RENAME_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, PATH_MAX - 1);
+       //memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, PATH_MAX - 1);
 
-               debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_comm_read_data(%ld)=%d\n", serv->id, req.size, ret);
+       if (old_path_len >= XPN_PATH_MAX || new_path_len >= XPN_PATH_MAX)
+       {
+           ret = nfi_write_operation(server_aux, & msg);
+           if (ret < 0) {
+               return -1;
            }
-           cont = cont + req.size;
-           diff = msg.u_st_xpn_server_msg.op_read.size - cont;
 
-       } while ((diff > 0) && (req.size != 0));
+           if (old_path_len >= XPN_PATH_MAX){
+               //int ret2 = socket_send(server_aux->server_socket, old_path + XPN_PATH_MAX, old_path_len - XPN_PATH_MAX);
+               if (nfi_xpn_server_comm_write_data(server_aux, old_path + XPN_PATH_MAX, old_path_len - XPN_PATH_MAX) < 0 ) {
+                   return -1;
+                }
+           }
 
-       if (req.size < 0) {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] ERROR: nfi_xpn_server_read reads zero bytes from '%s' in server %s\n", serv->id, fh_aux->path, serv->server);
-           if (req.status.ret < 0)
-               errno = req.status.server_errno;
+           if(new_path_len >= XPN_PATH_MAX){
+               //int ret3 = socket_send(server_aux->server_socket, new_path + XPN_PATH_MAX, new_path_len - XPN_PATH_MAX);
+               if (nfi_xpn_server_comm_write_data(server_aux, new_path + XPN_PATH_MAX, new_path_len - XPN_PATH_MAX) < 0 ) {
+                   return -1;
+                }
+           }
 
-           goto nfi_xpn_server_read_KO;
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
+           }
        }
-
-       if (req.status.ret < 0) {
-           errno = req.status.server_errno;
+       else
+       {
+           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
        }
-       ret = cont;
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] nfi_xpn_server_read(%s, %ld, %ld)=%d\n", serv->id, fh_aux->path, offset, size, ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read] >> End\n", serv->id);
-
-       if (serv->keep_connected == 0) {
-           nfi_xpn_server_disconnect(serv);
+       if (status.ret < 0) {
+           errno = status.server_errno;
        }
 
-       return ret;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] nfi_xpn_server_rename(%s,%s)=%d\n", serv->id, old_path, new_path, ret);
+       debug_info("[NFI_XPN] [nfi_xpn_server_rename] >> End\n");
 
-nfi_xpn_server_read_KO:
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return -1;
+       return ret;
    }
 
-   ssize_t nfi_xpn_server_write(struct nfi_server * serv, struct nfi_fhandle * fh, void * buffer, off_t offset, size_t size)
+   int nfi_xpn_server_getattr(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_attr * attr)
    {
-       int ret, diff, cont;
+       int ret;
+       char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_rw_req req;
+       struct st_xpn_server_attr_req req;
 
-       // Check arguments...
+       // check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fh, EINVAL);
+       NULL_RET_ERR(fh,   EINVAL);
+       NULL_RET_ERR(attr, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] >> Begin\n", serv->id);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] >> Begin\n", serv->id);
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] Get server private info\n", serv->id);
 
-       // MQTT publish
-       if (fh->has_mqtt) {
-           return nfi_mq_server_publish(server_aux, fh_aux, buffer, offset, size);
-       }
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
+       {
+           errno = EINVAL;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
 
-       // 0-size buffer
-       if (size == 0) {
-           return 0;
+           return -1;
        }
 
-       // private_info...
-       nfi_xpn_server_keep_connected(serv);
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL) {
+       // from url->server + dir
+       ret = ParseURL(fh->url, NULL, NULL, NULL, server, NULL, dir);
+       if (ret < 0)
+       {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] ERROR: incorrect url '%s'.\n", serv->id, fh->url);
            errno = EINVAL;
-           goto nfi_xpn_server_write_KO;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+
+           return -1;
        }
 
-       // private_info file handle
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_write(%s, %ld, %ld)\n", serv->id, fh_aux->path, offset, size);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] xpn_write(%s, %ld, %ld)\n", serv->id, msg.u_st_xpn_server_msg.op_write.path, offset, size);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] ParseURL(%s)= %s; %s\n", serv->id, fh->url, server, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] nfi_xpn_server_getattr(%s)\n", serv->id, dir);
 
-       int dir_len = strlen(fh_aux->path);
-       msg.u_st_xpn_server_msg.op_write.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_write.path, XPN_PATH_MAX);
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_getattr.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_getattr.path, XPN_PATH_MAX);
 
        if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, dir_len);
+           memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, dir_len);
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, XPN_PATH_MAX);
+           memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, XPN_PATH_MAX);
        }
 
-       // Do request
-       msg.type = XPN_SERVER_WRITE_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_write.path, fh_aux->path, 0, PATH_MAX - 1);
-       msg.u_st_xpn_server_msg.op_write.offset = offset;
-       msg.u_st_xpn_server_msg.op_write.size = size;
-       msg.u_st_xpn_server_msg.op_write.fd = fh_aux->fd;
-       msg.u_st_xpn_server_msg.op_write.xpn_session = serv->xpn_session_file;
-       msg.u_st_xpn_server_msg.op_write.file_type = fh->has_mqtt;
-
-       ret = nfi_write_operation(server_aux, & msg);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_write_operation fails\n", serv->id);
-           goto nfi_xpn_server_write_KO;
-       }
+       // do operation
+       msg.type = XPN_SERVER_GETATTR_FILE;
+       //memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, PATH_MAX - 1);
 
-       if (dir_len >= XPN_PATH_MAX){
-           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+       if (dir_len >= XPN_PATH_MAX)
+       {
+           ret = nfi_write_operation(server_aux, & msg);
+           if (ret < 0) {
+               return -1;
+           }
+           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
                return -1;
             }
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (req), sizeof(struct st_xpn_server_attr_req));
+           if (ret < 0) {
+               return -1;
+           }
        }
-
-       diff = size;
-       cont = 0;
-
-       int buffer_size = size;
-
-       // Max buffer size
-       if (buffer_size > MAX_BUFFER_SIZE) {
-           buffer_size = MAX_BUFFER_SIZE;
-       }
-
-       // writes n times: number of bytes + write data (n bytes)
-       do
+       else
        {
-           if (diff > buffer_size) {
-               ret = nfi_xpn_server_comm_write_data(server_aux, (char * ) buffer + cont, buffer_size);
-               if (ret < 0) {
-                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_write_data fails\n", serv->id);
-               }
-           } else {
-               ret = nfi_xpn_server_comm_write_data(server_aux, (char * ) buffer + cont, diff);
-               if (ret < 0) {
-                   printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_write_data fails\n", serv->id);
-               }
-           }
-
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_comm_write_data=%d.\n", serv->id, ret);
-
-           cont = cont + ret; //Send bytes
-           diff = size - cont;
-
-       } while ((diff > 0) && (ret != 0));
-
-       ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_rw_req));
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_comm_read_data fails\n", serv->id);
-           goto nfi_xpn_server_write_KO;
+           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_attr_req));
        }
 
-       if (req.size < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] ERROR: nfi_xpn_server_write writes zero bytes from '%s' in server %s\n", serv->id, fh_aux->path, serv->server);
-
-           if (req.status.ret < 0) {
-               errno = req.status.server_errno;
-           }
-           goto nfi_xpn_server_write_KO;
+       if (req.status_req.ret < 0) {
+           errno = req.status_req.server_errno;
        }
 
-       if (req.status.ret < 0) {
-           errno = req.status.server_errno;
-       }
-       ret = cont;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] nfi_xpn_server_getattr(%s)=%d\n", serv->id, dir, req.status);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] nfi_xpn_server_write(%s, %ld, %ld)=%d\n", serv->id, fh_aux->path, offset, size, ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write] >> End\n", serv->id);
+       xpn_2_nfi_attr(attr, & (req.attr));
 
-       if (serv->keep_connected == 0) {
-           nfi_xpn_server_disconnect(serv);
-       }
-       return ret;
+       debug_info("[NFI_XPN] [nfi_xpn_server_getattr] >> End\n");
 
-nfi_xpn_server_write_KO:
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
-       return -1;
+       return req.status;
    }
 
-   int nfi_xpn_server_close(__attribute__((__unused__)) struct nfi_server * serv, __attribute__((__unused__)) struct nfi_fhandle * fh)
+   int nfi_xpn_server_setattr(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_attr * attr)
    {
-       // With sesion...
        struct nfi_xpn_server * server_aux;
        struct nfi_xpn_server_fhandle * fh_aux;
-       struct st_xpn_server_msg msg;
-       struct st_xpn_server_status status;
-       int ret = 0;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fh, EINVAL);
-       nfi_xpn_server_keep_connected(serv);
-       NULL_RET_ERR(serv->private_info, EINVAL);
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] >> Begin\n", serv->id);
-
-       // Without sesion close do nothing
-       if (serv->xpn_session_file != 1)
-       {
-           FREE_AND_NULL(fh->priv_fh);
-           FREE_AND_NULL(fh->url);
-
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-           return 0;
-       }
-
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] Get server private info\n", serv->id);
-
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
-       {
-           errno = EINVAL;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-           return -1;
-       }
-
-       // private_info file handle
-       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] nfi_xpn_server_close(%d)\n", serv->id, fh_aux->fd);
-
-       int dir_len = strlen(fh_aux->path);
-       msg.u_st_xpn_server_msg.op_close.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_close.path, XPN_PATH_MAX);
+       NULL_RET_ERR(fh,   EINVAL);
+       NULL_RET_ERR(attr, EINVAL);
+       NULL_RET_ERR(fh->priv_fh, EINVAL);
+       nfi_xpn_server_keep_connected(serv);
+       NULL_RET_ERR(serv->private_info, EINVAL);
 
-       if (dir_len < XPN_PATH_MAX)
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, dir_len);
-       }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, XPN_PATH_MAX);
-       }
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] >> Begin\n", serv->id);
 
-       msg.type = XPN_SERVER_CLOSE_FILE;
-       msg.u_st_xpn_server_msg.op_close.fd = fh_aux->fd;
-       msg.u_st_xpn_server_msg.op_close.file_type = fh->has_mqtt;
-       //memccpy(msg.u_st_xpn_server_msg.op_close.path, fh_aux->path, 0, PATH_MAX - 1);
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] Get server private info\n", serv->id);
 
-       if (dir_len >= XPN_PATH_MAX)
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
        {
-           ret = nfi_write_operation(server_aux, & msg);
-           if (ret < 0) {
-               return -1;
+           errno = EINVAL;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
            }
 
-           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
-               return -1;
-            }
-
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
-           if (ret < 0) {
-               return -1;
-           }
-       }
-       else
-       {
-           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           return -1;
        }
 
-       if (status.ret < 0) {
-           errno = status.server_errno;
-       }
+       // private_info file handle
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] nfi_xpn_server_close(%d)=%d\n", serv->id, fh_aux->fd, status.ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_close] >> End\n", serv->id);
+       // TODO: setattr
+       server_aux = server_aux;
+       fh_aux = fh_aux;
 
-       FREE_AND_NULL(fh->priv_fh);
-       FREE_AND_NULL(fh->url);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return status.ret;
+       return 0;
    }
 
-   int nfi_xpn_server_remove(struct nfi_server * serv, char * url)
+   // Directories API
+   int nfi_xpn_server_mkdir(struct nfi_server * serv, char * url, mode_t mode, __attribute__((__unused__)) struct nfi_attr * attr, __attribute__((__unused__)) struct nfi_fhandle * fh)
    {
        int ret;
        char server[PATH_MAX], dir[PATH_MAX];
@@ -1102,30 +2650,30 @@ nfi_xpn_server_write_KO:
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(url, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] Get server private info\n", serv->id);
+
+       server_aux = nfi_xpn_server_stream(serv);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
        if (server_aux == NULL)
        {
+           errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-           errno = EINVAL;
+
            return -1;
        }
 
        // from url->server + dir
        ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
-       if (ret < 0)
-       {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] ERROR: incorrect url '%s'.\n", serv->id, url);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ERROR: incorrect url '%s'.\n", serv->id, url);
            errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
@@ -1134,26 +2682,26 @@ nfi_xpn_server_write_KO:
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] nfi_xpn_server_remove(%s)\n", serv->id, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] nfi_xpn_server_mkdir(%s)\n", serv->id, dir);
 
        int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_rm.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_rm.path, XPN_PATH_MAX);
+       msg.u_st_xpn_server_msg.op_mkdir.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_mkdir.path, XPN_PATH_MAX);
 
        if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, dir_len);
-           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
+           memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, dir_len);
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, XPN_PATH_MAX);
-           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
+           memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, XPN_PATH_MAX);
        }
 
-       msg.type = XPN_SERVER_RM_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_rm.path, dir, 0, XPN_PATH_MAX);
+       // do operation
+       msg.type = XPN_SERVER_MKDIR_DIR;
+       msg.u_st_xpn_server_msg.op_mkdir.mode = mode;
+       //memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, PATH_MAX - 1);
 
        if (dir_len >= XPN_PATH_MAX)
        {
@@ -1181,8 +2729,18 @@ nfi_xpn_server_write_KO:
            errno = status.server_errno;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] nfi_xpn_server_remove(%s)=%d\n", serv->id, dir, ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_remove] >> End\n", serv->id);
+       if ((status.ret < 0) && (errno != EEXIST))
+       {
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ERROR: xpn_mkdir fails to mkdir '%s' in server %s.\n", serv->id, dir, serv->server);
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] nfi_xpn_server_mkdir(%s)=%d\n", serv->id, dir, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
@@ -1191,203 +2749,201 @@ nfi_xpn_server_write_KO:
        return ret;
    }
 
-   int nfi_xpn_server_rename(struct nfi_server * serv, char * old_url, char * new_url)
+   int nfi_xpn_server_opendir(struct nfi_server * serv, char * url, struct nfi_fhandle * fho)
    {
        int ret;
-       char server[PATH_MAX], old_path[PATH_MAX], new_path[PATH_MAX];
+       char dir[PATH_MAX], server[PATH_MAX];
        struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_status status;
+       struct st_xpn_server_opendir_req req;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(old_url, EINVAL);
-       NULL_RET_ERR(new_url, EINVAL);
+       NULL_RET_ERR(url,  EINVAL);
+       NULL_RET_ERR(fho,  EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] Get server private info\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       server_aux = nfi_xpn_server_stream(serv);
        if (server_aux == NULL)
        {
            errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-           return -1;
-       }
 
-       // from url->server + dir
-       ret = ParseURL(old_url, NULL, NULL, NULL, server, NULL, old_path);
-       if (ret < 0)
-       {
-           errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ERROR: incorrect url '%s'.\n", serv->id, old_url);
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ParseURL(%s)= %s; %s\n", serv->id, old_url, server, old_path);
-
        // from url->server + dir
-       ret = ParseURL(new_url, NULL, NULL, NULL, server, NULL, new_path);
+       ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
        if (ret < 0)
        {
            errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ERROR: incorrect url '%s'.\n", serv->id, new_url);
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] ERROR: incorrect url '%s'.\n", serv->id, url);
+
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] ParseURL(%s)= %s; %s\n", serv->id, new_path, server, new_path);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] nfi_xpn_server_rename(%s,%s)\n", serv->id, old_path, new_path);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
 
-       int old_path_len = strlen(old_path);
-       msg.u_st_xpn_server_msg.op_rename.old_url_len = old_path_len;
-       bzero(msg.u_st_xpn_server_msg.op_rename.old_url, XPN_PATH_MAX);
+       // Copy url
+       fho->url = strdup(url);
+       NULL_RET_ERR(fho->url, ENOMEM);
 
-       int new_path_len = strlen(new_path);
-       msg.u_st_xpn_server_msg.op_rename.new_url_len = new_path_len;
-       bzero(msg.u_st_xpn_server_msg.op_rename.new_url, XPN_PATH_MAX);
+       // private_info file handle
+       fh_aux = (struct nfi_xpn_server_fhandle * ) malloc(sizeof(struct nfi_xpn_server_fhandle));
+       NULL_RET_ERR(fh_aux, ENOMEM);
+       bzero(fh_aux, sizeof(struct nfi_xpn_server_fhandle));
 
-       if (old_path_len < XPN_PATH_MAX)
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, old_path_len);
-       }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, XPN_PATH_MAX);
-       }
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] nfi_xpn_server_opendir(%s)\n", serv->id, dir);
 
-       if (new_path_len < XPN_PATH_MAX)
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_opendir.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_opendir.path, XPN_PATH_MAX);
+
+       if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, new_path_len);
+           memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, dir_len);
+           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, XPN_PATH_MAX);
+           memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, XPN_PATH_MAX);
+           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
        }
 
-       msg.type = XPN_SERVER_RENAME_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_rename.old_url, old_path, 0, PATH_MAX - 1);
-       //memccpy(msg.u_st_xpn_server_msg.op_rename.new_url, new_path, 0, PATH_MAX - 1);
+       // do operation
+       msg.type = XPN_SERVER_OPENDIR_DIR;
+       //memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, PATH_MAX - 1);
+       msg.u_st_xpn_server_msg.op_opendir.xpn_session = serv->xpn_session_dir;
 
-       if (old_path_len >= XPN_PATH_MAX || new_path_len >= XPN_PATH_MAX)
+       if (dir_len >= XPN_PATH_MAX)
        {
            ret = nfi_write_operation(server_aux, & msg);
            if (ret < 0) {
                return -1;
            }
 
-           if (old_path_len >= XPN_PATH_MAX){
-               //int ret2 = socket_send(server_aux->server_socket, old_path + XPN_PATH_MAX, old_path_len - XPN_PATH_MAX);
-               if (nfi_xpn_server_comm_write_data(server_aux, old_path + XPN_PATH_MAX, old_path_len - XPN_PATH_MAX) < 0 ) {
-                   return -1;
-                }
-           }
-
-           if(new_path_len >= XPN_PATH_MAX){
-               //int ret3 = socket_send(server_aux->server_socket, new_path + XPN_PATH_MAX, new_path_len - XPN_PATH_MAX);
-               if (nfi_xpn_server_comm_write_data(server_aux, new_path + XPN_PATH_MAX, new_path_len - XPN_PATH_MAX) < 0 ) {
-                   return -1;
-                }
-           }
+           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+               return -1;
+            }
 
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
            if (ret < 0) {
                return -1;
            }
        }
        else
        {
-           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+            nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
        }
 
-       if (status.ret < 0) {
-           errno = status.server_errno;
+       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
+       if (req.status.ret < 0) {
+           errno = req.status.server_errno;
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+           return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rename] nfi_xpn_server_rename(%s,%s)=%d\n", serv->id, old_path, new_path, ret);
-       debug_info("[NFI_XPN] [nfi_xpn_server_rename] >> End\n");
+       fh_aux->telldir = req.status.ret;
+       fh_aux->dir = req.dir;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] nfi_xpn_server_opendir(%s)\n", serv->id, dir);
+
+       strcpy(fh_aux->path, dir);
+       fho->type = NFIDIR;
+       fho->server = serv;
+       fho->priv_fh = (void * ) fh_aux;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
-
-       return ret;
+       return 0;
    }
 
-   int nfi_xpn_server_getattr(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_attr * attr)
+   int nfi_xpn_server_readdir(struct nfi_server * serv, struct nfi_fhandle * fh, struct dirent * entry)
    {
-       int ret;
-       char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
+       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_attr_req req;
+       struct st_xpn_server_readdir_req ret_entry;
+       int ret = 0;
 
-       // check arguments...
+       // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
        NULL_RET_ERR(fh,   EINVAL);
-       NULL_RET_ERR(attr, EINVAL);
+       NULL_RET_ERR(fh->priv_fh, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] >> Begin\n", serv->id);
-
-       // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] >> Begin\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
+       // check file type
+       if (fh->type != NFIDIR)
        {
-           errno = EINVAL;
+           errno = ENOTDIR;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-
            return -1;
        }
+       // private_info...
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] Get server private info\n", serv->id);
 
-       // from url->server + dir
-       ret = ParseURL(fh->url, NULL, NULL, NULL, server, NULL, dir);
-       if (ret < 0)
+       server_aux = nfi_xpn_server_stream(serv);
+       if (server_aux == NULL)
        {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] ERROR: incorrect url '%s'.\n", serv->id, fh->url);
            errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] ParseURL(%s)= %s; %s\n", serv->id, fh->url, server, dir);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] nfi_xpn_server_getattr(%s)\n", serv->id, dir);
+       // private_info file handle
+       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
 
-       int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_getattr.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_getattr.path, XPN_PATH_MAX);
+       // clean all entry content
+       memset(entry, 0, sizeof(struct dirent));
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] nfi_xpn_server_readdir(%s)\n", serv->id, fh_aux->path);
+
+       int dir_len = strlen(fh_aux->path);
+       msg.u_st_xpn_server_msg.op_readdir.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_readdir.path, XPN_PATH_MAX);
 
        if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, dir_len);
+           memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, dir_len);
+           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, XPN_PATH_MAX);
+           memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, XPN_PATH_MAX);
+           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
        }
 
        // do operation
-       msg.type = XPN_SERVER_GETATTR_FILE;
-       //memccpy(msg.u_st_xpn_server_msg.op_getattr.path, dir, 0, PATH_MAX - 1);
+       msg.type = XPN_SERVER_READDIR_DIR;
+       //memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, PATH_MAX - 1);
+       msg.u_st_xpn_server_msg.op_readdir.telldir = fh_aux->telldir;
+       msg.u_st_xpn_server_msg.op_readdir.dir = fh_aux->dir;
+       msg.u_st_xpn_server_msg.op_readdir.xpn_session = serv->xpn_session_dir;
 
        if (dir_len >= XPN_PATH_MAX)
        {
@@ -1395,55 +2951,75 @@ nfi_xpn_server_write_KO:
            if (ret < 0) {
                return -1;
            }
-           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+
+           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
                return -1;
             }
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (req), sizeof(struct st_xpn_server_attr_req));
+
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (ret_entry), sizeof(struct st_xpn_server_readdir_req));
            if (ret < 0) {
                return -1;
            }
        }
        else
        {
-           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_attr_req));
+           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (ret_entry), sizeof(struct st_xpn_server_readdir_req));
        }
 
-       if (req.status_req.ret < 0) {
-           errno = req.status_req.server_errno;
-       }
+       if (ret_entry.status.ret < 0)
+            errno = ret_entry.status.server_errno;
+       else fh_aux->telldir = ret_entry.telldir;
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_getattr] nfi_xpn_server_getattr(%s)=%d\n", serv->id, dir, req.status);
+       if (ret_entry.end == 0)
+       {
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+           return -1;
+       }
 
-       xpn_2_nfi_attr(attr, & (req.attr));
+       memcpy(entry, & (ret_entry.ret), sizeof(struct dirent));
 
-       debug_info("[NFI_XPN] [nfi_xpn_server_getattr] >> End\n");
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] nfi_xpn_server_readdir(%s)=%p\n", serv->id, fh_aux->path, entry);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
-       return req.status;
+
+       return 0;
    }
 
-   int nfi_xpn_server_setattr(struct nfi_server * serv, struct nfi_fhandle * fh, struct nfi_attr * attr)
+   int nfi_xpn_server_closedir(struct nfi_server * serv, struct nfi_fhandle * fh)
    {
+       if (serv->xpn_session_dir != 1)
+       {
+           if (serv->keep_connected == 0) {
+               nfi_xpn_server_disconnect(serv);
+           }
+
+           // Without sesion close do nothing
+           return 0;
+       }
+
        struct nfi_xpn_server * server_aux;
        struct nfi_xpn_server_fhandle * fh_aux;
+       struct st_xpn_server_msg msg;
+       struct st_xpn_server_status status;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
        NULL_RET_ERR(fh,   EINVAL);
-       NULL_RET_ERR(attr, EINVAL);
-       NULL_RET_ERR(fh->priv_fh, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] Get server private info\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] Get server private info\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       server_aux = nfi_xpn_server_stream(serv);
        if (server_aux == NULL)
        {
            errno = EINVAL;
@@ -1457,21 +3033,33 @@ nfi_xpn_server_write_KO:
        // private_info file handle
        fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
 
-       // TODO: setattr
-       server_aux = server_aux;
-       fh_aux = fh_aux;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] nfi_xpn_server_closedir(%p)\n", serv->id, fh_aux->dir);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_setattr] >> End\n", serv->id);
+       msg.type = XPN_SERVER_CLOSEDIR_DIR;
+
+#if!defined(HAVE_64BITS)
+       msg.u_st_xpn_server_msg.op_closedir.dir = (uint64_t) fh_aux->dir;
+#else
+       msg.u_st_xpn_server_msg.op_closedir.dir = fh_aux->dir;
+#endif
+
+       nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+
+       if (status.ret < 0) {
+           errno = status.server_errno;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] nfi_xpn_server_closedir(%p)=%d\n", serv->id, fh_aux->dir, status.ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return 0;
+       return status.ret;
    }
 
-   // Directories API
-   int nfi_xpn_server_mkdir(struct nfi_server * serv, char * url, mode_t mode, __attribute__((__unused__)) struct nfi_attr * attr, __attribute__((__unused__)) struct nfi_fhandle * fh)
+   int nfi_xpn_server_rmdir(struct nfi_server * serv, char * url)
    {
        int ret;
        char server[PATH_MAX], dir[PATH_MAX];
@@ -1481,16 +3069,16 @@ nfi_xpn_server_write_KO:
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
+       NULL_RET_ERR(url, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] Get server private info\n", serv->id);
-
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] Get server private info\n", serv->id);
 
+       server_aux = nfi_xpn_server_stream(serv);
        if (server_aux == NULL)
        {
            errno = EINVAL;
@@ -1503,36 +3091,36 @@ nfi_xpn_server_write_KO:
 
        // from url->server + dir
        ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
-       if (ret < 0) {
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ERROR: incorrect url '%s'.\n", serv->id, url);
+       if (ret < 0)
+       {
            errno = EINVAL;
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] ERROR: incorrect url '%s'.\n", serv->id, url);
+
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] nfi_xpn_server_mkdir(%s)\n", serv->id, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] nfi_xpn_server_rmdir(%s)\n", serv->id, dir);
 
        int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_mkdir.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_mkdir.path, XPN_PATH_MAX);
+       msg.u_st_xpn_server_msg.op_rmdir.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_rmdir.path, XPN_PATH_MAX);
 
        if (dir_len < XPN_PATH_MAX)
        {
-           memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, dir_len);
+           memccpy(msg.u_st_xpn_server_msg.op_rmdir.path, dir, 0, dir_len);
+           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
        }
        else
        {
-           memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, XPN_PATH_MAX);
+           memccpy(msg.u_st_xpn_server_msg.op_rmdir.path, dir, 0, XPN_PATH_MAX);
+           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
        }
 
-       // do operation
-       msg.type = XPN_SERVER_MKDIR_DIR;
-       msg.u_st_xpn_server_msg.op_mkdir.mode = mode;
-       //memccpy(msg.u_st_xpn_server_msg.op_mkdir.path, dir, 0, PATH_MAX - 1);
+       msg.type = XPN_SERVER_RMDIR_DIR;
 
        if (dir_len >= XPN_PATH_MAX)
        {
@@ -1556,107 +3144,67 @@ nfi_xpn_server_write_KO:
            nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
        }
 
-       if (status.ret < 0) {
-           errno = status.server_errno;
-       }
-
-       if ((status.ret < 0) && (errno != EEXIST))
+       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+       if (status.ret < 0)
        {
-           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] ERROR: xpn_mkdir fails to mkdir '%s' in server %s.\n", serv->id, dir, serv->server);
+           errno = status.server_errno;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
-
-           return -1;
+           return status.ret;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] nfi_xpn_server_mkdir(%s)=%d\n", serv->id, dir, ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir] >> End\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] nfi_xpn_server_rmdir(%s)=%d\n", serv->id, dir, ret);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] >> End\n", serv->id);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return ret;
+       return 0;
    }
 
-   int nfi_xpn_server_opendir(struct nfi_server * serv, char * url, struct nfi_fhandle * fho)
+   int nfi_xpn_server_mkdir_p(struct nfi_server * serv, char * url, mode_t mode)
    {
        int ret;
-       char dir[PATH_MAX], server[PATH_MAX];
+       char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_opendir_req req;
+       struct st_xpn_server_status status;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(url,  EINVAL);
-       NULL_RET_ERR(fho,  EINVAL);
+       NULL_RET_ERR(url, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir_p] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] Get server private info\n", serv->id);
-
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
-       {
-           errno = EINVAL;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-
-           return -1;
-       }
+       server_aux = nfi_xpn_server_stream(serv);
 
        // from url->server + dir
        ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
-       if (ret < 0)
-       {
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir_p] ERROR: incorrect url '%s'.\n", serv->id, url);
            errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] ERROR: incorrect url '%s'.\n", serv->id, url);
-
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
+
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
-
-       // Copy url
-       fho->url = strdup(url);
-       NULL_RET_ERR(fho->url, ENOMEM);
-
-       // private_info file handle
-       fh_aux = (struct nfi_xpn_server_fhandle * ) malloc(sizeof(struct nfi_xpn_server_fhandle));
-       NULL_RET_ERR(fh_aux, ENOMEM);
-       bzero(fh_aux, sizeof(struct nfi_xpn_server_fhandle));
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] nfi_xpn_server_opendir(%s)\n", serv->id, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir_p] nfi_xpn_server_mkdir_p(%s)\n", serv->id, dir);
 
        int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_opendir.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_opendir.path, XPN_PATH_MAX);
-
-       if (dir_len < XPN_PATH_MAX)
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, dir_len);
-           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
-       }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, XPN_PATH_MAX);
-           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
-       }
+       msg.u_st_xpn_server_msg.op_mkdir_p.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_mkdir_p.path, XPN_PATH_MAX);
+       memccpy(msg.u_st_xpn_server_msg.op_mkdir_p.path, dir, 0, (dir_len < XPN_PATH_MAX) ? dir_len : XPN_PATH_MAX);
 
        // do operation
-       msg.type = XPN_SERVER_OPENDIR_DIR;
-       //memccpy(msg.u_st_xpn_server_msg.op_opendir.path, dir, 0, PATH_MAX - 1);
-       msg.u_st_xpn_server_msg.op_opendir.xpn_session = serv->xpn_session_dir;
+       msg.type = XPN_SERVER_MKDIR_P_DIR;
+       msg.u_st_xpn_server_msg.op_mkdir_p.mode = mode;
 
        if (dir_len >= XPN_PATH_MAX)
        {
@@ -1665,116 +3213,78 @@ nfi_xpn_server_write_KO:
                return -1;
            }
 
-           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
            if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
                return -1;
-            }
-
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
-           if (ret < 0) {
-               return -1;
-           }
-       }
-       else
-       {
-            nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
-       }
-
-       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (req), sizeof(struct st_xpn_server_opendir_req));
-       if (req.status.ret < 0) {
-           errno = req.status.server_errno;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
            }
-           return -1;
-       }
-
-       fh_aux->telldir = req.status.ret;
-       fh_aux->dir = req.dir;
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] nfi_xpn_server_opendir(%s)\n", serv->id, dir);
-
-       strcpy(fh_aux->path, dir);
-       fho->type = NFIDIR;
-       fho->server = serv;
-       fho->priv_fh = (void * ) fh_aux;
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_opendir] >> End\n", serv->id);
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
+           }
+       }
+       else
+       {
+           ret = nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
+           }
+       }
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
+
+       if (status.ret < 0) {
+           errno = status.server_errno;
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir_p] ERROR: fails to mkdir_p '%s' in server %s.\n", serv->id, dir, serv->server);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_mkdir_p] >> End\n", serv->id);
+
        return 0;
    }
 
-   int nfi_xpn_server_readdir(struct nfi_server * serv, struct nfi_fhandle * fh, struct dirent * entry)
+   int nfi_xpn_server_rmtree(struct nfi_server * serv, char * url)
    {
+       int ret;
+       char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_readdir_req ret_entry;
-       int ret = 0;
+       struct st_xpn_server_status status;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fh,   EINVAL);
-       NULL_RET_ERR(fh->priv_fh, EINVAL);
+       NULL_RET_ERR(url, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmtree] >> Begin\n", serv->id);
 
-       // check file type
-       if (fh->type != NFIDIR)
-       {
-           errno = ENOTDIR;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-           return -1;
-       }
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] Get server private info\n", serv->id);
+       server_aux = nfi_xpn_server_stream(serv);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
-       {
+       // from url->server + dir
+       ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmtree] ERROR: incorrect url '%s'.\n", serv->id, url);
            errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
+
            return -1;
        }
 
-       // private_info file handle
-       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
-
-       // clean all entry content
-       memset(entry, 0, sizeof(struct dirent));
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] nfi_xpn_server_readdir(%s)\n", serv->id, fh_aux->path);
-
-       int dir_len = strlen(fh_aux->path);
-       msg.u_st_xpn_server_msg.op_readdir.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_readdir.path, XPN_PATH_MAX);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmtree] nfi_xpn_server_rmtree(%s)\n", serv->id, dir);
 
-       if (dir_len < XPN_PATH_MAX)
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, dir_len);
-           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
-       }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, XPN_PATH_MAX);
-           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
-       }
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_rmtree.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_rmtree.path, XPN_PATH_MAX);
+       memccpy(msg.u_st_xpn_server_msg.op_rmtree.path, dir, 0, (dir_len < XPN_PATH_MAX) ? dir_len : XPN_PATH_MAX);
 
        // do operation
-       msg.type = XPN_SERVER_READDIR_DIR;
-       //memccpy(msg.u_st_xpn_server_msg.op_readdir.path, fh_aux->path, 0, PATH_MAX - 1);
-       msg.u_st_xpn_server_msg.op_readdir.telldir = fh_aux->telldir;
-       msg.u_st_xpn_server_msg.op_readdir.dir = fh_aux->dir;
-       msg.u_st_xpn_server_msg.op_readdir.xpn_session = serv->xpn_session_dir;
+       msg.type = XPN_SERVER_RMTREE_DIR;
 
        if (dir_len >= XPN_PATH_MAX)
        {
@@ -1783,76 +3293,65 @@ nfi_xpn_server_write_KO:
                return -1;
            }
 
-           //int ret2 = socket_send(server_aux->server_socket, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, fh_aux->path + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
+           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
                return -1;
-            }
+           }
 
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (ret_entry), sizeof(struct st_xpn_server_readdir_req));
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
            if (ret < 0) {
                return -1;
            }
        }
        else
        {
-           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (ret_entry), sizeof(struct st_xpn_server_readdir_req));
-       }
-
-       if (ret_entry.status.ret < 0)
-            errno = ret_entry.status.server_errno;
-       else fh_aux->telldir = ret_entry.telldir;
-
-       if (ret_entry.end == 0)
-       {
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
+           ret = nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+           if (ret < 0) {
+               return -1;
            }
-           return -1;
        }
 
-       memcpy(entry, & (ret_entry.ret), sizeof(struct dirent));
-
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] nfi_xpn_server_readdir(%s)=%p\n", serv->id, fh_aux->path, entry);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_readdir] >> End\n", serv->id);
-
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
+       if (status.ret < 0) {
+           errno = status.server_errno;
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmtree] ERROR: fails to rmtree '%s' in server %s.\n", serv->id, dir, serv->server);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmtree] >> End\n", serv->id);
+
        return 0;
    }
 
-   int nfi_xpn_server_closedir(struct nfi_server * serv, struct nfi_fhandle * fh)
+   int nfi_xpn_server_walk(struct nfi_server * serv, char * url, int serv_id, int n_serv, int root_master, nfi_walk_fn walk_fn, void * walk_arg)
    {
-       if (serv->xpn_session_dir != 1)
-       {
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-
-           // Without sesion close do nothing
-           return 0;
-       }
-
+       int ret, i, cb_ret;
+       char server[PATH_MAX], dir[PATH_MAX], path[PATH_MAX];
        struct nfi_xpn_server * server_aux;
-       struct nfi_xpn_server_fhandle * fh_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_status status;
+       struct st_xpn_server_walk_req req;
+       struct st_xpn_server_walk_entry entry;
+       char * buffer;
+       int offset;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
-       NULL_RET_ERR(fh,   EINVAL);
+       NULL_RET_ERR(url, EINVAL);
+       NULL_RET_ERR(walk_fn, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_walk] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] Get server private info\n", serv->id);
+       server_aux = nfi_xpn_server_stream(serv);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
-       {
+       // from url->server + dir
+       ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_walk] ERROR: incorrect url '%s'.\n", serv->id, url);
            errno = EINVAL;
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
@@ -1861,137 +3360,164 @@ nfi_xpn_server_write_KO:
            return -1;
        }
 
-       // private_info file handle
-       fh_aux = (struct nfi_xpn_server_fhandle * ) fh->priv_fh;
+       buffer = (char * ) malloc(XPN_SERVER_WALK_BUFFER_SIZE);
+       NULL_RET_ERR(buffer, ENOMEM);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] nfi_xpn_server_closedir(%p)\n", serv->id, fh_aux->dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_walk] nfi_xpn_server_walk(%s)\n", serv->id, dir);
 
-       msg.type = XPN_SERVER_CLOSEDIR_DIR;
+       int dir_len = strlen(dir);
+       msg.u_st_xpn_server_msg.op_walk.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_walk.path, XPN_PATH_MAX);
+       memccpy(msg.u_st_xpn_server_msg.op_walk.path, dir, 0, (dir_len < XPN_PATH_MAX) ? dir_len : XPN_PATH_MAX);
 
-#if!defined(HAVE_64BITS)
-       msg.u_st_xpn_server_msg.op_closedir.dir = (uint64_t) fh_aux->dir;
-#else
-       msg.u_st_xpn_server_msg.op_closedir.dir = fh_aux->dir;
-#endif
+       // do operation
+       msg.type = XPN_SERVER_WALK_DIR;
+       msg.u_st_xpn_server_msg.op_walk.serv_id     = serv_id;
+       msg.u_st_xpn_server_msg.op_walk.n_serv      = n_serv;
+       msg.u_st_xpn_server_msg.op_walk.root_master = root_master;
 
-       nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+       ret = nfi_write_operation(server_aux, & msg);
+       if ((ret >= 0) && (dir_len >= XPN_PATH_MAX)) {
+           ret = nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
+       }
+       if (ret < 0) {
+           FREE_AND_NULL(buffer);
+           return -1;
+       }
 
-       if (status.ret < 0) {
-           errno = status.server_errno;
+       // read the batches of entries until the end of the walk
+       cb_ret = 0;
+       do
+       {
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_walk_req));
+           if (ret < 0) {
+               FREE_AND_NULL(buffer);
+               return -1;
+           }
+
+           if ((req.size < 0) || (req.size > XPN_SERVER_WALK_BUFFER_SIZE)) {
+               FREE_AND_NULL(buffer);
+               errno = EIO;
+               return -1;
+           }
+
+           if (req.size > 0)
+           {
+               ret = nfi_xpn_server_comm_read_data(server_aux, buffer, req.size);
+               if (ret < 0) {
+                   FREE_AND_NULL(buffer);
+                   return -1;
+               }
+           }
+
+           offset = 0;
+           for (i = 0; (i < req.n_entries) && (cb_ret >= 0); i++)
+           {
+               memcpy(&entry, buffer + offset, sizeof(entry));
+               offset += sizeof(entry);
+               if ((entry.path_len < 0) || (entry.path_len >= PATH_MAX) || (offset + entry.path_len > req.size)) {
+                   break;
+               }
+
+               memcpy(path, buffer + offset, entry.path_len);
+               path[entry.path_len] = '\0';
+               offset += entry.path_len;
+
+               // a callback < 0 stops the delivery, the rest of the stream is drained
+               cb_ret = walk_fn(path, (entry.type == XPN_SERVER_WALK_DIR_ENTRY) ? NFIDIR : NFIFILE, entry.depth, walk_arg);
+           }
        }
+       while (req.n_entries > 0);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] nfi_xpn_server_closedir(%p)=%d\n", serv->id, fh_aux->dir, status.ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_closedir] >> End\n", serv->id);
+       FREE_AND_NULL(buffer);
 
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
-       return status.ret;
+       if (req.status.ret < 0) {
+           errno = req.status.server_errno;
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_walk] ERROR: fails to walk '%s' in server %s.\n", serv->id, dir, serv->server);
+           return -1;
+       }
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_walk] >> End\n", serv->id);
+
+       return (cb_ret < 0) ? -1 : 0;
    }
 
-   int nfi_xpn_server_rmdir(struct nfi_server * serv, char * url)
+   int nfi_xpn_server_summarize(struct nfi_server * serv, char * url, int serv_id, int n_serv, int root_master, struct nfi_summary * summary)
    {
        int ret;
        char server[PATH_MAX], dir[PATH_MAX];
        struct nfi_xpn_server * server_aux;
        struct st_xpn_server_msg msg;
-       struct st_xpn_server_status status;
+       struct st_xpn_server_summarize_req req;
 
        // Check arguments...
        NULL_RET_ERR(serv, EINVAL);
        NULL_RET_ERR(url, EINVAL);
+       NULL_RET_ERR(summary, EINVAL);
        nfi_xpn_server_keep_connected(serv);
        NULL_RET_ERR(serv->private_info, EINVAL);
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] >> Begin\n", serv->id);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_summarize] >> Begin\n", serv->id);
 
        // private_info...
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] Get server private info\n", serv->id);
-
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
-       if (server_aux == NULL)
-       {
-           errno = EINVAL;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-
-           return -1;
-       }
+       server_aux = nfi_xpn_server_stream(serv);
 
        // from url->server + dir
        ret = ParseURL(url, NULL, NULL, NULL, server, NULL, dir);
-       if (ret < 0)
-       {
+       if (ret < 0) {
+           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_summarize] ERROR: incorrect url '%s'.\n", serv->id, url);
            errno = EINVAL;
-           printf("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] ERROR: incorrect url '%s'.\n", serv->id, url);
-
            if (serv->keep_connected == 0) {
                nfi_xpn_server_disconnect(serv);
            }
+
            return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] ParseURL(%s)= %s; %s\n", serv->id, url, server, dir);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] nfi_xpn_server_rmdir(%s)\n", serv->id, dir);
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_summarize] nfi_xpn_server_summarize(%s)\n", serv->id, dir);
 
        int dir_len = strlen(dir);
-       msg.u_st_xpn_server_msg.op_rmdir.path_len = dir_len;
-       bzero(msg.u_st_xpn_server_msg.op_rmdir.path, XPN_PATH_MAX);
-
-       if (dir_len < XPN_PATH_MAX)
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_rmdir.path, dir, 0, dir_len);
-           //msg.u_st_xpn_server_msg.op_open.path[dir_len] = '\0';
-       }
-       else
-       {
-           memccpy(msg.u_st_xpn_server_msg.op_rmdir.path, dir, 0, XPN_PATH_MAX);
-           //msg.u_st_xpn_server_msg.op_open.path[127] = '\0';
-       }
-
-       msg.type = XPN_SERVER_RMDIR_DIR;
-
-       if (dir_len >= XPN_PATH_MAX)
-       {
-           ret = nfi_write_operation(server_aux, & msg);
-           if (ret < 0) {
-               return -1;
-           }
+       msg.u_st_xpn_server_msg.op_summarize.path_len = dir_len;
+       bzero(msg.u_st_xpn_server_msg.op_summarize.path, XPN_PATH_MAX);
+       memccpy(msg.u_st_xpn_server_msg.op_summarize.path, dir, 0, (dir_len < XPN_PATH_MAX) ? dir_len : XPN_PATH_MAX);
 
-           //int ret2 = socket_send(server_aux->server_socket, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
-           if (nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX) < 0 ) {
-               return -1;
-            }
+       // do operation
+       msg.type = XPN_SERVER_SUMMARIZE_DIR;
+       msg.u_st_xpn_server_msg.op_summarize.serv_id     = serv_id;
+       msg.u_st_xpn_server_msg.op_summarize.n_serv      = n_serv;
+       msg.u_st_xpn_server_msg.op_summarize.root_master = root_master;
 
-           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & (status), sizeof(struct st_xpn_server_status));
-           if (ret < 0) {
-               return -1;
-           }
+       ret = nfi_write_operation(server_aux, & msg);
+       if ((ret >= 0) && (dir_len >= XPN_PATH_MAX)) {
+           ret = nfi_xpn_server_comm_write_data(server_aux, dir + XPN_PATH_MAX, dir_len - XPN_PATH_MAX);
        }
-       else
-       {
-           nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
+       if (ret >= 0) {
+           ret = nfi_xpn_server_comm_read_data(server_aux, (char * ) & req, sizeof(struct st_xpn_server_summarize_req));
        }
-
-       //nfi_xpn_server_do_request(server_aux, & msg, (char * ) & (status), sizeof(struct st_xpn_server_status));
-       if (status.ret < 0)
-       {
-           errno = status.server_errno;
-           if (serv->keep_connected == 0) {
-               nfi_xpn_server_disconnect(serv);
-           }
-           return status.ret;
+       if (ret < 0) {
+           return -1;
        }
 
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] nfi_xpn_server_rmdir(%s)=%d\n", serv->id, dir, ret);
-       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_rmdir] >> End\n", serv->id);
-
        if (serv->keep_connected == 0) {
            nfi_xpn_server_disconnect(serv);
        }
 
+       if (req.status.ret < 0) {
+           errno = req.status.server_errno;
+           debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_summarize] ERROR: fails to summarize '%s' in server %s.\n", serv->id, dir, serv->server);
+           return -1;
+       }
+
+       summary->bytes = req.bytes;
+       summary->files = req.files;
+       summary->dirs  = req.dirs;
+
+       debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_summarize] >> End\n", serv->id);
+
        return 0;
    }
 
@@ -2015,7 +3541,7 @@ nfi_xpn_server_write_KO:
        NULL_RET_ERR(serv->private_info, EINVAL);
 
        // private_info...
-       server_aux = (struct nfi_xpn_server *)serv->private_info;
+       server_aux = nfi_xpn_server_stream(serv);
 
        ret = xpn_statfs(server_aux->fh, &xpninf, server_aux->cl);
        if (ret <0).{
@@ -2053,7 +3579,7 @@ nfi_xpn_server_write_KO:
        // private_info...
        debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_read_mdata] Get server private info\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       server_aux = nfi_xpn_server_stream(serv);
        if (server_aux == NULL)
        {
            errno = EINVAL;
@@ -2152,7 +3678,7 @@ nfi_xpn_server_write_KO:
        // private_info...
        debug_info("[SERV_ID=%d] [NFI_XPN] [nfi_xpn_server_write_mdata] Get server private info\n", serv->id);
 
-       server_aux = (struct nfi_xpn_server * ) serv->private_info;
+       server_aux = nfi_xpn_server_stream(serv);
        if (server_aux == NULL)
        {
            errno = EINVAL;
@@ -30,11 +30,50 @@
 
 #ifdef ENABLE_SCK_SERVER
    #include "nfi_sck_server_comm.h"
+   #include "nfi_shm_server_comm.h"
 #endif
 
 
 /* ... Functions / Funciones ......................................... */
 
+// A server at its connection limit answers "busy": wait with exponential back-off and random jitter,
+// at most busy_wait seconds (0: give up at once)
+int nfi_xpn_server_comm_lookup_conn ( struct nfi_xpn_server *params )
+{
+  int  ret;
+  long delay_ms  = XPN_CONNECT_BACKOFF_MIN_MS;
+  long waited_ms = 0;
+  long sleep_ms;
+
+  while (1)
+  {
+    ret = sersoc_lookup_port_name(params->srv_name, params->port_name, SOCKET_ACCEPT_CODE_SCK_CONN) ;
+    if (ret < 0) {
+        return -1;
+    }
+    if (strcmp(params->port_name, SOCKET_BUSY_ANSWER) != 0) {
+        return 0;
+    }
+
+    if (waited_ms >= (long)params->busy_wait * 1000)
+    {
+        fprintf(stderr, "nfi_xpn_server_comm_lookup_conn: '%s' is busy (waited %ld ms)\n", params->srv_name, waited_ms);
+        strcpy(params->port_name, "");
+        return -1;
+    }
+
+    sleep_ms = delay_ms / 2 + random() % (delay_ms / 2 + 1);
+    debug_info("srv_name: '%s' busy, retry in %ld ms\n", params->srv_name, sleep_ms);
+    usleep(sleep_ms * 1000);
+    waited_ms = waited_ms + sleep_ms;
+
+    delay_ms = delay_ms * 2;
+    if (delay_ms > XPN_CONNECT_BACKOFF_MAX_MS) {
+        delay_ms = XPN_CONNECT_BACKOFF_MAX_MS;
+    }
+  }
+}
+
 int nfi_xpn_server_comm_init ( struct nfi_xpn_server *params )
 {
   int ret = -1;
@@ -50,6 +89,7 @@ int nfi_xpn_server_comm_init ( struct nfi_xpn_server *params )
 
   #ifdef ENABLE_SCK_SERVER
   case XPN_SERVER_TYPE_SCK:
+  case XPN_SERVER_TYPE_SHM:
        ret = 0;
        break;
   #endif
@@ -78,6 +118,7 @@ int nfi_xpn_server_comm_destroy ( struct nfi_xpn_server *params )
 
   #ifdef ENABLE_SCK_SERVER
   case XPN_SERVER_TYPE_SCK:
+  case XPN_SERVER_TYPE_SHM:
        ret = 0;
        break;
   #endif
@@ -106,6 +147,17 @@ int nfi_xpn_server_comm_connect ( struct nfi_xpn_server *params )
   #endif
 
   #ifdef ENABLE_SCK_SERVER
+   case XPN_SERVER_TYPE_SHM:
+        ret = nfi_shm_server_comm_connect(params->srv_name, &params->server_shm);
+        if (ret >= 0) {
+            break;
+        }
+
+        // the server cannot map the memory of this process: use the socket from now on
+        debug_info("srv_name: '%s' shared memory not available, using sockets\n", params->srv_name);
+        params->server_type = XPN_SERVER_TYPE_SCK;
+        // fall through
+
    case XPN_SERVER_TYPE_SCK:
 
         if (params->keep_connected == 1)
@@ -113,7 +165,7 @@ int nfi_xpn_server_comm_connect ( struct nfi_xpn_server *params )
             // lookup port_name
             debug_info("srv_name: '%s' ??\n", params->srv_name);
 
-            ret = sersoc_lookup_port_name(params->srv_name, params->port_name, SOCKET_ACCEPT_CODE_SCK_CONN) ;
+            ret = nfi_xpn_server_comm_lookup_conn(params) ;
             if (ret < 0) 
             {
                 fprintf(stderr, "nfi_sck_server_comm_lookup_port_name: error on '%s'\n", params->srv_name);
@@ -156,6 +208,11 @@ int nfi_xpn_server_comm_disconnect ( struct nfi_xpn_server *params )
        ret = nfi_sck_server_comm_disconnect(params->server_socket, params->keep_connected);
        params->server_socket = -1;
        break;
+
+  case XPN_SERVER_TYPE_SHM:
+       ret = nfi_shm_server_comm_disconnect(params->server_shm);
+       params->server_shm = NULL;
+       break;
   #endif
   
   default:
@@ -184,6 +241,10 @@ int nfi_xpn_server_comm_write_operation ( struct nfi_xpn_server *params, int op)
   case XPN_SERVER_TYPE_SCK:
        ret = socket_send(params->server_socket, &op, sizeof(op));
        break;
+
+  case XPN_SERVER_TYPE_SHM:
+       ret = shm_ring_send(params->server_shm, &op, sizeof(op));
+       break;
   #endif
   
   default:
@@ -195,6 +256,61 @@ int nfi_xpn_server_comm_write_operation ( struct nfi_xpn_server *params, int op)
   return ret;
 }
 
+// Operation code followed by its pieces (op struct, path tail, data...).
+// With sockets it is one sendmsg, other transports keep one message per piece.
+ssize_t nfi_xpn_server_comm_write_request ( struct nfi_xpn_server *params, int op, __attribute__((__unused__)) struct iovec *iov, __attribute__((__unused__)) int iovcnt )
+{
+  ssize_t ret = -1;
+  __attribute__((__unused__)) int i;
+  XPN_PROFILER_DEFAULT_BEGIN();
+
+  switch (params->server_type)
+  {
+  #ifdef ENABLE_MPI_SERVER
+  case XPN_SERVER_TYPE_MPI:
+       ret = nfi_mpi_server_comm_write_operation(params->server_comm, op);
+       for (i = 0; (i < iovcnt) && (ret >= 0); i++) {
+            ret = nfi_mpi_server_comm_write_data(params->server_comm, iov[i].iov_base, iov[i].iov_len);
+       }
+       break;
+  #endif
+
+  #ifdef ENABLE_SCK_SERVER
+  case XPN_SERVER_TYPE_SCK:
+       {
+         struct iovec v[SOCKET_IOV_MAX];
+
+         if (iovcnt >= SOCKET_IOV_MAX) {
+             printf("[NFI_XPN_SERVER] [nfi_xpn_server_comm_write_request] ERROR: too many pieces (%d)\n", iovcnt);
+             break;
+         }
+
+         v[0].iov_base = &op;
+         v[0].iov_len  = sizeof(op);
+         for (i = 0; i < iovcnt; i++) {
+              v[i + 1] = iov[i];
+         }
+         ret = socket_sendv(params->server_socket, v, iovcnt + 1);
+       }
+       break;
+
+  case XPN_SERVER_TYPE_SHM:
+       ret = shm_ring_send(params->server_shm, &op, sizeof(op));
+       for (i = 0; (i < iovcnt) && (ret >= 0); i++) {
+            ret = shm_ring_send(params->server_shm, iov[i].iov_base, iov[i].iov_len);
+       }
+       break;
+  #endif
+
+  default:
+       printf("[NFI_XPN_SERVER] [nfi_xpn_server_comm_write_request] server_type '%d' not recognized\n",params->server_type);
+       break;
+  }
+
+  XPN_PROFILER_DEFAULT_END_CUSTOM("%s, %s", params->srv_name, xpn_server_op2string(op));
+  return ret;
+}
+
 ssize_t nfi_xpn_server_comm_write_data ( struct nfi_xpn_server *params, __attribute__((__unused__)) char *data, ssize_t size )
 {
   ssize_t ret = -1;
@@ -212,6 +328,10 @@ ssize_t nfi_xpn_server_comm_write_data ( struct nfi_xpn_server *params, __attrib
   case XPN_SERVER_TYPE_SCK:
        ret = socket_send(params->server_socket, data, size);
        break;
+
+  case XPN_SERVER_TYPE_SHM:
+       ret = shm_ring_send(params->server_shm, data, size);
+       break;
   #endif
   
   default:
@@ -223,6 +343,58 @@ ssize_t nfi_xpn_server_comm_write_data ( struct nfi_xpn_server *params, __attrib
   return ret;
 }
 
+// Several pieces (chunk header + data...): one sendmsg with sockets, one message per piece otherwise
+ssize_t nfi_xpn_server_comm_write_datav ( struct nfi_xpn_server *params, __attribute__((__unused__)) struct iovec *iov, __attribute__((__unused__)) int iovcnt )
+{
+  ssize_t ret = -1;
+  ssize_t total = 0;
+  __attribute__((__unused__)) int i;
+  XPN_PROFILER_DEFAULT_BEGIN();
+
+  switch (params->server_type)
+  {
+  #ifdef ENABLE_MPI_SERVER
+  case XPN_SERVER_TYPE_MPI:
+       for (i = 0; i < iovcnt; i++) {
+            ret = nfi_mpi_server_comm_write_data(params->server_comm, iov[i].iov_base, iov[i].iov_len);
+            if (ret < 0) {
+                break;
+            }
+            total = total + ret;
+       }
+       break;
+  #endif
+
+  #ifdef ENABLE_SCK_SERVER
+  case XPN_SERVER_TYPE_SCK:
+       ret = socket_sendv(params->server_socket, iov, iovcnt);
+       total = ret;
+       break;
+
+  case XPN_SERVER_TYPE_SHM:
+       for (i = 0; i < iovcnt; i++) {
+            ret = shm_ring_send(params->server_shm, iov[i].iov_base, iov[i].iov_len);
+            if (ret < 0) {
+                break;
+            }
+            total = total + ret;
+       }
+       break;
+  #endif
+
+  default:
+       printf("[NFI_XPN_SERVER] [nfi_xpn_server_comm_write_datav] server_type '%d' not recognized\n",params->server_type);
+       break;
+  }
+
+  if (ret >= 0) {
+      ret = total;
+  }
+
+  XPN_PROFILER_DEFAULT_END_CUSTOM("%s, %ld", params->srv_name, total);
+  return ret;
+}
+
 ssize_t nfi_xpn_server_comm_read_data ( struct nfi_xpn_server *params, __attribute__((__unused__))  char *data, ssize_t size )
 {
   ssize_t ret = -1;
@@ -240,6 +412,10 @@ ssize_t nfi_xpn_server_comm_read_data ( struct nfi_xpn_server *params, __attribu
   case XPN_SERVER_TYPE_SCK:
        ret = socket_recv(params->server_socket, data, size);
        break;
+
+  case XPN_SERVER_TYPE_SHM:
+       ret = shm_ring_recv(params->server_shm, data, size);
+       break;
 #endif
   
   default:
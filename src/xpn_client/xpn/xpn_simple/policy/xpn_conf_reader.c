@@ -140,12 +140,15 @@
        for (int i=0; i<conf_data->partition_n; i++)
        {
             FREE_AND_NULL(conf_data->partitions[i].partition_name) ;
+            FREE_AND_NULL(conf_data->partitions[i].distribution) ;
+            FREE_AND_NULL(conf_data->partitions[i].compression) ;
 
             for (int j=0; j<conf_data->partitions[i].server_n; j++) {
                  FREE_AND_NULL(conf_data->partitions[i].servers[j]) ;
             }
 
             FREE_AND_NULL(conf_data->partitions[i].servers);
+            FREE_AND_NULL(conf_data->partitions[i].weights);
             conf_data->partitions[i].server_n = 0 ;
        }
 
@@ -230,8 +233,14 @@
           conf_data->partitions[current_partition].partition_name    = NULL ; // [P1] -> strdup(value)
           conf_data->partitions[current_partition].replication_level = XPN_CONF_DEFAULT_REPLICATION_LEVEL ;
           conf_data->partitions[current_partition].bsize             = XPN_CONF_DEFAULT_BLOCKSIZE ;
+          conf_data->partitions[current_partition].small_file_size   = XPN_CONF_DEFAULT_SMALL_FILE_SIZE ;
+          conf_data->partitions[current_partition].server_streams    = XPN_CONF_DEFAULT_SERVER_STREAMS ;
+          conf_data->partitions[current_partition].hedge_percentile  = XPN_CONF_DEFAULT_HEDGE_PERCENTILE ;
+          conf_data->partitions[current_partition].distribution      = NULL ; // round_robin -> strdup(value)
+          conf_data->partitions[current_partition].compression       = NULL ; // none -> strdup(value)
           conf_data->partitions[current_partition].server_n          = 0 ;
           conf_data->partitions[current_partition].servers           = NULL ;
+          conf_data->partitions[current_partition].weights           = NULL ;
 
           // fields of partition...
           while (feof(fd) == 0)
@@ -284,12 +293,60 @@
                      fprintf(stderr, "xpn_conf_reader_load: malloc for '%s' fails\n", conf) ;
                      goto cleanup_error_XpnConfLoad;
                  }
+
+                             conf_data->partitions[current_partition].weights = realloc(conf_data->partitions[current_partition].weights, (conf_data->partitions[current_partition].server_n)*sizeof(int)) ;
+                 if (NULL == conf_data->partitions[current_partition].weights)
+                 {
+                     fprintf(stderr, "xpn_conf_reader_load: malloc for '%s' fails\n", conf) ;
+                     goto cleanup_error_XpnConfLoad;
+                 }
+
+                 conf_data->partitions[current_partition].weights[current_server] = XPN_CONF_DEFAULT_SERVER_WEIGHT ;
+             }
+             // server_weight = 4 (of the previous server_url)
+             else if (strcasecmp(key, XPN_CONF_TAG_SERVER_WEIGHT) == 0)
+             {
+                 if (0 == conf_data->partitions[current_partition].server_n)
+                 {
+                     printf("[%s:%ld] %s\n", conf, conf_data->lines_n, "ERROR: server_weight without a previous server_url.\n") ;
+                     goto cleanup_error_XpnConfLoad;
+                 }
+
+                 current_server = conf_data->partitions[current_partition].server_n - 1 ;
+                 conf_data->partitions[current_partition].weights[current_server] = atoi(value) ;
              }
              // bsize = 512k
              else if (strcasecmp(key, XPN_CONF_TAG_BLOCKSIZE) == 0)
              {
                  conf_data->partitions[current_partition].bsize = getSizeFactor(value) ;
              }
+             // small_file_size = 4k
+             else if (strcasecmp(key, XPN_CONF_TAG_SMALL_FILE_SIZE) == 0)
+             {
+                 conf_data->partitions[current_partition].small_file_size = getSizeFactor(value) ;
+             }
+             // server_streams = 4
+             else if (strcasecmp(key, XPN_CONF_TAG_SERVER_STREAMS) == 0)
+             {
+                 conf_data->partitions[current_partition].server_streams = atoi(value) ;
+             }
+             // hedge_percentile = 95
+             else if (strcasecmp(key, XPN_CONF_TAG_HEDGE_PERCENTILE) == 0)
+             {
+                 conf_data->partitions[current_partition].hedge_percentile = atoi(value) ;
+             }
+             // distribution = raid5
+             else if (strcasecmp(key, XPN_CONF_TAG_DISTRIBUTION) == 0)
+             {
+                 FREE_AND_NULL(conf_data->partitions[current_partition].distribution) ;
+                 conf_data->partitions[current_partition].distribution = strdup(value) ;
+             }
+             // compression = lz4
+             else if (strcasecmp(key, XPN_CONF_TAG_COMPRESSION) == 0)
+             {
+                 FREE_AND_NULL(conf_data->partitions[current_partition].compression) ;
+                 conf_data->partitions[current_partition].compression = strdup(value) ;
+             }
              // replication_level = 0
              else if (strcasecmp(key, XPN_CONF_TAG_REPLICATION_LEVEL) == 0)
              {
@@ -339,9 +396,14 @@
             fprintf(fd, " [%d] partition: %s\n", i,         conf_data->partitions[i].partition_name) ;
 
             fprintf(fd, "     ** bsize: %ld\n",             conf_data->partitions[i].bsize) ;
+            fprintf(fd, "     ** small file size: %ld\n",   conf_data->partitions[i].small_file_size) ;
+            fprintf(fd, "     ** server streams: %d\n",     conf_data->partitions[i].server_streams) ;
+            fprintf(fd, "     ** hedge percentile: %d\n",   conf_data->partitions[i].hedge_percentile) ;
+            fprintf(fd, "     ** distribution: %s\n",      (NULL != conf_data->partitions[i].distribution) ? conf_data->partitions[i].distribution : XPN_CONF_DEFAULT_DISTRIBUTION) ;
+            fprintf(fd, "     ** compression: %s\n",       (NULL != conf_data->partitions[i].compression)  ? conf_data->partitions[i].compression  : XPN_CONF_DEFAULT_COMPRESSION) ;
             fprintf(fd, "     ** replication level: %d\n",  conf_data->partitions[i].replication_level) ;
             for (int j=0; j<conf_data->partitions[i].server_n; j++) {
-                 fprintf(fd, "     ** server %d: %s\n", j,  conf_data->partitions[i].servers[j]) ;
+                 fprintf(fd, "     ** server %d: %s (weight %d)\n", j,  conf_data->partitions[i].servers[j], conf_data->partitions[i].weights[j]) ;
             }
        }
 
@@ -404,6 +466,27 @@
        return 0 ;
    }
 
+   int xpn_conf_reader_get_server_weight ( struct conf_file_data *conf_data, int partition, int server )
+   {
+       // check params
+       if (NULL == conf_data) {
+           fprintf(stderr, "xpn_conf_reader_get_server_weight: ERROR: NULL conf_data argument.\n") ;
+           return -1 ;
+       }
+
+       // check ranges
+       if (partition >= conf_data->partition_n) {
+           fprintf(stderr, "xpn_conf_reader_get_server_weight: ERROR: partition index '%d' out of range.\n", partition) ;
+   	return -1 ;
+       }
+       if (server >= conf_data->partitions[partition].server_n) {
+           fprintf(stderr, "xpn_conf_reader_get_server_weight: ERROR: server index '%d' out of range.\n", server) ;
+   	return -1 ;
+       }
+
+       return conf_data->partitions[partition].weights[server] ;
+   }
+
    int xpn_conf_reader_get_value ( struct conf_file_data *conf_data, int partition_index, char *key, char *value )
    {
        // check params
@@ -431,6 +514,31 @@
        {
    	sprintf(value, "%ld", conf_data->partitions[partition_index].bsize) ;
        }
+       // small_file_size = 4k
+       else if (strcasecmp(key, XPN_CONF_TAG_SMALL_FILE_SIZE) == 0)
+       {
+   	sprintf(value, "%ld", conf_data->partitions[partition_index].small_file_size) ;
+       }
+       // server_streams = 4
+       else if (strcasecmp(key, XPN_CONF_TAG_SERVER_STREAMS) == 0)
+       {
+   	sprintf(value, "%d", conf_data->partitions[partition_index].server_streams) ;
+       }
+       // hedge_percentile = 95
+       else if (strcasecmp(key, XPN_CONF_TAG_HEDGE_PERCENTILE) == 0)
+       {
+   	sprintf(value, "%d", conf_data->partitions[partition_index].hedge_percentile) ;
+       }
+       // distribution = raid5
+       else if (strcasecmp(key, XPN_CONF_TAG_DISTRIBUTION) == 0)
+       {
+   	strcpy(value, (NULL != conf_data->partitions[partition_index].distribution) ? conf_data->partitions[partition_index].distribution : XPN_CONF_DEFAULT_DISTRIBUTION) ;
+       }
+       // compression = lz4
+       else if (strcasecmp(key, XPN_CONF_TAG_COMPRESSION) == 0)
+       {
+   	strcpy(value, (NULL != conf_data->partitions[partition_index].compression) ? conf_data->partitions[partition_index].compression : XPN_CONF_DEFAULT_COMPRESSION) ;
+       }
        // replication_level = 0
        else if (strcasecmp(key, XPN_CONF_TAG_REPLICATION_LEVEL) == 0)
        {
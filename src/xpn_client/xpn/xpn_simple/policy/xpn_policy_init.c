@@ -43,6 +43,8 @@ int XpnInitServer ( struct conf_file_data *conf_data, struct xpn_partition * par
         return -1;
 
     serv -> block_size = part -> block_size; // Reference of the partition blocksize
+    serv -> n_streams  = part -> server_streams; // The backend may use less
+    serv -> codec      = part -> compression;    // The backend may not support it
     XPN_DEBUG("url=%s", url_buf);
 
     ret = ParseURL(url_buf, prt, NULL, NULL, NULL, NULL, NULL);
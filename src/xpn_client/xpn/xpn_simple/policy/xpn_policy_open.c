@@ -124,6 +124,43 @@ int XpnGetServers(int pd, int fd, struct nfi_server **servers)
   return n;
 }
 
+/*
+ * Directories only exist for sure in their master servers: the one that lists them
+ * in the parent directory (hash(path, n, 0)) and the one that lists their content
+ * (hash(path, n, 1)), plus replicas. In any other server they are created on demand.
+ */
+int XpnCheckServIsDirMaster(const char *abs_path, int n_serv, int replication_level, int serv)
+{
+  int i, master_dir, master_node;
+
+  master_dir  = hash((char *)abs_path, n_serv, 0);
+  master_node = hash((char *)abs_path, n_serv, 1);
+  for (i = 0; i < replication_level+1; i++)
+  {
+    if (((master_dir+i) % n_serv == serv) || ((master_node+i) % n_serv == serv)){
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int XpnMakeParentDir(struct nfi_server *serv, const char *abs_path)
+{
+  char url_serv[PATH_MAX];
+  int res;
+
+  XPN_DEBUG_BEGIN_CUSTOM("%s", abs_path);
+
+  XpnGetURLServer(serv, abs_path, url_serv);
+  serv->wrk->thread = serv->xpn_thread;
+  nfi_worker_do_mkdir_p(serv->wrk, dirname(url_serv), S_IRWXU);
+  res = nfiworker_wait(serv->wrk);
+
+  XPN_DEBUG_END_CUSTOM("%s", abs_path);
+  return res;
+}
+
 int XpnGetFh( struct xpn_metadata *mdata, struct nfi_fhandle **fh, struct nfi_server *servers, char *path)
 {
   int res = 0;
@@ -157,6 +194,13 @@ int XpnGetFh( struct xpn_metadata *mdata, struct nfi_fhandle **fh, struct nfi_se
   nfi_worker_do_open(servers->wrk, url_serv, O_RDWR | O_CREAT, S_IRWXU, fh_aux);
   res = nfiworker_wait(servers->wrk);
 
+  // first block of a file in this server: create its directory
+  if ((res<0) && (errno == ENOENT) && (XpnMakeParentDir(servers, path) >= 0))
+  {
+    nfi_worker_do_open(servers->wrk, url_serv, O_RDWR | O_CREAT, S_IRWXU, fh_aux);
+    res = nfiworker_wait(servers->wrk);
+  }
+
   if(res<0)
   {
     free(fh_aux);
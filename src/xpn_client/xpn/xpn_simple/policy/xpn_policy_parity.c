@@ -0,0 +1,434 @@
+
+  /*
+   *  Copyright 2000-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Luis Miguel Sanchez Garcia, Borja Bergua Guerra, Dario Muñoz Muñoz
+   *
+   *  This file is part of Expand.
+   *
+   *  Expand is free software: you can redistribute it and/or modify
+   *  it under the terms of the GNU Lesser General Public License as published by
+   *  the Free Software Foundation, either version 3 of the License, or
+   *  (at your option) any later version.
+   *
+   *  Expand is distributed in the hope that it will be useful,
+   *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+   *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   *  GNU Lesser General Public License for more details.
+   *
+   *  You should have received a copy of the GNU Lesser General Public License
+   *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+   *
+   */
+
+
+#include "xpn/xpn_simple/xpn_policy_parity.h"
+
+/**
+ * Calculates the server and the offset (in server) of the given offset (origin file) of a file with raid5 distribution.
+ *
+ * The stripe 's' has the blocks s*(nserv-1) ... s*(nserv-1)+nserv-2 and their parity: every server stores one of
+ * them in its block 's', and the parity moves to the previous server in each stripe.
+ *
+ * @param block_size[in] The block size of the file.
+ * @param nserv[in] The number of servers.
+ * @param offset[in] The original offset.
+ * @param replication[in] 0 for the data of the offset, 1 for the parity of its stripe.
+ * @param first_node[in] The server with the first block.
+ * @param local_offset[out] The offset in the server.
+ * @param serv[out] The server in which is located the given offset.
+ */
+void XpnCalculateBlockRaid5(int block_size, int nserv, off_t offset, int replication, int first_node, off_t *local_offset, int *serv)
+{
+	off_t block = offset / block_size;
+	off_t stripe = block / (nserv - 1);
+	int SP, IP, SD, ID;
+
+	// The servers repeat every nserv stripes
+	MATH_MISC_locateInRAID5withInternalParity((int)(block % ((off_t)nserv * (nserv - 1))), nserv, &SP, &IP, &SD, &ID);
+
+	// Calculate the server
+	if (replication == 0){
+		(*serv) = (SD + first_node) % nserv;
+	}else{
+		(*serv) = (SP + first_node) % nserv;
+	}
+
+	// Calculate the offset in the server
+	(*local_offset) = stripe * block_size + (offset % block_size);
+}
+
+/**
+ * Finds the server of the partition that failed at init.
+ *
+ * @return Returns the server, -1 if all of them work or -2 if more than one failed.
+ */
+static int XpnParityFailedServer(struct nfi_server *servers, int n)
+{
+	int i, failed = -1;
+
+	for (i = 0; i < n; i++){
+		if (servers[i].error == -1){
+			if (failed != -1){
+				return -2;
+			}
+			failed = i;
+		}
+	}
+
+	return failed;
+}
+
+static struct nfi_worker_io **XpnParityIoAlloc(int n, int max)
+{
+	struct nfi_worker_io **io;
+	int i;
+
+	io = (struct nfi_worker_io **) calloc(n, sizeof(struct nfi_worker_io *));
+	if (io == NULL){
+		return NULL;
+	}
+	for (i = 0; i < n; i++){
+		io[i] = (struct nfi_worker_io *) malloc(max * sizeof(struct nfi_worker_io));
+		if (io[i] == NULL){
+			for (i = 0; i < n; i++){
+				FREE_AND_NULL(io[i]);
+			}
+			FREE_AND_NULL(io);
+			return NULL;
+		}
+	}
+
+	return io;
+}
+
+static void XpnParityIoFree(struct nfi_worker_io **io, int n)
+{
+	int i;
+
+	if (io == NULL){
+		return;
+	}
+	for (i = 0; i < n; i++){
+		FREE_AND_NULL(io[i]);
+	}
+	FREE_AND_NULL(io);
+}
+
+static void XpnParityIoAdd(struct nfi_worker_io **io, int *ion, int serv, off_t local_offset, size_t size, void *buffer)
+{
+	io[serv][ion[serv]].offset = local_offset;
+	io[serv][ion[serv]].size   = size;
+	io[serv][ion[serv]].buffer = buffer;
+	ion[serv]++;
+	XPN_DEBUG("l_serv = %d, l_offset = %lld, l_size = %lld, ion[l_serv] = %d", serv, (long long)local_offset, (long long)size, ion[serv]);
+}
+
+/**
+ * Reads/writes the blocks of every server at the same time and waits for all of them.
+ *
+ * @return Returns 0 on success or -1 if any server fails.
+ */
+static int XpnParityTransfer(int fd, struct nfi_server *servers, int n, struct nfi_worker_io **io, int *ion, int is_write)
+{
+	struct xpn_rw_streams *st;
+	int i, err = 0;
+
+	st = (struct xpn_rw_streams *) calloc(n, sizeof(struct xpn_rw_streams));
+	if (st == NULL){
+		return -1;
+	}
+
+	for (i = 0; i < n; i++){
+		if (ion[i] == 0){
+			continue;
+		}
+		if (XpnGetFh(xpn_file_table[fd]->mdata, &(xpn_file_table[fd]->data_vfh->nfih[i]), &(servers[i]), xpn_file_table[fd]->path) < 0){
+			ion[i] = 0; // not launched
+			err = 1;
+			continue;
+		}
+
+		servers[i].wrk->thread = servers[i].xpn_thread;
+		XpnRWStreamsLaunch(&(st[i]), &(servers[i]), xpn_file_table[fd]->data_vfh->nfih[i], io[i], ion[i], is_write);
+	}
+
+	for (i = 0; i < n; i++){
+		if (ion[i] != 0 && XpnRWStreamsWait(&(st[i]), &(servers[i])) < 0){
+			err = 1;
+		}
+	}
+
+	FREE_AND_NULL(st);
+
+	return err ? -1 : 0;
+}
+
+/**
+ * Reads a range of a file with raid5 distribution without moving the file offset.
+ *
+ * The blocks of a failed server are rebuilt from the other blocks and the parity of their stripe.
+ * The holes and the bytes after the end of the file are read as zeros.
+ *
+ * @return Returns the bytes read or -1 on error.
+ */
+static ssize_t XpnParityReadAt(int fd, void *buffer, size_t size, off_t offset)
+{
+	struct xpn_metadata *mdata = xpn_file_table[fd]->mdata;
+	struct nfi_server *servers = NULL;
+	struct nfi_worker_io **io = NULL;
+	int *ion = NULL, *lost = NULL;
+	char *tmp = NULL, **blocks = NULL;
+	off_t bs, sw, s, first, last, b, lo, hi, end, l_offset;
+	int n, k, failed, l_serv, res = -1;
+
+	n = XpnGetServers(xpn_file_table[fd]->part->id, fd, &servers);
+	if (n <= 0){
+		return -1;
+	}
+
+	failed = XpnParityFailedServer(servers, n);
+	if (failed == -2){
+		errno = EIO;
+		return -1;
+	}
+
+	if (offset >= mdata->file_size || size == 0){
+		return 0;
+	}
+	if ((off_t)size > mdata->file_size - offset){
+		size = mdata->file_size - offset;
+	}
+	memset(buffer, 0, size);
+
+	bs    = mdata->block_size;
+	sw    = bs * (n - 1);
+	end   = offset + size;
+	first = offset / sw;
+	last  = (end - 1) / sw;
+
+	io     = XpnParityIoAlloc(n, last - first + 1);
+	ion    = (int *) calloc(n, sizeof(int));
+	lost   = (int *) malloc((last - first + 1) * sizeof(int));
+	blocks = (char **) malloc(n * sizeof(char *));
+	if (io == NULL || ion == NULL || lost == NULL || blocks == NULL){
+		goto cleanup_xpn_parity_read_at;
+	}
+
+	// The stripes with a lost block are read whole: the data blocks in their order and then the parity
+	if (failed >= 0){
+		tmp = (char *) calloc((last - first + 1) * n, bs);
+		if (tmp == NULL){
+			goto cleanup_xpn_parity_read_at;
+		}
+	}
+
+	for (s = first; s <= last; s++){
+		char *t = (tmp != NULL) ? tmp + (s - first) * n * bs : NULL;
+
+		lost[s - first] = -1;
+		for (k = 0; k < n - 1 && failed >= 0; k++){
+			b = s * sw + k * bs;
+			XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], b, 0, mdata->first_node, &l_offset, &l_serv);
+			if (l_serv == failed && b < end && b + bs > offset){
+				lost[s - first] = k;
+			}
+		}
+
+		for (k = 0; k < n - 1; k++){
+			b  = s * sw + k * bs;
+			lo = MAX(b, offset);
+			hi = MIN(b + bs, end);
+			if (lost[s - first] == -1 && lo < hi){
+				XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], lo, 0, mdata->first_node, &l_offset, &l_serv);
+				XpnParityIoAdd(io, ion, l_serv, l_offset, hi - lo, (char *)buffer + (lo - offset));
+			}
+			else if (lost[s - first] != -1 && k != lost[s - first]){
+				XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], b, 0, mdata->first_node, &l_offset, &l_serv);
+				XpnParityIoAdd(io, ion, l_serv, l_offset, bs, t + k * bs);
+			}
+		}
+		if (lost[s - first] != -1){
+			XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], s * sw, 1, mdata->first_node, &l_offset, &l_serv);
+			XpnParityIoAdd(io, ion, l_serv, l_offset, bs, t + (n - 1) * bs);
+		}
+	}
+
+	if (XpnParityTransfer(fd, servers, n, io, ion, 0) < 0){
+		goto cleanup_xpn_parity_read_at;
+	}
+
+	// Rebuild the lost blocks: the XOR of the other blocks of the stripe and the parity
+	for (s = first; s <= last; s++){
+		char *t = tmp + (s - first) * n * bs;
+		int nblocks = 0;
+
+		if (lost[s - first] == -1){
+			continue;
+		}
+		for (k = 0; k < n; k++){
+			if (k != lost[s - first]){
+				blocks[nblocks++] = t + k * bs;
+			}
+		}
+		MATH_MISC_XorN(t + lost[s - first] * bs, blocks, nblocks, bs);
+
+		for (k = 0; k < n - 1; k++){
+			b  = s * sw + k * bs;
+			lo = MAX(b, offset);
+			hi = MIN(b + bs, end);
+			if (lo < hi){
+				memcpy((char *)buffer + (lo - offset), t + k * bs + (lo - b), hi - lo);
+			}
+		}
+	}
+
+	res = size;
+
+cleanup_xpn_parity_read_at:
+	XpnParityIoFree(io, n);
+	FREE_AND_NULL(ion);
+	FREE_AND_NULL(lost);
+	FREE_AND_NULL(blocks);
+	FREE_AND_NULL(tmp);
+
+	return res;
+}
+
+/**
+ * Reads a file with raid5 distribution, also when one of the servers has failed.
+ *
+ * @param fd[in] A file descriptor.
+ * @param buffer[out] The buffer.
+ * @param size[in] The size.
+ * @param offset[in] The offset in the file.
+ *
+ * @return Returns the bytes read or -1 on error.
+ */
+ssize_t XpnParityRead(int fd, void *buffer, size_t size, off_t offset)
+{
+	ssize_t res;
+
+	XPN_DEBUG_BEGIN_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+
+	res = XpnParityReadAt(fd, buffer, size, offset);
+	if (res > 0){
+		xpn_file_table[fd]->offset += res;
+	}
+
+	XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+
+	return res;
+}
+
+/**
+ * Writes a file with raid5 distribution: the data blocks and the new parity of every stripe written.
+ *
+ * The parity needs the whole stripe, so the rest of the first and the last stripe is read before.
+ * The blocks of a failed server are not written (they are rebuilt from the parity when read).
+ *
+ * @param fd[in] A file descriptor.
+ * @param buffer[in] The buffer.
+ * @param size[in] The size.
+ * @param offset[in] The offset in the file.
+ *
+ * @return Returns the bytes written or -1 on error.
+ */
+ssize_t XpnParityWrite(int fd, const void *buffer, size_t size, off_t offset)
+{
+	struct xpn_metadata *mdata = xpn_file_table[fd]->mdata;
+	struct nfi_server *servers = NULL;
+	struct nfi_worker_io **io = NULL;
+	int *ion = NULL;
+	char *sbuf = NULL, *pbuf = NULL, **blocks = NULL;
+	off_t bs, sw, s, first, last, b, lo, hi, end, l_offset;
+	int n, k, failed, l_serv;
+	ssize_t res = -1;
+
+	XPN_DEBUG_BEGIN_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+
+	n = XpnGetServers(xpn_file_table[fd]->part->id, fd, &servers);
+	if (n <= 0){
+		goto cleanup_xpn_parity_write;
+	}
+
+	failed = XpnParityFailedServer(servers, n);
+	if (failed == -2){
+		errno = EIO;
+		goto cleanup_xpn_parity_write;
+	}
+
+	bs    = mdata->block_size;
+	sw    = bs * (n - 1);
+	end   = offset + size;
+	first = offset / sw;
+	last  = (end - 1) / sw;
+
+	io     = XpnParityIoAlloc(n, last - first + 1);
+	ion    = (int *) calloc(n, sizeof(int));
+	sbuf   = (char *) calloc(last - first + 1, sw);
+	pbuf   = (char *) malloc((last - first + 1) * bs);
+	blocks = (char **) malloc(n * sizeof(char *));
+	if (io == NULL || ion == NULL || sbuf == NULL || pbuf == NULL || blocks == NULL){
+		goto cleanup_xpn_parity_write;
+	}
+
+	// The stripes with the old data around the new one
+	if (XpnParityReadAt(fd, sbuf, offset - first * sw, first * sw) < 0){
+		goto cleanup_xpn_parity_write;
+	}
+	if (XpnParityReadAt(fd, sbuf + (end - first * sw), (last + 1) * sw - end, end) < 0){
+		goto cleanup_xpn_parity_write;
+	}
+	memcpy(sbuf + (offset - first * sw), buffer, size);
+
+	for (s = first; s <= last; s++){
+		char *t = sbuf + (s - first) * sw;
+
+		// Parity
+		for (k = 0; k < n - 1; k++){
+			blocks[k] = t + k * bs;
+		}
+		MATH_MISC_XorN(pbuf + (s - first) * bs, blocks, n - 1, bs);
+
+		// Data written
+		for (k = 0; k < n - 1; k++){
+			b  = s * sw + k * bs;
+			lo = MAX(b, offset);
+			hi = MIN(b + bs, end);
+			if (lo >= hi){
+				continue;
+			}
+			XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], lo, 0, mdata->first_node, &l_offset, &l_serv);
+			if (l_serv != failed){
+				XpnParityIoAdd(io, ion, l_serv, l_offset, hi - lo, t + (lo - s * sw));
+			}
+		}
+
+		XpnCalculateBlockRaid5(bs, mdata->data_nserv[0], s * sw, 1, mdata->first_node, &l_offset, &l_serv);
+		if (l_serv != failed){
+			XpnParityIoAdd(io, ion, l_serv, l_offset, bs, pbuf + (s - first) * bs);
+		}
+	}
+
+	if (XpnParityTransfer(fd, servers, n, io, ion, 1) < 0){
+		goto cleanup_xpn_parity_write;
+	}
+
+	res = size;
+	xpn_file_table[fd]->offset = end;
+
+	// Update file_size in metadata
+	if (end > mdata->file_size){
+		mdata->file_size = end;
+		XpnUpdateMetadata(mdata, n, servers, xpn_file_table[fd]->path, xpn_file_table[fd]->part->replication_level, 1);
+	}
+
+cleanup_xpn_parity_write:
+	XpnParityIoFree(io, n);
+	FREE_AND_NULL(ion);
+	FREE_AND_NULL(sbuf);
+	FREE_AND_NULL(pbuf);
+	FREE_AND_NULL(blocks);
+	XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+
+	return res;
+}
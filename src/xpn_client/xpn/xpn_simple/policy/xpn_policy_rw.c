@@ -21,6 +21,8 @@
 
 
 #include "xpn/xpn_simple/xpn_policy_rw.h"
+#include "xpn/xpn_simple/xpn_policy_parity.h"
+#include "base/time_misc.h"
 
 /**
  * Calculates the server and the offset (in server) of the given offset (origin file) of a file with replication.
@@ -46,8 +48,73 @@ void XpnCalculateBlock(int block_size, int replication_level, int nserv, off_t o
 	(*local_offset) = block_line * block_size + (offset % block_size);
 }
 
+/**
+ * Calculates the server and the offset (in server) of the given offset (origin file) of a file with weighted distribution.
+ *
+ * Each round has sum(weights) blocks: starting at first_node, every server takes as many consecutive blocks as its weight.
+ * The replica r of a block is in the r-th next server, so in every round a server stores, one after another,
+ * the blocks of its own (weights[serv]) and the replicas of the previous servers (weights[serv-1], weights[serv-2], ...).
+ *
+ * @param block_size[in] The block size of the file.
+ * @param replication_level[in] The replication level of the file.
+ * @param nserv[in] The number of servers.
+ * @param weights[in] The blocks per round of each server.
+ * @param offset[in] The original offset.
+ * @param replication[in] The replication of actual offset.
+ * @param first_node[in] The server with the first block.
+ * @param local_offset[out] The offset in the server.
+ * @param serv[out] The server in which is located the given offset.
+ */
+void XpnCalculateBlockWeighted(int block_size, int replication_level, int nserv, const unsigned char *weights, off_t offset, int replication, int first_node, off_t *local_offset, int *serv)
+{
+	off_t block = offset / block_size;
+	off_t round_blocks = 0;
+	off_t slot, block_round, local_block;
+	int i, owner;
+
+	for (i = 0; i < nserv; i++) {
+		round_blocks += weights[i];
+	}
+	block_round = block / round_blocks;
+	slot = block % round_blocks;
+
+	// Server that owns the slot of the round
+	owner = first_node % nserv;
+	while (slot >= weights[owner]) {
+		slot -= weights[owner];
+		owner = (owner + 1) % nserv;
+	}
+
+	// Calculate the server
+	(*serv) = (owner + replication) % nserv;
+
+	// Calculate the offset in the server: blocks of the previous rounds and of the previous replicas in this round
+	local_block = 0;
+	for (i = 0; i <= replication_level; i++) {
+		local_block += weights[((*serv) - i + nserv) % nserv];
+	}
+	local_block = block_round * local_block + slot;
+	for (i = 0; i < replication; i++) {
+		local_block += weights[((*serv) - i + nserv) % nserv];
+	}
+
+	(*local_offset) = local_block * block_size + (offset % block_size);
+}
+
 void XpnCalculateBlockMdata(struct xpn_metadata *mdata, off_t offset, int replication, off_t *local_offset, int *serv)
 {
+	// Weighted distribution (without expand or shrink)
+	if (mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED){
+		XpnCalculateBlockWeighted(mdata->block_size, mdata->replication_level, mdata->data_nserv[0], mdata->weights, offset, replication, mdata->first_node, local_offset, serv);
+		return;
+	}
+
+	// Raid5 distribution (without expand or shrink)
+	if (mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5){
+		XpnCalculateBlockRaid5(mdata->block_size, mdata->data_nserv[0], offset, replication, mdata->first_node, local_offset, serv);
+		return;
+	}
+
 	// Without expand or shrink
 	if (mdata->data_nserv[1] == 0){
 		XpnCalculateBlock(mdata->block_size, mdata->replication_level, mdata->data_nserv[0], offset, replication, mdata->first_node, local_offset, serv);
@@ -346,44 +413,90 @@ void XpnCalculateBlockInvert(int block_size, int replication_level, int nserv, i
 
 /**
  * Calculates the server and the offset (in server) for reads of the given offset (origin file) of a file with replication.
+ * When no replica is local, the one with the lowest expected wait is used (see nfi_server_cost).
  *
  * @param fd[in] A file descriptor.
  * @param offset[in] The original offset.
  * @param serv_client[in] To optimize: the server where the client is.
- * @param replication[in] The replication of actual offset.
+ * @param load[in] Blocks already given to each server in this operation (NULL if none).
  * @param local_offset[out] The offset in the server.
  * @param serv[out] The server in which is located the given offset.
  *
  * @return Returns 0 on success or -1 on error.
  */
-int XpnReadGetBlock(int fd, off_t offset, int serv_client, off_t *local_offset, int *serv)
-{	
-	int retries = 0;
-	int replication = 0;
+int XpnReadGetBlockBalanced(int fd, off_t offset, int serv_client, int *load, off_t *local_offset, int *serv)
+{
+	struct nfi_server *servers = xpn_file_table[fd]->part->data_serv;
+	int replication_level = xpn_file_table[fd]->part->replication_level;
+	int replication, r, s, best_serv;
+	off_t l_offset, best_offset;
+	long cost, best_cost;
+
+	// The other "replica" of a raid5 file is the parity of the stripe
+	if (xpn_file_table[fd]->mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5){
+		XpnCalculateBlockMdata(xpn_file_table[fd]->mdata, offset, 0, local_offset, serv);
+		return 0;
+	}
+
 	if (serv_client != -1){
-		do{
+		for (replication = 0; replication <= replication_level; replication++){
 			XpnCalculateBlockMdata(xpn_file_table[fd]->mdata, offset, replication, local_offset, serv);
-			if ((*serv) == serv_client && xpn_file_table[fd]->part->data_serv[(*serv)].error != -1 ){
+			if ((*serv) == serv_client && servers[(*serv)].error != -1){
 				return 0;
 			}
-			replication++;
-		}while(replication <= xpn_file_table[fd]->part->replication_level);
+		}
 	}
-	
+
+	// The first replica that works if there is only one or all are down
 	replication = 0;
-	if (xpn_file_table[fd]->part->replication_level != 0)
-		replication = rand() % (xpn_file_table[fd]->part->replication_level + 1);
+	if (replication_level != 0)
+		replication = rand() % (replication_level + 1);
+
+	best_serv = -1;
+	best_offset = 0;
+	best_cost = 0;
+	for (r = 0; r <= replication_level; r++){
+		XpnCalculateBlockMdata(xpn_file_table[fd]->mdata, offset, (replication + r) % (replication_level + 1), &l_offset, &s);
+		if (servers[s].error == -1){
+			continue;
+		}
+
+		cost = nfi_server_cost(&(servers[s]), (load != NULL) ? load[s] : 0);
+		if (best_serv == -1 || cost < best_cost){
+			best_serv = s;
+			best_offset = l_offset;
+			best_cost = cost;
+		}
+	}
 
-	do{
+	if (best_serv == -1){
 		XpnCalculateBlockMdata(xpn_file_table[fd]->mdata, offset, replication, local_offset, serv);
-		if (xpn_file_table[fd]->part->replication_level != 0)
-			replication = (replication + 1) % (xpn_file_table[fd]->part->replication_level + 1);
-		retries++;
-	}while(xpn_file_table[fd]->part->data_serv[*serv].error == -1 && retries <= xpn_file_table[fd]->part->replication_level);
-	
+		return 0;
+	}
+
+	*serv = best_serv;
+	*local_offset = best_offset;
+
 	return 0;
 }
 
+/**
+ * Calculates the server and the offset (in server) for reads of the given offset (origin file) of a file with replication.
+ *
+ * @param fd[in] A file descriptor.
+ * @param offset[in] The original offset.
+ * @param serv_client[in] To optimize: the server where the client is.
+ * @param replication[in] The replication of actual offset.
+ * @param local_offset[out] The offset in the server.
+ * @param serv[out] The server in which is located the given offset.
+ *
+ * @return Returns 0 on success or -1 on error.
+ */
+int XpnReadGetBlock(int fd, off_t offset, int serv_client, off_t *local_offset, int *serv)
+{
+	return XpnReadGetBlockBalanced(fd, offset, serv_client, NULL, local_offset, serv);
+}
+
 /**
  * Calculates the server and the offset (in server) for writes of the given offset (origin file) of a file with replication.
  *
@@ -431,7 +544,7 @@ void XpnReadBlocksBlockByBlock(int fd, const void *buffer, size_t size, off_t of
 
 	while(size>count)
 	{
-		XpnReadGetBlock(fd, new_offset, serv_client, &l_offset, &l_serv);
+		XpnReadGetBlockBalanced(fd, new_offset, serv_client, ion, &l_offset, &l_serv);
 
 		// l_size is the remaining bytes from new_offset until the end of the block
 		l_size = xpn_file_table[fd]->block_size -
@@ -682,6 +795,10 @@ void *XpnWriteBlocks ( int fd, const void *buffer, size_t size, off_t offset, st
 	// if (xpn_file_table[fd]->part->replication_level > 0){
     // 	optimize = 0; // Do not optimize
 	// }
+	// With weighted distribution the replicas of a server are not next to its blocks, so they cannot be grouped
+	if (xpn_file_table[fd]->part->replication_level > 0 && xpn_file_table[fd]->mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED){
+		optimize = 0; // Do not optimize
+	}
 
 	void *new_buffer = (void *)buffer;
 	new_buffer = malloc(size * (xpn_file_table[fd]->part->replication_level + 1));
@@ -808,3 +925,500 @@ ssize_t XpnGetRealFileSize(struct xpn_partition *part, struct nfi_attr *attr, in
 	}
 	return offset;
 }
+
+/**
+ * Launches the read/write of a server, split across its connections when it is large enough.
+ *
+ * @param st[out] The requests launched, to wait for them with XpnRWStreamsWait.
+ * @param serv[in] The server.
+ * @param fh[in] The file handler in the server.
+ * @param io[in] The blocks of the server.
+ * @param ion[in] The number of blocks.
+ * @param is_write[in] 1 to write the blocks, 0 to read them.
+ *
+ * @return Returns the number of requests launched.
+ */
+int XpnRWStreamsLaunch(struct xpn_rw_streams *st, struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int ion, int is_write)
+{
+	size_t total = 0, part, left, chunk;
+	int i, k, p, n;
+
+	memset(st, 0, sizeof(struct xpn_rw_streams));
+
+	for (i = 0; i < ion; i++){
+		total += io[i].size;
+	}
+
+	// One part per connection, but not smaller than XPN_RW_STREAM_MIN_SIZE
+	k = serv->n_streams;
+	if ((size_t)k > total / XPN_RW_STREAM_MIN_SIZE){
+		k = total / XPN_RW_STREAM_MIN_SIZE;
+	}
+	if (serv->xpn_thread == TH_NOT){
+		k = 1;
+	}
+
+	if (k > 1){
+		st->reqs = (struct nfi_request *) malloc(k * sizeof(struct nfi_request));
+		st->io   = (struct nfi_worker_io *) malloc((ion + k) * sizeof(struct nfi_worker_io));
+		st->ion  = (int *) calloc(k, sizeof(int));
+		if (st->reqs == NULL || st->io == NULL || st->ion == NULL){
+			FREE_AND_NULL(st->reqs);
+			FREE_AND_NULL(st->io);
+			FREE_AND_NULL(st->ion);
+			k = 1;
+		}
+	}
+
+	if (k <= 1){
+		if (is_write){
+			nfi_worker_do_write(serv->wrk, fh, io, ion);
+		}else{
+			nfi_worker_do_read(serv->wrk, fh, io, ion);
+		}
+		return 1;
+	}
+
+	// Split the blocks in k parts of the same size, cutting a block if needed
+	part = total / k;
+	left = part;
+	p = 0;
+	n = 0;
+	for (i = 0; i < ion; i++){
+		off_t offset = io[i].offset;
+		size_t size = io[i].size;
+		char *buffer = (char *) io[i].buffer;
+
+		while (size > 0){
+			chunk = size;
+			if (p < k - 1 && chunk > left){
+				chunk = left;
+			}
+
+			st->io[n].offset = offset;
+			st->io[n].size = chunk;
+			st->io[n].buffer = buffer;
+			st->ion[p]++;
+			n++;
+
+			offset += chunk;
+			buffer += chunk;
+			size -= chunk;
+			left -= chunk;
+			if (left == 0 && p < k - 1){
+				p++;
+				left = part;
+			}
+		}
+	}
+
+	n = 0;
+	for (p = 0; p < k; p++){
+		nfi_request_init(&(st->reqs[p]), serv);
+		if (is_write){
+			nfi_request_do_write(&(st->reqs[p]), fh, &(st->io[n]), st->ion[p]);
+		}else{
+			nfi_request_do_read(&(st->reqs[p]), fh, &(st->io[n]), st->ion[p]);
+		}
+		n += st->ion[p];
+	}
+	st->n = k;
+
+	return k;
+}
+
+/**
+ * Waits for the read/write launched by XpnRWStreamsLaunch.
+ *
+ * @param st[in] The requests launched.
+ * @param serv[in] The server.
+ *
+ * @return Returns the bytes read/written in the server or -1 on error.
+ */
+ssize_t XpnRWStreamsWait(struct xpn_rw_streams *st, struct nfi_server *serv)
+{
+	ssize_t res;
+
+	if (st->n == 0){
+		return nfiworker_wait(serv->wrk);
+	}
+
+	res = nfi_request_wait_all(st->reqs, st->n);
+
+	FREE_AND_NULL(st->reqs);
+	FREE_AND_NULL(st->io);
+	FREE_AND_NULL(st->ion);
+	st->n = 0;
+
+	return res;
+}
+
+// Hedged reads still running after another replica answered (freed by XpnHedgeReap)
+static pthread_mutex_t   xpn_hedge_m    = PTHREAD_MUTEX_INITIALIZER;
+static struct xpn_hedge *xpn_hedge_list = NULL;
+
+static void XpnHedgeDone(struct nfi_request *req)
+{
+	struct xpn_hedge *h = (struct xpn_hedge *) req->done_arg;
+
+	pthread_mutex_lock(&(h->m));
+	if (req == &(h->req)){
+		h->req_done = 1;
+		if (h->req_slow){
+			__atomic_sub_fetch(&(req->wrk->server->n_slow), 1, __ATOMIC_RELAXED);
+		}
+	}else{
+		h->hreqs_done++;
+		if (req->arg.result < 0){
+			h->hreqs_failed = 1;
+		}
+	}
+	pthread_cond_broadcast(&(h->c));
+	pthread_mutex_unlock(&(h->m));
+}
+
+static int XpnHedgeFinished(struct xpn_hedge *h)
+{
+	return h->req_done && (h->hreqs_done == h->n_hreqs);
+}
+
+static void XpnHedgeFree(struct xpn_hedge *h)
+{
+	int i;
+
+	// the requests are waited so that the workers do not use them anymore
+	nfi_request_wait(&(h->req));
+	for (i = 0; i < h->n_hreqs; i++){
+		nfi_request_wait(&(h->hreqs[i]));
+	}
+
+	pthread_mutex_destroy(&(h->m));
+	pthread_cond_destroy(&(h->c));
+	FREE_AND_NULL(h->hreqs);
+	FREE_AND_NULL(h->hio);
+	FREE_AND_NULL(h->io);
+	FREE_AND_NULL(h->buf);
+	FREE_AND_NULL(h->hbuf);
+	FREE_AND_NULL(h);
+}
+
+/**
+ * Launches a read of the blocks of one server. The data is read in a buffer of its own, because
+ * another replica may answer first (see XpnHedgeWait) and this read may end after the caller returns.
+ *
+ * @param serv[in] The server.
+ * @param fh[in] The file handle in the server.
+ * @param io[in] The blocks to read in the server.
+ * @param ion[in] The number of blocks.
+ *
+ * @return Returns the read launched, or NULL on error.
+ */
+struct xpn_hedge *XpnHedgeLaunch(struct nfi_server *serv, struct nfi_fhandle *fh, struct nfi_worker_io *io, int ion)
+{
+	struct xpn_hedge *h;
+	size_t pos;
+	int i;
+
+	// the reads abandoned before that already ended
+	XpnHedgeReap(0);
+
+	h = (struct xpn_hedge *) calloc(1, sizeof(struct xpn_hedge));
+	if (h == NULL){
+		return NULL;
+	}
+
+	for (i = 0; i < ion; i++){
+		h->size += io[i].size;
+	}
+
+	h->io  = (struct nfi_worker_io *) malloc(2 * ion * sizeof(struct nfi_worker_io));
+	h->buf = (char *) malloc(h->size);
+	if (h->io == NULL || h->buf == NULL){
+		FREE_AND_NULL(h->io);
+		FREE_AND_NULL(h->buf);
+		FREE_AND_NULL(h);
+		return NULL;
+	}
+
+	pthread_mutex_init(&(h->m), NULL);
+	pthread_cond_init(&(h->c), NULL);
+
+	h->dst = h->io + ion;
+	h->ion = ion;
+	pos = 0;
+	for (i = 0; i < ion; i++){
+		h->dst[i] = io[i];
+		h->io[i] = io[i];
+		h->io[i].buffer = h->buf + pos;
+		pos += io[i].size;
+	}
+
+	nfi_request_init(&(h->req), serv);
+	h->req.done = XpnHedgeDone;
+	h->req.done_arg = h;
+
+	TIME_MISC_Timer(&(h->t_launch));
+	nfi_request_do_read(&(h->req), fh, h->io, ion);
+	nfi_request_flush();
+
+	// not launched (server down)
+	if (!h->req.launched){
+		h->req.arg.result = -1;
+		h->req_done = 1;
+	}
+
+	return h;
+}
+
+/**
+ * Sends the blocks of a read to the other replicas, in one request per server.
+ *
+ * @return Returns the number of requests launched (0 if some block has no other replica available).
+ */
+static int XpnHedgeLaunchReplicas(struct xpn_hedge *h, int fd, struct nfi_server *servers, int serv, const void *buffer, off_t offset)
+{
+	int n = xpn_file_table[fd]->part->data_nserv;
+	int replication_level = xpn_file_table[fd]->part->replication_level;
+	int *load = NULL, *alt_serv = NULL;
+	off_t *alt_offset = NULL;
+	off_t o, l_offset;
+	size_t pos;
+	long cost, best_cost;
+	int i, k, r, s, best, first, n_io, n_req, ret = 0;
+
+	load       = (int *) calloc(n, sizeof(int));
+	alt_serv   = (int *) malloc(h->ion * sizeof(int));
+	alt_offset = (off_t *) malloc(h->ion * sizeof(off_t));
+	h->hio     = (struct nfi_worker_io *) malloc(h->ion * sizeof(struct nfi_worker_io));
+	h->hbuf    = (char *) malloc(h->size);
+	if (load == NULL || alt_serv == NULL || alt_offset == NULL || h->hio == NULL || h->hbuf == NULL){
+		goto cleanup_XpnHedgeLaunchReplicas;
+	}
+
+	// the least loaded of the other replicas of each block
+	for (k = 0; k < h->ion; k++){
+		o = offset + ((char *) h->dst[k].buffer - (const char *) buffer);
+
+		best = -1;
+		best_cost = 0;
+		for (r = 0; r <= replication_level; r++){
+			XpnCalculateBlockMdata(xpn_file_table[fd]->mdata, o, r, &l_offset, &s);
+			if (s == serv || servers[s].error == -1){
+				continue;
+			}
+
+			cost = nfi_server_cost(&(servers[s]), load[s]);
+			if (best == -1 || cost < best_cost){
+				best = s;
+				best_cost = cost;
+				alt_offset[k] = l_offset;
+			}
+		}
+
+		if (best == -1){
+			goto cleanup_XpnHedgeLaunchReplicas;
+		}
+		alt_serv[k] = best;
+		load[best]++;
+	}
+
+	n_req = 0;
+	for (s = 0; s < n; s++){
+		if (load[s] == 0){
+			continue;
+		}
+		if (XpnGetFh(xpn_file_table[fd]->mdata, &(xpn_file_table[fd]->data_vfh->nfih[s]), &(servers[s]), xpn_file_table[fd]->path) < 0){
+			goto cleanup_XpnHedgeLaunchReplicas;
+		}
+		n_req++;
+	}
+
+	h->hreqs = (struct nfi_request *) malloc(n_req * sizeof(struct nfi_request));
+	if (h->hreqs == NULL){
+		goto cleanup_XpnHedgeLaunchReplicas;
+	}
+
+	pthread_mutex_lock(&(h->m));
+	h->n_hreqs = n_req;
+	pthread_mutex_unlock(&(h->m));
+
+	// the blocks of each server together, each one in the same place of hbuf as in buf
+	n_io = 0;
+	i = 0;
+	for (s = 0; s < n; s++){
+		if (load[s] == 0){
+			continue;
+		}
+
+		first = n_io;
+		pos = 0;
+		for (k = 0; k < h->ion; k++){
+			if (alt_serv[k] == s){
+				h->hio[n_io].offset = alt_offset[k];
+				h->hio[n_io].size   = h->dst[k].size;
+				h->hio[n_io].buffer = h->hbuf + pos;
+				n_io++;
+			}
+			pos += h->dst[k].size;
+		}
+
+		nfi_request_init(&(h->hreqs[i]), &(servers[s]));
+		h->hreqs[i].done = XpnHedgeDone;
+		h->hreqs[i].done_arg = h;
+		nfi_request_do_read(&(h->hreqs[i]), xpn_file_table[fd]->data_vfh->nfih[s], &(h->hio[first]), n_io - first);
+
+		// not launched (server down)
+		if (!h->hreqs[i].launched){
+			pthread_mutex_lock(&(h->m));
+			h->hreqs[i].arg.result = -1;
+			h->hreqs_done++;
+			h->hreqs_failed = 1;
+			pthread_mutex_unlock(&(h->m));
+		}
+		i++;
+	}
+	nfi_request_flush();
+	ret = n_req;
+
+cleanup_XpnHedgeLaunchReplicas:
+	FREE_AND_NULL(load);
+	FREE_AND_NULL(alt_serv);
+	FREE_AND_NULL(alt_offset);
+	return ret;
+}
+
+/**
+ * Waits for a read launched by XpnHedgeLaunch. When the server takes longer than the hedge_percentile
+ * of its read latency, the blocks are also read from the other replicas and the first complete copy is
+ * used. The slower one goes on until XpnHedgeReap frees it.
+ *
+ * @param h[in] The read launched.
+ * @param fd[in] A file descriptor.
+ * @param servers[in] The servers of the file.
+ * @param serv[in] The server the read was sent to.
+ * @param buffer[in] The original buffer.
+ * @param offset[in] The original offset.
+ *
+ * @return Returns the bytes read in the server or -1 on error.
+ */
+ssize_t XpnHedgeWait(struct xpn_hedge *h, int fd, struct nfi_server *servers, int serv, const void *buffer, off_t offset)
+{
+	struct timespec deadline;
+	long threshold, usec;
+	int hedge, req_ok, hreqs_ok, finished, i, ret;
+	ssize_t res, aux;
+	char *src;
+	size_t pos;
+
+	threshold = -1;
+	if (xpn_file_table[fd]->part->hedge_percentile > 0){
+		threshold = nfi_server_lat_percentile(&(servers[serv]), xpn_file_table[fd]->part->hedge_percentile);
+	}
+
+	// (1) the chosen replica, until the threshold
+	hedge = 0;
+	if (threshold > 0){
+		usec = h->t_launch.tv_usec + threshold;
+		deadline.tv_sec  = h->t_launch.tv_sec + usec / USECPSEC;
+		deadline.tv_nsec = (usec % USECPSEC) * 1000;
+
+		pthread_mutex_lock(&(h->m));
+		ret = 0;
+		while (!h->req_done && ret != ETIMEDOUT){
+			ret = pthread_cond_timedwait(&(h->c), &(h->m), &deadline);
+		}
+		hedge = !h->req_done;
+		if (hedge){
+			h->req_slow = 1;
+			__atomic_add_fetch(&(servers[serv].n_slow), 1, __ATOMIC_RELAXED);
+		}
+		pthread_mutex_unlock(&(h->m));
+	}
+
+	// (2) too slow, the other replicas too
+	if (hedge){
+		XPN_DEBUG("hedged read: server %d slower than %ld usec", serv, threshold);
+		XpnHedgeLaunchReplicas(h, fd, servers, serv, buffer, offset);
+	}
+
+	// (3) the first complete copy, or both if they fail
+	pthread_mutex_lock(&(h->m));
+	while (1){
+		req_ok   = h->req_done && (h->req.arg.result >= 0);
+		hreqs_ok = (h->n_hreqs > 0) && (h->hreqs_done == h->n_hreqs) && !(h->hreqs_failed);
+		if (req_ok || hreqs_ok || XpnHedgeFinished(h)){
+			break;
+		}
+		pthread_cond_wait(&(h->c), &(h->m));
+	}
+	pthread_mutex_unlock(&(h->m));
+
+	src = NULL;
+	if (req_ok || !hreqs_ok){
+		res = nfi_request_wait(&(h->req));
+		if (res >= 0){
+			src = h->buf;
+		}
+	}else{
+		res = 0;
+		for (i = 0; i < h->n_hreqs; i++){
+			aux = nfi_request_wait(&(h->hreqs[i]));
+			res += aux;
+		}
+		src = h->hbuf;
+	}
+
+	if (src != NULL){
+		pos = 0;
+		for (i = 0; i < h->ion; i++){
+			memcpy(h->dst[i].buffer, src + pos, h->dst[i].size);
+			pos += h->dst[i].size;
+		}
+	}
+
+	// the slower copy may still be running
+	pthread_mutex_lock(&(h->m));
+	finished = XpnHedgeFinished(h);
+	pthread_mutex_unlock(&(h->m));
+
+	if (finished){
+		XpnHedgeFree(h);
+	}else{
+		pthread_mutex_lock(&xpn_hedge_m);
+		h->next = xpn_hedge_list;
+		xpn_hedge_list = h;
+		pthread_mutex_unlock(&xpn_hedge_m);
+	}
+
+	return res;
+}
+
+/**
+ * Frees the hedged reads that were still running when their caller returned.
+ *
+ * @param wait[in] If not zero, waits for all of them (before closing their files).
+ */
+void XpnHedgeReap(int wait)
+{
+	struct xpn_hedge *h, **prev;
+	int finished;
+
+	pthread_mutex_lock(&xpn_hedge_m);
+	prev = &xpn_hedge_list;
+	while ((h = *prev) != NULL){
+		pthread_mutex_lock(&(h->m));
+		while (wait && !XpnHedgeFinished(h)){
+			pthread_cond_wait(&(h->c), &(h->m));
+		}
+		finished = XpnHedgeFinished(h);
+		pthread_mutex_unlock(&(h->m));
+
+		if (finished){
+			*prev = h->next;
+			XpnHedgeFree(h);
+		}else{
+			prev = &(h->next);
+		}
+	}
+	pthread_mutex_unlock(&xpn_hedge_m);
+}
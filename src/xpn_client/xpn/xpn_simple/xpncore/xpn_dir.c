@@ -33,6 +33,7 @@ int xpn_simple_mkdir(const char *path, mode_t perm)
   char abs_path[PATH_MAX], url_serv[PATH_MAX];
   struct nfi_server *servers;
   int res = 0, err, i, n, pd;
+  int master_dir, master_node, replication_level, serv;
 
   XPN_DEBUG_BEGIN_CUSTOM("%s, %d", path, perm);
   
@@ -66,17 +67,24 @@ int xpn_simple_mkdir(const char *path, mode_t perm)
     return -1;
   }
 
-  for(i=0;i<n;i++)
+  // The directory is only created in its master servers, the rest create it on demand:
+  // first where it is listed (the parent must be there) ...
+  replication_level = XpnSearchPart(pd)->replication_level;
+  master_dir  = hash(abs_path, n, 0);
+  master_node = hash(abs_path, n, 1);
+  for(i=0;i<replication_level+1;i++)
   {
-    XpnGetURLServer(&servers[i], abs_path, url_serv);
+    serv = (master_dir+i)%n;
+    XpnGetURLServer(&servers[serv], abs_path, url_serv);
+    servers[serv].wrk->thread = servers[serv].xpn_thread;
     // Worker
-    nfi_worker_do_mkdir(servers[i].wrk, url_serv, perm, NULL, NULL);
+    nfi_worker_do_mkdir(servers[serv].wrk, url_serv, perm, NULL, NULL);
   }
   // Wait
   err = 0;
-  for(i=0;i<n;i++)
+  for(i=0;i<replication_level+1;i++)
   {
-    res = nfiworker_wait(servers[i].wrk);
+    res = nfiworker_wait(servers[(master_dir+i)%n].wrk);
     if (res < 0) {
       err = 1;
     }
@@ -88,6 +96,37 @@ int xpn_simple_mkdir(const char *path, mode_t perm)
     return -1;
   }
 
+  // ... then where its content is listed (the parent may not be there)
+  for(i=0;i<replication_level+1;i++)
+  {
+    serv = (master_node+i)%n;
+    // skip the servers already done in the first step
+    if ((serv-master_dir+n)%n > replication_level)
+    {
+      XpnGetURLServer(&servers[serv], abs_path, url_serv);
+      servers[serv].wrk->thread = servers[serv].xpn_thread;
+      nfi_worker_do_mkdir_p(servers[serv].wrk, url_serv, perm);
+    }
+  }
+  // Wait
+  for(i=0;i<replication_level+1;i++)
+  {
+    serv = (master_node+i)%n;
+    if ((serv-master_dir+n)%n > replication_level)
+    {
+      res = nfiworker_wait(servers[serv].wrk);
+      if (res < 0) {
+        err = 1;
+      }
+    }
+  }
+  // Error checking
+  if (err)
+  {
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
   // TODO: metadata
   // mdata_aux = (struct xpn_metadata *)malloc(sizeof(struct xpn_metadata));
   // if(mdata_aux == NULL)
@@ -114,7 +153,7 @@ int xpn_simple_mkdir(const char *path, mode_t perm)
 int xpn_simple_rmdir(const char *path)
 {
   char abs_path[PATH_MAX], url_serv[PATH_MAX];
-  int res = 0, err, i, n, pd;
+  int res = 0, err, i, n, pd, serv;
   struct nfi_server *servers;
 
   XPN_DEBUG_BEGIN_CUSTOM("%s", path);
@@ -151,30 +190,60 @@ int xpn_simple_rmdir(const char *path)
     return -1;
   }
   int master_node = hash((char *)abs_path, n, 1);
-  servers[master_node].wrk->arg.is_master_node = 1;
+  int replication_level = XpnSearchPart(pd)->replication_level;
+
+  // First where the content is listed: it says if the directory exists and is empty...
+  err = 0;
+  for(i=0;i<replication_level+1;i++)
+  {
+    serv = (master_node+i)%n;
+    XpnGetURLServer(&servers[serv], abs_path, url_serv);
+    servers[serv].wrk->req.arg.is_master_node = (serv == master_node);
+    // Worker
+    servers[serv].wrk->thread = servers[serv].xpn_thread;
+    nfi_worker_do_rmdir(servers[serv].wrk, url_serv);
+  }
+  for(i=0;i<replication_level+1;i++)
+  {
+    res = nfiworker_wait(servers[(master_node+i)%n].wrk);
+    if((res<0)&&(!err)){
+      err = errno;
+    }
+  }
+  if(err){
+    errno = err;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  // ... then the rest, where the directory may not have been materialized
   for(i=0;i<n;i++)
   {
-    XpnGetURLServer(&servers[i], abs_path, url_serv);
-    if (i != master_node){
-      servers[i].wrk->arg.is_master_node = 0;
+    if ((i-master_node+n)%n > replication_level)
+    {
+      XpnGetURLServer(&servers[i], abs_path, url_serv);
+      servers[i].wrk->req.arg.is_master_node = 0;
+      // Worker
+      servers[i].wrk->thread = servers[i].xpn_thread;
+      nfi_worker_do_rmdir(servers[i].wrk, url_serv);
     }
-    // Worker
-    servers[i].wrk->thread = servers[i].xpn_thread;
-    nfi_worker_do_rmdir(servers[i].wrk, url_serv);
   }
 
   // Wait
-  err = 0;
   for (i=0;i<n;i++)
   {
-    res = nfiworker_wait(servers[i].wrk);
-    // Error checking
-    if((res<0)&&(!err)){
-      err = 1;
+    if ((i-master_node+n)%n > replication_level)
+    {
+      res = nfiworker_wait(servers[i].wrk);
+      // Error checking
+      if((res<0)&&(errno!=ENOENT)&&(!err)){
+        err = 1;
+      }
     }
   }
 
   // Error checking
+  res = 0;
   if(err){
     res = -1;
   }
@@ -183,6 +252,392 @@ int xpn_simple_rmdir(const char *path)
   return res;
 }
 
+int xpn_simple_mkdir_p(const char *path, mode_t perm)
+{
+  char abs_path[PATH_MAX], url_serv[PATH_MAX], dir_path[PATH_MAX];
+  struct nfi_server *servers;
+  int res = 0, err, i, n, pd, replication_level;
+  int *affected;
+  char *rel_path;
+
+  XPN_DEBUG_BEGIN_CUSTOM("%s, %d", path, perm);
+
+  if(path == NULL)
+  {
+    errno = EINVAL;
+    XPN_DEBUG_END;
+    return -1;
+  }
+
+  res = XpnGetAbsolutePath(path, abs_path);
+  if(res<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  pd = XpnGetPartition(abs_path);
+  if(pd<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  servers = NULL;
+  n = XpnGetServers(pd, -1, &servers);
+  if(n<=0){
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  // Only the master servers of some directory of the path are affected
+  affected = (int *) calloc(n, sizeof(int));
+  if (affected == NULL)
+  {
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  replication_level = XpnSearchPart(pd)->replication_level;
+  strcpy(dir_path, abs_path);
+  rel_path = strchr(dir_path+1, '/'); // skip the partition
+  while (rel_path != NULL)
+  {
+    rel_path = strchr(rel_path+1, '/');
+    if (rel_path != NULL) {
+      *rel_path = '\0';
+    }
+    if (dir_path[strlen(dir_path)-1] != '/')
+    {
+      for(i=0;i<n;i++) {
+        affected[i] |= XpnCheckServIsDirMaster(dir_path, n, replication_level, i);
+      }
+    }
+    if (rel_path != NULL) {
+      *rel_path = '/';
+    }
+  }
+
+  // Each affected server creates the whole path in one request
+  for(i=0;i<n;i++)
+  {
+    if (affected[i])
+    {
+      XpnGetURLServer(&servers[i], abs_path, url_serv);
+      servers[i].wrk->thread = servers[i].xpn_thread;
+      nfi_worker_do_mkdir_p(servers[i].wrk, url_serv, perm);
+    }
+  }
+
+  // Wait
+  err = 0;
+  for(i=0;i<n;i++)
+  {
+    if (affected[i])
+    {
+      res = nfiworker_wait(servers[i].wrk);
+      if ((res < 0) && (!err)) {
+        err = errno;
+      }
+    }
+  }
+
+  FREE_AND_NULL(affected);
+
+  if (err)
+  {
+    errno = err;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  XPN_DEBUG_END_ARGS1(path);
+  return 0;
+}
+
+int xpn_simple_rmtree(const char *path)
+{
+  char abs_path[PATH_MAX], url_serv[PATH_MAX];
+  struct nfi_server *servers;
+  int res = 0, err, i, n, pd;
+  char *rel_path;
+
+  XPN_DEBUG_BEGIN_CUSTOM("%s", path);
+
+  if(path == NULL)
+  {
+    errno = EINVAL;
+    XPN_DEBUG_END;
+    return -1;
+  }
+
+  res = XpnGetAbsolutePath(path, abs_path);
+  if(res<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  pd = XpnGetPartition(abs_path);
+  if(pd<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  // The root of the partition is never removed
+  rel_path = abs_path;
+  while (*rel_path == '/') {
+    rel_path++;
+  }
+  rel_path = strchr(rel_path, '/');
+  if ((rel_path == NULL) || (strspn(rel_path, "/") == strlen(rel_path)))
+  {
+    errno = EBUSY;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  servers = NULL;
+  n = XpnGetServers(pd, -1, &servers);
+  if(n<=0){
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  // Each server removes its local subtree (data, metadata and directories) in parallel
+  for(i=0;i<n;i++)
+  {
+    XpnGetURLServer(&servers[i], abs_path, url_serv);
+    servers[i].wrk->thread = servers[i].xpn_thread;
+    nfi_worker_do_rmtree(servers[i].wrk, url_serv);
+  }
+
+  // Wait (a file only lives in some servers, so ENOENT is not an error there)
+  err = 0;
+  for(i=0;i<n;i++)
+  {
+    res = nfiworker_wait(servers[i].wrk);
+    if ((res < 0) && (errno != ENOENT) && (!err)) {
+      err = errno;
+    }
+  }
+
+  if (err)
+  {
+    errno = err;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  XPN_DEBUG_END_ARGS1(path);
+  return 0;
+}
+
+struct xpn_simple_walk_arg
+{
+  pthread_mutex_t mutex;
+  int (*walk_fn)(const char *path, int is_dir, int depth, void *arg);
+  void *arg;
+};
+
+int xpn_simple_walk_entry(char *path, int type, int depth, void *arg)
+{
+  struct xpn_simple_walk_arg *walk = (struct xpn_simple_walk_arg *) arg;
+  int ret;
+
+  // servers may deliver their entries from several worker threads
+  pthread_mutex_lock(&(walk->mutex));
+  ret = walk->walk_fn(path, (type == NFIDIR), depth, walk->arg);
+  pthread_mutex_unlock(&(walk->mutex));
+
+  return ret;
+}
+
+int xpn_simple_walk(const char *path, int (*walk_fn)(const char *path, int is_dir, int depth, void *arg), void *arg)
+{
+  char abs_path[PATH_MAX], url_serv[PATH_MAX];
+  struct nfi_server *servers;
+  struct xpn_simple_walk_arg walk;
+  int res = 0, err, i, n, pd, root_master;
+
+  XPN_DEBUG_BEGIN_CUSTOM("%s", path);
+
+  if((path == NULL) || (walk_fn == NULL))
+  {
+    errno = EINVAL;
+    XPN_DEBUG_END;
+    return -1;
+  }
+
+  res = XpnGetAbsolutePath(path, abs_path);
+  if(res<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  pd = XpnGetPartition(abs_path);
+  if(pd<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  servers = NULL;
+  n = XpnGetServers(pd, -1, &servers);
+  if(n<=0){
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  pthread_mutex_init(&(walk.mutex), NULL);
+  walk.walk_fn = walk_fn;
+  walk.arg     = arg;
+
+  // Every server walks its local subtree and only reports the entries of the
+  // directories it is master of, so each entry is delivered exactly once
+  root_master = hash(abs_path, n, 1);
+  for(i=0;i<n;i++)
+  {
+    XpnGetURLServer(&servers[i], abs_path, url_serv);
+    servers[i].wrk->thread = servers[i].xpn_thread;
+    nfi_worker_do_walk(servers[i].wrk, url_serv, i, n, root_master, xpn_simple_walk_entry, &walk);
+  }
+
+  // Wait (directories are only materialized for sure in their master servers)
+  err = 0;
+  for(i=0;i<n;i++)
+  {
+    res = nfiworker_wait(servers[i].wrk);
+    if ((res < 0) && ((errno != ENOENT) || (i == root_master)) && (!err)) {
+      err = errno;
+    }
+  }
+
+  pthread_mutex_destroy(&(walk.mutex));
+
+  if (err)
+  {
+    errno = err;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  XPN_DEBUG_END_ARGS1(path);
+  return 0;
+}
+
+int xpn_simple_summarize(const char *path, struct nfi_summary *summary)
+{
+  char abs_path[PATH_MAX], url_serv[PATH_MAX];
+  struct nfi_server *servers;
+  struct nfi_summary *partial;
+  struct stat st;
+  int res = 0, err, i, n, pd, root_master;
+
+  XPN_DEBUG_BEGIN_CUSTOM("%s", path);
+
+  if((path == NULL) || (summary == NULL))
+  {
+    errno = EINVAL;
+    XPN_DEBUG_END;
+    return -1;
+  }
+
+  memset(summary, 0, sizeof(struct nfi_summary));
+
+  // a file is its own summary
+  res = xpn_simple_stat(path, &st);
+  if(res<0)
+  {
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+  if(!S_ISDIR(st.st_mode))
+  {
+    summary->files = 1;
+    summary->bytes = st.st_size;
+    XPN_DEBUG_END_ARGS1(path);
+    return 0;
+  }
+
+  res = XpnGetAbsolutePath(path, abs_path);
+  if(res<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  pd = XpnGetPartition(abs_path);
+  if(pd<0)
+  {
+    errno = ENOENT;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  servers = NULL;
+  n = XpnGetServers(pd, -1, &servers);
+  if(n<=0){
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  partial = (struct nfi_summary *) calloc(n, sizeof(struct nfi_summary));
+  if(partial == NULL){
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  // Every server adds up its local subtree: the directories it lists and
+  // the files it is master node of, so nothing is counted twice
+  root_master = hash(abs_path, n, 1);
+  for(i=0;i<n;i++)
+  {
+    XpnGetURLServer(&servers[i], abs_path, url_serv);
+    servers[i].wrk->thread = servers[i].xpn_thread;
+    nfi_worker_do_summarize(servers[i].wrk, url_serv, i, n, root_master, &(partial[i]));
+  }
+
+  // Wait and merge (directories are only materialized for sure in their master servers)
+  err = 0;
+  for(i=0;i<n;i++)
+  {
+    res = nfiworker_wait(servers[i].wrk);
+    if (res < 0)
+    {
+      if (((errno != ENOENT) || (i == root_master)) && (!err)) {
+        err = errno;
+      }
+      continue;
+    }
+
+    summary->bytes += partial[i].bytes;
+    summary->files += partial[i].files;
+    summary->dirs  += partial[i].dirs;
+  }
+
+  FREE_AND_NULL(partial);
+
+  if (err)
+  {
+    errno = err;
+    XPN_DEBUG_END_ARGS1(path);
+    return -1;
+  }
+
+  XPN_DEBUG_END_ARGS1(path);
+  return 0;
+}
+
 
   /* ................................................................... */
 
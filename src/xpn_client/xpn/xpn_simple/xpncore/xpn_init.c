@@ -96,6 +96,7 @@ int xpn_simple_destroy ( void )
        goto cleanup_xpn_simple_destroy;
     }
 
+    XpnHedgeReap(1);
     xpn_destroy_file_table();
     nfi_worker_destroy();
     i = 0;
@@ -115,6 +116,80 @@ cleanup_xpn_simple_destroy:
     return res;
 }
 
+// Servers of one partition are connected by up to XPN_CONNECT_FANOUT threads
+struct xpn_init_servers_arg
+{
+  struct conf_file_data *conf_data;
+  struct xpn_partition  *part;
+  int next;
+};
+
+void * xpn_init_servers_worker ( void * arg )
+{
+  struct xpn_init_servers_arg *aux = (struct xpn_init_servers_arg *)arg;
+  int j, res;
+
+  while ((j = __atomic_fetch_add(&(aux->next), 1, __ATOMIC_RELAXED)) < aux->part->data_nserv)
+  {
+    res = XpnInitServer(aux->conf_data, aux->part, &(aux->part->data_serv[j]), j);
+    if  (res < 0)
+    {
+        aux->part->data_serv[j].error = -1;
+    }
+  }
+
+  return NULL;
+}
+
+int xpn_init_servers ( struct conf_file_data *conf_data, struct xpn_partition *part )
+{
+  struct xpn_init_servers_arg aux;
+  pthread_t th[XPN_CONNECT_MAX_FANOUT];
+  char url_buf[KB];
+  int  fanout, n_th, j;
+
+  aux.conf_data = conf_data;
+  aux.part      = part;
+  aux.next      = 0;
+
+  fanout = utils_getenv_int("XPN_CONNECT_FANOUT", XPN_CONNECT_DEFAULT_FANOUT);
+  if (fanout > XPN_CONNECT_MAX_FANOUT) {
+      fanout = XPN_CONNECT_MAX_FANOUT;
+  }
+  if (fanout > part->data_nserv) {
+      fanout = part->data_nserv;
+  }
+
+  // MPI and mosquitto connections are set up sequentially
+  if (utils_getenv_int("XPN_MQTT", 0) != 0) {
+      fanout = 1;
+  }
+  for (j=0; (j<part->data_nserv) && (fanout > 1); j++)
+  {
+    if ( (XpnConfGetServer(conf_data, url_buf, part->id, j) == 0) && (strncmp(url_buf, "mpi_server", strlen("mpi_server")) == 0) ) {
+        fanout = 1;
+    }
+  }
+
+  n_th = 0;
+  while (n_th < fanout - 1)
+  {
+    if (pthread_create(&(th[n_th]), NULL, xpn_init_servers_worker, &aux) != 0) {
+        break;
+    }
+    n_th++;
+  }
+
+  // the calling thread also connects servers
+  xpn_init_servers_worker(&aux);
+
+  for (j=0; j<n_th; j++) {
+      pthread_join(th[j], NULL);
+  }
+
+  return 0;
+}
+
 int xpn_init_partition ( void )
 {
     int    res;
@@ -194,6 +269,36 @@ int xpn_init_partition ( void )
       }
       XPN_DEBUG("Partition %d: block_size=%ld", xpn_parttable[i].id, xpn_parttable[i].block_size);
 
+      // Small_file_size (at most one block, so that the whole file is the block of the master node)
+      res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_SMALL_FILE_SIZE, buff_value, i);
+      xpn_parttable[i].small_file_size = atol(buff_value);
+      if ( (res != 0) || (xpn_parttable[i].small_file_size < 0) ) {
+            xpn_parttable[i].small_file_size = XPN_CONF_DEFAULT_SMALL_FILE_SIZE;
+      }
+      if (xpn_parttable[i].small_file_size > xpn_parttable[i].block_size) {
+            xpn_parttable[i].small_file_size = xpn_parttable[i].block_size;
+      }
+      XPN_DEBUG("Partition %d: small_file_size=%ld", xpn_parttable[i].id, xpn_parttable[i].small_file_size);
+
+      // Server_streams
+      res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_SERVER_STREAMS, buff_value, i);
+      xpn_parttable[i].server_streams = atoi(buff_value);
+      if ( (res != 0) || (xpn_parttable[i].server_streams < 1) ) {
+            xpn_parttable[i].server_streams = XPN_CONF_DEFAULT_SERVER_STREAMS;
+      }
+      if (xpn_parttable[i].server_streams > XPN_CONF_MAX_SERVER_STREAMS) {
+            xpn_parttable[i].server_streams = XPN_CONF_MAX_SERVER_STREAMS;
+      }
+      XPN_DEBUG("Partition %d: server_streams=%d", xpn_parttable[i].id, xpn_parttable[i].server_streams);
+
+      // Hedge_percentile
+      res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_HEDGE_PERCENTILE, buff_value, i);
+      xpn_parttable[i].hedge_percentile = atoi(buff_value);
+      if ( (res != 0) || (xpn_parttable[i].hedge_percentile < 0) || (xpn_parttable[i].hedge_percentile > 99) ) {
+            xpn_parttable[i].hedge_percentile = XPN_CONF_DEFAULT_HEDGE_PERCENTILE;
+      }
+      XPN_DEBUG("Partition %d: hedge_percentile=%d", xpn_parttable[i].id, xpn_parttable[i].hedge_percentile);
+
       // Replication_level
       res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_REPLICATION_LEVEL, buff_value, i);
       xpn_parttable[i].replication_level = atoi(buff_value);
@@ -212,6 +317,65 @@ int xpn_init_partition ( void )
       }
       XPN_DEBUG("Partition %d: data_nserv=%d", xpn_parttable[i].id, xpn_parttable[i].data_nserv);
 
+      // Weights of the servers: any weight other than 1 selects the weighted distribution
+      xpn_parttable[i].distribution_policy = XPN_METADATA_DISTRIBUTION_ROUND_ROBIN;
+      memset(xpn_parttable[i].weights, 0, sizeof(xpn_parttable[i].weights));
+      for (j=0; j<xpn_parttable[i].data_nserv; j++)
+      {
+        int weight = xpn_conf_reader_get_server_weight(&conf_data, i, j);
+        if ( (weight < 1) || (weight > XPN_CONF_MAX_SERVER_WEIGHT) )
+        {
+          fprintf(stderr, "xpn_init: Error in conf_file: weight %d of server %d out of range [1, %d] in %d partition\n", weight, j, XPN_CONF_MAX_SERVER_WEIGHT, i);
+          res = -1;
+          goto cleanup_xpn_init_partition;
+        }
+        if (weight != XPN_CONF_DEFAULT_SERVER_WEIGHT) {
+          xpn_parttable[i].distribution_policy = XPN_METADATA_DISTRIBUTION_WEIGHTED;
+        }
+        if (j < XPN_METADATA_MAX_WEIGHTS) {
+          xpn_parttable[i].weights[j] = (unsigned char) weight;
+        }
+      }
+      if ( (xpn_parttable[i].distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED) &&
+           ((xpn_parttable[i].data_nserv > XPN_METADATA_MAX_WEIGHTS) || (xpn_parttable[i].replication_level >= xpn_parttable[i].data_nserv)) )
+      {
+        fprintf(stderr, "xpn_init: Error in conf_file: weighted distribution needs at most %d servers and more servers than replication level in %d partition\n", XPN_METADATA_MAX_WEIGHTS, i);
+        res = -1;
+        goto cleanup_xpn_init_partition;
+      }
+
+      // Distribution: raid5 keeps one parity block per stripe instead of a full copy of the data
+      res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_DISTRIBUTION, buff_value, i);
+      if ( (res == 0) && (strcmp(buff_value, "raid5") == 0) )
+      {
+        if ( (xpn_parttable[i].distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED) ||
+             (xpn_parttable[i].replication_level != 1) || (xpn_parttable[i].data_nserv < 3) )
+        {
+          fprintf(stderr, "xpn_init: Error in conf_file: raid5 distribution needs replication_level = 1, at least 3 servers and no server weights in %d partition\n", i);
+          res = -1;
+          goto cleanup_xpn_init_partition;
+        }
+        xpn_parttable[i].distribution_policy = XPN_METADATA_DISTRIBUTION_RAID5;
+      }
+      else if ( (res != 0) || (strcmp(buff_value, XPN_CONF_DEFAULT_DISTRIBUTION) != 0) )
+      {
+        fprintf(stderr, "xpn_init: Error in conf_file: unknown "XPN_CONF_TAG_DISTRIBUTION" '%s' in %d partition\n", buff_value, i);
+        res = -1;
+        goto cleanup_xpn_init_partition;
+      }
+      XPN_DEBUG("Partition %d: distribution_policy=%d", xpn_parttable[i].id, xpn_parttable[i].distribution_policy);
+
+      // Compression of the data sent to the servers (it is stored uncompressed)
+      res = XpnConfGetValue(&conf_data, XPN_CONF_TAG_COMPRESSION, buff_value, i);
+      xpn_parttable[i].compression = (res == 0) ? lz4_codec_from_name(buff_value) : -1;
+      if (xpn_parttable[i].compression < 0)
+      {
+        fprintf(stderr, "xpn_init: Error in conf_file: unknown "XPN_CONF_TAG_COMPRESSION" '%s' in %d partition\n", buff_value, i);
+        res = -1;
+        goto cleanup_xpn_init_partition;
+      }
+      XPN_DEBUG("Partition %d: compression=%d", xpn_parttable[i].id, xpn_parttable[i].compression);
+
       xpn_parttable[i].data_serv = (struct nfi_server *)malloc(xpn_parttable[i].data_nserv*sizeof(struct nfi_server));
       if (xpn_parttable[i].data_serv == NULL)
       {
@@ -223,14 +387,7 @@ int xpn_init_partition ( void )
       memset(xpn_parttable[i].data_serv, 0, xpn_parttable[i].data_nserv*sizeof(struct nfi_server));
 
       // Init all servers
-      for(j=0; j<xpn_parttable[i].data_nserv; j++)
-      {
-        res = XpnInitServer(&conf_data, &(xpn_parttable[i]), &(xpn_parttable[i].data_serv[j]), j);
-        if  (res < 0)
-        {
-            xpn_parttable[i].data_serv[j].error = -1;
-        }
-      }
+      xpn_init_servers(&conf_data, &(xpn_parttable[i]));
 
       // Check locality
       char hostip[HOST_NAME_MAX];
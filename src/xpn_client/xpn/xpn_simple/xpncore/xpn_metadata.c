@@ -47,6 +47,14 @@ void XpnPrintMetadata(struct xpn_metadata *mdata)
   fprintf(stderr, "\n");
 
   fprintf(stderr, "distribution_policy: %d\n", mdata->distribution_policy);
+
+  if (mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED) {
+    fprintf(stderr, "weights: ");
+    for(i = 0; i < mdata->data_nserv[0]; i++) {
+      fprintf(stderr, "%d ", mdata->weights[i]);
+    }
+    fprintf(stderr, "\n");
+  }
 }
 
 int XpnCreateMetadata(struct xpn_metadata *mdata, int pd, const char *path)
@@ -69,6 +77,16 @@ int XpnCreateMetadata(struct xpn_metadata *mdata, int pd, const char *path)
 
   XpnCreateMetadataExtern(mdata, path, xpn_parttable[part_id].data_nserv, xpn_parttable[part_id].block_size, xpn_parttable[part_id].replication_level);
 
+  if (xpn_parttable[part_id].distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED)
+  {
+    mdata->distribution_policy = XPN_METADATA_DISTRIBUTION_WEIGHTED;
+    memcpy(mdata->weights, xpn_parttable[part_id].weights, sizeof(mdata->weights));
+  }
+  else if (xpn_parttable[part_id].distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5)
+  {
+    mdata->distribution_policy = XPN_METADATA_DISTRIBUTION_RAID5;
+  }
+
   XPN_DEBUG_END_CUSTOM("%s", path);
   return 0;
 }
@@ -98,6 +116,29 @@ int XpnCreateMetadataExtern(struct xpn_metadata *mdata, const char *path, int ns
   return 0;
 }
 
+/*
+ * Small files (up to part->small_file_size, at most one block) are kept inline:
+ * all their data is the first block, which lives in the master node (first_node)
+ * right after the metadata, so they can be opened, read and closed in that server only.
+ * When the file grows past the threshold it is already in the striped layout,
+ * so the promotion does not move any data.
+ */
+int XpnIsSmallFile(struct xpn_metadata *mdata, struct xpn_partition *part)
+{
+  if ((mdata == NULL) || (part == NULL)){
+    return 0;
+  }
+  if (!XPN_CHECK_MAGIC_NUMBER(mdata)){
+    return 0;
+  }
+  // Files with malleability may have the first block in other server
+  if (mdata->data_nserv[1] != 0){
+    return 0;
+  }
+
+  return (part->small_file_size > 0) && ((ssize_t)mdata->file_size <= part->small_file_size);
+}
+
 /*
  * TODO: XpnGetMetadataPos -> xpn_mdata_associated_server
  *   (in) Logical server    0      1       3      4
@@ -130,34 +171,34 @@ int XpnGetMetadataPos(struct xpn_metadata *mdata, int pos)
 
 int XpnUpdateMetadata(struct xpn_metadata *mdata, int nserv, struct nfi_server *servers, const char *path, int replication_level, int only_file_size)
 {
-  int master_node, res, serv_node, err;
+  int master_node, res, serv_node;
   char url_serv[PATH_MAX];
+  struct nfi_request *reqs;
   XPN_DEBUG_BEGIN_CUSTOM("%s", path);
 
   if (mdata == NULL){
     return -1;
   }
 
+  // one request per copy, so every copy is waited for
+  reqs = (struct nfi_request *) malloc((replication_level+1) * sizeof(struct nfi_request));
+  if (reqs == NULL){
+    return -1;
+  }
+
   master_node = hash(path, nserv, 1);
   for (int i = 0; i < replication_level+1; i++)
   {
     serv_node = (master_node+i) % nserv;
     XpnGetURLServer(&servers[serv_node], path, url_serv);
-    servers[serv_node].wrk->thread = servers[serv_node].xpn_thread;
+    nfi_request_init(&reqs[i], &servers[serv_node]);
     XPN_DEBUG("Write metadata to server: %d url: %s", serv_node, url_serv);
-    nfi_worker_do_write_mdata(servers[serv_node].wrk, url_serv, mdata, only_file_size);
-  }
-  
-  err = 0;
-  for (int i = 0; i < replication_level; i++)
-  {
-    serv_node = (master_node+i) % nserv;
-    res = nfiworker_wait(servers[serv_node].wrk);
-    if(res < 0){
-      err = -1;
-    }
+    nfi_request_do_write_mdata(&reqs[i], url_serv, mdata, only_file_size);
   }
-  res = err;
+
+  res = (nfi_request_wait_all(reqs, replication_level+1) < 0) ? -1 : 0;
+  free(reqs);
+
   XPN_DEBUG("Mdata of %s:", path);
   if (xpn_debug){ XpnPrintMetadata(mdata); }
   XPN_DEBUG_END_CUSTOM("%s", path);
@@ -201,7 +242,7 @@ int xpn_simple_get_block_locality(char *path, off_t offset, int *url_c, char **u
   struct nfi_server *servers;
   struct xpn_partition *part;
   struct xpn_metadata mdata = {0};
-  int res, i, n, pd;
+  int res, i, n, pd, copies;
   off_t local_offset;
   int serv;
 
@@ -246,13 +287,19 @@ int xpn_simple_get_block_locality(char *path, off_t offset, int *url_c, char **u
     return -1;
   }
 
-  (*url_v) = malloc(((part->replication_level+1) + 1) * sizeof(char*));
+  // the block of a raid5 file is only in one server (the other has the parity)
+  copies = part->replication_level+1;
+  if (mdata.distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5) {
+    copies = 1;
+  }
+
+  (*url_v) = malloc((copies + 1) * sizeof(char*));
   if ((*url_v) == NULL){
     XPN_DEBUG_END;
     return -1;
   }
 
-  for (i = 0; i < part->replication_level+1; i++)
+  for (i = 0; i < copies; i++)
   {
     (*url_v)[i] = malloc(PATH_MAX * sizeof(char));
     if ((*url_v)[i] == NULL){
@@ -262,15 +309,15 @@ int xpn_simple_get_block_locality(char *path, off_t offset, int *url_c, char **u
     memset((*url_v)[i], 0, PATH_MAX);
   }
 
-  (*url_v)[part->replication_level+1] = NULL;
+  (*url_v)[copies] = NULL;
 
-  for (i = 0; i < part->replication_level+1; i++)
+  for (i = 0; i < copies; i++)
   {
     XpnCalculateBlockMdata(&mdata, offset, i, &local_offset, &serv);
     ParseURL(servers[serv].url, NULL, NULL, NULL, (*url_v)[i], NULL, NULL);
   }
 
-  (*url_c) = part->replication_level+1;
+  (*url_c) = copies;
 
   XPN_DEBUG_END;
   return res;
@@ -157,10 +157,17 @@
              return 1;
          }
 
-         // Calculate if has data in that server, the file must exist
+         // Calculate if has data in that server, the file must exist (every server has a block in the first round)
          off_t local_offset;
          int aux_serv;
-         for (i = 0; i < n_serv; i++)
+         int round_blocks = n_serv;
+         if (mdata->distribution_policy == XPN_METADATA_DISTRIBUTION_WEIGHTED){
+             round_blocks = 0;
+             for (i = 0; i < mdata->data_nserv[0]; i++){
+                 round_blocks += mdata->weights[i];
+             }
+         }
+         for (i = 0; i < round_blocks; i++)
          {
              off_t offset = mdata->block_size * i;
              if (offset > mdata->file_size){
@@ -185,8 +192,9 @@
      {
          char abs_path[PATH_MAX];
          char url_serv[PATH_MAX];
+         char parent_path[PATH_MAX];
          struct nfi_server *servers;
-         int n, pd, i, j, master_node, master_dir;
+         int n, pd, i, j, master_node, master_dir, open_serv;
          int res = -1, err;
 
          XPN_DEBUG_BEGIN_CUSTOM("%s, %d, %d", path, flags, mode);
@@ -274,12 +282,20 @@
                  }
              }
 
+             strcpy(parent_path, abs_path);
+             dirname(parent_path);
+
              err = 0;
              for (int i = 0; i < n; i++)
              {
                  if (XpnCheckServAffectedByOp(mdata, master_dir, master_node, n, i) == 1){
                      res = nfiworker_wait(servers[i].wrk);
-                     if (res < 0)
+                     if ((res < 0) && (errno == ENOENT) && (XpnCheckServIsDirMaster(parent_path, n, XpnSearchPart(pd)->replication_level, i) == 0))
+                     {
+                         // the parent directory is not materialized in this server yet (retried below)
+                         FREE_AND_NULL(vfh->nfih[i]);
+                     }
+                     else if (res < 0)
                      {
                          err = 1;
                      }
@@ -290,24 +306,56 @@
                  res = -1;
                  goto error_xpn_internal_open;
              }
+
+             // The parent exists (its master servers said so), so create it where it is missing
+             for (int i = 0; i < n; i++)
+             {
+                 if ((XpnCheckServAffectedByOp(mdata, master_dir, master_node, n, i) == 1) && (vfh->nfih[i] == NULL)){
+                     vfh->nfih[i] = (struct nfi_fhandle *) malloc(sizeof(struct nfi_fhandle));
+                     if(vfh->nfih[i] == NULL)
+                     {
+                         res = -1;
+                         goto error_xpn_internal_open;
+                     }
+                     res = XpnMakeParentDir(&servers[i], abs_path);
+                     if (res >= 0)
+                     {
+                         XpnGetURLServer(&servers[i], abs_path, url_serv);
+                         nfi_worker_do_open(servers[i].wrk, url_serv, flags, mode, vfh->nfih[i]);
+                         res = nfiworker_wait(servers[i].wrk);
+                     }
+                     if (res < 0)
+                     {
+                         goto error_xpn_internal_open;
+                     }
+                 }
+             }
          }else{
-             // else only open in one
-             vfh->nfih[master_dir] = (struct nfi_fhandle *) malloc(sizeof(struct nfi_fhandle));
-             if(vfh->nfih[master_dir] == NULL)
+             // else only open in one: master_dir, or master_node for small files
+             // so that the whole open+read+close goes to the server with the metadata and the data
+             open_serv = master_dir;
+             if ((O_DIRECTORY != (flags & O_DIRECTORY)) && (O_TRUNC != (flags & O_TRUNC)) &&
+                 (XpnIsSmallFile(mdata, XpnSearchPart(pd)) == 1) && (servers[master_node].error != -1))
+             {
+                 open_serv = master_node;
+             }
+
+             vfh->nfih[open_serv] = (struct nfi_fhandle *) malloc(sizeof(struct nfi_fhandle));
+             if(vfh->nfih[open_serv] == NULL)
              {
                  res = -1;
                  goto error_xpn_internal_open;
              }
 
-             servers[master_dir].wrk->thread = servers[master_dir].xpn_thread;
+             servers[open_serv].wrk->thread = servers[open_serv].xpn_thread;
 
-             XpnGetURLServer(&servers[master_dir], abs_path, url_serv);
-             XPN_DEBUG("Open in %d serv", master_dir);
+             XpnGetURLServer(&servers[open_serv], abs_path, url_serv);
+             XPN_DEBUG("Open in %d serv", open_serv);
              if (O_DIRECTORY == (flags & O_DIRECTORY))
-                 nfi_worker_do_opendir(servers[master_dir].wrk, url_serv, vfh->nfih[master_dir]);
+                 nfi_worker_do_opendir(servers[open_serv].wrk, url_serv, vfh->nfih[open_serv]);
              else
-                 nfi_worker_do_open(servers[master_dir].wrk, url_serv, flags, mode, vfh->nfih[master_dir]);
-             res = nfiworker_wait(servers[master_dir].wrk);
+                 nfi_worker_do_open(servers[open_serv].wrk, url_serv, flags, mode, vfh->nfih[open_serv]);
+             res = nfiworker_wait(servers[open_serv].wrk);
              if (res < 0) {
                  goto error_xpn_internal_open;
              }
@@ -386,11 +434,11 @@
          {
              if (XpnCheckServAffectedByOp(&mdata, master_dir, master_node, n, i) == 1){
                  if (master_node == i){
-                     servers[i].wrk->arg.is_master_node = 1;
+                     servers[i].wrk->req.arg.is_master_node = 1;
                  }else{
-                     servers[i].wrk->arg.is_master_node = 0;
+                     servers[i].wrk->req.arg.is_master_node = 0;
                  }
-                 servers[i].wrk->arg.master_node = master_node;
+                 servers[i].wrk->req.arg.master_node = master_node;
                  XpnGetURLServer(&servers[i], abs_path, url_serv);
                  nfi_worker_do_remove(servers[i].wrk, url_serv);
              }
@@ -483,6 +531,9 @@
          xpn_file_table[fd]->links--;
          if (xpn_file_table[fd]->links == 0)
          {
+             // hedged reads of the file still running
+             XpnHedgeReap(1);
+
              for (i = 0; i < xpn_file_table[fd]->data_vfh->n_nfih; i++)
              {
                  if (xpn_file_table[fd]->data_vfh->nfih[i] != NULL)
@@ -524,9 +575,11 @@
      {
          char abs_path[PATH_MAX], url_serv[PATH_MAX];
          char newabs_path[PATH_MAX], newurl_serv[PATH_MAX];
+         char newparent_path[PATH_MAX];
          struct nfi_server *servers;
          struct xpn_metadata mdata = {0};
          int res, err, i, n, pd, newpd;
+         int *lazy_serv;
          int master_dir, master_node;
 
          XPN_DEBUG_BEGIN_CUSTOM("(%s %s)", path, newpath);
@@ -603,11 +656,54 @@
              }
          }
 
+         lazy_serv = (int *) calloc(n, sizeof(int));
+         if (lazy_serv == NULL) {
+             XPN_DEBUG_END;
+             return -1;
+         }
+
+         strcpy(newparent_path, newabs_path);
+         dirname(newparent_path);
+
          err = 0;
          for (i = 0; i < n; i++)
          {
              if (XpnCheckServAffectedByOp(&mdata, master_dir, master_node, n, i) == 1){
                  res = nfiworker_wait(servers[i].wrk);
+                 if ((res < 0) && (errno == ENOENT) &&
+                     ((XpnCheckServIsDirMaster(newparent_path, n, XpnSearchPart(pd)->replication_level, i) == 0) ||
+                      ((!XPN_CHECK_MAGIC_NUMBER(&mdata)) && (XpnCheckServIsDirMaster(abs_path, n, XpnSearchPart(pd)->replication_level, i) == 0))))
+                 {
+                     // the new parent or the directory may not be materialized in this server yet (checked below)
+                     lazy_serv[i] = 1;
+                 }
+                 else if (res < 0)
+                 {
+                     err = 1;
+                 }
+             }
+         }
+
+         // The new parent exists (its master servers said so), so create it where it is missing
+         for (i = 0; (i < n) && (err == 0); i++)
+         {
+             if (lazy_serv[i] == 1){
+                 res = -1;
+                 errno = ENOENT;
+                 if ((XpnCheckServIsDirMaster(newparent_path, n, XpnSearchPart(pd)->replication_level, i) == 0) &&
+                     (XpnMakeParentDir(&servers[i], newabs_path) >= 0))
+                 {
+                     XpnGetURLServer(&servers[i], abs_path, url_serv);
+                     XpnGetURLServer(&servers[i], newabs_path, newurl_serv);
+                     nfi_worker_do_rename(servers[i].wrk, url_serv, newurl_serv);
+                     res = nfiworker_wait(servers[i].wrk);
+                 }
+                 // a directory does not need to be materialized out of its master servers
+                 if ((res < 0) && (errno == ENOENT) && (!XPN_CHECK_MAGIC_NUMBER(&mdata)) &&
+                     (XpnCheckServIsDirMaster(abs_path, n, XpnSearchPart(pd)->replication_level, i) == 0))
+                 {
+                     res = 0;
+                 }
                  if (res < 0)
                  {
                      err = 1;
@@ -615,10 +711,37 @@
              }
          }
 
+         FREE_AND_NULL(lazy_serv);
+
          if (err == 1){
              return -1;
          }
 
+         // A renamed directory must exist in its new master servers
+         if (!XPN_CHECK_MAGIC_NUMBER(&mdata)){
+             for (i = 0; i < n; i++)
+             {
+                 if (XpnCheckServIsDirMaster(newabs_path, n, XpnSearchPart(pd)->replication_level, i) == 1){
+                     XpnGetURLServer(&servers[i], newabs_path, newurl_serv);
+                     servers[i].wrk->thread = servers[i].xpn_thread;
+                     nfi_worker_do_mkdir_p(servers[i].wrk, newurl_serv, S_IRWXU);
+                 }
+             }
+             for (i = 0; i < n; i++)
+             {
+                 if (XpnCheckServIsDirMaster(newabs_path, n, XpnSearchPart(pd)->replication_level, i) == 1){
+                     res = nfiworker_wait(servers[i].wrk);
+                     if (res < 0)
+                     {
+                         err = 1;
+                     }
+                 }
+             }
+             if (err == 1){
+                 return -1;
+             }
+         }
+
          //Check magic number if is dir not have it so no update metadata
          if (XPN_CHECK_MAGIC_NUMBER(&mdata)){
              XpnUpdateMetadata(&mdata, n, servers, newabs_path, XpnSearchPart(pd)->replication_level, 0);
@@ -145,6 +145,12 @@
          XPN_DEBUG_BEGIN_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
      
          // (1) Check arguments in xpn_simple_read
+
+         // raid5: the data of a failed server is rebuilt from the parity
+         if (xpn_file_table[fd] -> mdata -> distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5) {
+             count = XpnParityRead(fd, (void *) buffer, size, offset);
+             goto cleanup_xpn_sread;
+         }
      
          // (2) Get servers...
          servers = NULL;
@@ -284,10 +290,20 @@
          struct nfi_worker_io ** io = NULL;
          int * ion = NULL;
          void * new_buffer = NULL;
+         struct xpn_rw_streams * st = NULL;
+         struct xpn_hedge ** hg = NULL;
+         int hedge;
      
          XPN_DEBUG_BEGIN_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
      
          // (1) check arguments in xpn_simple_read
+
+         // raid5: the data of a failed server is rebuilt from the parity
+         if (xpn_file_table[fd] -> mdata -> distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5) {
+             res = XpnParityRead(fd, buffer, size, offset);
+             XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+             return res;
+         }
      
          n = XpnGetServers(xpn_file_table[fd] -> part -> id, fd, & servers);
          if (n <= 0) {
@@ -312,6 +328,21 @@
              res = -1;
              goto cleanup_xpn_pread;
          }
+
+         st = (struct xpn_rw_streams * ) calloc(n, sizeof(struct xpn_rw_streams));
+         if (st == NULL) {
+             res = -1;
+             goto cleanup_xpn_pread;
+         }
+
+         hg = (struct xpn_hedge ** ) calloc(n, sizeof(struct xpn_hedge * ));
+         if (hg == NULL) {
+             res = -1;
+             goto cleanup_xpn_pread;
+         }
+
+         // replicated: a slow server can be replaced by another replica
+         hedge = (xpn_file_table[fd] -> part -> replication_level > 0) && (xpn_file_table[fd] -> part -> hedge_percentile > 0);
      
          bzero(io, n * sizeof(struct nfi_worker_io * ));
          bzero(ion, n * sizeof(int));
@@ -351,14 +382,29 @@
              if (ion[j] != 0)
 	     {
                  res = XpnGetFh(xpn_file_table[fd] -> mdata, & (xpn_file_table[fd] -> data_vfh -> nfih[j]), & servers[j], xpn_file_table[fd] -> path);
-                 if (res < 0) {
+                 if (res < 0)
+                 {
+                     // the requests already launched use st and io
+                     for (i = 0; i < j; i++) {
+                         if (hg[i] != NULL) {
+                             XpnHedgeWait(hg[i], fd, servers, i, buffer, offset);
+                         }
+                         else if (ion[i] != 0) {
+                             XpnRWStreamsWait(&(st[i]), &(servers[i]));
+                         }
+                     }
                      res = -1;
                      goto cleanup_xpn_pread;
                  }
      
                  // Worker
                  servers[j].wrk -> thread = servers[j].xpn_thread;
-                 nfi_worker_do_read(servers[j].wrk, xpn_file_table[fd] -> data_vfh -> nfih[j], io[j], ion[j]);
+                 if ((hedge) && (servers[j].xpn_thread != TH_NOT)) {
+                     hg[j] = XpnHedgeLaunch(&(servers[j]), xpn_file_table[fd] -> data_vfh -> nfih[j], io[j], ion[j]);
+                 }
+                 if (hg[j] == NULL) {
+                     XpnRWStreamsLaunch(&(st[j]), &(servers[j]), xpn_file_table[fd] -> data_vfh -> nfih[j], io[j], ion[j], 0);
+                 }
              }
          }
      
@@ -366,9 +412,16 @@
          err = 0;
          for (i = 0; i < n; i++)
 	 {
-             if (ion[i] != 0)
+             if (hg[i] != NULL)
 	     {
-                 res_v[i] = nfiworker_wait(servers[i].wrk);
+                 res_v[i] = XpnHedgeWait(hg[i], fd, servers, i, buffer, offset);
+                 if (res_v[i] < 0) {
+                     err = 1;
+                 }
+             }
+             else if (ion[i] != 0)
+	     {
+                 res_v[i] = XpnRWStreamsWait(&(st[i]), &(servers[i]));
                  if (res_v[i] < 0) {
                      err = 1;
                  }
@@ -397,6 +450,8 @@
              FREE_AND_NULL(io);
              FREE_AND_NULL(ion);
              FREE_AND_NULL(res_v);
+             FREE_AND_NULL(st);
+             FREE_AND_NULL(hg);
              FREE_AND_NULL(new_buffer);
              XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
 
@@ -412,10 +467,18 @@
          struct nfi_worker_io ** io = NULL;
          int * ion = NULL;
          void * new_buffer = NULL;
+         struct xpn_rw_streams * st = NULL;
      
          XPN_DEBUG_BEGIN_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
      
          // (1) check arguments in xpn_simple_write
+
+         // raid5: the data blocks and the parity of their stripes
+         if (xpn_file_table[fd] -> mdata -> distribution_policy == XPN_METADATA_DISTRIBUTION_RAID5) {
+             res = XpnParityWrite(fd, buffer, size, offset);
+             XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
+             return res;
+         }
      
          n = XpnGetServers(xpn_file_table[fd] -> part -> id, fd, & servers);
          if (n <= 0) {
@@ -440,6 +503,12 @@
              res = -1;
              goto cleanup_xpn_pwrite;
          }
+
+         st = (struct xpn_rw_streams * ) calloc(n, sizeof(struct xpn_rw_streams));
+         if (st == NULL) {
+             res = -1;
+             goto cleanup_xpn_pwrite;
+         }
      
          bzero(io, n * sizeof(struct nfi_worker_io * ));
          bzero(ion, n * sizeof(int));
@@ -479,14 +548,21 @@
              if (ion[j] != 0)
 	     {
                  res = XpnGetFh(xpn_file_table[fd] -> mdata, & (xpn_file_table[fd] -> data_vfh -> nfih[j]), & servers[j], xpn_file_table[fd] -> path);
-                 if (res < 0) {
+                 if (res < 0)
+                 {
+                     // the requests already launched use st and io
+                     for (i = 0; i < j; i++) {
+                         if (ion[i] != 0) {
+                             XpnRWStreamsWait(&(st[i]), &(servers[i]));
+                         }
+                     }
                      res = -1;
                      goto cleanup_xpn_pwrite;
                  }
      
                  //Worker
                  servers[j].wrk -> thread = servers[j].xpn_thread;
-                 nfi_worker_do_write(servers[j].wrk, xpn_file_table[fd] -> data_vfh -> nfih[j], io[j], ion[j]);
+                 XpnRWStreamsLaunch(&(st[j]), &(servers[j]), xpn_file_table[fd] -> data_vfh -> nfih[j], io[j], ion[j], 1);
              }
          }
      
@@ -496,7 +572,7 @@
 	 {
              if (ion[i] != 0)
 	     {
-                 res_v[i] = nfiworker_wait(servers[i].wrk);
+                 res_v[i] = XpnRWStreamsWait(&(st[i]), &(servers[i]));
                  if (res_v[i] < 0) {
                      err = 1;
                  }
@@ -531,6 +607,7 @@
              FREE_AND_NULL(io);
              FREE_AND_NULL(ion);
              FREE_AND_NULL(res_v);
+             FREE_AND_NULL(st);
              FREE_AND_NULL(new_buffer);
              XPN_DEBUG_END_CUSTOM("%d, %zu, %lld", fd, size, (long long int) offset);
 
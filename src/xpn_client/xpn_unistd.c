@@ -260,6 +260,78 @@
        return ret;
      }
 
+     int xpn_mkdir_p ( const char *path, mode_t perm )
+     {
+       int ret = -1;
+
+       debug_info("[XPN_UNISTD] [xpn_mkdir_p] >> Begin\n");
+
+       XPN_API_LOCK();
+       ret = xpn_simple_mkdir_p(path, perm);
+       XPN_API_UNLOCK();
+
+       debug_info("[XPN_UNISTD] [xpn_mkdir_p] >> End\n");
+
+       return ret;
+     }
+
+     int xpn_rmtree ( const char *path )
+     {
+       int ret = -1;
+
+       debug_info("[XPN_UNISTD] [xpn_rmtree] >> Begin\n");
+
+       XPN_API_LOCK();
+       ret = xpn_simple_rmtree(path);
+       XPN_API_UNLOCK();
+
+       debug_info("[XPN_UNISTD] [xpn_rmtree] >> End\n");
+
+       return ret;
+     }
+
+     int xpn_walk ( const char *path, int (*walk_fn)(const char *path, int is_dir, int depth, void *arg), void *arg )
+     {
+       int ret = -1;
+
+       debug_info("[XPN_UNISTD] [xpn_walk] >> Begin\n");
+
+       XPN_API_LOCK();
+       ret = xpn_simple_walk(path, walk_fn, arg);
+       XPN_API_UNLOCK();
+
+       debug_info("[XPN_UNISTD] [xpn_walk] >> End\n");
+
+       return ret;
+     }
+
+     int xpn_summarize ( const char *path, struct xpn_summary *summary )
+     {
+       int ret = -1;
+       struct nfi_summary aux;
+
+       debug_info("[XPN_UNISTD] [xpn_summarize] >> Begin\n");
+
+       if (NULL == summary) {
+         errno = EINVAL;
+         return -1;
+       }
+
+       XPN_API_LOCK();
+       ret = xpn_simple_summarize(path, &aux);
+       XPN_API_UNLOCK();
+
+       if (ret >= 0) {
+         summary->bytes = aux.bytes;
+         summary->files = aux.files;
+         summary->dirs  = aux.dirs;
+       }
+
+       debug_info("[XPN_UNISTD] [xpn_summarize] >> End\n");
+
+       return ret;
+     }
+
      DIR *xpn_opendir ( const char *path )
      {
        DIR *ret = NULL;
@@ -254,9 +254,9 @@ ssize_t mpi_server_comm_write_data ( MPI_Comm *fd, char *data, ssize_t size, int
   // Send message
   debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_write_data] Write data tag %d\n", 0, tag_client_id);
 
-  ret = MPI_Send(data, size, MPI_CHAR, rank_client_id, tag_client_id, *fd);
-  if (MPI_SUCCESS != ret) {
-    debug_warning("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_write_data] ERROR: MPI_Send fails\n", 0);
+  ret = mpi_pipe_send(data, size, rank_client_id, tag_client_id, *fd);
+  if (ret < 0) {
+    debug_warning("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_write_data] ERROR: mpi_pipe_send fails\n", 0);
   }
 
   debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_write_data] << End\n", 0);
@@ -268,8 +268,7 @@ ssize_t mpi_server_comm_write_data ( MPI_Comm *fd, char *data, ssize_t size, int
 ssize_t mpi_server_comm_read_data ( MPI_Comm *fd, char *data, ssize_t size, int rank_client_id, int tag_client_id )
 {
   int ret;
-  MPI_Status status;
-
+  
   debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] >> Begin\n", 0);
 
   if (size == 0) {
@@ -284,12 +283,11 @@ ssize_t mpi_server_comm_read_data ( MPI_Comm *fd, char *data, ssize_t size, int
   // Get message
   debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] Read data tag %d\n", 0, tag_client_id);
 
-  ret = MPI_Recv(data, size, MPI_CHAR, rank_client_id, tag_client_id, *fd, &status);
-  if (MPI_SUCCESS != ret) {
-    debug_warning("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] ERROR: MPI_Recv fails\n", 0);
+  ret = mpi_pipe_recv(data, size, rank_client_id, tag_client_id, *fd);
+  if (ret < 0) {
+    debug_warning("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] ERROR: mpi_pipe_recv fails\n", 0);
   }
 
-  debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] MPI_Recv (MPI SOURCE %d, MPI_TAG %d, MPI_ERROR %d)\n", 0, status.MPI_SOURCE, status.MPI_TAG, status.MPI_ERROR);
   debug_info("[Server=%d] [MPI_SERVER_COMM] [mpi_server_comm_read_data] << End\n", 0);
 
   // Return bytes read
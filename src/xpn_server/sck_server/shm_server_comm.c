@@ -0,0 +1,69 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+   /* ... Include / Inclusion ........................................... */
+
+      #include "shm_server_comm.h"
+
+
+   /* ... Functions / Funciones ......................................... */
+
+      int shm_server_comm_accept ( char *name, shm_ring_t **new_ring )
+      {
+          int ret ;
+
+          debug_info("[Server=%d] [SHM_SERVER_COMM] [shm_server_comm_accept] >> Begin\n", 0);
+
+          *new_ring = malloc(sizeof(shm_ring_t));
+          if ( *new_ring == NULL) {
+              printf("[Server=%d] [SHM_SERVER_COMM] [shm_server_comm_accept] ERROR: Memory allocation\n", 0);
+              return -1;
+          }
+
+          // map the channel created by the client ('name' is "<pid> <fd>")
+          ret = shm_ring_attach(*new_ring, name) ;
+          if (ret < 0) {
+              debug_info("[Server=%d] [SHM_SERVER_COMM] [shm_server_comm_accept] channel '%s' cannot be mapped\n", 0, name);
+              free(*new_ring) ;
+              *new_ring = NULL ;
+              return -1;
+          }
+
+          debug_info("[Server=%d] [SHM_SERVER_COMM] [shm_server_comm_accept] << End\n", 0);
+
+          return ret ;
+      }
+
+      int shm_server_comm_disconnect ( shm_ring_t *ring )
+      {
+          int ret ;
+
+          ret = shm_ring_close(ring);
+          free(ring);
+
+          return ret ;
+      }
+
+
+   /* ................................................................... */
+
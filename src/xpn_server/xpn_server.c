@@ -37,12 +37,78 @@
 
    char serv_name[HOST_NAME_MAX];
    xpn_server_param_st params;
+   xpn_server_param_st params_shm;  // same configuration for the clients on this node that use shared memory
    worker_t worker1, worker2, worker3;
    int the_end = 0;
+   int n_connections = 0;  // dispatchers of clients kept connected
+   char weight_addr[XPN_SERVER_ADMISSION_MAX_WEIGHTS][INET6_ADDRSTRLEN];  // address of each -W host
+   char self_addr[INET6_ADDRSTRLEN];                                      // address of this node (shared memory clients)
 
 
 /* ... Auxiliar Functions / Funciones Auxiliares ..................... */
 
+// Numeric address of a host name ("" if unknown)
+void xpn_server_host_addr ( char *host, char *addr, socklen_t addr_size )
+{
+    struct addrinfo hints, *res = NULL;
+
+    strcpy(addr, "");
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0) {
+        return;
+    }
+
+    getnameinfo(res->ai_addr, res->ai_addrlen, addr, addr_size, NULL, 0, NI_NUMERICHOST);
+    freeaddrinfo(res);
+}
+
+// Address of the client at the other side of 'comm' ("" if unknown)
+void xpn_server_client_addr ( int server_type, void *comm, char *addr )
+{
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    char buffer[INET6_ADDRSTRLEN];
+
+    strcpy(buffer, "");
+    switch (server_type)
+    {
+        case XPN_SERVER_TYPE_SCK:
+             if (getpeername(*(int *)comm, (struct sockaddr *)&peer, &peer_len) == 0) {
+                 getnameinfo((struct sockaddr *)&peer, peer_len, buffer, sizeof(buffer), NULL, 0, NI_NUMERICHOST);
+             }
+             break;
+
+        case XPN_SERVER_TYPE_SHM:
+             strcpy(buffer, self_addr);
+             break;
+
+        default:  // mpi_server: the address of the client is unknown
+             break;
+    }
+
+    // IPv4 clients of an IPv6 socket
+    if (strncmp(buffer, "::ffff:", 7) == 0)
+         strcpy(addr, buffer + 7);
+    else strcpy(addr, buffer);
+}
+
+// Weight of the clients at 'addr': the one of its host with -W, 1 otherwise
+int xpn_server_client_weight ( char *addr )
+{
+    for (int i = 0; (i < params.n_weights) && (strlen(addr) > 0); i++)
+    {
+        if (strcmp(addr, weight_addr[i]) == 0) {
+            return params.weight[i];
+        }
+    }
+
+    return 1;
+}
+
+
 void xpn_server_run ( struct st_th th )
 {
     xpn_server_param_st *local_params ;
@@ -51,6 +117,7 @@ void xpn_server_run ( struct st_th th )
     debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_run] >> Begin: OP '%s'; OP_ID %d\n", th.id, xpn_server_op2string(th.type_op), th.type_op);
 
     xpn_server_do_operation(th.server_type, &th, &the_end);
+    xpn_server_admission_leave(local_params->admission, th.comm);
 
     if (errno == EPIPE)
     {
@@ -140,6 +207,7 @@ void xpn_server_dispatcher_connectionless ( struct st_th th )
         th_arg.close4me       = TRUE;
         th_arg.server_type    = XPN_SERVER_TYPE_SCK;
 
+        xpn_server_admission_enter(params.admission, th.comm);
         base_workers_launch(&worker2, &th_arg, xpn_server_run);
         debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_dispatcher_connectionless] Worker launched\n", th.id);
     }
@@ -165,6 +233,11 @@ void xpn_server_dispatcher ( struct st_th th )
 
     local_params = (xpn_server_param_st *)th.params ;
 
+    // the connections of the same host share their turns
+    char client_addr[INET6_ADDRSTRLEN];
+    xpn_server_client_addr(local_params->server_type, th.comm, client_addr);
+    xpn_server_admission_connect(local_params->admission, th.comm, client_addr, xpn_server_client_weight(client_addr));
+
     int disconnect = 0;
     while (!disconnect)
     {
@@ -176,6 +249,8 @@ void xpn_server_dispatcher ( struct st_th th )
         if (ret < 0)
         {
             printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_dispatcher] ERROR: read operation fail\n", th.id);
+            xpn_server_admission_disconnect(local_params->admission, th.comm);
+            __atomic_sub_fetch(&n_connections, 1, __ATOMIC_RELAXED);
             return;
         }
 
@@ -198,7 +273,7 @@ void xpn_server_dispatcher ( struct st_th th )
         }
 
         // Launch worker per operation
-        th_arg.params         = &params;
+        th_arg.params         = local_params;
         th_arg.comm           = th.comm;
         th_arg.function       = xpn_server_run;
         th_arg.type_op        = th.type_op;
@@ -206,24 +281,28 @@ void xpn_server_dispatcher ( struct st_th th )
         th_arg.tag_client_id  = th.tag_client_id;
         th_arg.wait4me        = FALSE;
         th_arg.close4me       = FALSE;
-        th_arg.server_type    = params.server_type;
+        th_arg.server_type    = local_params->server_type;
 
+        // without a free request slot of this client its next request is not read
+        xpn_server_admission_enter(local_params->admission, th.comm);
         base_workers_launch(&worker2, &th_arg, xpn_server_run);
         debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_dispatcher] Worker launched\n", th.id);
     }
 
     debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_dispatcher] Client %d close\n", th.id, th.rank_client_id);
+    xpn_server_admission_disconnect(local_params->admission, th.comm);
     xpn_server_comm_disconnect(local_params->server_type, th.comm);
+    __atomic_sub_fetch(&n_connections, 1, __ATOMIC_RELAXED);
 
     debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_dispatcher] End\n", th.id);
 }
 
-void xpn_server_launch_worker ( worker_t *w, void *comm, void (*function)(struct st_th) )
+void xpn_server_launch_worker ( worker_t *w, xpn_server_param_st *w_params, void *comm, void (*function)(struct st_th) )
 {
     struct st_th th_arg;
 
     // Launch dispatcher per aplication
-    th_arg.params         = &params;
+    th_arg.params         = w_params;
     th_arg.comm           = comm;
     th_arg.type_op        = 0;
     th_arg.rank_client_id = 0;
@@ -231,9 +310,44 @@ void xpn_server_launch_worker ( worker_t *w, void *comm, void (*function)(struct
     th_arg.wait4me        = FALSE;
     th_arg.function       = function;
 
+    if (function == xpn_server_dispatcher) {
+        __atomic_add_fetch(&n_connections, 1, __ATOMIC_RELAXED);
+    }
+
     base_workers_launch(w, &th_arg, function);
 }
 
+// With a connection limit, new clients kept connected are told to come back later
+int xpn_server_busy ( void )
+{
+    return (params.max_connections > 0) && (__atomic_load_n(&n_connections, __ATOMIC_RELAXED) >= params.max_connections);
+}
+
+// Queue depth and credits in use, as one line
+void xpn_server_stats ( char *buffer, int size )
+{
+    int len, queued = 0;
+
+    if (TH_POOL == worker2.thread_mode) {
+        queued = __atomic_load_n(&(worker2.w2.n_operation), __ATOMIC_RELAXED);
+    }
+
+    len = snprintf(buffer, size, "connections=%d queued=%d ", __atomic_load_n(&n_connections, __ATOMIC_RELAXED), queued);
+    if ((len > 0) && (len < size)) {
+        len = len + xpn_server_admission_stats(params.admission, buffer + len, size - len);
+    }
+    if ((len > 0) && (len + 1 < size)) {
+        strcat(buffer, " ");
+        len++;
+        len = len + xpn_server_coalesce_stats(params.coalesce, buffer + len, size - len);
+    }
+    if ((len > 0) && (len + 1 < size)) {
+        strcat(buffer, " ");
+        len++;
+        xpn_server_wlog_stats(params.wlog, buffer + len, size - len);
+    }
+}
+
 int xpn_server_init ( void )
 {
     int ret ;
@@ -252,6 +366,66 @@ int xpn_server_init ( void )
         ret = xpn_server_comm_init(XPN_SERVER_TYPE_SCK, &params); // SCK only
     }
 
+    // * Metadata index initialization
+    if (strlen(params.mdata_index_dir) > 0)
+    {
+        char log_path[PATH_MAX];
+
+        debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] Metadata index initialization\n", 0);
+
+        filesystem_mkdir_p(params.mdata_index_dir, S_IRWXU);
+        sprintf(log_path, "%.*s/%s", PATH_MAX - 64, params.mdata_index_dir, XPN_MDATA_INDEX_FILE);
+        params.mdata_index = kv_index_open(log_path, sizeof(struct xpn_metadata), utils_getenv_int("XPN_MDATA_INDEX_SYNC", 0));
+        if (NULL == params.mdata_index)
+        {
+            printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] ERROR: metadata index '%s' initialization fails\n", 0, log_path);
+            return -1;
+        }
+    }
+
+    // * Admission control (shared by all the connections)
+    params.admission = xpn_server_admission_init(params.max_requests, params.max_bytes, params.client_requests, params.client_bytes, params.quantum);
+    if (NULL == params.admission)
+    {
+        printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] ERROR: admission control initialization fails\n", 0);
+        return -1;
+    }
+
+    for (int i = 0; i < params.n_weights; i++)
+    {
+        xpn_server_host_addr(params.weight_host[i], weight_addr[i], INET6_ADDRSTRLEN);
+        if (strlen(weight_addr[i]) == 0) {
+            printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] WARNING: unknown host '%s' in -W\n", 0, params.weight_host[i]);
+        }
+    }
+    xpn_server_host_addr(params.srv_name, self_addr, INET6_ADDRSTRLEN);
+
+    // * Write coalescing (shared by all the connections)
+    if (params.coalesce_window > 0)
+    {
+        params.coalesce = xpn_server_coalesce_init(params.coalesce_window);
+        if (NULL == params.coalesce)
+        {
+            printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] ERROR: write coalescing initialization fails\n", 0);
+            return -1;
+        }
+    }
+
+    // * Log-structured writes (shared by all the connections)
+    if (strlen(params.wlog_dir) > 0)
+    {
+        params.wlog = xpn_server_wlog_init(params.wlog_dir);
+        if (NULL == params.wlog)
+        {
+            printf("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] ERROR: write log '%s' initialization fails\n", 0, params.wlog_dir);
+            return -1;
+        }
+    }
+
+    // * Shared memory channels (they use the same operations with another server_type)
+    params_shm = params;
+    params_shm.server_type = XPN_SERVER_TYPE_SHM;
+
     // * Workers initialization
     debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] Workers initialization\n", 0);
 
@@ -278,7 +452,7 @@ int xpn_server_init ( void )
 
     // One thread for connection-less clients...
     if (params.server_type != XPN_SERVER_TYPE_MPI) { // SCK only
-        xpn_server_launch_worker(&worker3, NULL, xpn_server_dispatcher_connectionless);
+        xpn_server_launch_worker(&worker3, &params, NULL, xpn_server_dispatcher_connectionless);
     }
 
     return 0;
@@ -302,6 +476,26 @@ int xpn_server_finish ( void )
     base_workers_destroy(&worker2);
     base_workers_destroy(&worker3);
 
+    xpn_server_admission_destroy(params.admission);
+    params.admission = NULL;
+    params_shm.admission = NULL;
+
+    xpn_server_coalesce_destroy(params.coalesce);
+    params.coalesce = NULL;
+    params_shm.coalesce = NULL;
+
+    // the logs left are compacted into the data files
+    xpn_server_wlog_destroy(params.wlog);
+    params.wlog = NULL;
+    params_shm.wlog = NULL;
+
+    // close the metadata index once no operation can use it
+    if (NULL != params.mdata_index)
+    {
+        kv_index_close(params.mdata_index);
+        params.mdata_index = NULL;
+    }
+
     return 0;
 }
 
@@ -317,6 +511,7 @@ int xpn_server_up ( void )
     int recv_code = 0;
     int await_stop = 0;
     void *comm = NULL;
+    char status[MAX_PORT_NAME_LENGTH];
 
     debug_info("[TH_ID=%d] [XPN_SERVER] [xpn_server_up] >> Begin\n", 0);
 
@@ -358,21 +553,54 @@ int xpn_server_up ( void )
         	 if (ret < 0) continue;
         	 ret = xpn_server_comm_accept(params.server_type, &params, XPN_SERVER_CONNECTION, &comm) ;
         	 if (ret < 0) continue;
-        	 xpn_server_launch_worker(&worker1, comm, xpn_server_dispatcher) ;
+        	 xpn_server_launch_worker(&worker1, &params, comm, xpn_server_dispatcher) ;
                  break;
 
             case SOCKET_ACCEPT_CODE_SCK_CONN:
+                 if (xpn_server_busy())
+                 {
+                     memset(status, 0, MAX_PORT_NAME_LENGTH);
+                     strcpy(status, SOCKET_BUSY_ANSWER);
+                     socket_send(connection_socket, status, MAX_PORT_NAME_LENGTH);
+                     break;
+                 }
 		 ret = socket_send(connection_socket, params.port_name_conn, MAX_PORT_NAME_LENGTH);
         	 if (ret < 0) continue;
         	 ret = xpn_server_comm_accept(params.server_type, &params, XPN_SERVER_CONNECTION, &comm) ;
         	 if (ret < 0) continue;
-        	 xpn_server_launch_worker(&worker1, comm, xpn_server_dispatcher) ;
+        	 xpn_server_launch_worker(&worker1, &params, comm, xpn_server_dispatcher) ;
                  break;
 
             case SOCKET_ACCEPT_CODE_SCK_NO_CONN:
                  socket_send(connection_socket, params.port_name_no_conn, MAX_PORT_NAME_LENGTH);
                  break;
 
+            case SOCKET_ACCEPT_CODE_SHM_CONN:
+                 ret = socket_recv(connection_socket, params_shm.port_name, MAX_PORT_NAME_LENGTH);
+        	 if (ret <= 0) break;
+                 params_shm.port_name[MAX_PORT_NAME_LENGTH - 1] = '\0';
+
+                 // only sck_server runs the operations of a connection in order, as the channel needs
+                 // (at the connection limit the client goes to the socket, where it is told to wait)
+                 ret = -1;
+                 if ((XPN_SERVER_TYPE_SCK == params.server_type) && (! xpn_server_busy())) {
+                     ret = xpn_server_comm_accept(XPN_SERVER_TYPE_SHM, &params_shm, XPN_SERVER_CONNECTION, &comm) ;
+                 }
+
+                 // the client falls back to sockets if the answer is not "ok"
+                 memset(status, 0, MAX_PORT_NAME_LENGTH);
+                 strcpy(status, (ret < 0) ? "error" : "ok");
+                 socket_send(connection_socket, status, MAX_PORT_NAME_LENGTH);
+                 if (ret < 0) break;
+        	 xpn_server_launch_worker(&worker1, &params_shm, comm, xpn_server_dispatcher) ;
+                 break;
+
+            case SOCKET_STATS_CODE:
+                 memset(status, 0, MAX_PORT_NAME_LENGTH);
+                 xpn_server_stats(status, MAX_PORT_NAME_LENGTH);
+                 socket_send(connection_socket, status, MAX_PORT_NAME_LENGTH);
+                 break;
+
             case SOCKET_FINISH_CODE:
                  the_end = 1;
                  xpn_server_finish();
@@ -547,6 +775,21 @@ int main ( int argc, char *argv[] )
         req_id = SOCKET_FINISH_CODE;
         ret    = sersoc_do_send(params.srv_name, port, req_id) ;
     }
+    else if (strcasecmp(exec_name, "xpn_stats_server") == 0)
+    {
+        char stats[MAX_PORT_NAME_LENGTH];
+
+        debug_info("[TH_ID=%d] [XPN_SERVER] [main] Stats of server\n", 0);
+
+        port   = utils_getenv_int("XPN_SCK_PORT", DEFAULT_XPN_SCK_PORT) ;
+        req_id = SOCKET_STATS_CODE;
+        memset(stats, 0, MAX_PORT_NAME_LENGTH);
+        ret    = sersoc_do_send_recv(params.srv_name, port, req_id, stats) ;
+        stats[MAX_PORT_NAME_LENGTH - 1] = '\0';
+        if (ret >= 0) {
+            printf(" * Server (%s): %s\n", params.srv_name, stats);
+        }
+    }
     else
     {
         debug_info("[TH_ID=%d] [XPN_SERVER] [main] Up servers\n", 0);
@@ -0,0 +1,617 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "xpn_server_admission.h"
+
+
+  /* ... Functions / Funciones ......................................... */
+
+
+     /*
+      * Internal
+      */
+
+     static struct xpn_server_admission_client ** aux_admission_bucket ( xpn_server_admission_t *adm, void *key )
+     {
+         uintptr_t h = (uintptr_t)key;
+
+         h = (h >> 4) ^ (h >> 12);
+         return &(adm->clients[h & (XPN_SERVER_ADMISSION_BUCKETS - 1)]);
+     }
+
+     static struct xpn_server_admission_client * aux_admission_find ( xpn_server_admission_t *adm, void *key, int create )
+     {
+         struct xpn_server_admission_client **bucket;
+         struct xpn_server_admission_client  *c;
+
+         bucket = aux_admission_bucket(adm, key);
+         for (c = *bucket; c != NULL; c = c->next)
+         {
+             if (c->key == key) {
+                 return c;
+             }
+         }
+
+         if (! create) {
+             return NULL;
+         }
+
+         c = (struct xpn_server_admission_client *)malloc(sizeof(struct xpn_server_admission_client));
+         if (NULL == c) {
+             return NULL;
+         }
+
+         memset(c, 0, sizeof(struct xpn_server_admission_client));
+         c->key = key;
+         pthread_cond_init(&(c->c_enter), NULL);
+         c->next = *bucket;
+         *bucket = c;
+
+         return c;
+     }
+
+     static struct xpn_server_admission_flow ** aux_admission_flow_bucket ( xpn_server_admission_t *adm, char *name )
+     {
+         uint32_t h = 5381;
+
+         for (char *n = name; *n != '\0'; n++) {
+             h = ((h << 5) + h) ^ (unsigned char)(*n);
+         }
+         return &(adm->flows[h & (XPN_SERVER_ADMISSION_BUCKETS - 1)]);
+     }
+
+     // Flow of the host 'name' (a new one for the connection if 'name' is empty)
+     static struct xpn_server_admission_flow * aux_admission_flow_get ( xpn_server_admission_t *adm, char *name, int weight )
+     {
+         struct xpn_server_admission_flow **bucket = NULL;
+         struct xpn_server_admission_flow  *f;
+
+         if ((NULL != name) && (strlen(name) > 0))
+         {
+             bucket = aux_admission_flow_bucket(adm, name);
+             for (f = *bucket; f != NULL; f = f->next)
+             {
+                 if (strcmp(f->name, name) == 0)
+                 {
+                     f->n_clients++;
+                     return f;
+                 }
+             }
+         }
+
+         f = (struct xpn_server_admission_flow *)malloc(sizeof(struct xpn_server_admission_flow));
+         if (NULL == f) {
+             return NULL;
+         }
+
+         memset(f, 0, sizeof(struct xpn_server_admission_flow));
+         f->weight    = (weight > 0) ? weight : 1;
+         f->n_clients = 1;
+         if (NULL != bucket)
+         {
+             strncpy(f->name, name, INET6_ADDRSTRLEN - 1);
+             f->next = *bucket;
+             *bucket = f;
+         }
+
+         return f;
+     }
+
+     static void aux_admission_flow_put ( xpn_server_admission_t *adm, struct xpn_server_admission_flow *flow )
+     {
+         struct xpn_server_admission_flow **p;
+
+         flow->n_clients--;
+         if (flow->n_clients > 0) {
+             return;
+         }
+
+         if (strlen(flow->name) > 0)
+         {
+             for (p = aux_admission_flow_bucket(adm, flow->name); *p != NULL; p = &((*p)->next))
+             {
+                 if (*p == flow)
+                 {
+                     *p = flow->next;
+                     break;
+                 }
+             }
+         }
+
+         free(flow);
+     }
+
+     static void aux_admission_forget ( xpn_server_admission_t *adm, struct xpn_server_admission_client *client )
+     {
+         struct xpn_server_admission_client **p;
+
+         // keep the entry while its connection is alive, it has something in flight or somebody waits on it
+         if ((client->connected) || (client->n_requests > 0) || (client->n_bytes > 0) || (client->n_enter_wait > 0)) {
+             return;
+         }
+
+         for (p = aux_admission_bucket(adm, client->key); *p != NULL; p = &((*p)->next))
+         {
+             if (*p == client)
+             {
+                 *p = client->next;
+                 if (NULL != client->flow) {
+                     aux_admission_flow_put(adm, client->flow);
+                 }
+                 pthread_cond_destroy(&(client->c_enter));
+                 free(client);
+                 return;
+             }
+         }
+     }
+
+     // 1 if the server budget has room for 'bytes' (a request alone always fits)
+     static int aux_admission_server_fits ( xpn_server_admission_t *adm, long bytes )
+     {
+         if ((adm->max_requests > 0) && (adm->n_requests >= adm->max_requests)) {
+             return 0;
+         }
+         if ((adm->max_bytes > 0) && (adm->n_bytes > 0) && (adm->n_bytes + bytes > adm->max_bytes)) {
+             return 0;
+         }
+
+         return 1;
+     }
+
+     static int aux_admission_client_fits ( xpn_server_admission_t *adm, struct xpn_server_admission_client *client, long bytes )
+     {
+         if (NULL == client) {
+             return 1;
+         }
+         if ((adm->client_bytes > 0) && (client->n_bytes > 0) && (client->n_bytes + bytes > adm->client_bytes)) {
+             return 0;
+         }
+
+         return 1;
+     }
+
+     static void aux_admission_account ( xpn_server_admission_t *adm, struct xpn_server_admission_client *client, long bytes )
+     {
+         adm->n_requests++;
+         adm->n_bytes = adm->n_bytes + bytes;
+         adm->n_admitted++;
+
+         if (NULL != client) {
+             client->n_bytes = client->n_bytes + bytes;
+         }
+     }
+
+     static void aux_admission_wakeup ( xpn_server_admission_t *adm, struct xpn_server_admission_waiter *w, int lane )
+     {
+         adm->n_waiting--;
+         if (XPN_SERVER_ADMISSION_MDATA == lane) {
+             adm->n_waiting_mdata--;
+         }
+
+         aux_admission_account(adm, w->client, w->bytes);
+         w->admitted = 1;
+         pthread_cond_signal(&(w->c_admit));
+     }
+
+     // The flow at the head of the data lane goes to the tail
+     static void aux_admission_rotate ( xpn_server_admission_t *adm )
+     {
+         struct xpn_server_admission_flow *f = adm->active_first;
+
+         f->in_turn = 0;
+         if (adm->active_last == f) {
+             return;
+         }
+
+         adm->active_first = f->active_next;
+         f->active_next    = NULL;
+         adm->active_last->active_next = f;
+         adm->active_last  = f;
+     }
+
+     // Deficit round robin: admit the next data request, 0 if none can run now
+     static int aux_admission_drr ( xpn_server_admission_t *adm )
+     {
+         struct xpn_server_admission_flow   *f;
+         struct xpn_server_admission_waiter *w;
+         long cost;
+         int  blocked = 0;
+
+         while ((NULL != adm->active_first) && (blocked < adm->n_active))
+         {
+             f    = adm->active_first;
+             w    = f->first;
+             cost = (w->bytes > XPN_SERVER_ADMISSION_MIN_COST) ? w->bytes : XPN_SERVER_ADMISSION_MIN_COST;
+
+             // without bytes of its own connection, the flow loses its turn
+             if (! aux_admission_client_fits(adm, w->client, w->bytes))
+             {
+                 aux_admission_rotate(adm);
+                 blocked++;
+                 continue;
+             }
+
+             if (! f->in_turn)
+             {
+                 f->deficit = f->deficit + adm->quantum * f->weight;
+                 f->in_turn = 1;
+             }
+             if (f->deficit < cost)
+             {
+                 aux_admission_rotate(adm);
+                 blocked = 0;
+                 continue;
+             }
+
+             // the turn is kept until the server has room, so a big request is not starved
+             if (! aux_admission_server_fits(adm, w->bytes)) {
+                 return 0;
+             }
+
+             f->first   = w->next;
+             f->deficit = f->deficit - cost;
+             if (NULL == f->first)
+             {
+                 f->last    = NULL;
+                 f->deficit = 0;
+                 f->in_turn = 0;
+
+                 adm->active_first = f->active_next;
+                 if (NULL == adm->active_first) {
+                     adm->active_last = NULL;
+                 }
+                 f->active_next = NULL;
+                 adm->n_active--;
+             }
+
+             aux_admission_wakeup(adm, w, XPN_SERVER_ADMISSION_DATA);
+             return 1;
+         }
+
+         return 0;
+     }
+
+     // Admit the waiting requests while there are credits: metadata first, but
+     // only a burst of them in a row while data requests are waiting too
+     static void aux_admission_grant ( xpn_server_admission_t *adm )
+     {
+         struct xpn_server_admission_waiter *w;
+         int data_waits;
+
+         for (;;)
+         {
+             data_waits = (NULL != adm->active_first);
+
+             if ((NULL != adm->m_first) && ((! data_waits) || (adm->meta_burst < XPN_SERVER_ADMISSION_META_BURST)))
+             {
+                 w = adm->m_first;
+                 if (! aux_admission_server_fits(adm, w->bytes)) {
+                     return;
+                 }
+
+                 adm->m_first = w->next;
+                 if (NULL == adm->m_first) {
+                     adm->m_last = NULL;
+                 }
+                 if (data_waits) {
+                     adm->meta_burst++;
+                 }
+
+                 aux_admission_wakeup(adm, w, XPN_SERVER_ADMISSION_MDATA);
+                 continue;
+             }
+
+             if ((! data_waits) || (! aux_admission_drr(adm))) {
+                 return;
+             }
+             adm->meta_burst = 0;
+         }
+     }
+
+
+     /*
+      * API
+      */
+
+     xpn_server_admission_t * xpn_server_admission_init ( int max_requests, long max_bytes, int client_requests, long client_bytes, long quantum )
+     {
+         xpn_server_admission_t *adm;
+
+         debug_info("[XPN_SERVER_ADMISSION] [xpn_server_admission_init] >> Begin\n");
+
+         adm = (xpn_server_admission_t *)malloc(sizeof(xpn_server_admission_t));
+         if (NULL == adm)
+         {
+             debug_error("[XPN_SERVER_ADMISSION] [xpn_server_admission_init] ERROR: malloc fails\n");
+             return NULL;
+         }
+
+         memset(adm, 0, sizeof(xpn_server_admission_t));
+         pthread_mutex_init(&(adm->m_admission), NULL);
+
+         adm->max_requests    = (max_requests    > 0) ? max_requests    : 0;
+         adm->max_bytes       = (max_bytes       > 0) ? max_bytes       : 0;
+         adm->client_requests = (client_requests > 0) ? client_requests : 0;
+         adm->client_bytes    = (client_bytes    > 0) ? client_bytes    : 0;
+         adm->quantum         = (quantum         > 0) ? quantum         : XPN_SERVER_ADMISSION_QUANTUM;
+         adm->limited         = (adm->max_requests > 0) || (adm->max_bytes > 0) || (adm->client_requests > 0) || (adm->client_bytes > 0);
+
+         debug_info("[XPN_SERVER_ADMISSION] [xpn_server_admission_init] << End\n");
+
+         return adm;
+     }
+
+     void xpn_server_admission_destroy ( xpn_server_admission_t *adm )
+     {
+         struct xpn_server_admission_client *c;
+
+         if (NULL == adm) {
+             return;
+         }
+
+         for (int i = 0; i < XPN_SERVER_ADMISSION_BUCKETS; i++)
+         {
+             while (NULL != adm->clients[i])
+             {
+                 c = adm->clients[i];
+                 adm->clients[i] = c->next;
+                 if (NULL != c->flow) {
+                     aux_admission_flow_put(adm, c->flow);
+                 }
+                 pthread_cond_destroy(&(c->c_enter));
+                 free(c);
+             }
+         }
+
+         pthread_mutex_destroy(&(adm->m_admission));
+         free(adm);
+     }
+
+     // A connection starts: it keeps its entry until it ends, and its data requests
+     // share the turns of 'flow' (its host) with the other connections of that host
+     void xpn_server_admission_connect ( xpn_server_admission_t *adm, void *client, char *flow, int weight )
+     {
+         struct xpn_server_admission_client *c;
+
+         if ((NULL == adm) || (! adm->limited)) {
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         c = aux_admission_find(adm, client, 1);
+         if (NULL != c)
+         {
+             c->connected = 1;
+             if (NULL == c->flow) {
+                 c->flow = aux_admission_flow_get(adm, flow, weight);
+             }
+         }
+
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     void xpn_server_admission_disconnect ( xpn_server_admission_t *adm, void *client )
+     {
+         struct xpn_server_admission_client *c;
+
+         if ((NULL == adm) || (! adm->limited)) {
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         c = aux_admission_find(adm, client, 0);
+         if (NULL != c)
+         {
+             c->connected = 0;
+             aux_admission_forget(adm, c);
+         }
+
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     // A request of 'client' has been read: wait for a request slot of this client
+     void xpn_server_admission_enter ( xpn_server_admission_t *adm, void *client )
+     {
+         struct xpn_server_admission_client *c;
+
+         if ((NULL == adm) || (! adm->limited)) {
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         c = aux_admission_find(adm, client, 1);
+         if (NULL != c)
+         {
+             if (NULL == c->flow) {
+                 c->flow = aux_admission_flow_get(adm, "", 1);
+             }
+
+             c->n_enter_wait++;
+             while ((adm->client_requests > 0) && (c->n_requests >= adm->client_requests)) {
+                 pthread_cond_wait(&(c->c_enter), &(adm->m_admission));
+             }
+             c->n_enter_wait--;
+             c->n_requests++;
+         }
+
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     void xpn_server_admission_leave ( xpn_server_admission_t *adm, void *client )
+     {
+         struct xpn_server_admission_client *c;
+
+         if ((NULL == adm) || (! adm->limited)) {
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         c = aux_admission_find(adm, client, 0);
+         if (NULL != c)
+         {
+             c->n_requests--;
+             if (c->n_enter_wait > 0) {
+                 pthread_cond_signal(&(c->c_enter));
+             }
+             aux_admission_forget(adm, c);
+         }
+
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     // Wait until the request (and its bytes) can run
+     void xpn_server_admission_get ( xpn_server_admission_t *adm, void *client, int lane, long bytes )
+     {
+         struct xpn_server_admission_waiter w;
+         struct xpn_server_admission_client *c;
+         struct xpn_server_admission_flow   *f;
+
+         if (NULL == adm) {
+             return;
+         }
+
+         if (! adm->limited)
+         {
+             __atomic_add_fetch(&(adm->n_requests), 1,     __ATOMIC_RELAXED);
+             __atomic_add_fetch(&(adm->n_bytes),    bytes, __ATOMIC_RELAXED);
+             __atomic_add_fetch(&(adm->n_admitted), 1,     __ATOMIC_RELAXED);
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         c = aux_admission_find(adm, client, 0);
+
+         // nobody waiting: run now if it fits
+         if ((NULL == adm->m_first) && (NULL == adm->active_first) && aux_admission_server_fits(adm, bytes) && aux_admission_client_fits(adm, c, bytes))
+         {
+             aux_admission_account(adm, c, bytes);
+             pthread_mutex_unlock(&(adm->m_admission));
+             return;
+         }
+
+         w.client   = c;
+         w.bytes    = bytes;
+         w.admitted = 0;
+         w.next     = NULL;
+         pthread_cond_init(&(w.c_admit), NULL);
+
+         f = (NULL != c) ? c->flow : NULL;
+         if ((XPN_SERVER_ADMISSION_MDATA == lane) || (NULL == f))
+         {
+             lane = XPN_SERVER_ADMISSION_MDATA;
+             if (NULL == adm->m_last)
+                  adm->m_first      = &w;
+             else adm->m_last->next = &w;
+             adm->m_last = &w;
+             adm->n_waiting_mdata++;
+         }
+         else
+         {
+             if (NULL == f->last)
+             {
+                 // the flow joins the round
+                 f->first = &w;
+                 if (NULL == adm->active_last)
+                      adm->active_first             = f;
+                 else adm->active_last->active_next = f;
+                 adm->active_last = f;
+                 f->active_next   = NULL;
+                 adm->n_active++;
+             }
+             else {
+                 f->last->next = &w;
+             }
+             f->last = &w;
+         }
+
+         adm->n_waiting++;
+         adm->n_delayed++;
+         if (adm->n_waiting > adm->max_waiting) {
+             adm->max_waiting = adm->n_waiting;
+         }
+
+         debug_info("[XPN_SERVER_ADMISSION] [xpn_server_admission_get] lane %d waiting for %ld bytes, %d requests in the queue\n", lane, bytes, adm->n_waiting);
+
+         aux_admission_grant(adm);
+         while (! w.admitted) {
+             pthread_cond_wait(&(w.c_admit), &(adm->m_admission));
+         }
+
+         pthread_cond_destroy(&(w.c_admit));
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     void xpn_server_admission_put ( xpn_server_admission_t *adm, void *client, long bytes )
+     {
+         struct xpn_server_admission_client *c;
+
+         if (NULL == adm) {
+             return;
+         }
+
+         if (! adm->limited)
+         {
+             __atomic_sub_fetch(&(adm->n_requests), 1,     __ATOMIC_RELAXED);
+             __atomic_sub_fetch(&(adm->n_bytes),    bytes, __ATOMIC_RELAXED);
+             return;
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+
+         adm->n_requests--;
+         adm->n_bytes = adm->n_bytes - bytes;
+
+         c = aux_admission_find(adm, client, 0);
+         if (NULL != c) {
+             c->n_bytes = c->n_bytes - bytes;
+         }
+
+         aux_admission_grant(adm);
+
+         pthread_mutex_unlock(&(adm->m_admission));
+     }
+
+     // One line with the queue depth and the credits in use
+     int xpn_server_admission_stats ( xpn_server_admission_t *adm, char *buffer, int size )
+     {
+         if (NULL == adm) {
+             return snprintf(buffer, size, "admission=off");
+         }
+
+         pthread_mutex_lock(&(adm->m_admission));
+         int ret = snprintf(buffer, size, "running=%d bytes=%ld waiting=%d waiting_mdata=%d flows_waiting=%d max_waiting=%d admitted=%ld delayed=%ld",
+                            adm->n_requests, adm->n_bytes, adm->n_waiting, adm->n_waiting_mdata, adm->n_active, adm->max_waiting, adm->n_admitted, adm->n_delayed);
+         pthread_mutex_unlock(&(adm->m_admission));
+
+         return ret;
+     }
+
+
+  /* ................................................................... */
+
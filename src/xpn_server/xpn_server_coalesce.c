@@ -0,0 +1,440 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "xpn_server_coalesce.h"
+
+
+  /* ... Functions / Funciones ......................................... */
+
+
+     /*
+      * Internal
+      */
+
+     static struct xpn_server_coalesce_file ** aux_coalesce_bucket ( xpn_server_coalesce_t *c, char *path )
+     {
+         uint32_t h = 5381;
+
+         for (char *p = path; *p != '\0'; p++) {
+             h = ((h << 5) + h) ^ (unsigned char)(*p);
+         }
+         return &(c->files[h & (XPN_SERVER_COALESCE_BUCKETS - 1)]);
+     }
+
+     static long aux_coalesce_now ( void )
+     {
+         struct timespec t;
+
+         clock_gettime(CLOCK_REALTIME, &t);
+         return (long)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+     }
+
+     static void aux_coalesce_free ( struct xpn_server_coalesce_file *file )
+     {
+         pthread_cond_destroy(&(file->c_file));
+         free(file->path);
+         free(file);
+     }
+
+     // Idle files are kept a while to know if they are shared, then the next begin on the bucket removes them
+     static void aux_coalesce_purge ( struct xpn_server_coalesce_file **bucket, long now )
+     {
+         struct xpn_server_coalesce_file **p = bucket;
+         struct xpn_server_coalesce_file  *file;
+
+         while (NULL != *p)
+         {
+             file = *p;
+             if ((file->n_users > 0) || (now - file->last_time < XPN_SERVER_COALESCE_SHARED))
+             {
+                 p = &(file->next);
+                 continue;
+             }
+
+             *p = file->next;
+             aux_coalesce_free(file);
+         }
+     }
+
+     static int aux_coalesce_cmp ( const void *a, const void *b )
+     {
+         struct xpn_server_coalesce_req *ra = *(struct xpn_server_coalesce_req **)a;
+         struct xpn_server_coalesce_req *rb = *(struct xpn_server_coalesce_req **)b;
+
+         if (ra->offset != rb->offset) {
+             return (ra->offset < rb->offset) ? -1 : 1;
+         }
+         return (ra->seq < rb->seq) ? -1 : 1;
+     }
+
+     static ssize_t aux_coalesce_pwrite ( int fd, off_t offset, char *buffer, long size )
+     {
+         if (filesystem_lseek(fd, offset, SEEK_SET) < 0) {
+             return -1;
+         }
+         return filesystem_write(fd, buffer, size);
+     }
+
+     static void aux_coalesce_result ( struct xpn_server_coalesce_req *r, ssize_t ret, int err )
+     {
+         r->ret = (ret < 0) ? -1 : r->size;
+         r->err = (ret < 0) ? err : 0;
+     }
+
+     // Write a batch (list in arrival order) with one write per run of adjacent or overlapping requests.
+     // It returns the number of writes done.
+     static long aux_coalesce_flush ( int fd, struct xpn_server_coalesce_req *batch, int n )
+     {
+         struct xpn_server_coalesce_req **sorted;
+         struct xpn_server_coalesce_req  *r;
+         off_t   start, end;
+         char   *run_buffer;
+         ssize_t ret;
+         long    n_syscalls = 0;
+         int     i, j, k, run;
+
+         sorted = (struct xpn_server_coalesce_req **)malloc(n * sizeof(struct xpn_server_coalesce_req *));
+         if (NULL == sorted)
+         {
+             // one by one
+             for (r = batch; r != NULL; r = r->next)
+             {
+                 ret = aux_coalesce_pwrite(fd, r->offset, r->buffer, r->size);
+                 aux_coalesce_result(r, ret, errno);
+                 n_syscalls++;
+             }
+             return n_syscalls;
+         }
+
+         for (i = 0, r = batch; r != NULL; r = r->next, i++) {
+             sorted[i] = r;
+             r->run = -1;
+         }
+         qsort(sorted, n, sizeof(struct xpn_server_coalesce_req *), aux_coalesce_cmp);
+
+         for (i = 0, run = 0; i < n; i = j, run++)
+         {
+             // the run: next requests that start before (or where) it ends
+             start = sorted[i]->offset;
+             end   = sorted[i]->offset + sorted[i]->size;
+             sorted[i]->run = run;
+             for (j = i + 1; j < n; j++)
+             {
+                 off_t next_end = sorted[j]->offset + sorted[j]->size;
+
+                 if (sorted[j]->offset > end) {
+                     break;
+                 }
+                 // cut only between adjacent requests: two runs that overlap are written in offset order, not in arrival order
+                 if ((sorted[j]->offset == end) && (next_end - start > XPN_SERVER_COALESCE_MAX_RUN)) {
+                     break;
+                 }
+                 if (next_end > end) {
+                     end = next_end;
+                 }
+                 sorted[j]->run = run;
+             }
+
+             // only one request: from its own buffer
+             if (j - i == 1)
+             {
+                 ret = aux_coalesce_pwrite(fd, sorted[i]->offset, sorted[i]->buffer, sorted[i]->size);
+                 aux_coalesce_result(sorted[i], ret, errno);
+                 n_syscalls++;
+                 continue;
+             }
+
+             run_buffer = (char *)malloc(end - start);
+             if (NULL == run_buffer)
+             {
+                 // one by one in arrival order
+                 for (r = batch; r != NULL; r = r->next)
+                 {
+                     if (r->run == run)
+                     {
+                         ret = aux_coalesce_pwrite(fd, r->offset, r->buffer, r->size);
+                         aux_coalesce_result(r, ret, errno);
+                         n_syscalls++;
+                     }
+                 }
+                 continue;
+             }
+
+             // copy in arrival order, so the last write wins where two of them overlap
+             for (r = batch; r != NULL; r = r->next)
+             {
+                 if (r->run == run) {
+                     memcpy(run_buffer + (r->offset - start), r->buffer, r->size);
+                 }
+             }
+
+             ret = aux_coalesce_pwrite(fd, start, run_buffer, end - start);
+             n_syscalls++;
+             for (k = i; k < j; k++) {
+                 aux_coalesce_result(sorted[k], ret, errno);
+             }
+
+             FREE_AND_NULL(run_buffer);
+         }
+
+         FREE_AND_NULL(sorted);
+
+         return n_syscalls;
+     }
+
+
+     /*
+      * API
+      */
+
+     xpn_server_coalesce_t * xpn_server_coalesce_init ( long window )
+     {
+         xpn_server_coalesce_t *c;
+
+         debug_info("[XPN_SERVER_COALESCE] [xpn_server_coalesce_init] >> Begin\n");
+
+         c = (xpn_server_coalesce_t *)malloc(sizeof(xpn_server_coalesce_t));
+         if (NULL == c)
+         {
+             debug_error("[XPN_SERVER_COALESCE] [xpn_server_coalesce_init] ERROR: malloc fails\n");
+             return NULL;
+         }
+
+         memset(c, 0, sizeof(xpn_server_coalesce_t));
+         pthread_mutex_init(&(c->m_coalesce), NULL);
+
+         c->window   = (window > 0) ? window : 0;
+         c->max_size = XPN_SERVER_COALESCE_MAX_SIZE;
+
+         debug_info("[XPN_SERVER_COALESCE] [xpn_server_coalesce_init] << End\n");
+
+         return c;
+     }
+
+     void xpn_server_coalesce_destroy ( xpn_server_coalesce_t *c )
+     {
+         struct xpn_server_coalesce_file *file;
+
+         if (NULL == c) {
+             return;
+         }
+
+         for (int i = 0; i < XPN_SERVER_COALESCE_BUCKETS; i++)
+         {
+             while (NULL != c->files[i])
+             {
+                 file = c->files[i];
+                 c->files[i] = file->next;
+                 aux_coalesce_free(file);
+             }
+         }
+
+         pthread_mutex_destroy(&(c->m_coalesce));
+         free(c);
+     }
+
+     // A write of 'client' to 'path' is going to receive its data (NULL if it cannot be coalesced)
+     struct xpn_server_coalesce_file * xpn_server_coalesce_begin ( xpn_server_coalesce_t *c, char *path, void *client )
+     {
+         struct xpn_server_coalesce_file **bucket;
+         struct xpn_server_coalesce_file  *file;
+         long now;
+
+         if (NULL == c) {
+             return NULL;
+         }
+
+         pthread_mutex_lock(&(c->m_coalesce));
+
+         now    = aux_coalesce_now();
+         bucket = aux_coalesce_bucket(c, path);
+         aux_coalesce_purge(bucket, now);
+         for (file = *bucket; file != NULL; file = file->next)
+         {
+             if (strcmp(file->path, path) == 0) {
+                 break;
+             }
+         }
+
+         if (NULL == file)
+         {
+             file = (struct xpn_server_coalesce_file *)malloc(sizeof(struct xpn_server_coalesce_file));
+             if (NULL != file)
+             {
+                 memset(file, 0, sizeof(struct xpn_server_coalesce_file));
+                 file->path = strdup(path);
+                 if (NULL == file->path) {
+                     FREE_AND_NULL(file);
+                 }
+             }
+             if (NULL == file)
+             {
+                 pthread_mutex_unlock(&(c->m_coalesce));
+                 return NULL;
+             }
+
+             pthread_cond_init(&(file->c_file), NULL);
+             file->next = *bucket;
+             *bucket = file;
+         }
+
+         file->n_users++;
+         file->n_receiving++;
+
+         if ((NULL != file->last_client) && (file->last_client != client) && (now - file->last_time < XPN_SERVER_COALESCE_SHARED)) {
+             file->shared_until = now + XPN_SERVER_COALESCE_SHARED;
+         }
+         file->last_client = client;
+         file->last_time   = now;
+
+         pthread_mutex_unlock(&(c->m_coalesce));
+
+         return file;
+     }
+
+     // The write ends ('written' = 0 if it did not reach xpn_server_coalesce_write)
+     void xpn_server_coalesce_end ( xpn_server_coalesce_t *c, struct xpn_server_coalesce_file *file, int written )
+     {
+         if ((NULL == c) || (NULL == file)) {
+             return;
+         }
+
+         pthread_mutex_lock(&(c->m_coalesce));
+
+         if (! written)
+         {
+             // the leader does not wait for it anymore
+             file->n_receiving--;
+             pthread_cond_broadcast(&(file->c_file));
+         }
+
+         file->n_users--;
+
+         pthread_mutex_unlock(&(c->m_coalesce));
+     }
+
+     // Write 'size' bytes at 'offset', maybe together with the writes of other clients to the same file
+     // ('leader' = 1 if this thread wrote the batch with 'fd', else another fd was used)
+     ssize_t xpn_server_coalesce_write ( xpn_server_coalesce_t *c, struct xpn_server_coalesce_file *file, int fd, off_t offset, char *buffer, long size, int *leader )
+     {
+         struct xpn_server_coalesce_req  r;
+         struct xpn_server_coalesce_req *batch;
+         struct timespec deadline;
+         long n_syscalls;
+         int  n, shared;
+
+         memset(&r, 0, sizeof(struct xpn_server_coalesce_req));
+         r.offset = offset;
+         r.buffer = buffer;
+         r.size   = size;
+         *leader  = 0;
+
+         pthread_mutex_lock(&(c->m_coalesce));
+
+         r.seq = file->seq++;
+         if (NULL == file->last)
+              file->first      = &r;
+         else file->last->next = &r;
+         file->last = &r;
+         file->n_pending++;
+         file->pending_bytes = file->pending_bytes + size;
+         file->n_receiving--;
+         pthread_cond_broadcast(&(file->c_file));
+
+         while (! r.done)
+         {
+             if ((file->leader) && (! r.lead))
+             {
+                 pthread_cond_wait(&(file->c_file), &(c->m_coalesce));
+                 continue;
+             }
+
+             // leader: gather the writes whose data is still coming and, in a shared file, the ones of the window
+             file->leader = 1;
+             r.lead = 0;
+             *leader = 1;
+
+             clock_gettime(CLOCK_REALTIME, &deadline);
+             shared = (deadline.tv_sec * 1000000L + deadline.tv_nsec / 1000 < file->shared_until);
+             deadline.tv_nsec = deadline.tv_nsec + (c->window % 1000000) * 1000;
+             deadline.tv_sec  = deadline.tv_sec  + (c->window / 1000000) + (deadline.tv_nsec / 1000000000);
+             deadline.tv_nsec = deadline.tv_nsec % 1000000000;
+             while (((file->n_receiving > 0) || (shared)) && (file->pending_bytes < XPN_SERVER_COALESCE_MAX_RUN))
+             {
+                 if (pthread_cond_timedwait(&(file->c_file), &(c->m_coalesce), &deadline) == ETIMEDOUT) {
+                     break;
+                 }
+             }
+
+             batch = file->first;
+             n     = file->n_pending;
+             file->first     = NULL;
+             file->last      = NULL;
+             file->n_pending = 0;
+             file->pending_bytes = 0;
+
+             pthread_mutex_unlock(&(c->m_coalesce));
+
+             debug_info("[XPN_SERVER_COALESCE] [xpn_server_coalesce_write] %s: batch of %d writes\n", file->path, n);
+             n_syscalls = aux_coalesce_flush(fd, batch, n);
+
+             pthread_mutex_lock(&(c->m_coalesce));
+
+             for (struct xpn_server_coalesce_req *b = batch; b != NULL; b = b->next) {
+                 b->done = 1;
+             }
+             c->n_writes   = c->n_writes   + n;
+             c->n_batches  = c->n_batches  + 1;
+             c->n_syscalls = c->n_syscalls + n_syscalls;
+
+             // the writes that arrived meanwhile are the next batch
+             if (NULL != file->first)
+                  file->first->lead = 1;
+             else file->leader = 0;
+             pthread_cond_broadcast(&(file->c_file));
+         }
+
+         pthread_mutex_unlock(&(c->m_coalesce));
+
+         errno = r.err;
+         return r.ret;
+     }
+
+     // One line with the writes coalesced
+     int xpn_server_coalesce_stats ( xpn_server_coalesce_t *c, char *buffer, int size )
+     {
+         if (NULL == c) {
+             return snprintf(buffer, size, "coalesce=off");
+         }
+
+         pthread_mutex_lock(&(c->m_coalesce));
+         int ret = snprintf(buffer, size, "coalesced=%ld batches=%ld syscalls=%ld", c->n_writes, c->n_batches, c->n_syscalls);
+         pthread_mutex_unlock(&(c->m_coalesce));
+
+         return ret;
+     }
+
+
+  /* ................................................................... */
+
@@ -52,6 +52,11 @@ int xpn_server_comm_init ( int server_type, xpn_server_param_st * params )
                 ret = mq_server_mqtt_init(params);
             }
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            // channels are created by the clients and announced through the control socket
+            ret = 0;
+            break;
 #endif
 
        default:
@@ -88,6 +93,10 @@ int xpn_server_comm_destroy ( int server_type, xpn_server_param_st * params )
 	    ret =     shutdown(params->server_socket_no_conn, SHUT_RDWR) ;
             ret = socket_close(params->server_socket_no_conn);
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = 0;
+            break;
 #endif
 
        default:
@@ -116,6 +125,10 @@ int xpn_server_comm_accept ( int server_type, xpn_server_param_st * params, int
                  ret = sck_server_comm_accept(params->server_socket,         (int ** ) new_sd, params->ipv);
             else ret = sck_server_comm_accept(params->server_socket_no_conn, (int ** ) new_sd, params->ipv);
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = shm_server_comm_accept(params->port_name, (shm_ring_t ** ) new_sd);
+            break;
 #endif
 
        default:
@@ -142,6 +155,10 @@ int xpn_server_comm_disconnect ( int server_type, void * sd )
        case XPN_SERVER_TYPE_SCK:
             ret = sck_server_comm_disconnect((int * ) sd);
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = shm_server_comm_disconnect((shm_ring_t * ) sd);
+            break;
 #endif
 
        default:
@@ -168,6 +185,10 @@ ssize_t xpn_server_comm_read_operation ( int server_type, void * sd, int * op, _
        case XPN_SERVER_TYPE_SCK:
             ret = socket_recv( * (int * ) sd, op, sizeof( * op));
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = shm_ring_recv((shm_ring_t * ) sd, op, sizeof( * op));
+            break;
 #endif
 
        default:
@@ -194,6 +215,10 @@ ssize_t xpn_server_comm_write_data ( int server_type, void * sd, char * data, ss
        case XPN_SERVER_TYPE_SCK:
             ret = socket_send( * (int * ) sd, data, size);
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = shm_ring_send((shm_ring_t * ) sd, data, size);
+            break;
 #endif
 
        default:
@@ -204,6 +229,59 @@ ssize_t xpn_server_comm_write_data ( int server_type, void * sd, char * data, ss
     return ret;
 }
 
+// Several pieces (reply header + data...): one sendmsg with sockets, one message per piece otherwise
+ssize_t xpn_server_comm_write_datav ( int server_type, void * sd, __attribute__((__unused__)) struct iovec * iov, __attribute__((__unused__)) int iovcnt, __attribute__((__unused__)) int rank_client_id, __attribute__((__unused__)) int tag_client_id )
+{
+    ssize_t ret = -1;
+    __attribute__((__unused__)) ssize_t total = 0;
+    __attribute__((__unused__)) int i;
+
+    switch (server_type)
+    {
+#ifdef ENABLE_MPI_SERVER
+       case XPN_SERVER_TYPE_MPI:
+            for (i = 0; i < iovcnt; i++)
+            {
+                ret = mpi_server_comm_write_data((MPI_Comm * ) sd, iov[i].iov_base, iov[i].iov_len, rank_client_id, tag_client_id);
+                if (ret < 0) {
+                    break;
+                }
+                total = total + ret;
+            }
+            if (ret >= 0) {
+                ret = total;
+            }
+            break;
+#endif
+
+#ifdef ENABLE_SCK_SERVER
+       case XPN_SERVER_TYPE_SCK:
+            ret = socket_sendv( * (int * ) sd, iov, iovcnt);
+            break;
+
+       case XPN_SERVER_TYPE_SHM:
+            for (i = 0; i < iovcnt; i++)
+            {
+                ret = shm_ring_send((shm_ring_t * ) sd, iov[i].iov_base, iov[i].iov_len);
+                if (ret < 0) {
+                    break;
+                }
+                total = total + ret;
+            }
+            if (ret >= 0) {
+                ret = total;
+            }
+            break;
+#endif
+
+       default:
+            printf("[XPN_SERVER] [xpn_server_comm_write_datav] server_type '%d' not recognized, please check your compiler options just in case.\n", server_type);
+            break;
+    }
+
+    return ret;
+}
+
 ssize_t xpn_server_comm_read_data ( int server_type, void * sd, char * data, ssize_t size, __attribute__((__unused__)) int rank_client_id, __attribute__((__unused__)) int tag_client_id )
 {
     ssize_t ret = -1;
@@ -220,6 +298,10 @@ ssize_t xpn_server_comm_read_data ( int server_type, void * sd, char * data, ssi
        case XPN_SERVER_TYPE_SCK:
             ret = socket_recv( * (int *)sd, data, size );
             break;
+
+       case XPN_SERVER_TYPE_SHM:
+            ret = shm_ring_recv((shm_ring_t * ) sd, data, size);
+            break;
 #endif
 
        default:
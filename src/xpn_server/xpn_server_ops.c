@@ -32,6 +32,8 @@
     void xpn_server_op_creat       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_read        ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_write       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_readv       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_writev      ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_close       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_rm          ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_rm_async    ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
@@ -46,6 +48,10 @@
     void xpn_server_op_closedir    ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_rmdir       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_rmdir_async ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_mkdir_p     ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_rmtree      ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_walk        ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_summarize   ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
 
     // FS Operations
     void xpn_server_op_getnodename ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id );
@@ -56,16 +62,38 @@
     void xpn_server_op_write_mdata           ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
     void xpn_server_op_write_mdata_file_size ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
 
+    // Connection
+    void xpn_server_op_codec       ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+    void xpn_server_op_layout      ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id ) ;
+
 
     //Read the operation to realize
     int xpn_server_do_operation ( int server_type, struct st_th * th, int * the_end )
     {
         int ret;
         struct st_xpn_server_msg head;
+        xpn_server_param_st *local_params = (xpn_server_param_st *)th->params;
+        long admit_bytes = -1;
 
         debug_info("[TH_ID=%d] [XPN_SERVER_OPS] [xpn_server_do_operation] >> Begin\n", th->id);
         debug_info("[TH_ID=%d] [XPN_SERVER_OPS] [xpn_server_do_operation] OP '%s'; OP_ID %d\n", th->id, xpn_server_op2string(th->type_op), th->type_op);
 
+        // data requests wait for their credits once the head tells their size, the rest right now (in the metadata lane)
+        switch (th->type_op)
+        {
+        case XPN_SERVER_READ_FILE:
+        case XPN_SERVER_WRITE_FILE:
+        case XPN_SERVER_READV_FILE:
+        case XPN_SERVER_WRITEV_FILE:
+        case XPN_SERVER_DISCONNECT:
+        case XPN_SERVER_FINALIZE:
+             break;
+        default:
+             admit_bytes = 0;
+             xpn_server_admission_get(local_params->admission, th->comm, XPN_SERVER_ADMISSION_MDATA, admit_bytes);
+             break;
+        }
+
         switch (th->type_op)
         {
             //File API
@@ -84,15 +112,35 @@
         case XPN_SERVER_READ_FILE:
              ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_read), sizeof(head.u_st_xpn_server_msg.op_read), th->rank_client_id, th->tag_client_id);
              if (ret != -1) {
+                 admit_bytes = head.u_st_xpn_server_msg.op_read.size;
+                 xpn_server_admission_get(local_params->admission, th->comm, XPN_SERVER_ADMISSION_DATA, admit_bytes);
                  xpn_server_op_read(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
              }
              break;
         case XPN_SERVER_WRITE_FILE:
              ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_write), sizeof(head.u_st_xpn_server_msg.op_write), th->rank_client_id, th->tag_client_id);
              if (ret != -1) {
+                 admit_bytes = head.u_st_xpn_server_msg.op_write.size;
+                 xpn_server_admission_get(local_params->admission, th->comm, XPN_SERVER_ADMISSION_DATA, admit_bytes);
                  xpn_server_op_write(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
              }
              break;
+        case XPN_SERVER_READV_FILE:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_readv), sizeof(head.u_st_xpn_server_msg.op_readv), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 admit_bytes = head.u_st_xpn_server_msg.op_readv.size;
+                 xpn_server_admission_get(local_params->admission, th->comm, XPN_SERVER_ADMISSION_DATA, admit_bytes);
+                 xpn_server_op_readv(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
+        case XPN_SERVER_WRITEV_FILE:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_writev), sizeof(head.u_st_xpn_server_msg.op_writev), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 admit_bytes = head.u_st_xpn_server_msg.op_writev.size;
+                 xpn_server_admission_get(local_params->admission, th->comm, XPN_SERVER_ADMISSION_DATA, admit_bytes);
+                 xpn_server_op_writev(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
         case XPN_SERVER_CLOSE_FILE:
              ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_close), sizeof(head.u_st_xpn_server_msg.op_close), th->rank_client_id, th->tag_client_id);
              if (ret != -1) {
@@ -167,6 +215,30 @@
                  xpn_server_op_rmdir_async(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
              }
              break;
+        case XPN_SERVER_MKDIR_P_DIR:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_mkdir_p), sizeof(head.u_st_xpn_server_msg.op_mkdir_p), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 xpn_server_op_mkdir_p(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
+        case XPN_SERVER_RMTREE_DIR:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_rmtree), sizeof(head.u_st_xpn_server_msg.op_rmtree), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 xpn_server_op_rmtree(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
+        case XPN_SERVER_WALK_DIR:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_walk), sizeof(head.u_st_xpn_server_msg.op_walk), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 xpn_server_op_walk(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
+        case XPN_SERVER_SUMMARIZE_DIR:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_summarize), sizeof(head.u_st_xpn_server_msg.op_summarize), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 xpn_server_op_summarize(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
         case XPN_SERVER_READ_MDATA:
              ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_read_mdata), sizeof(head.u_st_xpn_server_msg.op_read_mdata), th->rank_client_id, th->tag_client_id);
              if (ret != -1) {
@@ -187,6 +259,16 @@
              break;
 
             //Connection API
+        case XPN_SERVER_CODEC:
+             ret = xpn_server_comm_read_data(server_type, th->comm, (char * ) & (head.u_st_xpn_server_msg.op_codec), sizeof(head.u_st_xpn_server_msg.op_codec), th->rank_client_id, th->tag_client_id);
+             if (ret != -1) {
+                 xpn_server_op_codec(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             }
+             break;
+        case XPN_SERVER_LAYOUT:
+             xpn_server_op_layout(th->params, th->comm, & head, th->rank_client_id, th->tag_client_id);
+             break;
+
         case XPN_SERVER_DISCONNECT:
              break;
 
@@ -195,6 +277,10 @@
              break;
         }
 
+        if (admit_bytes >= 0) {
+            xpn_server_admission_put(local_params->admission, th->comm, admit_bytes);
+        }
+
         debug_info("[TH_ID=%d] [XPN_SERVER_OPS] [xpn_server_do_operation] << End\n", th->id);
         return 0;
     }
@@ -218,6 +304,135 @@
         return 0;
     }
 
+    // Clients address data after XPN_HEADER_SIZE; with a metadata index there is no header on disk
+    off_t xpn_server_data_offset ( xpn_server_param_st * params, off_t offset )
+    {
+        if ( (NULL != params->mdata_index) && (offset >= XPN_HEADER_SIZE) ) {
+            return offset - XPN_HEADER_SIZE;
+        }
+
+        return offset;
+    }
+
+    // Data chunks: with a codec each one is a st_xpn_server_zchunk header and the coded bytes
+    int xpn_server_codec ( int codec )
+    {
+        return (XPN_CODEC_LZ4 == codec) ? XPN_CODEC_LZ4 : XPN_CODEC_NONE;
+    }
+
+    ssize_t xpn_server_recv_chunk ( xpn_server_param_st * params, void * comm, int codec, char * buffer, int size, char * zbuffer, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_zchunk zhdr;
+        ssize_t ret;
+
+        if ((XPN_CODEC_NONE == codec) || (size <= 0)) {
+            return xpn_server_comm_read_data(params->server_type, comm, buffer, size, rank_client_id, tag_client_id);
+        }
+
+        ret = xpn_server_comm_read_data(params->server_type, comm, (char * ) & zhdr, sizeof(zhdr), rank_client_id, tag_client_id);
+        if (ret < 0) {
+            return -1;
+        }
+        if ((zhdr.raw_size != size) || (zhdr.wire_size <= 0) || (zhdr.wire_size > size)) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_recv_chunk] ERROR: wrong chunk header (%d, %d) for %d bytes\n", params->rank, zhdr.raw_size, zhdr.wire_size, size);
+            return -1;
+        }
+
+        // sent raw
+        if (zhdr.wire_size == size) {
+            return xpn_server_comm_read_data(params->server_type, comm, buffer, size, rank_client_id, tag_client_id);
+        }
+
+        ret = xpn_server_comm_read_data(params->server_type, comm, zbuffer, zhdr.wire_size, rank_client_id, tag_client_id);
+        if (ret < 0) {
+            return -1;
+        }
+        if (lz4_codec_decompress(zbuffer, zhdr.wire_size, buffer, size) != size) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_recv_chunk] ERROR: corrupted chunk of %d bytes\n", params->rank, size);
+            return -1;
+        }
+
+        return size;
+    }
+
+    // read reply: rw_req header and, if any, the data of the chunk
+    ssize_t xpn_server_send_chunk ( xpn_server_param_st * params, void * comm, int codec, struct st_xpn_server_rw_req * req, char * buffer, char * zbuffer, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_zchunk zhdr;
+        struct iovec iov[3];
+        int n = 0;
+
+        iov[n].iov_base = (char * ) req;
+        iov[n].iov_len  = sizeof(struct st_xpn_server_rw_req);
+        n++;
+
+        if ((req->size > 0) && (XPN_CODEC_NONE != codec))
+        {
+            zhdr.raw_size  = req->size;
+            zhdr.wire_size = -1;
+            if (req->size >= XPN_CODEC_MIN_SIZE) {
+                zhdr.wire_size = lz4_codec_compress(buffer, req->size, zbuffer, XPN_CODEC_MAX_WIRE(req->size));
+            }
+
+            iov[n].iov_base = (char * ) & zhdr;
+            iov[n].iov_len  = sizeof(zhdr);
+            n++;
+
+            // not worth it: send raw
+            if (zhdr.wire_size < 0) {
+                zhdr.wire_size = zhdr.raw_size;
+            }
+            else {
+                buffer = zbuffer;
+            }
+
+            iov[n].iov_base = buffer;
+            iov[n].iov_len  = zhdr.wire_size;
+            n++;
+        }
+        else if (req->size > 0)
+        {
+            iov[n].iov_base = buffer;
+            iov[n].iov_len  = req->size;
+            n++;
+        }
+
+        return xpn_server_comm_write_datav(params->server_type, comm, iov, n, rank_client_id, tag_client_id);
+    }
+
+    // Connection API
+    void xpn_server_op_codec ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_status status;
+
+        // accept the proposed codec if it is known, or none
+        status.ret = xpn_server_codec(head->u_st_xpn_server_msg.op_codec.codec);
+        status.server_errno = 0;
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_codec] codec(%d)=%d\n", params->rank, head->u_st_xpn_server_msg.op_codec.codec, status.ret);
+
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & status, sizeof(struct st_xpn_server_status), rank_client_id, tag_client_id);
+    }
+
+    void xpn_server_op_layout ( xpn_server_param_st * params, void * comm, __attribute__((__unused__)) struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_status status;
+
+        // what a client on this node has to know before it uses the data files directly
+        status.ret = 0;
+        if (NULL != params->mdata_index) {
+            status.ret |= XPN_SERVER_LAYOUT_INDEX;
+        }
+        if (NULL != params->wlog) {
+            status.ret |= XPN_SERVER_LAYOUT_WLOG;
+        }
+        status.server_errno = 0;
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_layout] layout=%d\n", params->rank, status.ret);
+
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & status, sizeof(struct st_xpn_server_status), rank_client_id, tag_client_id);
+    }
+
     // File API
     void xpn_server_op_open ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
@@ -238,6 +453,11 @@
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_open] >> Begin - open(%s, %d, %d)\n", params->rank, full_path, head->u_st_xpn_server_msg.op_open.flags, head->u_st_xpn_server_msg.op_open.mode);
 
+        // the data logged before the truncation must not come back on top of the new data
+        if (head->u_st_xpn_server_msg.op_open.flags & O_TRUNC) {
+            xpn_server_wlog_discard(params->wlog, full_path, 0);
+        }
+
         errno = 0;
         status.ret = filesystem_open2(full_path, head->u_st_xpn_server_msg.op_open.flags, head->u_st_xpn_server_msg.op_open.mode);
         status.server_errno = errno;
@@ -281,6 +501,9 @@ cleanup_xpn_server_op_open:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_creat] >> Begin - creat(%s)\n", params->rank, full_path);
 
+        // creat truncates an existing file, the same as open with O_TRUNC
+        xpn_server_wlog_discard(params->wlog, full_path, 0);
+
         errno = 0;
         status.ret = filesystem_creat(full_path, head->u_st_xpn_server_msg.op_creat.mode);
         status.server_errno = errno;
@@ -308,10 +531,11 @@ cleanup_xpn_server_op_creat:
     void xpn_server_op_read ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         struct st_xpn_server_rw_req req;
-        char * buffer = NULL;
+        char * buffer  = NULL;
+        char * zbuffer = NULL;
         long size, diff, to_read, cont;
         off_t ret_lseek;
-        int fd;
+        int fd, codec;
 
         // check params...
         if ( (NULL == head) || (NULL == params) ) {
@@ -350,8 +574,12 @@ cleanup_xpn_server_op_creat:
         }
 
         // malloc a buffer of size...
+        codec  = xpn_server_codec(head->u_st_xpn_server_msg.op_read.codec);
         buffer = (char * ) malloc(size);
-        if (NULL == buffer) {
+        if ((NULL != buffer) && (XPN_CODEC_NONE != codec)) {
+            zbuffer = (char * ) malloc(LZ4_CODEC_BOUND(size));
+        }
+        if ((NULL == buffer) || ((XPN_CODEC_NONE != codec) && (NULL == zbuffer))) {
             req.size = -1;
             req.status.ret = -1;
             req.status.server_errno = errno;
@@ -366,17 +594,24 @@ cleanup_xpn_server_op_creat:
                  to_read = size;
             else to_read = diff;
 
-            // lseek and read data...
-            ret_lseek = filesystem_lseek(fd, head->u_st_xpn_server_msg.op_read.offset + cont, SEEK_SET);
-            if (ret_lseek == -1) {
-                req.size = -1;
-                req.status.ret = -1;
-                req.status.server_errno = errno;
-                xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
-                goto cleanup_xpn_server_op_read;
+            // the data written to the log is read through its index
+            if (NULL != params->wlog) {
+                req.size = xpn_server_wlog_read(params->wlog, full_path, fd, xpn_server_data_offset(params, head->u_st_xpn_server_msg.op_read.offset) + cont, buffer, to_read);
+            }
+            else
+            {
+                // lseek and read data...
+                ret_lseek = filesystem_lseek(fd, xpn_server_data_offset(params, head->u_st_xpn_server_msg.op_read.offset) + cont, SEEK_SET);
+                if (ret_lseek == -1) {
+                    req.size = -1;
+                    req.status.ret = -1;
+                    req.status.server_errno = errno;
+                    xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+                    goto cleanup_xpn_server_op_read;
+                }
+
+                req.size = filesystem_read(fd, buffer, to_read);
             }
-
-            req.size = filesystem_read(fd, buffer, to_read);
             // if error then send as "how many bytes" -1
             if (req.size < 0 || req.status.ret == -1) {
                 req.size = -1;
@@ -388,14 +623,8 @@ cleanup_xpn_server_op_creat:
             // send (how many + data) to client...
             req.status.ret = 0;
             req.status.server_errno = errno;
-            xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
-            debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_read] op_read: send size %ld\n", params->rank, req.size);
-
-            // send data to client...
-            if (req.size > 0) {
-                xpn_server_comm_write_data(params->server_type, comm, buffer, req.size, rank_client_id, tag_client_id);
-                debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_read] op_read: send data\n", params->rank);
-            }
+            xpn_server_send_chunk(params, comm, codec, & req, buffer, zbuffer, rank_client_id, tag_client_id);
+            debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_read] op_read: send size %ld and data\n", params->rank, req.size);
             cont = cont + req.size; //Send bytes
             diff = head->u_st_xpn_server_msg.op_read.size - cont;
 
@@ -408,6 +637,7 @@ cleanup_xpn_server_op_read:
 
         // free buffer
         FREE_AND_NULL(buffer);
+        FREE_AND_NULL(zbuffer);
 
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_read] << End - read(%s, %ld %ld)=%ld\n", params->rank, full_path, head->u_st_xpn_server_msg.op_read.offset, head->u_st_xpn_server_msg.op_read.size, cont);
     }
@@ -415,10 +645,12 @@ cleanup_xpn_server_op_read:
     void xpn_server_op_write ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         struct st_xpn_server_rw_req req;
-        char * buffer = NULL;
+        struct xpn_server_coalesce_file * cfile = NULL;
+        char * buffer  = NULL;
+        char * zbuffer = NULL;
         int size, diff, cont, to_write;
         off_t ret_lseek;
-        int fd, ret;
+        int fd, ret, codec, written = 0, leader = 1;
 
         // check params...
         if ( (NULL == head) || (NULL == params) ) {
@@ -460,13 +692,22 @@ cleanup_xpn_server_op_read:
         }
 
         // malloc a buffer of size...
+        codec  = xpn_server_codec(head->u_st_xpn_server_msg.op_write.codec);
         buffer = (char * ) malloc(size);
-        if (NULL == buffer) {
+        if ((NULL != buffer) && (XPN_CODEC_NONE != codec)) {
+            zbuffer = (char * ) malloc(LZ4_CODEC_BOUND(size));
+        }
+        if ((NULL == buffer) || ((XPN_CODEC_NONE != codec) && (NULL == zbuffer))) {
             req.size = -1;
             req.status.ret = -1;
             goto cleanup_xpn_server_op_write;
         }
 
+        // a small write may go together with the ones of other clients to this file (the log is sequential already)
+        if ((NULL != params->coalesce) && (NULL == params->wlog) && (diff > 0) && (diff <= params->coalesce->max_size)) {
+            cfile = xpn_server_coalesce_begin(params->coalesce, full_path, comm);
+        }
+
         // loop...
         do
         {
@@ -475,18 +716,39 @@ cleanup_xpn_server_op_read:
             else to_write = diff;
 
             // read data from MPI and write into the file
-            ret = xpn_server_comm_read_data(params->server_type, comm, buffer, to_write, rank_client_id, tag_client_id);
+            ret = xpn_server_recv_chunk(params, comm, codec, buffer, to_write, zbuffer, rank_client_id, tag_client_id);
             if (ret < 0) {
                 req.status.ret = -1;
                 goto cleanup_xpn_server_op_write;
             }
 
-            ret_lseek = filesystem_lseek(fd, head->u_st_xpn_server_msg.op_write.offset + cont, SEEK_SET);
-            if (ret_lseek < 0) {
-                req.status.ret = -1;
-                goto cleanup_xpn_server_op_write;
+            if (NULL != cfile)
+            {
+                written  = 1;
+                req.size = xpn_server_coalesce_write(params->coalesce, cfile, fd, xpn_server_data_offset(params, head->u_st_xpn_server_msg.op_write.offset) + cont, buffer, to_write, &leader);
+                if (req.size < 0) {
+                    req.status.ret = -1;
+                    goto cleanup_xpn_server_op_write;
+                }
+
+                cont = cont + req.size;
+                diff = head->u_st_xpn_server_msg.op_write.size - cont;
+                continue;
+            }
+
+            if (NULL != params->wlog)
+            {
+                req.size = xpn_server_wlog_write(params->wlog, full_path, xpn_server_data_offset(params, head->u_st_xpn_server_msg.op_write.offset) + cont, buffer, to_write);
+            }
+            else
+            {
+                ret_lseek = filesystem_lseek(fd, xpn_server_data_offset(params, head->u_st_xpn_server_msg.op_write.offset) + cont, SEEK_SET);
+                if (ret_lseek < 0) {
+                    req.status.ret = -1;
+                    goto cleanup_xpn_server_op_write;
+                }
+                req.size = filesystem_write(fd, buffer, to_write);
             }
-            req.size = filesystem_write(fd, buffer, to_write);
             
             if (req.size < 0) {
                 req.status.ret = -1;
@@ -505,18 +767,321 @@ cleanup_xpn_server_op_write:
         // write to the client the status of the write operation
         req.status.server_errno = errno;
 
+        xpn_server_coalesce_end(params->coalesce, cfile, written);
+
         xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
 
-        if (head->u_st_xpn_server_msg.op_write.xpn_session == 1)
+        // a coalesced write is synced by the leader of its batch, a logged one with its log
+        if (head->u_st_xpn_server_msg.op_write.xpn_session == 0)
+             filesystem_close(fd);
+        else if (NULL != params->wlog)
+             xpn_server_wlog_sync(params->wlog, full_path);
+        else if (leader)
              filesystem_fsync(fd);
-        else filesystem_close(fd);
 
         // free buffer
         FREE_AND_NULL(buffer);
+        FREE_AND_NULL(zbuffer);
 
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_write] << End - write(%s, %ld %ld)=%d\n", params->rank, full_path, head->u_st_xpn_server_msg.op_write.offset, head->u_st_xpn_server_msg.op_write.size, cont);
     }
 
+    struct st_xpn_server_extent * xpn_server_read_extents ( xpn_server_param_st * params, void * comm, int n_extents, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_extent * extents;
+        int ret;
+
+        if (n_extents <= 0) {
+            return NULL;
+        }
+
+        extents = (struct st_xpn_server_extent * ) malloc(n_extents * sizeof(struct st_xpn_server_extent));
+        if (NULL == extents) {
+            return NULL;
+        }
+
+        ret = xpn_server_comm_read_data(params->server_type, comm, (char * ) extents, n_extents * sizeof(struct st_xpn_server_extent), rank_client_id, tag_client_id);
+        if (ret < 0) {
+            FREE_AND_NULL(extents);
+        }
+
+        return extents;
+    }
+
+    void xpn_server_op_readv ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_rw_req req;
+        struct st_xpn_server_extent * extents = NULL;
+        char * buffer  = NULL;
+        char * zbuffer = NULL;
+        long size, diff, to_read, cont, total;
+        off_t ret_lseek;
+        int fd, i, codec;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_readv] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path and extents
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_readv.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_readv.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        extents = xpn_server_read_extents(params, comm, head->u_st_xpn_server_msg.op_readv.n_extents, rank_client_id, tag_client_id);
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_readv] >> Begin - readv(%s, %d extents, %ld)\n", params->rank, full_path, head->u_st_xpn_server_msg.op_readv.n_extents, head->u_st_xpn_server_msg.op_readv.size);
+
+        total = 0;
+        fd = -1;
+        memset(&req, 0, sizeof(struct st_xpn_server_rw_req));
+
+        if (NULL == extents) {
+            req.size = -1;
+            req.status.ret = -1;
+            req.status.server_errno = ENOMEM;
+            xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+            goto cleanup_xpn_server_op_readv;
+        }
+
+        // open file
+        errno = 0;
+        if (head->u_st_xpn_server_msg.op_readv.xpn_session == 1)
+             fd = head->u_st_xpn_server_msg.op_readv.fd;
+        else fd = filesystem_open(full_path, O_RDONLY);
+        if (fd < 0) {
+            req.size = -1;
+            req.status.ret = fd;
+            req.status.server_errno = errno;
+            xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+            goto cleanup_xpn_server_op_readv;
+        }
+
+        // malloc a buffer of size...
+        size = head->u_st_xpn_server_msg.op_readv.size;
+        if (size > MAX_BUFFER_SIZE) {
+            size = MAX_BUFFER_SIZE;
+        }
+        if (size <= 0) {
+            size = 1;
+        }
+
+        codec  = xpn_server_codec(head->u_st_xpn_server_msg.op_readv.codec);
+        buffer = (char * ) malloc(size);
+        if ((NULL != buffer) && (XPN_CODEC_NONE != codec)) {
+            zbuffer = (char * ) malloc(LZ4_CODEC_BOUND(size));
+        }
+        if ((NULL == buffer) || ((XPN_CODEC_NONE != codec) && (NULL == zbuffer))) {
+            req.size = -1;
+            req.status.ret = -1;
+            req.status.server_errno = errno;
+            xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+            goto cleanup_xpn_server_op_readv;
+        }
+
+        // each extent as a read: n times (how many + data), and (0) at the end of file
+        for (i = 0; i < head->u_st_xpn_server_msg.op_readv.n_extents; i++)
+        {
+            cont = 0;
+            diff = extents[i].size;
+
+            while (diff > 0)
+            {
+                if (diff > size)
+                     to_read = size;
+                else to_read = diff;
+
+                // lseek and read data (through the index of the log if any)...
+                if (NULL != params->wlog) {
+                    req.size = xpn_server_wlog_read(params->wlog, full_path, fd, xpn_server_data_offset(params, extents[i].offset) + cont, buffer, to_read);
+                }
+                else
+                {
+                    ret_lseek = filesystem_lseek(fd, xpn_server_data_offset(params, extents[i].offset) + cont, SEEK_SET);
+                    if (ret_lseek == -1) {
+                        req.size = -1;
+                    }
+                    else {
+                        req.size = filesystem_read(fd, buffer, to_read);
+                    }
+                }
+
+                // if error then send as "how many bytes" -1 and stop
+                if (req.size < 0) {
+                    req.size = -1;
+                    req.status.ret = -1;
+                    req.status.server_errno = errno;
+                    xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+                    goto cleanup_xpn_server_op_readv;
+                }
+
+                // send (how many + data) to client...
+                req.status.ret = 0;
+                req.status.server_errno = errno;
+                xpn_server_send_chunk(params, comm, codec, & req, buffer, zbuffer, rank_client_id, tag_client_id);
+
+                if (req.size == 0) {
+                    break;
+                }
+
+                cont  = cont + req.size;
+                total = total + req.size;
+                diff  = extents[i].size - cont;
+            }
+        }
+
+cleanup_xpn_server_op_readv:
+        if ((head->u_st_xpn_server_msg.op_readv.xpn_session == 0) && (fd >= 0)) {
+            filesystem_close(fd);
+        }
+
+        // free buffers
+        FREE_AND_NULL(buffer);
+        FREE_AND_NULL(zbuffer);
+        FREE_AND_NULL(extents);
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_readv] << End - readv(%s, %d extents, %ld)=%ld\n", params->rank, full_path, head->u_st_xpn_server_msg.op_readv.n_extents, head->u_st_xpn_server_msg.op_readv.size, total);
+    }
+
+    void xpn_server_op_writev ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_rw_req req;
+        struct st_xpn_server_extent * extents = NULL;
+        char * buffer  = NULL;
+        char * zbuffer = NULL;
+        long size, diff, to_write, cont, total;
+        ssize_t ret;
+        int fd, i, err, codec;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_writev] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path and extents
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_writev.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_writev.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        extents = xpn_server_read_extents(params, comm, head->u_st_xpn_server_msg.op_writev.n_extents, rank_client_id, tag_client_id);
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_writev] >> Begin - writev(%s, %d extents, %ld)\n", params->rank, full_path, head->u_st_xpn_server_msg.op_writev.n_extents, head->u_st_xpn_server_msg.op_writev.size);
+
+        total = 0;
+        err = 0;
+        memset(&req, 0, sizeof(struct st_xpn_server_rw_req));
+
+        // open file
+        errno = 0;
+        if (head->u_st_xpn_server_msg.op_writev.xpn_session == 1)
+             fd = head->u_st_xpn_server_msg.op_writev.fd;
+        else fd = filesystem_open(full_path, O_WRONLY);
+        if (fd < 0) {
+            err = errno;
+        }
+
+        // malloc a buffer of size...
+        size = head->u_st_xpn_server_msg.op_writev.size;
+        if (size > MAX_BUFFER_SIZE) {
+            size = MAX_BUFFER_SIZE;
+        }
+        if (size <= 0) {
+            size = 1;
+        }
+
+        codec  = xpn_server_codec(head->u_st_xpn_server_msg.op_writev.codec);
+        buffer = (char * ) malloc(size);
+        if ((NULL != buffer) && (XPN_CODEC_NONE != codec)) {
+            zbuffer = (char * ) malloc(LZ4_CODEC_BOUND(size));
+        }
+        if ((NULL == buffer) || (NULL == extents) || ((XPN_CODEC_NONE != codec) && (NULL == zbuffer))) {
+            // the data cannot be drained without them
+            req.size = -1;
+            req.status.ret = -1;
+            req.status.server_errno = ENOMEM;
+            goto cleanup_xpn_server_op_writev;
+        }
+
+        // the data of all the extents follows, it is always received to keep the connection in sync
+        for (i = 0; i < head->u_st_xpn_server_msg.op_writev.n_extents; i++)
+        {
+            cont = 0;
+            diff = extents[i].size;
+
+            while (diff > 0)
+            {
+                if (diff > size)
+                     to_write = size;
+                else to_write = diff;
+
+                ret = xpn_server_recv_chunk(params, comm, codec, buffer, to_write, zbuffer, rank_client_id, tag_client_id);
+                if (ret < 0) {
+                    req.size = -1;
+                    req.status.ret = -1;
+                    req.status.server_errno = errno;
+                    goto cleanup_xpn_server_op_writev;
+                }
+
+                if (0 == err)
+                {
+                    ret = -1;
+                    if (NULL != params->wlog) {
+                        ret = xpn_server_wlog_write(params->wlog, full_path, xpn_server_data_offset(params, extents[i].offset) + cont, buffer, to_write);
+                    }
+                    else if (filesystem_lseek(fd, xpn_server_data_offset(params, extents[i].offset) + cont, SEEK_SET) >= 0) {
+                        ret = filesystem_write(fd, buffer, to_write);
+                    }
+                    if (ret < 0) {
+                        err = errno;
+                    }
+                    else {
+                        total = total + ret;
+                    }
+                }
+
+                cont = cont + to_write;
+                diff = extents[i].size - cont;
+            }
+        }
+
+        if (0 != err) {
+            req.size = -1;
+            req.status.ret = -1;
+            req.status.server_errno = err;
+        }
+        else {
+            req.size = total;
+            req.status.ret = 0;
+            req.status.server_errno = 0;
+        }
+
+cleanup_xpn_server_op_writev:
+        // write to the client the status of the write operation
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_rw_req), rank_client_id, tag_client_id);
+
+        if (fd >= 0)
+        {
+            if (head->u_st_xpn_server_msg.op_writev.xpn_session == 0)
+                 filesystem_close(fd);
+            else if (NULL != params->wlog)
+                 xpn_server_wlog_sync(params->wlog, full_path);
+            else filesystem_fsync(fd);
+        }
+
+        // free buffers
+        FREE_AND_NULL(buffer);
+        FREE_AND_NULL(zbuffer);
+        FREE_AND_NULL(extents);
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_writev] << End - writev(%s, %d extents, %ld)=%ld\n", params->rank, full_path, head->u_st_xpn_server_msg.op_writev.n_extents, head->u_st_xpn_server_msg.op_writev.size, total);
+    }
+
     void xpn_server_op_close ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         struct st_xpn_server_status status;
@@ -540,6 +1105,9 @@ cleanup_xpn_server_op_write:
         status.ret = filesystem_close(head->u_st_xpn_server_msg.op_close.fd);
         status.server_errno = errno;
 
+        // the log of the file goes to the data file in background
+        xpn_server_wlog_flush(params->wlog, full_path);
+
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_close] << End - close(%d)=%d\n", params->rank, head->u_st_xpn_server_msg.op_close.fd, status.ret);
 
         // send back the status
@@ -570,10 +1138,16 @@ cleanup_xpn_server_op_write:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rm] >> Begin - unlink(%s)\n", params->rank, full_path);
 
+        xpn_server_wlog_discard(params->wlog, full_path, 0);
+
         errno = 0;
         status.ret = filesystem_unlink(full_path);
         status.server_errno = errno;
 
+        if ( (NULL != params->mdata_index) && (status.ret == 0) ) {
+            kv_index_del(params->mdata_index, full_path);
+        }
+
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rm] << End - unlink(%s)=%d\n", params->rank, full_path, status.ret);
 
         // send back the status
@@ -597,7 +1171,11 @@ cleanup_xpn_server_op_write:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rm_async] >> Begin - unlink(%s)\n", params->rank, head->u_st_xpn_server_msg.op_rm.path);
 
-        filesystem_unlink(full_path);
+        xpn_server_wlog_discard(params->wlog, full_path, 0);
+
+        if ( (filesystem_unlink(full_path) == 0) && (NULL != params->mdata_index) ) {
+            kv_index_del(params->mdata_index, full_path);
+        }
 
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rm_async] << End - unlink(%s)=%d\n", params->rank, head->u_st_xpn_server_msg.op_rm.path, 0);
     }
@@ -626,10 +1204,18 @@ cleanup_xpn_server_op_write:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rename] >> Begin - rename(%s, %s)\n", params->rank, full_path_old, full_path_new);
 
+        // the logs are kept by path: the data goes to the data files before
+        xpn_server_wlog_compact(params->wlog, full_path_old, 1);
+
         errno = 0;
         status.ret = filesystem_rename(full_path_old, full_path_new);
         status.server_errno = errno;
 
+        // move the metadata of the file, or of everything below the directory
+        if ( (NULL != params->mdata_index) && (status.ret == 0) ) {
+            kv_index_rename(params->mdata_index, full_path_old, full_path_new);
+        }
+
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rename] << End - rename(%s, %s)=%d\n", params->rank, full_path_old, full_path_new, status.ret);
 
         // send back the status
@@ -655,9 +1241,17 @@ cleanup_xpn_server_op_write:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_getattr] >> Begin - stat(%s)\n", params->rank, full_path);
 
+        // the size of a data file with a log is the one after compaction
+        xpn_server_wlog_compact(params->wlog, full_path, 0);
+
         errno = 0;
         req.status = filesystem_stat(full_path, &(req.attr)) ;
         req.status_req.server_errno = errno;
+
+        // report the size as if the data were after the header
+        if ( (NULL != params->mdata_index) && (req.status == 0) && S_ISREG(req.attr.st_mode) && (req.attr.st_size > 0) ) {
+            req.attr.st_size += XPN_HEADER_SIZE;
+        }
         req.status_req.ret          = req.status;
 
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_getattr] << End - stat(%s)=%d\n", params->rank, head->u_st_xpn_server_msg.op_getattr.path, req.status);
@@ -905,9 +1499,314 @@ cleanup_xpn_server_op_write:
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rmdir_async] << End - rmdir(%s)=%d\n", params->rank, head->u_st_xpn_server_msg.op_rmdir.path, 0);
     }
 
+    void xpn_server_op_mkdir_p ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_status status;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_mkdir_p] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_mkdir_p.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_mkdir_p.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_mkdir_p] >> Begin - mkdir_p(%s)\n", params->rank, full_path);
+
+        errno = 0;
+        status.ret = filesystem_mkdir_p(full_path, head->u_st_xpn_server_msg.op_mkdir_p.mode);
+        status.server_errno = errno;
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_mkdir_p] << End - mkdir_p(%s)=%d\n", params->rank, full_path, status.ret);
+
+        // send back the status
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & status, sizeof(struct st_xpn_server_status), rank_client_id, tag_client_id);
+    }
+
+    void xpn_server_op_rmtree ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct st_xpn_server_status status;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rmtree] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_rmtree.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_rmtree.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rmtree] >> Begin - rmtree(%s)\n", params->rank, full_path);
+
+        xpn_server_wlog_discard(params->wlog, full_path, 1);
+
+        errno = 0;
+        status.ret = filesystem_rmtree(full_path);
+        status.server_errno = errno;
+
+        if ( (NULL != params->mdata_index) && (status.ret == 0) ) {
+            kv_index_del_prefix(params->mdata_index, full_path);
+        }
+
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_rmtree] << End - rmtree(%s)=%d\n", params->rank, full_path, status.ret);
+
+        // send back the status
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & status, sizeof(struct st_xpn_server_status), rank_client_id, tag_client_id);
+    }
+
+    struct xpn_server_walk_batch
+    {
+        xpn_server_param_st * params;
+        void * comm;
+        int    rank_client_id;
+        int    tag_client_id;
+
+        struct st_xpn_server_walk * op_walk;
+        struct st_xpn_server_walk_req req;
+        char   buffer[XPN_SERVER_WALK_BUFFER_SIZE];
+    };
+
+    int xpn_server_walk_flush ( struct xpn_server_walk_batch * batch )
+    {
+        ssize_t ret;
+
+        ret = xpn_server_comm_write_data(batch->params->server_type, batch->comm, (char * ) & (batch->req), sizeof(struct st_xpn_server_walk_req), batch->rank_client_id, batch->tag_client_id);
+        if ((ret >= 0) && (batch->req.size > 0)) {
+            ret = xpn_server_comm_write_data(batch->params->server_type, batch->comm, batch->buffer, batch->req.size, batch->rank_client_id, batch->tag_client_id);
+        }
+
+        batch->req.n_entries = 0;
+        batch->req.size      = 0;
+
+        return (ret < 0) ? -1 : 0;
+    }
+
+    int xpn_server_walk_entry ( char * path, int is_dir, int depth, void * arg )
+    {
+        struct xpn_server_walk_batch * batch = (struct xpn_server_walk_batch *) arg;
+        struct st_xpn_server_walk_entry entry;
+        int master;
+
+        // only the master of the parent directory reports an entry (as readdir does)
+        if (batch->op_walk->n_serv > 0)
+        {
+            master = (0 == depth) ? batch->op_walk->root_master : hash(path, batch->op_walk->n_serv, 0);
+            if (master != batch->op_walk->serv_id) {
+                return 0;
+            }
+        }
+
+        entry.type     = is_dir ? XPN_SERVER_WALK_DIR_ENTRY : XPN_SERVER_WALK_FILE;
+        entry.depth    = depth;
+        entry.path_len = strlen(path);
+
+        if ((size_t)batch->req.size + sizeof(entry) + entry.path_len > XPN_SERVER_WALK_BUFFER_SIZE)
+        {
+            if (xpn_server_walk_flush(batch) < 0) {
+                return -1;
+            }
+        }
+
+        memcpy(batch->buffer + batch->req.size, &entry, sizeof(entry));
+        memcpy(batch->buffer + batch->req.size + sizeof(entry), path, entry.path_len);
+        batch->req.size += sizeof(entry) + entry.path_len;
+        batch->req.n_entries++;
+
+        return 0;
+    }
+
+    void xpn_server_op_walk ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct xpn_server_walk_batch * batch;
+        struct st_xpn_server_walk_req  end;
+        int ret;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_walk] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_walk.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_walk.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_walk] >> Begin - walk(%s)\n", params->rank, full_path);
+
+        memset(&end, 0, sizeof(struct st_xpn_server_walk_req));
+
+        batch = (struct xpn_server_walk_batch *) malloc(sizeof(struct xpn_server_walk_batch));
+        if (NULL == batch)
+        {
+            end.status.ret = -1;
+            end.status.server_errno = ENOMEM;
+            goto cleanup_xpn_server_op_walk;
+        }
+
+        batch->params         = params;
+        batch->comm           = comm;
+        batch->rank_client_id = rank_client_id;
+        batch->tag_client_id  = tag_client_id;
+        batch->op_walk        = &(head->u_st_xpn_server_msg.op_walk);
+        batch->req.n_entries  = 0;
+        batch->req.size       = 0;
+        batch->req.status.ret = 0;
+        batch->req.status.server_errno = 0;
+
+        // stream the entries in batches while walking the local subtree
+        errno = 0;
+        ret = filesystem_walk(full_path, xpn_server_walk_entry, batch);
+        end.status.ret = ret;
+        end.status.server_errno = errno;
+
+        if ((batch->req.n_entries > 0) && (xpn_server_walk_flush(batch) < 0)) {
+            end.status.ret = -1;
+        }
+
+        free(batch);
+
+cleanup_xpn_server_op_walk:
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_walk] << End - walk(%s)=%d\n", params->rank, full_path, end.status.ret);
+
+        // send back the end of the walk
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & end, sizeof(struct st_xpn_server_walk_req), rank_client_id, tag_client_id);
+    }
+
+    struct xpn_server_summarize_arg
+    {
+        xpn_server_param_st * params;
+        struct st_xpn_server_walk * op_summarize;
+        char   root_path[PATH_MAX];
+        struct st_xpn_server_summarize_req req;
+    };
+
+    int xpn_server_summarize_entry ( char * path, int is_dir, int depth, void * arg )
+    {
+        struct xpn_server_summarize_arg * sum = (struct xpn_server_summarize_arg *) arg;
+        struct xpn_metadata mdata;
+        struct stat st;
+        char   full_path[PATH_MAX];
+        int    master, fd;
+
+        if (is_dir)
+        {
+            // a directory is counted by the master of its parent (as readdir does)
+            master = (0 == depth) ? sum->op_summarize->root_master : hash(path, sum->op_summarize->n_serv, 0);
+            if ((sum->op_summarize->n_serv == 0) || (master == sum->op_summarize->serv_id)) {
+                sum->req.dirs++;
+            }
+            return 0;
+        }
+
+        // a file is counted by its master node, that has the metadata with the logical size
+        if ((sum->op_summarize->n_serv > 0) && (hash(path, sum->op_summarize->n_serv, 1) != sum->op_summarize->serv_id)) {
+            return 0;
+        }
+
+        if (snprintf(full_path, PATH_MAX, "%s/%s", sum->root_path, path) >= PATH_MAX)
+        {
+            debug_error("[Server=%d] [XPN_SERVER_OPS] [xpn_server_summarize_entry] ERROR: path too long, '%s' skipped\n", sum->params->rank, path);
+            return 0;
+        }
+        sum->req.files++;
+
+        memset(&mdata, 0, sizeof(struct xpn_metadata));
+        if (NULL != sum->params->mdata_index)
+        {
+            kv_index_get(sum->params->mdata_index, full_path, & mdata);
+        }
+        else
+        {
+            fd = filesystem_open(full_path, O_RDONLY);
+            if (fd >= 0) {
+                filesystem_read(fd, & mdata, sizeof(struct xpn_metadata));
+                filesystem_close(fd);
+            }
+        }
+
+        if (XPN_CHECK_MAGIC_NUMBER(& mdata)) {
+            sum->req.bytes += mdata.file_size;
+        }
+        else if (filesystem_stat(full_path, & st) == 0) {
+            // not an Expand file (or empty one): its local size
+            sum->req.bytes += st.st_size;
+        }
+
+        return 0;
+    }
+
+    void xpn_server_op_summarize ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
+    {
+        struct xpn_server_summarize_arg * sum;
+        struct st_xpn_server_summarize_req req;
+
+        // check params...
+        if ( (NULL == head) || (NULL == params) ) {
+            printf("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_summarize] ERROR: NULL arguments\n", -1);
+            return;
+        }
+
+        // read full-path
+        char  full_path[PATH_MAX];
+        int   path_len = head->u_st_xpn_server_msg.op_summarize.path_len;
+        char *path_msg = head->u_st_xpn_server_msg.op_summarize.path ;
+        xpn_server_read_path(params->server_type, comm, full_path, PATH_MAX, path_msg, path_len, rank_client_id, tag_client_id) ;
+
+        // do operation
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_summarize] >> Begin - summarize(%s)\n", params->rank, full_path);
+
+        memset(&req, 0, sizeof(struct st_xpn_server_summarize_req));
+
+        sum = (struct xpn_server_summarize_arg *) malloc(sizeof(struct xpn_server_summarize_arg));
+        if (NULL == sum)
+        {
+            req.status.ret = -1;
+            req.status.server_errno = ENOMEM;
+            goto cleanup_xpn_server_op_summarize;
+        }
+
+        memset(sum, 0, sizeof(struct xpn_server_summarize_arg));
+        sum->params       = params;
+        sum->op_summarize = &(head->u_st_xpn_server_msg.op_summarize);
+        strcpy(sum->root_path, full_path);
+        path_len = strlen(sum->root_path);
+        while ((path_len > 1) && ('/' == sum->root_path[path_len - 1])) {
+            sum->root_path[--path_len] = '\0';
+        }
+
+        // only the totals go back, the entries never leave the server
+        errno = 0;
+        req.status.ret = filesystem_walk(full_path, xpn_server_summarize_entry, sum);
+        req.status.server_errno = errno;
+        req.bytes = sum->req.bytes;
+        req.files = sum->req.files;
+        req.dirs  = sum->req.dirs;
+
+        free(sum);
+
+cleanup_xpn_server_op_summarize:
+        debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_summarize] << End - summarize(%s)=%d\n", params->rank, full_path, req.status.ret);
+
+        // send back the partial summary
+        xpn_server_comm_write_data(params->server_type, comm, (char * ) & req, sizeof(struct st_xpn_server_summarize_req), rank_client_id, tag_client_id);
+    }
+
     void xpn_server_op_read_mdata ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         int  fd;
+        struct stat st;
         struct st_xpn_server_read_mdata_req req = { 0 };
 
         // check params...
@@ -926,6 +1825,20 @@ cleanup_xpn_server_op_write:
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_read_mdata] >> Begin - read_mdata(%s)\n", params->rank, full_path);
 
 	errno = 0;
+        if (NULL != params->mdata_index)
+        {
+            if (kv_index_get(params->mdata_index, full_path, & req.mdata) == 0) {
+                req.status.ret = sizeof(struct xpn_metadata);
+                goto cleanup_xpn_server_op_read_mdata;
+            }
+
+            // without entry it is like an empty file (or a directory): no metadata
+            errno = 0;
+            memset( &(req.mdata), 0, sizeof(struct xpn_metadata) );
+            req.status.ret = filesystem_stat(full_path, & st);
+            goto cleanup_xpn_server_op_read_mdata;
+        }
+
         fd = filesystem_open(full_path, O_RDWR);
         if (fd < 0)
         {
@@ -960,6 +1873,7 @@ cleanup_xpn_server_op_read_mdata:
     void xpn_server_op_write_mdata ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         int  fd;
+        struct xpn_metadata mdata;
         struct st_xpn_server_status req;
 
         // check params...
@@ -978,7 +1892,24 @@ cleanup_xpn_server_op_read_mdata:
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_write_mdata] >> Begin - write_mdata(%s)\n", params->rank, full_path);
 
 	errno = 0;
+        if ( (NULL != params->mdata_index) && (kv_index_get(params->mdata_index, full_path, & mdata) == 0) )
+        {
+            // already indexed, so the file exists: update only the index
+            req.ret = kv_index_put(params->mdata_index, full_path, & head->u_st_xpn_server_msg.op_write_mdata.mdata);
+            if (req.ret == 0) {
+                req.ret = sizeof(struct xpn_metadata);
+            }
+            goto cleanup_xpn_server_op_write_mdata;
+        }
+        errno = 0;
+
         fd = filesystem_open2(full_path, O_WRONLY | O_CREAT, S_IRWXU);
+        if ((fd < 0) && (errno == ENOENT))
+        {
+            // directories are created lazily out of their master servers
+            filesystem_mkpath(full_path);
+            fd = filesystem_open2(full_path, O_WRONLY | O_CREAT, S_IRWXU);
+        }
         if (fd < 0)
         {
             if (errno == EISDIR) {
@@ -991,7 +1922,16 @@ cleanup_xpn_server_op_read_mdata:
             goto cleanup_xpn_server_op_write_mdata;
         }
 
-        req.ret = filesystem_write(fd, & head->u_st_xpn_server_msg.op_write_mdata.mdata, sizeof(struct xpn_metadata));
+        if (NULL != params->mdata_index)
+        {
+            req.ret = kv_index_put(params->mdata_index, full_path, & head->u_st_xpn_server_msg.op_write_mdata.mdata);
+            if (req.ret == 0) {
+                req.ret = sizeof(struct xpn_metadata);
+            }
+        }
+        else {
+            req.ret = filesystem_write(fd, & head->u_st_xpn_server_msg.op_write_mdata.mdata, sizeof(struct xpn_metadata));
+        }
 
         filesystem_close(fd); //TODO: think if necesary check error in close
 
@@ -1007,9 +1947,24 @@ cleanup_xpn_server_op_write_mdata:
 
     pthread_mutex_t op_write_mdata_file_size_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+    // kv_index_update() callback: file_size only grows
+    int xpn_server_mdata_update_file_size ( void * value, void * arg )
+    {
+        struct xpn_metadata * mdata = (struct xpn_metadata *) value;
+        ssize_t size = *((ssize_t *) arg);
+
+        if ((ssize_t) mdata->file_size >= size) {
+            return 0;
+        }
+
+        mdata->file_size = size;
+        return 1;
+    }
+
     void xpn_server_op_write_mdata_file_size ( xpn_server_param_st * params, void * comm, struct st_xpn_server_msg * head, int rank_client_id, int tag_client_id )
     {
         int ret, fd;
+        struct stat st;
         ssize_t actual_file_size = 0;
         struct st_xpn_server_status req;
 
@@ -1028,6 +1983,24 @@ cleanup_xpn_server_op_write_mdata:
         // do operation
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_write_mdata_file_size] >> Begin - write_mdata_file_size(%s, %ld)\n", params->rank, full_path, head->u_st_xpn_server_msg.op_write_mdata_file_size.size);
 
+        if (NULL != params->mdata_index)
+        {
+            errno = 0;
+            ret = kv_index_update(params->mdata_index, full_path, xpn_server_mdata_update_file_size, & head->u_st_xpn_server_msg.op_write_mdata_file_size.size);
+            if (ret >= 0) {
+                ret = sizeof(ssize_t);
+            }
+            else if (errno == ENOENT) {
+                // without entry there is no file size to update, as in an empty file
+                errno = 0;
+                ret = filesystem_stat(full_path, & st);
+            }
+
+            req.ret = ret;
+            req.server_errno = errno;
+            goto send_xpn_server_op_write_mdata_file_size;
+        }
+
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_write_mdata_file_size] mutex lock\n", params->rank);
         pthread_mutex_lock( & op_write_mdata_file_size_mutex);
 
@@ -1062,6 +2035,7 @@ cleanup_xpn_server_op_write_mdata_file_size:
         req.ret = ret;
         req.server_errno = errno;
 
+send_xpn_server_op_write_mdata_file_size:
         debug_info("[Server=%d] [XPN_SERVER_OPS] [xpn_server_op_write_mdata_file_size] << End - write_mdata_file_size(%s, %ld)=%d\n", params->rank, head->u_st_xpn_server_msg.op_write_mdata_file_size.path, head->u_st_xpn_server_msg.op_write_mdata_file_size.size, req.ret);
 
         // send back the status
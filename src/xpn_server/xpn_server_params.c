@@ -69,11 +69,51 @@
          // * IP version
          printf(" |\t-i  <IP version>:\t'%d'\n", params->ipv);
 
+         // * connection limit
+         if (params->max_connections > 0) {
+             printf(" |\t-c  <int>:\t%d connections at most\n", params->max_connections);
+         }
+
+         // * admission control
+         if (params->max_requests > 0) {
+             printf(" |\t-r  <int>:\t%d requests running at most\n", params->max_requests);
+         }
+         if (params->max_bytes > 0) {
+             printf(" |\t-b  <MiB>:\t%ld MiB in flight at most\n", params->max_bytes / MB);
+         }
+         if (params->client_requests > 0) {
+             printf(" |\t-R  <int>:\t%d requests per connection at most\n", params->client_requests);
+         }
+         if (params->client_bytes > 0) {
+             printf(" |\t-B  <MiB>:\t%ld MiB per connection at most\n", params->client_bytes / MB);
+         }
+         if (params->quantum > 0) {
+             printf(" |\t-q  <KiB>:\t%ld KiB per turn\n", params->quantum / KB);
+         }
+         for (int i = 0; i < params->n_weights; i++) {
+             printf(" |\t-W  <host>=<int>:\t'%s' weight %d\n", params->weight_host[i], params->weight[i]);
+         }
+
+         // * write coalescing
+         if (params->coalesce_window > 0) {
+             printf(" |\t-g  <usec>:\t%ld usec to gather small writes\n", params->coalesce_window);
+         }
+
+         // * log-structured writes
+         if (strlen(params->wlog_dir) > 0) {
+             printf(" |\t-L  <path>:\t'%s'\n", params->wlog_dir);
+         }
+
          // use of mqtt
          if (params->mosquitto_mode == 1) {
              printf(" |\t-m <mqtt_qos>:\t%d\n", params->mosquitto_qos);
          }
 
+         // metadata index
+         if (strlen(params->mdata_index_dir) > 0) {
+             printf(" |\t-d  <path>:\t'%s'\n", params->mdata_index_dir);
+         }
+
          debug_info("[Server=%d] [XPN_SERVER_PARAMS] [xpn_server_params_show] << End\n", params->rank);
      }
 
@@ -102,6 +142,26 @@
          printf("\t       0 (QoS 0)\n");
          printf("\t       1 (QoS 1)\n");
          printf("\t       2 (QoS 2)\n");
+         printf("\t-d  <path>\n");
+         printf("\t       ^ directory of the metadata index (default: metadata in the file header)\n");
+         printf("\t-c  <max connections as integer>\n");
+         printf("\t       ^ clients connected at the same time, the rest wait (default: 0, no limit)\n");
+         printf("\t-r  <max requests as integer>\n");
+         printf("\t       ^ requests running at the same time, the rest wait (default: 0, no limit)\n");
+         printf("\t-b  <max MiB as integer>\n");
+         printf("\t       ^ data of the requests running at the same time (default: 0, no limit)\n");
+         printf("\t-R  <max requests as integer>\n");
+         printf("\t       ^ requests in flight per connection, the next one is not read (default: 0, no limit)\n");
+         printf("\t-B  <max MiB as integer>\n");
+         printf("\t       ^ data in flight per connection (default: 0, no limit)\n");
+         printf("\t-q  <KiB as integer>\n");
+         printf("\t       ^ data of each client per round when requests wait (default: 1024)\n");
+         printf("\t-W  <host>=<weight as integer>\n");
+         printf("\t       ^ share of the clients on that host when requests wait (default: 1, repeat for more hosts)\n");
+         printf("\t-g  <microseconds as integer>\n");
+         printf("\t       ^ time to gather the small writes to a file of other clients and merge them (default: 0, off)\n");
+         printf("\t-L  <path>\n");
+         printf("\t       ^ directory of the write logs: writes are appended to a log per file, compacted later (default: off)\n");
 
          debug_info("[Server=%d] [XPN_SERVER_PARAMS] [xpn_server_params_show_usage] << End\n", -1);
      }
@@ -129,6 +189,18 @@
          #endif
 
          params->await_stop = 0;
+         params->max_connections = 0;
+         params->max_requests    = 0;
+         params->max_bytes       = 0;
+         params->client_requests = 0;
+         params->client_bytes    = 0;
+         params->admission       = NULL;
+         params->quantum         = 0;
+         params->n_weights       = 0;
+         params->coalesce_window = 0;
+         params->coalesce        = NULL;
+         strcpy(params->wlog_dir, "");
+         params->wlog            = NULL;
          strcpy(params->srv_name, "");
          ns_get_hostname(params->srv_name);
          strcpy(params->port_name, "");
@@ -139,6 +211,10 @@
          params->mosquitto_mode = 0;
          params->mosquitto_qos  = 0;
 
+         // default values for the metadata index
+         strcpy(params->mdata_index_dir, "");
+         params->mdata_index = NULL;
+
          // update user requests
          debug_info("[Server=%d] [XPN_SERVER_PARAMS] [xpn_server_params_get] Get user configuration\n", params->rank);
 
@@ -223,10 +299,121 @@
                             i++;
                             break;
 
+                       case 'd':
+                            if ((i + 1) < argc)
+                                 strcpy(params->mdata_index_dir, argv[i + 1]);
+                            else printf("ERROR: empty metadata index directory.\n");
+                            i++;
+                            break;
+
                        case 'i':
                             params->ipv = utils_str2int(argv[i + 1], SCK_IP4);
                             break;
 
+                       case 'c':
+                            if ((i + 1) < argc) {
+                                params->max_connections = utils_str2int(argv[i + 1], 0);
+                                if (params->max_connections < 0) {
+                                    printf("ERROR: wrong option -c '%s'\n", argv[i + 1]);
+                                    params->max_connections = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'r':
+                            if ((i + 1) < argc) {
+                                params->max_requests = utils_str2int(argv[i + 1], 0);
+                                if (params->max_requests < 0) {
+                                    printf("ERROR: wrong option -r '%s'\n", argv[i + 1]);
+                                    params->max_requests = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'b':
+                            if ((i + 1) < argc) {
+                                params->max_bytes = (long)utils_str2int(argv[i + 1], 0) * MB;
+                                if (params->max_bytes < 0) {
+                                    printf("ERROR: wrong option -b '%s'\n", argv[i + 1]);
+                                    params->max_bytes = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'R':
+                            if ((i + 1) < argc) {
+                                params->client_requests = utils_str2int(argv[i + 1], 0);
+                                if (params->client_requests < 0) {
+                                    printf("ERROR: wrong option -R '%s'\n", argv[i + 1]);
+                                    params->client_requests = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'B':
+                            if ((i + 1) < argc) {
+                                params->client_bytes = (long)utils_str2int(argv[i + 1], 0) * MB;
+                                if (params->client_bytes < 0) {
+                                    printf("ERROR: wrong option -B '%s'\n", argv[i + 1]);
+                                    params->client_bytes = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'q':
+                            if ((i + 1) < argc) {
+                                params->quantum = (long)utils_str2int(argv[i + 1], 0) * KB;
+                                if (params->quantum < 0) {
+                                    printf("ERROR: wrong option -q '%s'\n", argv[i + 1]);
+                                    params->quantum = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'W':
+                            if ((i + 1) < argc)
+                            {
+                                char *eq = strrchr(argv[i + 1], '=');
+                                int   w  = (NULL != eq) ? utils_str2int(eq + 1, 0) : 0;
+
+                                if ((NULL == eq) || (eq == argv[i + 1]) || (eq - argv[i + 1] >= HOST_NAME_MAX) || (w <= 0)) {
+                                    printf("ERROR: wrong option -W '%s', <host>=<weight> expected\n", argv[i + 1]);
+                                } else if (params->n_weights >= XPN_SERVER_ADMISSION_MAX_WEIGHTS) {
+                                    printf("ERROR: too many -W options, '%s' ignored\n", argv[i + 1]);
+                                } else {
+                                    memset(params->weight_host[params->n_weights], 0, HOST_NAME_MAX);
+                                    strncpy(params->weight_host[params->n_weights], argv[i + 1], eq - argv[i + 1]);
+                                    params->weight[params->n_weights] = w;
+                                    params->n_weights++;
+                                }
+                            }
+                            i++;
+                            break;
+
+                       case 'L':
+                            if ((i + 1) < argc)
+                                 strcpy(params->wlog_dir, argv[i + 1]);
+                            else printf("ERROR: empty write log directory.\n");
+                            i++;
+                            break;
+
+                       case 'g':
+                            if ((i + 1) < argc) {
+                                params->coalesce_window = (long)utils_str2int(argv[i + 1], 0);
+                                if (params->coalesce_window < 0) {
+                                    printf("ERROR: wrong option -g '%s'\n", argv[i + 1]);
+                                    params->coalesce_window = 0;
+                                }
+                            }
+                            i++;
+                            break;
+
                        default:
                             break;
                      }
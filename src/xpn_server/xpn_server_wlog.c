@@ -0,0 +1,745 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Dario Muñoz Muñoz
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+  /* ... Include / Inclusion ........................................... */
+
+     #include "xpn_server_wlog.h"
+
+
+  /* ... Functions / Funciones ......................................... */
+
+
+     /*
+      * Internal
+      */
+
+     static long aux_wlog_now ( void )
+     {
+         struct timespec t;
+
+         clock_gettime(CLOCK_REALTIME, &t);
+         return (long)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+     }
+
+     static uint32_t aux_wlog_hash ( char *path )
+     {
+         uint32_t h = 5381;
+
+         for (char *p = path; *p != '\0'; p++) {
+             h = ((h << 5) + h) ^ (unsigned char)(*p);
+         }
+         return h;
+     }
+
+     static int aux_wlog_match ( struct xpn_server_wlog_file *file, char *path, int subtree )
+     {
+         size_t len;
+
+         if (strcmp(file->path, path) == 0) {
+             return 1;
+         }
+         if (! subtree) {
+             return 0;
+         }
+
+         len = strlen(path);
+         return (strncmp(file->path, path, len) == 0) && (file->path[len] == '/');
+     }
+
+     static void aux_wlog_free ( struct xpn_server_wlog_file *file )
+     {
+         pthread_mutex_destroy(&(file->m_file));
+         FREE_AND_NULL(file->extents);
+         free(file->path);
+         free(file);
+     }
+
+     // Entry of 'path' in use by the caller (NULL if there is none and 'create' is 0)
+     static struct xpn_server_wlog_file * aux_wlog_get ( xpn_server_wlog_t *w, char *path, int create )
+     {
+         struct xpn_server_wlog_file **bucket;
+         struct xpn_server_wlog_file  *file;
+
+         pthread_mutex_lock(&(w->m_wlog));
+
+         bucket = &(w->files[aux_wlog_hash(path) & (XPN_SERVER_WLOG_BUCKETS - 1)]);
+         for (file = *bucket; file != NULL; file = file->next)
+         {
+             if (strcmp(file->path, path) == 0) {
+                 break;
+             }
+         }
+
+         if ((NULL == file) && (create))
+         {
+             file = (struct xpn_server_wlog_file *)malloc(sizeof(struct xpn_server_wlog_file));
+             if (NULL != file)
+             {
+                 memset(file, 0, sizeof(struct xpn_server_wlog_file));
+                 file->path = strdup(path);
+                 if (NULL == file->path) {
+                     FREE_AND_NULL(file);
+                 }
+             }
+             if (NULL != file)
+             {
+                 pthread_mutex_init(&(file->m_file), NULL);
+                 file->log_fd = -1;
+                 file->next   = *bucket;
+                 *bucket      = file;
+             }
+         }
+
+         if (NULL != file) {
+             file->n_users++;
+         }
+
+         pthread_mutex_unlock(&(w->m_wlog));
+
+         return file;
+     }
+
+     // Remove the entries without a log that nobody uses (with m_wlog locked)
+     static void aux_wlog_purge ( struct xpn_server_wlog_file **bucket )
+     {
+         struct xpn_server_wlog_file **p = bucket;
+         struct xpn_server_wlog_file  *file;
+
+         while (NULL != *p)
+         {
+             file = *p;
+             if ((file->n_users > 0) || (file->log_fd >= 0))
+             {
+                 p = &(file->next);
+                 continue;
+             }
+
+             *p = file->next;
+             aux_wlog_free(file);
+         }
+     }
+
+     static void aux_wlog_put ( xpn_server_wlog_t *w, struct xpn_server_wlog_file *file )
+     {
+         pthread_mutex_lock(&(w->m_wlog));
+
+         file->n_users--;
+         if (file->n_users == 0) {
+             aux_wlog_purge(&(w->files[aux_wlog_hash(file->path) & (XPN_SERVER_WLOG_BUCKETS - 1)]));
+         }
+
+         pthread_mutex_unlock(&(w->m_wlog));
+     }
+
+     // Entries of 'path' (or below it) with a log, in use by the caller
+     static struct xpn_server_wlog_file ** aux_wlog_collect ( xpn_server_wlog_t *w, char *path, int subtree, int *n )
+     {
+         struct xpn_server_wlog_file **files = NULL;
+         struct xpn_server_wlog_file  *file;
+         int first, last, max = 0;
+
+         *n = 0;
+
+         if (subtree) {
+             first = 0;
+             last  = XPN_SERVER_WLOG_BUCKETS - 1;
+         }
+         else {
+             first = last = aux_wlog_hash(path) & (XPN_SERVER_WLOG_BUCKETS - 1);
+         }
+
+         pthread_mutex_lock(&(w->m_wlog));
+
+         for (int i = first; i <= last; i++)
+         {
+             for (file = w->files[i]; file != NULL; file = file->next)
+             {
+                 if ((file->log_fd < 0) || (! aux_wlog_match(file, path, subtree))) {
+                     continue;
+                 }
+
+                 if (*n == max)
+                 {
+                     struct xpn_server_wlog_file **aux;
+
+                     aux = (struct xpn_server_wlog_file **)realloc(files, (2 * max + 1) * sizeof(struct xpn_server_wlog_file *));
+                     if (NULL == aux) {
+                         break;
+                     }
+                     files = aux;
+                     max   = 2 * max + 1;
+                 }
+
+                 file->n_users++;
+                 files[(*n)++] = file;
+             }
+         }
+
+         pthread_mutex_unlock(&(w->m_wlog));
+
+         return files;
+     }
+
+     static void aux_wlog_release ( xpn_server_wlog_t *w, struct xpn_server_wlog_file **files, int n )
+     {
+         for (int i = 0; i < n; i++) {
+             aux_wlog_put(w, files[i]);
+         }
+         FREE_AND_NULL(files);
+     }
+
+     // First extent that ends after 'offset'
+     static int aux_wlog_search ( struct xpn_server_wlog_file *file, off_t offset )
+     {
+         int lo = 0, hi = file->n_extents;
+
+         while (lo < hi)
+         {
+             int mid = (lo + hi) / 2;
+
+             if (file->extents[mid].offset + file->extents[mid].size <= offset)
+                  lo = mid + 1;
+             else hi = mid;
+         }
+
+         return lo;
+     }
+
+     // [offset, offset+size) is now at log_offset: the extents below are trimmed, split or removed
+     static int aux_wlog_insert ( struct xpn_server_wlog_file *file, off_t offset, long size, off_t log_offset )
+     {
+         struct xpn_server_wlog_extent pieces[3];
+         off_t end = offset + size;
+         int i, j, k = 0;
+
+         i = aux_wlog_search(file, offset);
+         for (j = i; (j < file->n_extents) && (file->extents[j].offset < end); j++) {
+             ;
+         }
+
+         // the part of the first one before it, the new one and the part of the last one after it
+         if ((i < j) && (file->extents[i].offset < offset))
+         {
+             pieces[k].offset     = file->extents[i].offset;
+             pieces[k].size       = offset - file->extents[i].offset;
+             pieces[k].log_offset = file->extents[i].log_offset;
+             k++;
+         }
+
+         pieces[k].offset     = offset;
+         pieces[k].size       = size;
+         pieces[k].log_offset = log_offset;
+         k++;
+
+         if ((i < j) && (file->extents[j - 1].offset + file->extents[j - 1].size > end))
+         {
+             pieces[k].offset     = end;
+             pieces[k].size       = file->extents[j - 1].offset + file->extents[j - 1].size - end;
+             pieces[k].log_offset = file->extents[j - 1].log_offset + (end - file->extents[j - 1].offset);
+             k++;
+         }
+
+         // a write right after the previous one, in the file and in the log, just makes it longer
+         if ((k == 1) && (i > 0) && (i == j) &&
+             (file->extents[i - 1].offset + file->extents[i - 1].size == offset) &&
+             (file->extents[i - 1].log_offset + file->extents[i - 1].size == log_offset))
+         {
+             file->extents[i - 1].size += size;
+             if (end > file->end) {
+                 file->end = end;
+             }
+             return 0;
+         }
+
+         if (file->n_extents - (j - i) + k > file->max_extents)
+         {
+             struct xpn_server_wlog_extent *aux;
+             int max = (file->max_extents > 0) ? 2 * file->max_extents : 64;
+
+             aux = (struct xpn_server_wlog_extent *)realloc(file->extents, max * sizeof(struct xpn_server_wlog_extent));
+             if (NULL == aux) {
+                 return -1;
+             }
+             file->extents     = aux;
+             file->max_extents = max;
+         }
+
+         memmove(&(file->extents[i + k]), &(file->extents[j]), (file->n_extents - j) * sizeof(struct xpn_server_wlog_extent));
+         memcpy (&(file->extents[i]), pieces, k * sizeof(struct xpn_server_wlog_extent));
+         file->n_extents = file->n_extents - (j - i) + k;
+
+         if (end > file->end) {
+             file->end = end;
+         }
+
+         return 0;
+     }
+
+     // The log is not needed anymore (with m_file locked)
+     static void aux_wlog_drop ( struct xpn_server_wlog_file *file )
+     {
+         if (file->log_fd >= 0)
+         {
+             filesystem_close(file->log_fd);
+             filesystem_unlink(file->log_path);
+         }
+
+         __atomic_store_n(&(file->log_fd), -1, __ATOMIC_RELAXED);
+         file->log_size  = 0;
+         file->n_extents = 0;
+         file->end       = 0;
+         file->flush     = 0;
+     }
+
+     // Copy the extents of the log into the data file, in order, then drop the log (with m_file locked)
+     static int aux_wlog_compact ( xpn_server_wlog_t *w, struct xpn_server_wlog_file *file )
+     {
+         char   *buffer;
+         long    copied = 0, to_copy, cont;
+         ssize_t ret;
+         int     fd;
+
+         if (file->n_extents == 0)
+         {
+             aux_wlog_drop(file);
+             return 0;
+         }
+
+         fd = filesystem_open(file->path, O_WRONLY);
+         if (fd < 0)
+         {
+             // the data file is gone, and its log with it
+             if (ENOENT == errno)
+             {
+                 aux_wlog_drop(file);
+                 return 0;
+             }
+             return -1;
+         }
+
+         buffer = (char *)malloc(XPN_SERVER_WLOG_COPY_SIZE);
+         if (NULL == buffer)
+         {
+             filesystem_close(fd);
+             return -1;
+         }
+
+         debug_info("[XPN_SERVER_WLOG] [aux_wlog_compact] %s: %d extents, %ld bytes of log\n", file->path, file->n_extents, (long)file->log_size);
+
+         for (int i = 0; i < file->n_extents; i++)
+         {
+             for (cont = 0; cont < file->extents[i].size; cont = cont + to_copy)
+             {
+                 to_copy = file->extents[i].size - cont;
+                 if (to_copy > XPN_SERVER_WLOG_COPY_SIZE) {
+                     to_copy = XPN_SERVER_WLOG_COPY_SIZE;
+                 }
+
+                 ret = -1;
+                 if (filesystem_lseek(file->log_fd, file->extents[i].log_offset + cont, SEEK_SET) >= 0) {
+                     ret = filesystem_read(file->log_fd, buffer, to_copy);
+                 }
+                 if ((ret == to_copy) && (filesystem_lseek(fd, file->extents[i].offset + cont, SEEK_SET) >= 0)) {
+                     ret = filesystem_write(fd, buffer, to_copy);
+                 }
+                 else {
+                     ret = -1;
+                 }
+
+                 if (ret < 0)
+                 {
+                     debug_error("[XPN_SERVER_WLOG] [aux_wlog_compact] ERROR: %s cannot be compacted\n", file->path);
+                     FREE_AND_NULL(buffer);
+                     filesystem_close(fd);
+                     return -1;
+                 }
+             }
+             copied = copied + file->extents[i].size;
+         }
+
+         FREE_AND_NULL(buffer);
+
+         // the data has to be in the data file before the log goes away
+         filesystem_fsync(fd);
+         filesystem_close(fd);
+         aux_wlog_drop(file);
+
+         __atomic_add_fetch(&(w->n_compactions),     1,      __ATOMIC_RELAXED);
+         __atomic_add_fetch(&(w->n_bytes_compacted), copied, __ATOMIC_RELAXED);
+
+         return 0;
+     }
+
+     // Read without log
+     static ssize_t aux_wlog_pread ( int fd, off_t offset, char *buffer, long size )
+     {
+         if (filesystem_lseek(fd, offset, SEEK_SET) < 0) {
+             return -1;
+         }
+         return filesystem_read(fd, buffer, size);
+     }
+
+     // Compaction thread: logs to flush, idle or too big
+     static void * aux_wlog_compactor ( void *arg )
+     {
+         xpn_server_wlog_t *w = (xpn_server_wlog_t *)arg;
+         struct xpn_server_wlog_file *file;
+         struct timespec deadline;
+         long now;
+         int  again;
+
+         pthread_mutex_lock(&(w->m_wlog));
+
+         while (! w->the_end)
+         {
+             clock_gettime(CLOCK_REALTIME, &deadline);
+             deadline.tv_nsec = deadline.tv_nsec + XPN_SERVER_WLOG_PERIOD * 1000;
+             deadline.tv_sec  = deadline.tv_sec  + deadline.tv_nsec / 1000000000;
+             deadline.tv_nsec = deadline.tv_nsec % 1000000000;
+             pthread_cond_timedwait(&(w->c_compact), &(w->m_wlog), &deadline);
+
+             for (int i = 0; (i < XPN_SERVER_WLOG_BUCKETS) && (! w->the_end); i++)
+             {
+                 do
+                 {
+                     again = 0;
+                     now   = aux_wlog_now();
+
+                     for (file = w->files[i]; file != NULL; file = file->next)
+                     {
+                         if (__atomic_load_n(&(file->log_fd), __ATOMIC_RELAXED) < 0) {
+                             continue;
+                         }
+                         if ((! __atomic_load_n(&(file->flush), __ATOMIC_RELAXED)) &&
+                             (now - __atomic_load_n(&(file->last_time), __ATOMIC_RELAXED) < XPN_SERVER_WLOG_IDLE) &&
+                             (__atomic_load_n(&(file->log_size), __ATOMIC_RELAXED) < XPN_SERVER_WLOG_MAX_LOG)) {
+                             continue;
+                         }
+
+                         file->n_users++;
+                         pthread_mutex_unlock(&(w->m_wlog));
+
+                         pthread_mutex_lock(&(file->m_file));
+                         if (aux_wlog_compact(w, file) < 0)
+                         {
+                             // try again later
+                             __atomic_store_n(&(file->flush),     0,   __ATOMIC_RELAXED);
+                             __atomic_store_n(&(file->last_time), now, __ATOMIC_RELAXED);
+                         }
+                         pthread_mutex_unlock(&(file->m_file));
+
+                         pthread_mutex_lock(&(w->m_wlog));
+                         file->n_users--;
+                         again = 1;
+                         break;
+                     }
+                 } while ((again) && (! w->the_end));
+
+                 aux_wlog_purge(&(w->files[i]));
+             }
+         }
+
+         pthread_mutex_unlock(&(w->m_wlog));
+
+         return NULL;
+     }
+
+
+     /*
+      * API
+      */
+
+     xpn_server_wlog_t * xpn_server_wlog_init ( char *dir )
+     {
+         xpn_server_wlog_t *w;
+
+         debug_info("[XPN_SERVER_WLOG] [xpn_server_wlog_init] >> Begin\n");
+
+         w = (xpn_server_wlog_t *)malloc(sizeof(xpn_server_wlog_t));
+         if (NULL == w)
+         {
+             debug_error("[XPN_SERVER_WLOG] [xpn_server_wlog_init] ERROR: malloc fails\n");
+             return NULL;
+         }
+
+         memset(w, 0, sizeof(xpn_server_wlog_t));
+         strncpy(w->dir, dir, PATH_MAX - 64);
+         pthread_mutex_init(&(w->m_wlog), NULL);
+         pthread_cond_init(&(w->c_compact), NULL);
+
+         filesystem_mkdir_p(w->dir, S_IRWXU);
+
+         if (pthread_create(&(w->th_compact), NULL, aux_wlog_compactor, (void *)w) != 0)
+         {
+             debug_error("[XPN_SERVER_WLOG] [xpn_server_wlog_init] ERROR: pthread_create fails\n");
+             pthread_cond_destroy(&(w->c_compact));
+             pthread_mutex_destroy(&(w->m_wlog));
+             free(w);
+             return NULL;
+         }
+
+         debug_info("[XPN_SERVER_WLOG] [xpn_server_wlog_init] << End\n");
+
+         return w;
+     }
+
+     // Stop the compaction thread and compact what is left
+     void xpn_server_wlog_destroy ( xpn_server_wlog_t *w )
+     {
+         struct xpn_server_wlog_file *file;
+
+         if (NULL == w) {
+             return;
+         }
+
+         pthread_mutex_lock(&(w->m_wlog));
+         w->the_end = 1;
+         pthread_cond_signal(&(w->c_compact));
+         pthread_mutex_unlock(&(w->m_wlog));
+         pthread_join(w->th_compact, NULL);
+
+         for (int i = 0; i < XPN_SERVER_WLOG_BUCKETS; i++)
+         {
+             while (NULL != w->files[i])
+             {
+                 file = w->files[i];
+                 w->files[i] = file->next;
+
+                 if (aux_wlog_compact(w, file) < 0) {
+                     printf("[XPN_SERVER_WLOG] [xpn_server_wlog_destroy] ERROR: the log of '%s' is kept in '%s'\n", file->path, file->log_path);
+                 }
+                 aux_wlog_free(file);
+             }
+         }
+
+         pthread_cond_destroy(&(w->c_compact));
+         pthread_mutex_destroy(&(w->m_wlog));
+         free(w);
+     }
+
+     // Append 'size' bytes of the file at 'offset' to its log
+     ssize_t xpn_server_wlog_write ( xpn_server_wlog_t *w, char *path, off_t offset, char *buffer, long size )
+     {
+         struct xpn_server_wlog_file *file;
+         ssize_t ret = -1;
+
+         file = aux_wlog_get(w, path, 1);
+         if (NULL == file) {
+             errno = ENOMEM;
+             return -1;
+         }
+
+         pthread_mutex_lock(&(file->m_file));
+
+         if (file->log_fd < 0)
+         {
+             sprintf(file->log_path, "%.*s/%08x.%ld.log", PATH_MAX - 64, w->dir, aux_wlog_hash(path), __atomic_add_fetch(&(w->seq), 1, __ATOMIC_RELAXED));
+             __atomic_store_n(&(file->log_fd), filesystem_open2(file->log_path, O_CREAT | O_TRUNC | O_RDWR, S_IRUSR | S_IWUSR), __ATOMIC_RELAXED);
+             file->log_size = 0;
+         }
+
+         if ((file->log_fd >= 0) && (filesystem_lseek(file->log_fd, file->log_size, SEEK_SET) >= 0)) {
+             ret = filesystem_write(file->log_fd, buffer, size);
+         }
+         if ((ret >= 0) && (aux_wlog_insert(file, offset, size, file->log_size) < 0)) {
+             errno = ENOMEM;
+             ret = -1;
+         }
+
+         if (ret >= 0)
+         {
+             __atomic_store_n(&(file->log_size),  file->log_size + size, __ATOMIC_RELAXED);
+             __atomic_store_n(&(file->last_time), aux_wlog_now(),        __ATOMIC_RELAXED);
+             __atomic_add_fetch(&(w->n_appends),      1,    __ATOMIC_RELAXED);
+             __atomic_add_fetch(&(w->n_bytes_logged), size, __ATOMIC_RELAXED);
+         }
+         else if (file->n_extents == 0) {
+             aux_wlog_drop(file);
+         }
+
+         pthread_mutex_unlock(&(file->m_file));
+         aux_wlog_put(w, file);
+
+         return ret;
+     }
+
+     // Read 'size' bytes at 'offset' of the data file 'fd', with the data of the log on top
+     ssize_t xpn_server_wlog_read ( xpn_server_wlog_t *w, char *path, int fd, off_t offset, char *buffer, long size )
+     {
+         struct xpn_server_wlog_file *file;
+         ssize_t ret;
+         off_t   start, end;
+
+         file = aux_wlog_get(w, path, 0);
+         if (NULL == file) {
+             return aux_wlog_pread(fd, offset, buffer, size);
+         }
+
+         pthread_mutex_lock(&(file->m_file));
+
+         ret = aux_wlog_pread(fd, offset, buffer, size);
+         if ((ret >= 0) && (file->n_extents > 0))
+         {
+             // holes up to the end of the log read as zeros
+             if (ret < size) {
+                 memset(buffer + ret, 0, size - ret);
+             }
+             if (file->end > offset + ret) {
+                 ret = (file->end - offset < size) ? file->end - offset : size;
+             }
+
+             for (int i = aux_wlog_search(file, offset); (i < file->n_extents) && (file->extents[i].offset < offset + size); i++)
+             {
+                 start = (file->extents[i].offset > offset) ? file->extents[i].offset : offset;
+                 end   = file->extents[i].offset + file->extents[i].size;
+                 if (end > offset + size) {
+                     end = offset + size;
+                 }
+
+                 if ((filesystem_lseek(file->log_fd, file->extents[i].log_offset + (start - file->extents[i].offset), SEEK_SET) < 0) ||
+                     (filesystem_read(file->log_fd, buffer + (start - offset), end - start) != end - start))
+                 {
+                     ret = -1;
+                     break;
+                 }
+             }
+         }
+
+         pthread_mutex_unlock(&(file->m_file));
+         aux_wlog_put(w, file);
+
+         return ret;
+     }
+
+     // Sync the log of 'path' (instead of its data file)
+     int xpn_server_wlog_sync ( xpn_server_wlog_t *w, char *path )
+     {
+         struct xpn_server_wlog_file *file;
+         int fd = -1, ret = 0;
+
+         file = aux_wlog_get(w, path, 0);
+         if (NULL == file) {
+             return 0;
+         }
+
+         // a copy of the descriptor, so the appends do not wait for the sync
+         pthread_mutex_lock(&(file->m_file));
+         if (file->log_fd >= 0) {
+             fd = dup(file->log_fd);
+         }
+         pthread_mutex_unlock(&(file->m_file));
+         aux_wlog_put(w, file);
+
+         if (fd >= 0)
+         {
+             ret = filesystem_fsync(fd);
+             filesystem_close(fd);
+         }
+
+         return ret;
+     }
+
+     // The file is closed: compact its log in background
+     void xpn_server_wlog_flush ( xpn_server_wlog_t *w, char *path )
+     {
+         struct xpn_server_wlog_file **files;
+         int n;
+
+         if (NULL == w) {
+             return;
+         }
+
+         files = aux_wlog_collect(w, path, 0, &n);
+         for (int i = 0; i < n; i++) {
+             __atomic_store_n(&(files[i]->flush), 1, __ATOMIC_RELAXED);
+         }
+         aux_wlog_release(w, files, n);
+
+         if (n > 0)
+         {
+             pthread_mutex_lock(&(w->m_wlog));
+             pthread_cond_signal(&(w->c_compact));
+             pthread_mutex_unlock(&(w->m_wlog));
+         }
+     }
+
+     // Compact now the log of 'path' (and of the files below it if 'subtree')
+     int xpn_server_wlog_compact ( xpn_server_wlog_t *w, char *path, int subtree )
+     {
+         struct xpn_server_wlog_file **files;
+         int n, ret = 0;
+
+         if (NULL == w) {
+             return 0;
+         }
+
+         files = aux_wlog_collect(w, path, subtree, &n);
+         for (int i = 0; i < n; i++)
+         {
+             pthread_mutex_lock(&(files[i]->m_file));
+             if (aux_wlog_compact(w, files[i]) < 0) {
+                 ret = -1;
+             }
+             pthread_mutex_unlock(&(files[i]->m_file));
+         }
+         aux_wlog_release(w, files, n);
+
+         return ret;
+     }
+
+     // The file is removed: its log too (and the ones of the files below it if 'subtree')
+     void xpn_server_wlog_discard ( xpn_server_wlog_t *w, char *path, int subtree )
+     {
+         struct xpn_server_wlog_file **files;
+         int n;
+
+         if (NULL == w) {
+             return;
+         }
+
+         files = aux_wlog_collect(w, path, subtree, &n);
+         for (int i = 0; i < n; i++)
+         {
+             pthread_mutex_lock(&(files[i]->m_file));
+             aux_wlog_drop(files[i]);
+             pthread_mutex_unlock(&(files[i]->m_file));
+         }
+         aux_wlog_release(w, files, n);
+     }
+
+     // One line with the data that went through the logs
+     int xpn_server_wlog_stats ( xpn_server_wlog_t *w, char *buffer, int size )
+     {
+         if (NULL == w) {
+             return snprintf(buffer, size, "wlog=off");
+         }
+
+         return snprintf(buffer, size, "logged=%ld logged_bytes=%ld compactions=%ld compacted_bytes=%ld",
+                         __atomic_load_n(&(w->n_appends),         __ATOMIC_RELAXED),
+                         __atomic_load_n(&(w->n_bytes_logged),    __ATOMIC_RELAXED),
+                         __atomic_load_n(&(w->n_compactions),     __ATOMIC_RELAXED),
+                         __atomic_load_n(&(w->n_bytes_compacted), __ATOMIC_RELAXED));
+     }
+
+
+  /* ................................................................... */
+
@@ -0,0 +1,303 @@
+
+/*
+ * kv_index: put/get/del/rename, replay after reopen, torn last record and compaction
+ */
+
+#include "all_system.h"
+#include "base/kv_index.h"
+
+struct value
+{
+    long size;
+    char tag[56];
+};
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+void set_value ( struct value *v, long size, char *tag )
+{
+    memset(v, 0, sizeof(struct value));
+    v->size = size;
+    strncpy(v->tag, tag, sizeof(v->tag) - 1);
+}
+
+// key is in the index with this size
+int has ( kv_index_t *kv, char *key, long size )
+{
+    struct value v;
+
+    if (kv_index_get(kv, key, &v) < 0) {
+        return 0;
+    }
+    return (v.size == size);
+}
+
+int missing ( kv_index_t *kv, char *key )
+{
+    struct value v;
+
+    return (kv_index_get(kv, key, &v) < 0) && (errno == ENOENT);
+}
+
+off_t file_size ( char *path )
+{
+    struct stat st;
+
+    if (stat(path, &st) < 0) {
+        return -1;
+    }
+    return st.st_size;
+}
+
+
+void test_basic ( char *log )
+{
+    kv_index_t  *kv;
+    struct value v;
+
+    printf("kv_index: put/get/del/rename\n");
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+
+    set_value(&v, 1, "a");    CHECK(kv_index_put(kv, "/a",     &v) == 0);
+    set_value(&v, 2, "dx");   CHECK(kv_index_put(kv, "/d/x",   &v) == 0);
+    set_value(&v, 3, "dyz");  CHECK(kv_index_put(kv, "/d/y/z", &v) == 0);
+    set_value(&v, 4, "dd");   CHECK(kv_index_put(kv, "/dd",    &v) == 0);
+    set_value(&v, 5, "d");    CHECK(kv_index_put(kv, "/d",     &v) == 0);
+    CHECK(kv->n_entries == 5);
+
+    CHECK(has(kv, "/a", 1));
+    CHECK(has(kv, "/d/y/z", 3));
+    CHECK(missing(kv, "/b"));
+    CHECK(missing(kv, "/d/y"));
+
+    // the last put wins
+    set_value(&v, 10, "a2");
+    CHECK(kv_index_put(kv, "/a", &v) == 0);
+    CHECK(has(kv, "/a", 10));
+    CHECK(kv->n_entries == 5);
+
+    CHECK(kv_index_del(kv, "/a") == 0);
+    CHECK(missing(kv, "/a"));
+    CHECK((kv_index_del(kv, "/a") < 0) && (errno == ENOENT));
+
+    // '/d' and what is below it move, '/dd' only shares the first characters
+    CHECK(kv_index_rename(kv, "/d", "/e") == 3);
+    CHECK(has(kv, "/e", 5));
+    CHECK(has(kv, "/e/x", 2));
+    CHECK(has(kv, "/e/y/z", 3));
+    CHECK(missing(kv, "/d"));
+    CHECK(missing(kv, "/d/x"));
+    CHECK(missing(kv, "/d/y/z"));
+    CHECK(has(kv, "/dd", 4));
+
+    // not inside itself
+    CHECK((kv_index_rename(kv, "/e", "/e/f") < 0) && (errno == EINVAL));
+    CHECK(has(kv, "/e/x", 2));
+
+    CHECK(kv_index_del_prefix(kv, "/e/y") == 1);
+    CHECK(missing(kv, "/e/y/z"));
+    CHECK(has(kv, "/e/x", 2));
+
+    CHECK(kv_index_close(kv) == 0);
+
+    // replay: the same entries after reopen
+    printf("kv_index: replay after reopen\n");
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+
+    CHECK(kv->n_entries == 3);
+    CHECK(missing(kv, "/a"));
+    CHECK(has(kv, "/e", 5));
+    CHECK(has(kv, "/e/x", 2));
+    CHECK(missing(kv, "/e/y/z"));
+    CHECK(has(kv, "/dd", 4));
+    CHECK(missing(kv, "/d/x"));
+    CHECK(kv->log_size == file_size(log));
+
+    CHECK(kv_index_close(kv) == 0);
+
+    // other value size: it is not the same index
+    kv = kv_index_open(log, sizeof(struct value) + 8, 0);
+    CHECK((NULL == kv) && (errno == EINVAL));
+    if (NULL != kv) {
+        kv_index_close(kv);
+    }
+}
+
+void test_torn ( char *log )
+{
+    kv_index_t  *kv;
+    struct value v;
+    off_t good, torn;
+    int   fd;
+
+    printf("kv_index: torn last record\n");
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+    good = kv->log_size;
+    set_value(&v, 6, "t");
+    CHECK(kv_index_put(kv, "/torn", &v) == 0);
+    torn = kv->log_size;
+    CHECK(kv_index_close(kv) == 0);
+
+    // a crash in the middle of the last append
+    CHECK(truncate(log, torn - 7) == 0);
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+    CHECK(missing(kv, "/torn"));
+    CHECK(has(kv, "/e/x", 2));
+    CHECK(kv->n_entries == 3);
+    CHECK(file_size(log) == good);
+
+    // the new records go after the last good one
+    set_value(&v, 7, "t2");
+    CHECK(kv_index_put(kv, "/torn2", &v) == 0);
+    torn = kv->log_size;
+    CHECK(kv_index_close(kv) == 0);
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK((NULL != kv) && has(kv, "/torn2", 7));
+    if (NULL != kv) {
+        CHECK(kv_index_close(kv) == 0);
+    }
+
+    // a corrupted last record (bad crc) is cut off too
+    fd = open(log, O_WRONLY);
+    CHECK(fd >= 0);
+    CHECK(pwrite(fd, "X", 1, torn - 1) == 1);
+    close(fd);
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+    CHECK(missing(kv, "/torn2"));
+    CHECK(has(kv, "/dd", 4));
+    CHECK(file_size(log) == good);
+    CHECK(kv_index_close(kv) == 0);
+}
+
+void test_compact ( char *log )
+{
+    kv_index_t  *kv;
+    struct value v;
+    char  key[64];
+    off_t before;
+    long  i, n;
+
+    printf("kv_index: compaction\n");
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+
+    // explicit compaction: only the live records are kept
+    for (i = 0; i < 1000; i++)
+    {
+        sprintf(key, "/c/%ld", i % 10);
+        set_value(&v, i, "c");
+        CHECK(kv_index_put(kv, key, &v) == 0);
+    }
+    before = file_size(log);
+    CHECK(kv_index_compact(kv) == 0);
+    CHECK(kv->log_size == kv->live_size);
+    CHECK(file_size(log) == kv->log_size);
+    CHECK(file_size(log) < before);
+    CHECK(has(kv, "/c/9", 999));
+    CHECK(has(kv, "/dd", 4));
+
+    // appends after it go to the new log
+    set_value(&v, 8, "after");
+    CHECK(kv_index_put(kv, "/after", &v) == 0);
+    CHECK(kv_index_close(kv) == 0);
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK(NULL != kv);
+    if (NULL == kv) {
+        return;
+    }
+    CHECK(kv->n_entries == 3 + 10 + 1);
+    CHECK(has(kv, "/c/0", 990));
+    CHECK(has(kv, "/after", 8));
+    CHECK(has(kv, "/e/x", 2));
+
+    // automatic compaction once the dead records are more than KV_INDEX_COMPACT_MIN
+    n = 2 * KV_INDEX_COMPACT_MIN / (sizeof(struct value) + 32);
+    for (i = 0; i < n; i++)
+    {
+        set_value(&v, i, "hot");
+        CHECK(kv_index_put(kv, "/hot", &v) == 0);
+    }
+    CHECK(kv->log_size - kv->live_size <= KV_INDEX_COMPACT_MIN);
+    CHECK(file_size(log) == kv->log_size);
+    CHECK(has(kv, "/hot", n - 1));
+    CHECK(kv_index_close(kv) == 0);
+
+    kv = kv_index_open(log, sizeof(struct value), 0);
+    CHECK((NULL != kv) && has(kv, "/hot", n - 1) && has(kv, "/after", 8));
+    if (NULL != kv) {
+        CHECK(kv_index_close(kv) == 0);
+    }
+}
+
+
+int main ( int argc, char *argv[] )
+{
+    char dir[PATH_MAX];
+    char log[PATH_MAX];
+
+    if (argc > 1) {
+        snprintf(dir, PATH_MAX, "%s", argv[1]);
+    }
+    else {
+        strcpy(dir, "/tmp/kv_index-test.XXXXXX");
+        if (NULL == mkdtemp(dir)) {
+            perror("mkdtemp");
+            return -1;
+        }
+    }
+    snprintf(log, PATH_MAX, "%s/index.log", dir);
+    unlink(log);
+
+    test_basic(log);
+    test_torn(log);
+    test_compact(log);
+
+    unlink(log);
+    if (argc <= 1) {
+        rmdir(dir);
+    }
+
+    printf("kv_index: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
@@ -0,0 +1,253 @@
+
+/*
+ * lz4_codec: round trips, a capacity too small for the compressor and the bounds checks of the decoder
+ */
+
+#include "all_system.h"
+#include "base/lz4_codec.h"
+
+#define GUARD_SIZE  64
+#define GUARD_BYTE  0x5a
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+// Decompress into a buffer of exactly dst_size bytes followed by a guard that must stay untouched
+int decompress_guarded ( const char *src, int src_size, int dst_size, char *out )
+{
+    char *dst;
+    int   ret;
+
+    dst = (char *)malloc(dst_size + GUARD_SIZE);
+    if (NULL == dst) {
+        return -2;
+    }
+    memset(dst, GUARD_BYTE, dst_size + GUARD_SIZE);
+
+    ret = lz4_codec_decompress(src, src_size, dst, dst_size);
+    for (int i = dst_size; i < dst_size + GUARD_SIZE; i++)
+    {
+        if (dst[i] != GUARD_BYTE)
+        {
+            printf("FAIL write past the output at %d (dst_size %d)\n", i, dst_size);
+            n_errors++;
+            break;
+        }
+    }
+    if ((NULL != out) && (ret > 0)) {
+        memcpy(out, dst, ret);
+    }
+
+    free(dst);
+    return ret;
+}
+
+void fill ( char *buffer, int size, int kind )
+{
+    switch (kind)
+    {
+        case 0: // zeros
+            memset(buffer, 0, size);
+            break;
+        case 1: // short repeated pattern
+            for (int i = 0; i < size; i++) {
+                buffer[i] = "expand"[i % 6];
+            }
+            break;
+        case 2: // text like, with matches at several distances
+            for (int i = 0; i < size; i++) {
+                buffer[i] = (char)('a' + ((i / 7) * 13 + (i % 7)) % 26);
+            }
+            break;
+        default: // not compressible
+            for (int i = 0; i < size; i++) {
+                buffer[i] = (char)(rand() & 0xff);
+            }
+            break;
+    }
+}
+
+void test_round_trip ( void )
+{
+    int   sizes[] = { 0, 1, 5, 12, 13, 17, 100, 4099, 65536, 65537 + 11, 1024 * 1024 };
+    char *src, *cmp, *out;
+    int   n_cmp, ret;
+
+    printf("lz4_codec: round trips\n");
+
+    src = (char *)malloc(1024 * 1024);
+    out = (char *)malloc(1024 * 1024);
+    cmp = (char *)malloc(LZ4_CODEC_BOUND(1024 * 1024));
+
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        for (int kind = 0; kind < 4; kind++)
+        {
+            fill(src, sizes[s], kind);
+
+            n_cmp = lz4_codec_compress(src, sizes[s], cmp, LZ4_CODEC_BOUND(sizes[s]));
+            CHECK(n_cmp >= 0);
+            CHECK(n_cmp <= LZ4_CODEC_BOUND(sizes[s]));
+            if ((kind < 3) && (sizes[s] >= 4099)) {
+                CHECK(n_cmp < sizes[s] / 4);
+            }
+            if (n_cmp < 0) {
+                continue;
+            }
+
+            ret = decompress_guarded(cmp, n_cmp, sizes[s], out);
+            CHECK(ret == sizes[s]);
+            if ((ret > 0) && (memcmp(src, out, ret) != 0))
+            {
+                printf("FAIL size %d kind %d: data differs\n", sizes[s], kind);
+                n_errors++;
+            }
+
+            // the output size must be exact
+            if (sizes[s] > 0) {
+                CHECK(decompress_guarded(cmp, n_cmp, sizes[s] - 1, NULL) == -1);
+            }
+            CHECK(decompress_guarded(cmp, n_cmp, sizes[s] + 1, NULL) == -1);
+        }
+    }
+
+    free(src);
+    free(out);
+    free(cmp);
+}
+
+void test_capacity ( void )
+{
+    char src[8192], cmp[LZ4_CODEC_BOUND(8192)];
+
+    printf("lz4_codec: capacity too small\n");
+
+    // not compressible data does not fit in less than its own size
+    fill(src, sizeof(src), 3);
+    CHECK(lz4_codec_compress(src, sizeof(src), cmp, sizeof(src) - 1) == -1);
+    CHECK(lz4_codec_compress(src, sizeof(src), cmp, 0) == -1);
+
+    // compressible data fits in a small capacity, but not in a tiny one
+    fill(src, sizeof(src), 1);
+    CHECK(lz4_codec_compress(src, sizeof(src), cmp, sizeof(src) / 8) > 0);
+    CHECK(lz4_codec_compress(src, sizeof(src), cmp, 4) == -1);
+}
+
+void test_bounds ( void )
+{
+    char out[64];
+
+    printf("lz4_codec: bounds of the decoder\n");
+
+    // valid sequences: literals, then a match; and an overlapping match that repeats one byte
+    const char lit_match[] = { 0x40, 'a', 'b', 'c', 'd', 0x04, 0x00 };
+    const char run[]       = { 0x1f, 'x', 0x01, 0x00, 0x05 };
+    CHECK(decompress_guarded(lit_match, sizeof(lit_match), 8, out) == 8);
+    CHECK(memcmp(out, "abcdabcd", 8) == 0);
+    CHECK(decompress_guarded(run, sizeof(run), 25, out) == 25);
+    CHECK((out[0] == 'x') && (out[24] == 'x'));
+
+    // match longer than the output left
+    CHECK(decompress_guarded(lit_match, sizeof(lit_match), 7, NULL) == -1);
+    CHECK(decompress_guarded(run, sizeof(run), 24, NULL) == -1);
+
+    // offset 0, and offsets before the beginning of the output
+    const char offset_zero[] = { 0x40, 'a', 'b', 'c', 'd', 0x00, 0x00 };
+    const char offset_far[]  = { 0x40, 'a', 'b', 'c', 'd', 0x05, 0x00 };
+    const char offset_max[]  = { 0x40, 'a', 'b', 'c', 'd', (char)0xff, (char)0xff };
+    const char no_literal[]  = { 0x00, 0x01, 0x00 };
+    CHECK(decompress_guarded(offset_zero, sizeof(offset_zero), 8, NULL) == -1);
+    CHECK(decompress_guarded(offset_far,  sizeof(offset_far),  8, NULL) == -1);
+    CHECK(decompress_guarded(offset_max,  sizeof(offset_max),  8, NULL) == -1);
+    CHECK(decompress_guarded(no_literal,  sizeof(no_literal),  4, NULL) == -1);
+
+    // offset cut in the middle
+    CHECK(decompress_guarded(lit_match, sizeof(lit_match) - 1, 8, NULL) == -1);
+
+    // length extensions cut at the end of the input (literals and match)
+    const char lit_ext[]   = { (char)0xf0, (char)0xff, (char)0xff };
+    const char match_ext[] = { 0x1f, 'x', 0x01, 0x00, (char)0xff };
+    CHECK(decompress_guarded(lit_ext, 1, 64, NULL) == -1);
+    CHECK(decompress_guarded(lit_ext, sizeof(lit_ext), 64, NULL) == -1);
+    CHECK(decompress_guarded(match_ext, sizeof(match_ext), 64, NULL) == -1);
+
+    // literals past the end of the input, and past the end of the output
+    const char lit_short[] = { 0x50, 'a', 'b', 'c', 'd' };
+    const char lit_long[]  = { (char)0xf0, 0x01, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h',
+                               'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p' };
+    CHECK(decompress_guarded(lit_short, sizeof(lit_short), 5, NULL) == -1);
+    CHECK(decompress_guarded(lit_long,  sizeof(lit_long),  16, out) == 16);
+    CHECK(decompress_guarded(lit_long,  sizeof(lit_long),  15, NULL) == -1);
+    CHECK(decompress_guarded(lit_long,  sizeof(lit_long) - 1, 16, NULL) == -1);
+
+    // empty input is only valid for an empty output
+    CHECK(decompress_guarded(lit_match, 0, 0, NULL) == 0);
+    CHECK(decompress_guarded(lit_match, 0, 1, NULL) == -1);
+}
+
+void test_corrupted ( void )
+{
+    char *src, *cmp, *bad;
+    int   size = 70000;
+    int   n_cmp, ret;
+
+    printf("lz4_codec: truncated and corrupted input\n");
+
+    src = (char *)malloc(size);
+    cmp = (char *)malloc(LZ4_CODEC_BOUND(size));
+    bad = (char *)malloc(LZ4_CODEC_BOUND(size));
+
+    fill(src, size, 2);
+    for (int i = 0; i < size; i = i + 997) {
+        src[i] = (char)(rand() & 0xff);
+    }
+    n_cmp = lz4_codec_compress(src, size, cmp, LZ4_CODEC_BOUND(size));
+    CHECK(n_cmp > 0);
+    if (n_cmp <= 0) {
+        goto end;
+    }
+
+    // every prefix of the input stops before the exact size
+    for (int n = 0; n < n_cmp; n++) {
+        CHECK(decompress_guarded(cmp, n, size, NULL) == -1);
+    }
+
+    // random bytes changed: an error or a full output, never a write past it
+    for (int k = 0; k < 2000; k++)
+    {
+        memcpy(bad, cmp, n_cmp);
+        for (int j = 0; j < 1 + k % 4; j++) {
+            bad[rand() % n_cmp] = (char)(rand() & 0xff);
+        }
+        ret = decompress_guarded(bad, n_cmp, size, NULL);
+        CHECK((ret == -1) || (ret == size));
+    }
+
+end:
+    free(src);
+    free(cmp);
+    free(bad);
+}
+
+
+int main ( void )
+{
+    srand(1234);
+
+    test_round_trip();
+    test_capacity();
+    test_bounds();
+    test_corrupted();
+
+    printf("lz4_codec: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
@@ -0,0 +1,132 @@
+
+/*
+ * ns: DNS files with long server names and long (MPI) port names, lines too long for the cache,
+ * and lines published after the file was loaded.
+ */
+
+#include "all_system.h"
+#include "base/ns.h"
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+char dns_file[PATH_MAX];
+
+// A string of 'size' characters from 'seed' (no blanks and no ':')
+void make_name ( char *str, int size, int seed )
+{
+    for (int i = 0; i < size; i++) {
+        str[i] = 'a' + (i * 7 + seed) % 26;
+    }
+    str[size] = '\0';
+}
+
+// Like the port names of MPICH: "tag#0$description#<...>$port#<n>$ifname#<ip>$"
+void make_port ( char *str, int size, int seed )
+{
+    int n;
+
+    n = snprintf(str, size + 1, "tag#0$description#host%d$port#%d$ifname#10.0.0.%d$", seed, 40000 + seed, seed % 250);
+    for (int i = n; i < size; i++) {
+        str[i] = '0' + (i + seed) % 10;
+    }
+    str[size] = '\0';
+}
+
+void check_lookup ( char *name, char *ip, char *port )
+{
+    char srv_ip[CONST_TEMP];
+    char port_name[MAX_PORT_NAME_LENGTH];
+
+    memset(srv_ip,    0, sizeof(srv_ip));
+    memset(port_name, 0, sizeof(port_name));
+    CHECK(ns_lookup("mpi_server", name, srv_ip, port_name) == 0);
+    CHECK(strcmp(srv_ip, ip) == 0);
+    CHECK(strcmp(port_name, port) == 0);
+
+    // also by address
+    memset(port_name, 0, sizeof(port_name));
+    CHECK(ns_lookup("mpi_server", ip, srv_ip, port_name) == 0);
+    CHECK(strcmp(port_name, port) == 0);
+}
+
+int main ( void )
+{
+    char name[8][CONST_TEMP];
+    char ip  [8][CONST_TEMP];
+    char port[8][MAX_PORT_NAME_LENGTH];
+    char srv_ip[CONST_TEMP];
+    char port_name[MAX_PORT_NAME_LENGTH];
+    char long_port[4 * MAX_PORT_NAME_LENGTH];
+    FILE *f;
+    int   fd;
+
+    strcpy(dns_file, "/tmp/ns-test.XXXXXX");
+    fd = mkstemp(dns_file);
+    if (fd < 0)
+    {
+        printf("FAIL mkstemp\n");
+        return -1;
+    }
+    close(fd);
+    setenv("XPN_DNS", dns_file, 1);
+
+    // short names, a port of 71 characters, the longest port, long names and addresses
+    make_name(name[0], 8,   0);  make_name(ip[0], 8,   1);  make_port(port[0], 20, 0);
+    make_name(name[1], 8,   2);  make_name(ip[1], 8,   3);  make_port(port[1], 71, 1);
+    make_name(name[2], 16,  4);  make_name(ip[2], 16,  5);  make_port(port[2], MAX_PORT_NAME_LENGTH - 1, 2);
+    make_name(name[3], 900, 6);  make_name(ip[3], 900, 7);  make_port(port[3], 200, 3);
+    make_name(name[4], 8,   8);  make_name(ip[4], 8,   9);  make_port(port[4], 30, 4);
+
+    // a port that does not fit, between good lines
+    make_port(long_port, sizeof(long_port) - 1, 5);
+    make_name(name[5], 8, 10);   make_name(ip[5], 8, 11);
+
+    f = fopen(dns_file, "w");
+    CHECK(NULL != f);
+    if (NULL == f) {
+        return -1;
+    }
+    for (int i = 0; i < 3; i++) {
+        fprintf(f, "mpi_server:%s mpi_server:%s %s\n", name[i], ip[i], port[i]);
+    }
+    fprintf(f, "mpi_server:%s mpi_server:%s %s\n", name[5], ip[5], long_port);
+    for (int i = 3; i < 5; i++) {
+        fprintf(f, "mpi_server:%s mpi_server:%s %s\n", name[i], ip[i], port[i]);
+    }
+    fclose(f);
+
+    printf("ns: long names and port names\n");
+    for (int i = 0; i < 5; i++) {
+        check_lookup(name[i], ip[i], port[i]);
+    }
+
+    printf("ns: lines too long are skipped\n");
+    CHECK(ns_lookup("mpi_server", name[5], srv_ip, port_name) < 0);
+
+    printf("ns: published after the file was loaded\n");
+    make_name(name[6], 40, 12);  make_name(ip[6], 40, 13);  make_port(port[6], 150, 6);
+    CHECK(ns_publish(dns_file, "mpi_server", name[6], ip[6], port[6]) == 0);
+    check_lookup(name[6], ip[6], port[6]);
+    check_lookup(name[1], ip[1], port[1]);
+
+    printf("ns: unpublished\n");
+    CHECK(ns_unpublish(dns_file, "mpi_server", name[1]) == 0);
+    CHECK(ns_lookup("mpi_server", name[1], srv_ip, port_name) < 0);
+    check_lookup(name[2], ip[2], port[2]);
+    check_lookup(name[6], ip[6], port[6]);
+
+    unlink(dns_file);
+
+    printf("ns: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
@@ -0,0 +1,7 @@
+#!/bin/bash
+set -e
+
+./kv_index-test
+./shm_ring-test
+./lz4_codec-test
+./ns-test
@@ -0,0 +1,230 @@
+
+/*
+ * shm_ring: wrap-around of small rings, messages bigger than the ring, close and death of the peer
+ */
+
+#include "all_system.h"
+#include "base/shm_ring.h"
+#include <sys/wait.h>
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+// Byte 'i' of the stream of one direction
+static char stream_byte ( long i, int dir )
+{
+    return (char)((i * 7 + i / 251 + dir * 101) & 0xff);
+}
+
+// Size of message 'k': around the ring size, so the ring wraps in every possible place
+static int message_size ( int k, int ring_size )
+{
+    return 1 + (k * 37) % (3 * ring_size + 11);
+}
+
+struct peer_arg
+{
+    shm_ring_t *ring;
+    int  dir;
+    int  n_messages;
+    int  ring_size;
+    int  errors;
+};
+
+void * sender ( void *arg )
+{
+    struct peer_arg *p = (struct peer_arg *)arg;
+    char *buffer;
+    long  pos = 0;
+    int   size;
+
+    buffer = (char *)malloc(3 * p->ring_size + 11);
+    for (int k = 0; k < p->n_messages; k++)
+    {
+        size = message_size(k, p->ring_size);
+        for (int i = 0; i < size; i++) {
+            buffer[i] = stream_byte(pos + i, p->dir);
+        }
+        if (shm_ring_send(p->ring, buffer, size) != size) {
+            p->errors++;
+            break;
+        }
+        pos = pos + size;
+    }
+    free(buffer);
+
+    return NULL;
+}
+
+void * receiver ( void *arg )
+{
+    struct peer_arg *p = (struct peer_arg *)arg;
+    char *buffer;
+    long  pos = 0;
+    int   size;
+
+    buffer = (char *)malloc(3 * p->ring_size + 11);
+    for (int k = 0; k < p->n_messages; k++)
+    {
+        // the receiver reads pieces of other sizes than the ones sent
+        size = message_size(p->n_messages - 1 - k, p->ring_size);
+        if (shm_ring_recv(p->ring, buffer, size) != size) {
+            p->errors++;
+            break;
+        }
+        for (int i = 0; i < size; i++)
+        {
+            if (buffer[i] != stream_byte(pos + i, p->dir))
+            {
+                printf("FAIL stream %d differs at %ld\n", p->dir, pos + i);
+                p->errors++;
+                free(buffer);
+                return NULL;
+            }
+        }
+        pos = pos + size;
+    }
+    free(buffer);
+
+    return NULL;
+}
+
+// Messages both ways at the same time, received with other sizes
+void test_stream ( int ring_size, int n_messages )
+{
+    shm_ring_t client, server;
+    char name[64];
+    pthread_t th[4];
+    struct peer_arg args[4];
+    long total = 0;
+
+    printf("shm_ring: %d messages each way on a ring of %d bytes\n", n_messages, ring_size);
+
+    CHECK(shm_ring_create(&client, ring_size) == 0);
+    CHECK(shm_ring_getname(&client, name, sizeof(name)) == 0);
+    CHECK(shm_ring_attach(&server, name) == 0);
+    CHECK(shm_ring_attached(&client) == 0);
+    if (n_errors > 0) {
+        return;
+    }
+
+    // the receiver gets as many bytes as sent: same sizes in reverse order
+    for (int k = 0; k < n_messages; k++) {
+        total = total + message_size(k, ring_size);
+    }
+
+    args[0] = (struct peer_arg){ &client, SHM_RING_TO_SERVER, n_messages, ring_size, 0 };
+    args[1] = (struct peer_arg){ &server, SHM_RING_TO_SERVER, n_messages, ring_size, 0 };
+    args[2] = (struct peer_arg){ &server, SHM_RING_TO_CLIENT, n_messages, ring_size, 0 };
+    args[3] = (struct peer_arg){ &client, SHM_RING_TO_CLIENT, n_messages, ring_size, 0 };
+    pthread_create(&th[0], NULL, sender,   &args[0]);
+    pthread_create(&th[1], NULL, receiver, &args[1]);
+    pthread_create(&th[2], NULL, sender,   &args[2]);
+    pthread_create(&th[3], NULL, receiver, &args[3]);
+    for (int i = 0; i < 4; i++)
+    {
+        pthread_join(th[i], NULL);
+        CHECK(args[i].errors == 0);
+    }
+
+    // head and tail went around the ring many times and met again
+    CHECK(server.rx_ctl->head == (uint64_t)total);
+    CHECK(server.rx_ctl->tail == (uint64_t)total);
+    CHECK(client.rx_ctl->tail == (uint64_t)total);
+    CHECK(total > 10 * ring_size);
+
+    CHECK(shm_ring_close(&server) == 0);
+    CHECK(shm_ring_close(&client) == 0);
+}
+
+void * close_later ( void *arg )
+{
+    usleep(100 * 1000);
+    shm_ring_close((shm_ring_t *)arg);
+    return NULL;
+}
+
+// A receiver waiting on an empty ring sees the end of the channel
+void test_close ( void )
+{
+    shm_ring_t client, server;
+    char name[64];
+    char buffer[16];
+    pthread_t th;
+
+    printf("shm_ring: close while the peer waits\n");
+
+    CHECK(shm_ring_create(&client, 128) == 0);
+    CHECK(shm_ring_getname(&client, name, sizeof(name)) == 0);
+    CHECK(shm_ring_attach(&server, name) == 0);
+    CHECK(shm_ring_attached(&client) == 0);
+    if (n_errors > 0) {
+        return;
+    }
+
+    pthread_create(&th, NULL, close_later, &client);
+    CHECK(shm_ring_recv(&server, buffer, sizeof(buffer)) == 0);
+    pthread_join(th, NULL);
+
+    CHECK(shm_ring_close(&server) == 0);
+}
+
+// A sender waiting on a full ring sees that the peer died
+void test_dead_peer ( void )
+{
+    shm_ring_t client, server;
+    char  name[64];
+    char  buffer[1024];
+    char  c = 'x';
+    pid_t pid;
+
+    printf("shm_ring: the peer dies with the ring full\n");
+
+    CHECK(shm_ring_create(&client, 256) == 0);
+    CHECK(shm_ring_getname(&client, name, sizeof(name)) == 0);
+
+    pid = fork();
+    if (0 == pid)
+    {
+        if (shm_ring_attach(&server, name) < 0) {
+            _exit(1);
+        }
+        shm_ring_send(&server, &c, 1);
+        _exit(0);
+    }
+
+    CHECK(shm_ring_recv(&client, &c, 1) == 1);
+    CHECK(c == 'x');
+    CHECK(shm_ring_attached(&client) == 0);
+    CHECK(client.peer == pid);
+    waitpid(pid, NULL, 0);
+
+    memset(buffer, 0, sizeof(buffer));
+    CHECK(shm_ring_send(&client, buffer, sizeof(buffer)) < 0);
+    CHECK(errno == ECONNRESET);
+    CHECK(client.broken == 1);
+
+    CHECK(shm_ring_close(&client) == 0);
+}
+
+
+int main ( void )
+{
+    test_stream(64,   2000);
+    test_stream(1000, 2000);
+    test_stream(4096, 500);
+    test_close();
+    test_dead_peer();
+
+    printf("shm_ring: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
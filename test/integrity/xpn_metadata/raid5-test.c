@@ -0,0 +1,224 @@
+
+/*
+ * raid5 distribution: the server and offset of every data block, the place of the parity of every stripe,
+ * and the blocks of each server rebuilt from the others and the parity, for several numbers of servers.
+ */
+
+#include "all_system.h"
+#include "xpn/xpn_simple/xpn_policy_parity.h"
+
+#define BLOCK_SIZE  64
+#define N_ROUNDS    3
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+// Server of the parity of stripe 's'
+int parity_server ( int nserv, int first_node, off_t s )
+{
+    off_t l_offset;
+    int   l_serv;
+
+    XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, s * (nserv - 1) * BLOCK_SIZE, 1, first_node, &l_offset, &l_serv);
+    return l_serv;
+}
+
+// Every server has one block of every stripe (data or parity) in its block 's', and the parity goes round the servers
+void test_mapping ( int nserv, int first_node )
+{
+    int    n_stripes = N_ROUNDS * nserv;
+    int   *owner;
+    int   *n_parity;
+    off_t  b, s, offset, l_offset, p_offset;
+    int    k, l_serv, p_serv;
+    struct xpn_metadata mdata;
+
+    owner    = (int *)malloc(n_stripes * nserv * sizeof(int));
+    n_parity = (int *)calloc(nserv, sizeof(int));
+    for (int i = 0; i < n_stripes * nserv; i++) {
+        owner[i] = -1;
+    }
+
+    memset(&mdata, 0, sizeof(mdata));
+    mdata.block_size          = BLOCK_SIZE;
+    mdata.replication_level   = 1;
+    mdata.data_nserv[0]       = nserv;
+    mdata.first_node          = first_node;
+    mdata.distribution_policy = XPN_METADATA_DISTRIBUTION_RAID5;
+
+    for (s = 0; s < n_stripes; s++)
+    {
+        // the data blocks of the stripe
+        for (k = 0; k < nserv - 1; k++)
+        {
+            b = s * (nserv - 1) + k;
+
+            // any byte of the block goes to the same server, at the same place in block 's'
+            for (offset = b * BLOCK_SIZE; offset < (b + 1) * BLOCK_SIZE; offset = offset + 13)
+            {
+                XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, offset, 0, first_node, &l_offset, &l_serv);
+                CHECK((l_serv >= 0) && (l_serv < nserv));
+                CHECK(l_offset == s * BLOCK_SIZE + offset % BLOCK_SIZE);
+                if (offset == b * BLOCK_SIZE)
+                {
+                    if ((l_serv >= 0) && (l_serv < nserv))
+                    {
+                        CHECK(owner[s * nserv + l_serv] == -1);
+                        owner[s * nserv + l_serv] = (int)k;
+                    }
+                }
+
+                // the parity is the same for all the blocks of the stripe
+                XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, offset, 1, first_node, &p_offset, &p_serv);
+                CHECK(p_serv == parity_server(nserv, first_node, s));
+                CHECK(p_offset == l_offset);
+            }
+
+            // the same through the metadata of the file
+            XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, b * BLOCK_SIZE, 0, first_node, &l_offset, &l_serv);
+            XpnCalculateBlockMdata(&mdata, b * BLOCK_SIZE + 5, 0, &p_offset, &p_serv);
+            CHECK(p_serv == l_serv);
+            CHECK(p_offset == l_offset + 5);
+            XpnCalculateBlockMdata(&mdata, b * BLOCK_SIZE + 5, 1, &p_offset, &p_serv);
+            CHECK(p_serv == parity_server(nserv, first_node, s));
+        }
+
+        // the parity in the server that is left
+        p_serv = parity_server(nserv, first_node, s);
+        CHECK(owner[s * nserv + p_serv] == -1);
+        owner[s * nserv + p_serv] = nserv - 1;
+        n_parity[p_serv]++;
+
+        // the parity of the next stripe in the previous server
+        if (s > 0) {
+            CHECK(p_serv == (parity_server(nserv, first_node, s - 1) - 1 + nserv) % nserv);
+        }
+    }
+
+    // no server without a block in a stripe, and the same number of parity blocks in each one
+    for (int i = 0; i < n_stripes * nserv; i++) {
+        CHECK(owner[i] != -1);
+    }
+    for (int i = 0; i < nserv; i++) {
+        CHECK(n_parity[i] == N_ROUNDS);
+    }
+
+    free(owner);
+    free(n_parity);
+}
+
+// Data files of the servers written as XpnParityWrite does, and each server rebuilt as XpnParityRead does
+void test_rebuild ( int nserv, int first_node )
+{
+    int    n_stripes = N_ROUNDS * nserv;
+    long   file_size = (long)n_stripes * (nserv - 1) * BLOCK_SIZE;
+    long   serv_size = (long)n_stripes * BLOCK_SIZE;
+    char  *file, *data, *rebuilt, *read_back;
+    char **blocks;
+    off_t  s, b, l_offset;
+    int    k, f, l_serv, nblocks;
+
+    file      = (char *)malloc(file_size);
+    data      = (char *)malloc(nserv * serv_size);
+    rebuilt   = (char *)malloc(BLOCK_SIZE);
+    read_back = (char *)malloc(file_size);
+    blocks    = (char **)malloc(nserv * sizeof(char *));
+
+    for (long i = 0; i < file_size; i++) {
+        file[i] = (char)(rand() & 0xff);
+    }
+
+    // write: the data blocks, and the parity of the data blocks of each stripe in their order
+    memset(data, 0, nserv * serv_size);
+    for (s = 0; s < n_stripes; s++)
+    {
+        for (k = 0; k < nserv - 1; k++)
+        {
+            b = s * (nserv - 1) + k;
+            XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, b * BLOCK_SIZE, 0, first_node, &l_offset, &l_serv);
+            memcpy(data + l_serv * serv_size + l_offset, file + b * BLOCK_SIZE, BLOCK_SIZE);
+            blocks[k] = file + b * BLOCK_SIZE;
+        }
+        XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, s * (nserv - 1) * BLOCK_SIZE, 1, first_node, &l_offset, &l_serv);
+        MATH_MISC_XorN(data + l_serv * serv_size + l_offset, blocks, nserv - 1, BLOCK_SIZE);
+    }
+
+    // read with the server 'f' failed: its blocks are the XOR of the other blocks of their stripe
+    for (f = 0; f < nserv; f++)
+    {
+        memset(read_back, 0, file_size);
+        for (s = 0; s < n_stripes; s++)
+        {
+            nblocks = 0;
+            for (int i = 0; i < nserv; i++)
+            {
+                if (i != f) {
+                    blocks[nblocks++] = data + i * serv_size + s * BLOCK_SIZE;
+                }
+            }
+            MATH_MISC_XorN(rebuilt, blocks, nblocks, BLOCK_SIZE);
+
+            for (k = 0; k < nserv - 1; k++)
+            {
+                b = s * (nserv - 1) + k;
+                XpnCalculateBlockRaid5(BLOCK_SIZE, nserv, b * BLOCK_SIZE, 0, first_node, &l_offset, &l_serv);
+                if (l_serv == f) {
+                    memcpy(read_back + b * BLOCK_SIZE, rebuilt, BLOCK_SIZE);
+                } else {
+                    memcpy(read_back + b * BLOCK_SIZE, data + l_serv * serv_size + l_offset, BLOCK_SIZE);
+                }
+            }
+
+            // when the parity is the block lost, the rebuild gives the parity back
+            if (parity_server(nserv, first_node, s) == f) {
+                CHECK(memcmp(rebuilt, data + f * serv_size + s * BLOCK_SIZE, BLOCK_SIZE) == 0);
+            }
+        }
+
+        if (memcmp(read_back, file, file_size) != 0)
+        {
+            printf("FAIL %d servers (first %d): the file differs without server %d\n", nserv, first_node, f);
+            n_errors++;
+        }
+    }
+
+    free(file);
+    free(data);
+    free(rebuilt);
+    free(read_back);
+    free(blocks);
+}
+
+
+int main ( void )
+{
+    int nservs[] = { 3, 4, 5, 7, 8 };
+    int nserv;
+
+    srand(5678);
+
+    for (unsigned i = 0; i < sizeof(nservs) / sizeof(nservs[0]); i++)
+    {
+        nserv = nservs[i];
+        printf("raid5: %d servers\n", nserv);
+
+        test_mapping(nserv, 0);
+        test_mapping(nserv, 1);
+        test_mapping(nserv, nserv - 1);
+
+        test_rebuild(nserv, 0);
+        test_rebuild(nserv, nserv - 1);
+    }
+
+    printf("raid5: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
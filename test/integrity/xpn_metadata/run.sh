@@ -0,0 +1,4 @@
+#!/bin/bash
+set -e
+
+./raid5-test
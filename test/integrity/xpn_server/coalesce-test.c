@@ -0,0 +1,299 @@
+
+/*
+ * Group commit of small writes (xpn_server -g): batches of overlapping and adjacent writes that arrive
+ * out of order, checked against a reference image where the last write wins; runs longer than
+ * XPN_SERVER_COALESCE_MAX_RUN, and the writes done one by one when malloc fails.
+ */
+
+#include "all_system.h"
+#include "xpn_server_coalesce.h"
+
+#define MAX_SIZE    (10 * 1024 * 1024)
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+// malloc of xpn_server_coalesce.c (built with -Dmalloc=coalesce_test_malloc): it fails after 'malloc_ok' more calls,
+// 'malloc_limit' while a batch is written
+int malloc_ok    = -1;
+int malloc_limit = -1;
+
+void * coalesce_test_malloc ( size_t size )
+{
+    if (malloc_ok == 0) {
+        return NULL;
+    }
+    if (malloc_ok > 0) {
+        malloc_ok--;
+    }
+    return malloc(size);
+}
+
+
+struct write_arg
+{
+    xpn_server_coalesce_t *c;
+    struct xpn_server_coalesce_file *file;
+    int     fd;
+    off_t   offset;
+    long    size;
+    char   *buffer;
+    ssize_t ret;
+    int     leader;
+};
+
+char  file_name[PATH_MAX];
+char *ref;
+long  ref_size;
+int   client;
+
+void * do_write ( void *arg )
+{
+    struct write_arg *w = (struct write_arg *)arg;
+
+    w->ret = xpn_server_coalesce_write(w->c, w->file, w->fd, w->offset, w->buffer, w->size, &(w->leader));
+    return NULL;
+}
+
+// Writes in the given order ({offset, size} pairs) as one batch, and the same writes on the reference image
+void write_batch ( xpn_server_coalesce_t *c, int fd, long *writes, int n, int seed, long n_syscalls, const char *step )
+{
+    struct write_arg *w;
+    pthread_t *th;
+    long  n_batches, syscalls, pending;
+    int   n_leaders = 0;
+
+    w  = (struct write_arg *)malloc(n * sizeof(struct write_arg));
+    th = (pthread_t *)malloc(n * sizeof(pthread_t));
+
+    // all of them are receiving their data, so the leader waits for all of them
+    for (int k = 0; k < n; k++)
+    {
+        w[k].c      = c;
+        w[k].file   = xpn_server_coalesce_begin(c, file_name, &client);
+        w[k].fd     = fd;
+        w[k].offset = writes[2 * k];
+        w[k].size   = writes[2 * k + 1];
+        w[k].buffer = (char *)malloc(w[k].size);
+        for (long i = 0; i < w[k].size; i++) {
+            w[k].buffer[i] = (char)((w[k].offset + i) * 3 + k * 29 + seed);
+        }
+        CHECK(NULL != w[k].file);
+    }
+
+    n_batches = c->n_batches;
+    syscalls  = c->n_syscalls;
+    malloc_ok = malloc_limit;
+
+    // one after another, so the arrival order is the one given
+    for (int k = 0; k < n; k++)
+    {
+        pthread_create(&th[k], NULL, do_write, &w[k]);
+        do
+        {
+            usleep(1000);
+            pthread_mutex_lock(&(c->m_coalesce));
+            pending = w[k].file->n_receiving;
+            pthread_mutex_unlock(&(c->m_coalesce));
+        } while (pending > n - 1 - k);
+    }
+
+    for (int k = 0; k < n; k++) {
+        pthread_join(th[k], NULL);
+    }
+    malloc_ok = -1;
+
+    for (int k = 0; k < n; k++)
+    {
+        xpn_server_coalesce_end(c, w[k].file, 1);
+        CHECK(w[k].ret == w[k].size);
+        n_leaders = n_leaders + w[k].leader;
+
+        memcpy(ref + w[k].offset, w[k].buffer, w[k].size);
+        if (w[k].offset + w[k].size > ref_size) {
+            ref_size = w[k].offset + w[k].size;
+        }
+        free(w[k].buffer);
+    }
+
+    if ((c->n_batches - n_batches != 1) || (c->n_syscalls - syscalls != n_syscalls) || (n_leaders != 1))
+    {
+        printf("FAIL %s: %ld batches, %ld writes and %d leaders, expected 1, %ld and 1\n", step, c->n_batches - n_batches, c->n_syscalls - syscalls, n_leaders, n_syscalls);
+        n_errors++;
+    }
+
+    free(w);
+    free(th);
+}
+
+// The data file is the reference image
+void check_file ( int fd, const char *step )
+{
+    char *buffer = (char *)malloc(MAX_SIZE);
+    long  ret;
+
+    ret = pread(fd, buffer, MAX_SIZE, 0);
+    CHECK(ret == ref_size);
+    if ((ret > 0) && (memcmp(buffer, ref, ret) != 0))
+    {
+        for (long i = 0; i < ret; i++)
+        {
+            if (buffer[i] != ref[i])
+            {
+                printf("FAIL %s: the data file differs at %ld\n", step, i);
+                break;
+            }
+        }
+        n_errors++;
+    }
+
+    free(buffer);
+}
+
+void file_reset ( int fd )
+{
+    CHECK(ftruncate(fd, 0) == 0);
+    memset(ref, 0, MAX_SIZE);
+    ref_size = 0;
+}
+
+
+void test_overlap ( xpn_server_coalesce_t *c, int fd )
+{
+    // three overlapping writes, and three that overlap or are adjacent further on: two runs
+    long writes_1[] = { 100, 50,   0, 120,   60, 100,   300, 20,   280, 30,   320, 10 };
+    long writes_2[2 * 40];
+
+    printf("coalesce: overlapping writes out of order\n");
+    file_reset(fd);
+    write_batch(c, fd, writes_1, 6, 1, 2, "overlap");
+    check_file(fd, "overlap");
+
+    // random ones over the same range: the last one wins
+    for (int k = 0; k < 40; k++)
+    {
+        writes_2[2 * k]     = rand() % 60000;
+        writes_2[2 * k + 1] = 1 + rand() % 6000;
+    }
+    writes_2[0] = 0;
+    writes_2[1] = 66000;
+    write_batch(c, fd, writes_2, 40, 2, 1, "random overlap");
+    check_file(fd, "random overlap");
+}
+
+void test_adjacent ( xpn_server_coalesce_t *c, int fd )
+{
+    long writes[2 * 8];
+    int  order[8] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+
+    printf("coalesce: adjacent writes out of order\n");
+    file_reset(fd);
+
+    // one write of 8 pieces sorted by offset
+    for (int k = 0; k < 8; k++)
+    {
+        writes[2 * k]     = order[k] * 4096;
+        writes[2 * k + 1] = 4096;
+    }
+    write_batch(c, fd, writes, 8, 3, 1, "adjacent");
+    check_file(fd, "adjacent");
+
+    // with a hole between them: two writes
+    writes[2 * 2] = 40000;
+    write_batch(c, fd, writes, 8, 4, 2, "adjacent with a hole");
+    check_file(fd, "adjacent with a hole");
+}
+
+void test_max_run ( xpn_server_coalesce_t *c, int fd )
+{
+    // adjacent: the run is cut where it would be longer than XPN_SERVER_COALESCE_MAX_RUN
+    long adjacent[] = { 6 * MB, 3 * MB,   0, 3 * MB,   3 * MB, 3 * MB };
+    // overlapping: not cut, the last write wins in the bytes that would have been in two runs
+    long overlap[]  = { 6 * MB, 5 * MB / 2,   0, 5 * MB / 2,   2 * MB, 5 * MB / 2,   4 * MB, 5 * MB / 2 };
+
+    printf("coalesce: runs longer than %d bytes\n", XPN_SERVER_COALESCE_MAX_RUN);
+    file_reset(fd);
+    write_batch(c, fd, adjacent, 3, 5, 2, "max run adjacent");
+    check_file(fd, "max run adjacent");
+
+    file_reset(fd);
+    write_batch(c, fd, overlap, 4, 6, 1, "max run overlap");
+    check_file(fd, "max run overlap");
+}
+
+void test_no_memory ( xpn_server_coalesce_t *c, int fd )
+{
+    long writes[] = { 100, 50,   0, 120,   60, 100,   4000, 20,   3980, 30,   4020, 10,   9000, 10 };
+
+    printf("coalesce: malloc fails\n");
+
+    // without the sorted list: every write alone in arrival order
+    file_reset(fd);
+    malloc_limit = 0;
+    write_batch(c, fd, writes, 7, 7, 7, "no sorted list");
+    check_file(fd, "no sorted list");
+
+    // without the buffers of the runs: the writes of each run alone in arrival order
+    file_reset(fd);
+    malloc_limit = 1;
+    write_batch(c, fd, writes, 7, 8, 7, "no run buffer");
+    check_file(fd, "no run buffer");
+
+    // without the buffer of the second run
+    file_reset(fd);
+    malloc_limit = 2;
+    write_batch(c, fd, writes, 7, 9, 5, "no second run buffer");
+    malloc_limit = -1;
+    check_file(fd, "no second run buffer");
+}
+
+
+int main ( void )
+{
+    xpn_server_coalesce_t *c;
+    char stats[256];
+    int  fd;
+
+    srand(8765);
+
+    strcpy(file_name, "/tmp/coalesce-test.XXXXXX");
+    fd = mkstemp(file_name);
+    if (fd < 0)
+    {
+        printf("FAIL mkstemp\n");
+        return -1;
+    }
+
+    // a long window: the leader only stops waiting when all the writes arrived
+    ref = (char *)malloc(MAX_SIZE);
+    c   = xpn_server_coalesce_init(10 * 1000 * 1000);
+    CHECK(NULL != c);
+    if ((NULL == ref) || (NULL == c)) {
+        return -1;
+    }
+
+    test_overlap(c, fd);
+    test_adjacent(c, fd);
+    test_max_run(c, fd);
+    test_no_memory(c, fd);
+
+    xpn_server_coalesce_stats(c, stats, sizeof(stats));
+    printf("coalesce: %s\n", stats);
+
+    xpn_server_coalesce_destroy(c);
+    free(ref);
+    close(fd);
+    unlink(file_name);
+
+    printf("coalesce: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
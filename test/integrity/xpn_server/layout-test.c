@@ -0,0 +1,199 @@
+
+/*
+ * Data of a file written and read back in separate runs, so a client with locality (XPN_LOCALITY=1)
+ * and one through the server (XPN_LOCALITY=0) check the data of each other.
+ *
+ *   layout-test write <gen>   creat and write the image <gen> (unaligned and overlapping writes)
+ *   layout-test trunc <gen>   open with O_TRUNC and write the image <gen>
+ *   layout-test read  <gen>   read and check the image <gen>, before and after stat
+ *   layout-test rm            unlink and check it is gone
+ */
+
+#include "all_system.h"
+#include "xpn.h"
+
+#define FILE_NAME   "/P1/layout-test"
+#define CHUNK_SIZE  4099
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+// Image of each generation: a hole, a base pattern and an overlapping rewrite on top of it.
+// The next generations are bigger, with a bigger hole where the data of the previous one must not be seen.
+long image_size ( int gen )
+{
+    return 300777 + 40000 * gen;
+}
+
+long image_hole ( int gen )
+{
+    return (gen == 0) ? 0 : 50000 * gen + 123;
+}
+
+void image_build ( int gen, char *image )
+{
+    long size = image_size(gen);
+    long rw_offset = image_hole(gen) + 1000 + 3 * gen;
+    long rw_size   = size / 4 + 1;
+
+    memset(image, 0, image_hole(gen));
+    for (long i = image_hole(gen); i < size; i++) {
+        image[i] = (char)(i * 31 + gen);
+    }
+    for (long i = rw_offset; i < rw_offset + rw_size; i++) {
+        image[i] = (char)(i * 13 + gen + 101);
+    }
+}
+
+int image_write ( int fd, int gen )
+{
+    long  size = image_size(gen);
+    long  rw_offset = image_hole(gen) + 1000 + 3 * gen;
+    long  rw_size   = size / 4 + 1;
+    char *image;
+    long  to_write;
+
+    image = (char *)malloc(size);
+    if (NULL == image) {
+        return -1;
+    }
+    image_build(gen, image);
+
+    // sequential unaligned chunks after the hole, then the rewrite (the data of the base pattern, then the final one)
+    for (long i = rw_offset; i < rw_offset + rw_size; i++) {
+        image[i] = (char)(i * 31 + gen);
+    }
+    CHECK(xpn_lseek(fd, image_hole(gen), SEEK_SET) == image_hole(gen));
+    for (long i = image_hole(gen); i < size; i = i + to_write)
+    {
+        to_write = (size - i < CHUNK_SIZE) ? size - i : CHUNK_SIZE;
+        CHECK(xpn_write(fd, image + i, to_write) == to_write);
+    }
+
+    image_build(gen, image);
+    CHECK(xpn_lseek(fd, rw_offset, SEEK_SET) == rw_offset);
+    CHECK(xpn_write(fd, image + rw_offset, rw_size) == rw_size);
+
+    free(image);
+    return 0;
+}
+
+long image_check ( int fd, int gen, char *image, char *buffer )
+{
+    long size = image_size(gen);
+    long ret, i;
+
+    memset(buffer, 0, size + CHUNK_SIZE);
+    CHECK(xpn_lseek(fd, 0, SEEK_SET) == 0);
+    for (i = 0; i < size + CHUNK_SIZE; i = i + ret)
+    {
+        ret = xpn_read(fd, buffer + i, CHUNK_SIZE);
+        if (ret <= 0) {
+            break;
+        }
+    }
+    CHECK(i == size);
+
+    for (i = 0; i < size; i++)
+    {
+        if (buffer[i] != image[i])
+        {
+            printf("FAIL image %d differs at %ld\n", gen, i);
+            n_errors++;
+            break;
+        }
+    }
+
+    return size;
+}
+
+
+int main ( int argc, char *argv[] )
+{
+    struct stat st;
+    char *image, *buffer;
+    int   fd, gen = 0;
+
+    if (argc < 2)
+    {
+        printf("Usage: %s write|trunc|read <gen> | rm\n", argv[0]);
+        return -1;
+    }
+    if (argc > 2) {
+        gen = atoi(argv[2]);
+    }
+
+    image  = (char *)malloc(image_size(gen));
+    buffer = (char *)malloc(image_size(gen) + CHUNK_SIZE);
+    if ((NULL == image) || (NULL == buffer)) {
+        return -1;
+    }
+    image_build(gen, image);
+
+    if (xpn_init() < 0)
+    {
+        printf("FAIL xpn_init\n");
+        return -1;
+    }
+
+    if (strcmp(argv[1], "write") == 0)
+    {
+        fd = xpn_creat(FILE_NAME, 00644);
+        CHECK(fd >= 0);
+        if (fd >= 0) {
+            image_write(fd, gen);
+            CHECK(xpn_close(fd) == 0);
+        }
+    }
+    else if (strcmp(argv[1], "trunc") == 0)
+    {
+        fd = xpn_open(FILE_NAME, O_WRONLY | O_TRUNC);
+        CHECK(fd >= 0);
+        if (fd >= 0) {
+            image_write(fd, gen);
+            CHECK(xpn_close(fd) == 0);
+        }
+    }
+    else if (strcmp(argv[1], "read") == 0)
+    {
+        fd = xpn_open(FILE_NAME, O_RDONLY);
+        CHECK(fd >= 0);
+        if (fd >= 0)
+        {
+            // the data as written (with a write log on the server, maybe not in the data files yet)
+            image_check(fd, gen, image, buffer);
+
+            // stat gives the logical size, and the data is the same after it
+            CHECK(xpn_stat(FILE_NAME, &st) == 0);
+            CHECK(st.st_size == image_size(gen));
+            image_check(fd, gen, image, buffer);
+
+            CHECK(xpn_close(fd) == 0);
+        }
+    }
+    else if (strcmp(argv[1], "rm") == 0)
+    {
+        CHECK(xpn_unlink(FILE_NAME) == 0);
+        CHECK(xpn_stat(FILE_NAME, &st) < 0);
+        CHECK(xpn_open(FILE_NAME, O_RDONLY) < 0);
+    }
+    else
+    {
+        printf("FAIL unknown step '%s'\n", argv[1]);
+        n_errors++;
+    }
+
+    xpn_destroy();
+
+    printf("layout-test %s %d: %s (%d errors)\n", argv[1], gen, (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
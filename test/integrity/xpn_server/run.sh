@@ -0,0 +1,63 @@
+#!/bin/bash
+#
+# A client on the same node as the server (XPN_LOCALITY=1 uses the data files directly)
+# and one through the server (XPN_LOCALITY=0) read what the other wrote, for each data layout:
+#
+#   ./run.sh              metadata in the header of the data files
+#   ./run.sh index        metadata in the index of the server (xpn_server -d)
+#   ./run.sh wlog         data in the write logs of the server until they are compacted (xpn_server -L)
+#   ./run.sh index_wlog   both (xpn_server -d -L)
+#
+
+BASE_DIR=$(mktemp -d /tmp/xpn_server-test.XXXXXX)
+SERVER=../../../src/xpn_server/xpn_server
+
+mkdir -p $BASE_DIR/data
+cat > $BASE_DIR/xpn.conf <<EOF
+[partition]
+bsize = 64k
+replication_level = 0
+partition_name = P1
+server_url = sck_server://$(hostname)$BASE_DIR/data
+EOF
+
+case "$1" in
+  index) SERVER_ARGS="-d $BASE_DIR/index" ;;
+  wlog)  SERVER_ARGS="-L $BASE_DIR/wlog" ;;
+  index_wlog) SERVER_ARGS="-d $BASE_DIR/index -L $BASE_DIR/wlog" ;;
+  *)     SERVER_ARGS="" ;;
+esac
+
+$SERVER -s sck -t pool $SERVER_ARGS > $BASE_DIR/server.log 2>&1 &
+SERVER_PID=$!
+sleep 1
+
+export XPN_CONF=$BASE_DIR/xpn.conf
+RET=0
+step ()
+{
+    XPN_LOCALITY=$1 ./layout-test $2 $3 || RET=1
+}
+
+# local write, remote read and the other way round
+# (and reads of the data files with the header bytes of the layout, XPN_SHORT_CIRCUIT=1)
+step 1 write 0 ; step 0 read 0 ; step 1 read 0 ; XPN_SHORT_CIRCUIT=1 step 0 read 0
+step 0 write 1 ; step 1 read 1 ; step 0 read 1 ; XPN_SHORT_CIRCUIT=1 step 0 read 1
+# (O_TRUNC drops the header with the metadata, so only the layouts with the metadata in the server)
+case "$1" in
+  index*)
+    step 1 trunc 2 ; step 0 read 2
+    step 0 trunc 3 ; step 1 read 3 ;;
+esac
+step 1 rm
+
+# the write logs and the group commit of small writes alone
+[ "$1" = "wlog" ] && { ./wlog-test || RET=1; }
+[ -z "$1" ] && { ./coalesce-test || RET=1; }
+
+kill $SERVER_PID
+wait $SERVER_PID
+rm -rf $BASE_DIR
+
+[ $RET -eq 0 ] && echo "run.sh $1: OK" || echo "run.sh $1: FAIL"
+exit $RET
@@ -0,0 +1,334 @@
+
+/*
+ * Write logs of the server (xpn_server -L): random overlapping and unaligned writes checked against
+ * a reference image, before and after compaction, and the logs of truncated, recreated and removed files.
+ */
+
+#include "all_system.h"
+#include "xpn_server_wlog.h"
+
+#define MAX_SIZE    (1024 * 1024)
+#define MAX_WRITE   20000
+#define BASE_SIZE   200000
+
+int n_errors = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);         \
+            n_errors++;                                                    \
+        }                                                                  \
+    } while (0)
+
+
+char  base_dir[PATH_MAX];
+char  log_dir[PATH_MAX];
+char *ref;
+long  ref_size;
+
+
+void file_path ( char *path, const char *name )
+{
+    sprintf(path, "%.*s/%s", PATH_MAX - 64, base_dir, name);
+}
+
+// Data file with 'size' bytes of 'seed', and the same in the reference image
+void file_create ( char *path, long size, int seed )
+{
+    int fd;
+
+    memset(ref, 0, MAX_SIZE);
+    for (long i = 0; i < size; i++) {
+        ref[i] = (char)(i * 17 + seed);
+    }
+    ref_size = size;
+
+    fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    CHECK(fd >= 0);
+    CHECK(write(fd, ref, size) == size);
+    close(fd);
+}
+
+// Random writes to the log, also applied to the reference image
+void random_writes ( xpn_server_wlog_t *w, char *path, int n, int seed )
+{
+    char  *buffer = (char *)malloc(MAX_WRITE);
+    off_t  offset;
+    long   size, limit;
+
+    for (int k = 0; k < n; k++)
+    {
+        // anywhere up to a bit past the end of the file, so they overlap and extend it
+        limit  = (ref_size < MAX_SIZE - 2 * MAX_WRITE) ? ref_size : MAX_SIZE - 2 * MAX_WRITE;
+        offset = rand() % (limit + MAX_WRITE + 1);
+        size   = 1 + rand() % MAX_WRITE;
+        for (long i = 0; i < size; i++) {
+            buffer[i] = (char)((offset + i) * 7 + k + seed);
+        }
+
+        CHECK(xpn_server_wlog_write(w, path, offset, buffer, size) == size);
+        memcpy(ref + offset, buffer, size);
+        if (offset + size > ref_size) {
+            ref_size = offset + size;
+        }
+    }
+
+    free(buffer);
+}
+
+// Expected result of a read at 'offset' of 'size' bytes
+long expected_size ( off_t offset, long size )
+{
+    if (offset >= ref_size) {
+        return 0;
+    }
+    return (ref_size - offset < size) ? ref_size - offset : size;
+}
+
+// Reads through the log: all the file, and random pieces of it
+void check_reads ( xpn_server_wlog_t *w, char *path, const char *step )
+{
+    char   *buffer = (char *)malloc(MAX_SIZE);
+    off_t   offset;
+    long    size;
+    ssize_t ret;
+    int     fd;
+
+    fd = open(path, O_RDONLY);
+    CHECK(fd >= 0);
+
+    ret = xpn_server_wlog_read(w, path, fd, 0, buffer, MAX_SIZE);
+    CHECK(ret == ref_size);
+    if ((ret > 0) && (memcmp(buffer, ref, ret) != 0))
+    {
+        printf("FAIL %s: the data of the file differs\n", step);
+        n_errors++;
+    }
+
+    for (int k = 0; k < 200; k++)
+    {
+        offset = rand() % (ref_size + 1000);
+        size   = 1 + rand() % (3 * MAX_WRITE);
+        if (offset + size > MAX_SIZE) {
+            size = MAX_SIZE - offset;
+        }
+
+        ret = xpn_server_wlog_read(w, path, fd, offset, buffer, size);
+        if (ret != expected_size(offset, size))
+        {
+            printf("FAIL %s: read(%ld, %ld)=%ld, expected %ld\n", step, (long)offset, size, (long)ret, expected_size(offset, size));
+            n_errors++;
+            break;
+        }
+        if ((ret > 0) && (memcmp(buffer, ref + offset, ret) != 0))
+        {
+            printf("FAIL %s: read(%ld, %ld) data differs\n", step, (long)offset, size);
+            n_errors++;
+            break;
+        }
+    }
+
+    close(fd);
+    free(buffer);
+}
+
+// The data file itself, without the log
+void check_data_file ( char *path, const char *step )
+{
+    char *buffer = (char *)malloc(MAX_SIZE);
+    struct stat st;
+    long  ret;
+    int   fd;
+
+    CHECK(stat(path, &st) == 0);
+    CHECK(st.st_size == ref_size);
+
+    fd = open(path, O_RDONLY);
+    CHECK(fd >= 0);
+    ret = read(fd, buffer, MAX_SIZE);
+    CHECK(ret == ref_size);
+    if ((ret > 0) && (memcmp(buffer, ref, ret) != 0))
+    {
+        printf("FAIL %s: the data file differs\n", step);
+        n_errors++;
+    }
+    close(fd);
+
+    free(buffer);
+}
+
+// Files in the directory of the logs
+int n_logs ( void )
+{
+    DIR *dir;
+    struct dirent *entry;
+    int n = 0;
+
+    dir = opendir(log_dir);
+    if (NULL == dir) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.') {
+            n++;
+        }
+    }
+    closedir(dir);
+
+    return n;
+}
+
+
+void test_overwrite ( xpn_server_wlog_t *w )
+{
+    char path[PATH_MAX];
+    char stats[256];
+
+    printf("wlog: overlapping and unaligned writes, compaction\n");
+    file_path(path, "overwrite");
+    file_create(path, BASE_SIZE, 1);
+
+    // the data file is not changed until the log is compacted
+    random_writes(w, path, 500, 1);
+    check_reads(w, path, "logged");
+    CHECK(n_logs() == 1);
+
+    random_writes(w, path, 500, 2);
+    check_reads(w, path, "logged twice");
+
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    CHECK(n_logs() == 0);
+    check_data_file(path, "compacted");
+    check_reads(w, path, "compacted");
+
+    // a new log on top of the compacted file
+    random_writes(w, path, 300, 3);
+    check_reads(w, path, "logged after compaction");
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    check_data_file(path, "compacted again");
+
+    xpn_server_wlog_stats(w, stats, sizeof(stats));
+    CHECK(strstr(stats, "compactions=2") != NULL);
+
+    unlink(path);
+}
+
+void test_truncate ( xpn_server_wlog_t *w )
+{
+    char path[PATH_MAX];
+
+    printf("wlog: truncate and recreate\n");
+    file_path(path, "truncate");
+    file_create(path, BASE_SIZE, 4);
+    random_writes(w, path, 300, 4);
+
+    // open with O_TRUNC (and creat): the log of the old data goes before the truncation
+    xpn_server_wlog_discard(w, path, 0);
+    CHECK(n_logs() == 0);
+    file_create(path, 1000, 5);
+    check_reads(w, path, "truncated");
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    check_data_file(path, "truncated");
+
+    // the same with a smaller file written through the log
+    random_writes(w, path, 100, 6);
+    xpn_server_wlog_discard(w, path, 0);
+    file_create(path, 0, 7);
+    random_writes(w, path, 20, 7);
+    check_reads(w, path, "recreated");
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    check_data_file(path, "recreated");
+
+    unlink(path);
+}
+
+void test_remove ( xpn_server_wlog_t *w )
+{
+    char path[PATH_MAX], dir[PATH_MAX], path_a[PATH_MAX], path_b[PATH_MAX];
+    struct stat st;
+
+    printf("wlog: rm and rmdir\n");
+
+    // rm: the log goes with the file, and the compaction does not bring the file back
+    file_path(path, "remove");
+    file_create(path, BASE_SIZE, 8);
+    random_writes(w, path, 100, 8);
+    xpn_server_wlog_discard(w, path, 0);
+    CHECK(unlink(path) == 0);
+    CHECK(n_logs() == 0);
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    CHECK(stat(path, &st) < 0);
+
+    // the data file removed under the log: the compaction drops the log
+    file_create(path, BASE_SIZE, 9);
+    random_writes(w, path, 100, 9);
+    CHECK(unlink(path) == 0);
+    CHECK(xpn_server_wlog_compact(w, path, 0) == 0);
+    CHECK(n_logs() == 0);
+    CHECK(stat(path, &st) < 0);
+
+    // a directory: compaction and removal of the files below it, not of the ones with the same prefix
+    file_path(dir, "dir");
+    file_path(path_a, "dir/a");
+    file_path(path_b, "dir.b");
+    mkdir(dir, 0755);
+    file_create(path_b, 100, 10);
+    random_writes(w, path_b, 10, 10);
+    file_create(path_a, 100, 11);
+    random_writes(w, path_a, 10, 11);
+    CHECK(n_logs() == 2);
+
+    CHECK(xpn_server_wlog_compact(w, dir, 1) == 0);
+    CHECK(n_logs() == 1);
+    check_data_file(path_a, "compacted subtree");
+
+    random_writes(w, path_a, 10, 12);
+    xpn_server_wlog_discard(w, dir, 1);
+    CHECK(n_logs() == 1);
+    CHECK(xpn_server_wlog_compact(w, path_b, 0) == 0);
+    CHECK(n_logs() == 0);
+
+    unlink(path_a);
+    unlink(path_b);
+    rmdir(dir);
+}
+
+
+int main ( void )
+{
+    xpn_server_wlog_t *w;
+
+    srand(4321);
+
+    strcpy(base_dir, "/tmp/wlog-test.XXXXXX");
+    if (NULL == mkdtemp(base_dir))
+    {
+        printf("FAIL mkdtemp\n");
+        return -1;
+    }
+    file_path(log_dir, "logs");
+
+    ref = (char *)malloc(MAX_SIZE);
+    w   = xpn_server_wlog_init(log_dir);
+    CHECK(NULL != w);
+    if ((NULL == ref) || (NULL == w)) {
+        return -1;
+    }
+
+    test_overwrite(w);
+    test_truncate(w);
+    test_remove(w);
+
+    xpn_server_wlog_destroy(w);
+    free(ref);
+
+    CHECK(n_logs() == 0);
+    rmdir(log_dir);
+    rmdir(base_dir);
+
+    printf("wlog: %s (%d errors)\n", (n_errors == 0) ? "OK" : "FAIL", n_errors);
+
+    return (n_errors == 0) ? 0 : -1;
+}
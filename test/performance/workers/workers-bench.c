@@ -0,0 +1,135 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "all_system.h"
+#include "base/workers.h"
+#include <sys/time.h>
+
+
+long n_ops     = 200000 ;
+long n_work    = 0 ;
+int  n_clients = 4 ;
+long n_done    = 0 ;
+worker_t pool ;
+
+
+double get_time(void)
+{
+    struct timeval tp;
+    struct timezone tzp;
+
+    gettimeofday(&tp,&tzp);
+    return((double) tp.tv_sec + .000001 * (double) tp.tv_usec);
+}
+
+void op ( struct st_th th )
+{
+    volatile long x = 0 ;
+
+    (void)th ;
+    for (long i = 0; i < n_work; i++) {
+         x += i ;
+    }
+
+    __atomic_add_fetch(&n_done, 1, __ATOMIC_RELAXED) ;
+}
+
+void *client ( void *arg )
+{
+    struct st_th th_arg ;
+    long n = (long)arg ;
+
+    for (long i = 0; i < n; i++)
+    {
+         memset(&th_arg, 0, sizeof(struct st_th)) ;
+         th_arg.wait4me = FALSE ;
+         base_workers_launch(&pool, &th_arg, op) ;
+    }
+
+    return NULL ;
+}
+
+
+int main ( int argc, char *argv[] )
+{
+    pthread_t th[MAX_THREADS] ;
+    char   str[32] ;
+    double t_b, t_a ;
+    int    threads ;
+
+    if (argc < 2)
+    {
+        printf("\n") ;
+        printf(" Usage: %s <pool threads> [<pool threads> ...]\n", argv[0]) ;
+        printf("\n") ;
+        printf(" Environment:\n") ;
+        printf("   BENCH_OPS      operations per run (default %ld)\n", n_ops) ;
+        printf("   BENCH_CLIENTS  threads launching operations (default %d)\n", n_clients) ;
+        printf("   BENCH_WORK     loop iterations per operation (default %ld)\n", n_work) ;
+        printf("\n") ;
+        printf(" Example:") ;
+        printf(" %s 1 2 4 8 16\n", argv[0]) ;
+        printf("\n") ;
+        return -1 ;
+    }
+
+    n_ops     = utils_getenv_int("BENCH_OPS",     n_ops) ;
+    n_clients = utils_getenv_int("BENCH_CLIENTS", n_clients) ;
+    n_work    = utils_getenv_int("BENCH_WORK",    n_work) ;
+    if ((n_clients < 1) || (n_clients > MAX_THREADS)) {
+        n_clients = 1 ;
+    }
+
+    printf("# clients=%d ops=%ld work=%ld\n", n_clients, n_ops, n_work) ;
+    printf("# threads;ops/sec\n") ;
+
+    for (int a = 1; a < argc; a++)
+    {
+         threads = atoi(argv[a]) ;
+         sprintf(str, "%d", threads) ;
+         setenv("XPN_POOL_THREADS", str, 1) ;
+
+         base_workers_init(&pool, TH_POOL) ;
+         n_done = 0 ;
+
+         t_b = get_time() ;
+
+         for (int i = 0; i < n_clients; i++) {
+              pthread_create(&(th[i]), NULL, client, (void *)(n_ops / n_clients)) ;
+         }
+         for (int i = 0; i < n_clients; i++) {
+              pthread_join(th[i], NULL) ;
+         }
+         while (__atomic_load_n(&n_done, __ATOMIC_RELAXED) < (n_ops / n_clients) * n_clients) {
+              sched_yield() ;
+         }
+
+         t_a = get_time() ;
+
+         base_workers_destroy(&pool) ;
+
+         printf("%d;%.0f\n", threads, (double)n_done / (t_a - t_b)) ;
+    }
+
+    return 0 ;
+}
+
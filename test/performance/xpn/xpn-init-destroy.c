@@ -0,0 +1,100 @@
+
+/*
+ *  Copyright 2020-2025 Felix Garcia Carballeira, Diego Camarmas Alonso, Alejandro Calderon Mateos, Elías Del Pozo Puñal
+ *
+ *  This file is part of Expand.
+ *
+ *  Expand is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Expand is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with Expand.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "all_system.h"
+#include "xpn.h"
+#include <sys/time.h>
+
+
+double get_time(void)
+{
+    struct timeval tp;
+    struct timezone tzp;
+
+    gettimeofday(&tp,&tzp);
+    return((double) tp.tv_sec + .000001 * (double) tp.tv_usec);
+}
+
+
+int main ( int argc, char *argv[] )
+{
+	int    ret = 0, n_iter ;
+	double t_bi, t_init, t_first, t_destroy ;
+	double s_init = 0, s_first = 0, s_destroy = 0 ;
+	struct stat st ;
+
+	if (argc < 3)
+	{
+	    printf("\n") ;
+	    printf(" Usage: %s <full path> <iterations>\n", argv[0]) ;
+	    printf("\n") ;
+	    printf(" Example:") ;
+	    printf(" env XPN_CONF=./xpn.conf XPN_CONNECT_FANOUT=16 %s /P1 10\n", argv[0]);
+	    printf(" env XPN_CONF=./xpn.conf XPN_CONNECT_LAZY=1    %s /P1 10\n", argv[0]);
+	    printf("\n") ;
+	    return -1 ;
+	}
+
+	n_iter = atoi(argv[2]) ;
+
+	printf("Iteration; Init time (ms); First stat time (ms); Destroy time (ms)\n") ;
+	for (int i = 0; i < n_iter; i++)
+	{
+		// xpn-init
+		t_bi = get_time();
+		ret = xpn_init();
+		if (ret < 0) {
+		    printf("%d = xpn_init()\n", ret);
+		    return -1;
+		}
+		t_init = get_time() - t_bi;
+
+		// first operation (with XPN_CONNECT_LAZY=1 it pays for the connections)
+		t_bi = get_time();
+		ret = xpn_stat(argv[1], &st);
+		if (ret < 0) {
+		    printf("%d = xpn_stat('%s')\n", ret, argv[1]);
+		}
+		t_first = get_time() - t_bi;
+
+		// xpn-destroy
+		t_bi = get_time();
+		ret = xpn_destroy();
+		if (ret < 0) {
+		    printf("%d = xpn_destroy()\n", ret);
+		    return -1;
+		}
+		t_destroy = get_time() - t_bi;
+
+		printf("%d;%f;%f;%f\n", i, t_init * 1000, t_first * 1000, t_destroy * 1000) ;
+		s_init    += t_init ;
+		s_first   += t_first ;
+		s_destroy += t_destroy ;
+	}
+
+	if (n_iter > 0) {
+	    printf("Average;%f;%f;%f\n", s_init * 1000 / n_iter, s_first * 1000 / n_iter, s_destroy * 1000 / n_iter) ;
+	}
+
+	return 0;
+}
+